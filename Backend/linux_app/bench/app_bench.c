@@ -0,0 +1,1582 @@
+/*
+ * File: app_bench.c
+ * Version: 1.13.1
+ * Description:
+ * Implements the benchmark suite of logic_bench.
+ * Workloads are synthetic but shaped like real equations: random trees
+ * over inputs A-F using every gate type, so flattening, labels and
+ * escaping all get exercised.
+ */
+
+#include "app_bench.h"
+#include "logic_ast.h"
+#include "logic_netlist.h"
+#include "logic_graph.h"
+#include "logic_layout.h"
+#include "logic_parser.h"
+#include "logic_sim.h"
+#include "logic_event.h"
+#include "logic_seq.h"
+#include "logic_par.h"
+#include "logic_fault.h"
+#include "logic_sat.h"
+#include "logic_cnf.h"
+#include "logic_stim.h"
+#include "app_verification.h"
+#include "app_vectors.h"
+#include "utils_timer.h"
+#include "net_shm.h"
+#include "net_proto.h"
+#include "utils_lz4.h"
+#include "logic_minimizer.h"
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Minimum measured time per data point, so tiny workloads are averaged
+#define BENCH_MIN_NS 50000000LL
+
+/*
+ * Function: bench_rand
+ * --------------------
+ * xorshift32 PRNG. Deterministic, so every run builds identical circuits.
+ */
+static unsigned int bench_rand(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*
+ * Function: build_wide_tree
+ * -------------------------
+ * Builds a random logic tree with roughly 'nodes' nodes.
+ * Leaves are the first 'vars' variables (A, B, ...); inner nodes pick
+ * a random gate type.
+ */
+static LogicNode* build_wide_tree(int nodes, int vars, unsigned int* seed) {
+    static const NodeType GATES[] = { NODE_AND, NODE_OR, NODE_XOR, NODE_NOT, NODE_NAND, NODE_NOR };
+
+    if (nodes <= 1) return AST_CreateVar((char)('A' + bench_rand(seed) % (unsigned int)vars));
+
+    NodeType type = GATES[bench_rand(seed) % 6];
+    LogicNode* node = AST_CreateNode(type);
+    if (type == NODE_NOT) {
+        node->left = build_wide_tree(nodes - 1, vars, seed);
+    } else {
+        int left = 1 + (int)(bench_rand(seed) % (unsigned int)(nodes - 1));
+        node->left = build_wide_tree(left, vars, seed);
+        node->right = build_wide_tree(nodes - 1 - left > 0 ? nodes - 1 - left : 1, vars, seed);
+    }
+    return node;
+}
+
+// Random tree over inputs A-F
+static LogicNode* build_random_tree(int nodes, unsigned int* seed) {
+    return build_wide_tree(nodes, 6, seed);
+}
+
+static int count_nodes(LogicNode* node) {
+    if (!node) return 0;
+    return 1 + count_nodes(node->left) + count_nodes(node->right);
+}
+
+/*
+ * Function: bench_json
+ * --------------------
+ * Measures Netlist_GenerateCombinedJSON over four random trees for a
+ * range of circuit sizes. Reports nanoseconds and bytes per AST node.
+ * The output buffer is reused between iterations, which is how a
+ * long-running serializer would hold it.
+ */
+static void bench_json(const char* args, DynBuf* out) {
+    (void)args;
+    static const int SIZES[] = { 16, 256, 4096, 65536 };
+    unsigned int seed = 0x1234567u;
+
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+        LogicNode* roots[4];
+        int total_nodes = 0;
+        for (int i = 0; i < 4; i++) {
+            roots[i] = build_random_tree(SIZES[s] / 4, &seed);
+            total_nodes += count_nodes(roots[i]);
+        }
+
+        DynBuf json;
+        DynBuf_Init(&json);
+        long long iterations = 0;
+        long long start = Timer_GetNanos();
+        long long elapsed = 0;
+        do {
+            DynBuf_Reset(&json);
+            Netlist_GenerateCombinedJSON("X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3], &json);
+            iterations++;
+            elapsed = Timer_GetNanos() - start;
+        } while (elapsed < BENCH_MIN_NS);
+
+        double ns_per_node = (double)elapsed / (double)iterations / (double)total_nodes;
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "{\"nodes\": %d, \"iterations\": %lld, \"bytes\": %zu, \"bytes_per_node\": %.1f, \"ns_per_node\": %.1f},",
+                 total_nodes, iterations, json.len, (double)json.len / total_nodes, ns_per_node);
+        DynBuf_AppendStr(out, line);
+
+        DynBuf_Free(&json);
+        for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+/*
+ * Function: bench_netlist_sizes
+ * -----------------------------
+ * Compares the JSON and binary encodings of the combined netlist on
+ * representative circuits: hand-written equations, a full K-map style
+ * SOP for each channel, and large random trees.
+ */
+static void bench_netlist_sizes(const char* args, DynBuf* out) {
+    (void)args;
+    typedef struct {
+        const char* name;
+        const char* eq[4];
+        int random_nodes; // > 0: use random trees of this size instead
+    } Circuit;
+
+    static const Circuit CIRCUITS[] = {
+        { "simple",      { "A*B+C", "", "", "" }, 0 },
+        { "full_adder",  { "A^B^C", "A*B+C*(A^B)", "", "" }, 0 },
+        { "mux_parity",  { "A'*B'*C + A*B'*D + A'*B*E + A*B*F", "A^B^C^D^E^F", "(A+B)*(C+D)*(E+F)", "(A%B)$(C%D)" }, 0 },
+        { "sop_4ch",     { "A'B'C + AB'D + A'BE' + ABF + C'D'E + CDF' + A'CE + BD'F",
+                           "AB + CD + EF + A'C' + B'D' + E'F'",
+                           "A'B'C'D + A'BC'D' + AB'CD' + ABCD + A'B'EF + ABE'F'",
+                           "AC'E + BD'F + A'CE' + B'DF' + ACE + BDF" }, 0 },
+        { "random_1k",   { NULL, NULL, NULL, NULL }, 256 },
+        { "random_16k",  { NULL, NULL, NULL, NULL }, 4096 },
+    };
+
+    unsigned int seed = 0xC0FFEEu;
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (size_t c = 0; c < sizeof(CIRCUITS) / sizeof(CIRCUITS[0]); c++) {
+        LogicNode* roots[4];
+        for (int i = 0; i < 4; i++) {
+            roots[i] = CIRCUITS[c].random_nodes
+                ? build_random_tree(CIRCUITS[c].random_nodes, &seed)
+                : Parser_ParseString(CIRCUITS[c].eq[i]);
+        }
+
+        DynBuf json, bin;
+        DynBuf_Init(&json);
+        DynBuf_Init(&bin);
+        Netlist_GenerateCombinedJSON("X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3], &json);
+
+        long long iterations = 0;
+        long long start = Timer_GetNanos();
+        long long elapsed = 0;
+        do {
+            DynBuf_Reset(&bin);
+            Netlist_GenerateCombinedBinary("X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3], &bin);
+            iterations++;
+            elapsed = Timer_GetNanos() - start;
+        } while (elapsed < BENCH_MIN_NS / 4);
+
+        int nodes = 0;
+        for (int i = 0; i < 4; i++) nodes += count_nodes(roots[i]);
+
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "{\"circuit\": \"%s\", \"ast_nodes\": %d, \"json_bytes\": %zu, \"binary_bytes\": %zu, \"ratio\": %.1f, \"binary_encode_us\": %.2f},",
+                 CIRCUITS[c].name, nodes, json.len, bin.len,
+                 bin.len ? (double)json.len / (double)bin.len : 0.0,
+                 (double)elapsed / (double)iterations / 1000.0);
+        DynBuf_AppendStr(out, line);
+
+        DynBuf_Free(&json);
+        DynBuf_Free(&bin);
+        for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+/*
+ * Function: bench_delta
+ * ---------------------
+ * Compares a full combined snapshot with the delta sent after a typical
+ * edit, for random 4-channel circuits of growing size. Two edits:
+ * - "extend_x": X becomes (X)+A, i.e. one new gate in front of X.
+ * - "replace_y": Y is replaced by an unrelated tree of the same size.
+ */
+static void bench_delta(const char* args, DynBuf* out) {
+    (void)args;
+    static const int SIZES[] = { 16, 64, 256, 1024 };
+
+    unsigned int seed = 0xDE17Au;
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+        for (int edit = 0; edit < 2; edit++) {
+            LogicNode* roots[4];
+            for (int i = 0; i < 4; i++) roots[i] = build_random_tree(SIZES[s], &seed);
+
+            NetGraph before, after;
+            Netlist_BuildCombinedGraph(&before, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+
+            LogicNode* replaced = NULL;
+            if (edit == 0) {
+                LogicNode* wrap = AST_CreateNode(NODE_OR);
+                wrap->left = roots[0];
+                wrap->right = AST_CreateVar('A');
+                roots[0] = wrap;
+            } else {
+                replaced = roots[1];
+                roots[1] = build_random_tree(SIZES[s], &seed);
+            }
+            Netlist_BuildCombinedGraph(&after, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+
+            GraphDelta delta;
+            long long iterations = 0;
+            long long start = Timer_GetNanos();
+            long long elapsed = 0;
+            do {
+                if (iterations) GraphDelta_Free(&delta);
+                GraphDelta_Compute(&before, &after, &delta);
+                iterations++;
+                elapsed = Timer_GetNanos() - start;
+            } while (elapsed < BENCH_MIN_NS / 4);
+
+            DynBuf snapshot, diff;
+            DynBuf_Init(&snapshot);
+            DynBuf_Init(&diff);
+            Netlist_WriteJSON(&after, NULL, &snapshot);
+            Netlist_WriteDeltaJSON(&before, NULL, &after, NULL, &delta, &diff);
+
+            char line[256];
+            snprintf(line, sizeof(line),
+                     "{\"tree_nodes\": %d, \"edit\": \"%s\", \"graph_nodes\": %d, \"snapshot_bytes\": %zu, \"delta_ops\": %d, \"delta_bytes\": %zu, \"diff_us\": %.2f},",
+                     SIZES[s], edit == 0 ? "extend_x" : "replace_y", after.node_count,
+                     snapshot.len, GraphDelta_OpCount(&delta), diff.len,
+                     (double)elapsed / (double)iterations / 1000.0);
+            DynBuf_AppendStr(out, line);
+
+            DynBuf_Free(&snapshot);
+            DynBuf_Free(&diff);
+            GraphDelta_Free(&delta);
+            Graph_Free(&before);
+            Graph_Free(&after);
+            for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+            if (replaced) AST_Free(replaced);
+        }
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+/*
+ * Function: bench_layout
+ * ----------------------
+ * Times the layered layout on random 4-channel circuits, uncached and
+ * served from the layout cache.
+ */
+static void bench_layout(const char* args, DynBuf* out) {
+    (void)args;
+    static const int SIZES[] = { 16, 64, 256, 1024, 4096 };
+
+    unsigned int seed = 0x1A7007u;
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+        LogicNode* roots[4];
+        for (int i = 0; i < 4; i++) roots[i] = build_random_tree(SIZES[s], &seed);
+
+        NetGraph g;
+        Netlist_BuildCombinedGraph(&g, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+
+        GraphLayout layout;
+        long long iterations = 0;
+        long long start = Timer_GetNanos();
+        long long compute_ns = 0;
+        do {
+            Layout_Compute(&g, &layout);
+            Layout_Free(&layout);
+            iterations++;
+            compute_ns = Timer_GetNanos() - start;
+        } while (compute_ns < BENCH_MIN_NS / 4);
+        double compute_us = (double)compute_ns / (double)iterations / 1000.0;
+
+        Layout_Get(&g, &layout); // Prime the cache
+        Layout_Free(&layout);
+        iterations = 0;
+        start = Timer_GetNanos();
+        long long cached_ns = 0;
+        do {
+            Layout_Get(&g, &layout);
+            Layout_Free(&layout);
+            iterations++;
+            cached_ns = Timer_GetNanos() - start;
+        } while (cached_ns < BENCH_MIN_NS / 4);
+
+        char line[192];
+        snprintf(line, sizeof(line),
+                 "{\"tree_nodes\": %d, \"graph_nodes\": %d, \"edges\": %d, \"layout_us\": %.1f, \"cached_us\": %.2f},",
+                 SIZES[s], g.node_count, g.input_count, compute_us,
+                 (double)cached_ns / (double)iterations / 1000.0);
+        DynBuf_AppendStr(out, line);
+
+        Graph_Free(&g);
+        for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+/*
+ * Function: bench_sim
+ * -------------------
+ * Compares AST_Evaluate with the compiled simulator on random 4-channel
+ * circuits: one vector per sweep ("compiled") and 64 vectors per
+ * bit-sliced sweep ("sliced", including the transpose in and out).
+ * Every output of every vector is cross-checked against the AST.
+ */
+static void bench_sim(const char* args, DynBuf* out) {
+    (void)args;
+    static const int SIZES[] = { 16, 256, 4096 };
+    enum { VECTORS = 4096 };
+    static uint32_t masks[VECTORS], expected[VECTORS], results[VECTORS];
+
+    unsigned int seed = 0x51AA7u;
+    for (int k = 0; k < VECTORS; k++) masks[k] = bench_rand(&seed) & 63u;
+
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+        LogicNode* roots[4];
+        for (int i = 0; i < 4; i++) roots[i] = build_random_tree(SIZES[s], &seed);
+
+        NetGraph g;
+        SimProgram prog;
+        Netlist_BuildCombinedGraph(&g, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+        long long start = Timer_GetNanos();
+        Sim_Compile(&g, &prog);
+        double compile_us = (double)(Timer_GetNanos() - start) / 1000.0;
+
+        long long iterations = 0, ast_ns = 0;
+        start = Timer_GetNanos();
+        do {
+            for (int k = 0; k < VECTORS; k++) {
+                uint32_t r = 0;
+                for (int i = 0; i < 4; i++) r |= (uint32_t)AST_Evaluate(roots[i], (int)masks[k]) << i;
+                expected[k] = r;
+            }
+            iterations++;
+            ast_ns = Timer_GetNanos() - start;
+        } while (ast_ns < BENCH_MIN_NS / 4);
+        double ast_per_vector = (double)ast_ns / (double)(iterations * VECTORS);
+
+        long long compiled_ns = 0;
+        iterations = 0;
+        start = Timer_GetNanos();
+        do {
+            for (int k = 0; k < VECTORS; k++) results[k] = Sim_Evaluate(&prog, masks[k]);
+            iterations++;
+            compiled_ns = Timer_GetNanos() - start;
+        } while (compiled_ns < BENCH_MIN_NS / 4);
+        double compiled_per_vector = (double)compiled_ns / (double)(iterations * VECTORS);
+
+        int mismatches = 0;
+        for (int k = 0; k < VECTORS; k++) mismatches += (results[k] != expected[k]);
+
+        long long sliced_ns = 0;
+        iterations = 0;
+        start = Timer_GetNanos();
+        do {
+            Sim_EvaluateBatch(&prog, masks, VECTORS, results);
+            iterations++;
+            sliced_ns = Timer_GetNanos() - start;
+        } while (sliced_ns < BENCH_MIN_NS / 4);
+        double sliced_per_vector = (double)sliced_ns / (double)(iterations * VECTORS);
+
+        for (int k = 0; k < VECTORS; k++) mismatches += (results[k] != expected[k]);
+
+        char line[320];
+        snprintf(line, sizeof(line),
+                 "{\"tree_nodes\": %d, \"gates\": %d, \"levels\": %d, \"compile_us\": %.1f, \"ast_ns_per_vector\": %.1f, \"compiled_ns_per_vector\": %.1f, \"sliced_ns_per_vector\": %.2f, \"speedup\": %.1f, \"mismatches\": %d},",
+                 SIZES[s] * 4, prog.gate_count, prog.level_count, compile_us,
+                 ast_per_vector, compiled_per_vector, sliced_per_vector,
+                 ast_per_vector / sliced_per_vector, mismatches);
+        DynBuf_AppendStr(out, line);
+
+        Sim_Free(&prog);
+        Graph_Free(&g);
+        for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+/*
+ * Function: bench_event
+ * ---------------------
+ * Drives the event-driven simulator with bursts of random input changes
+ * 20 us apart (50,000 changes per simulated second) on random 4-channel
+ * circuits. Before each change the outputs must have settled to what
+ * the compiled simulator computes for the previous inputs.
+ */
+static void bench_event(const char* args, DynBuf* out) {
+    (void)args;
+    static const int SIZES[] = { 16, 256, 4096 };
+    enum { CHANGES = 4096, SPACING = 20000 };
+    static uint32_t masks[CHANGES];
+
+    unsigned int seed = 0xE7E27u;
+    for (int k = 0; k < CHANGES; k++) masks[k] = bench_rand(&seed) & 63u;
+
+    EventDelays delays;
+    EventDelays_Default(&delays);
+
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+        LogicNode* roots[4];
+        for (int i = 0; i < 4; i++) roots[i] = build_random_tree(SIZES[s], &seed);
+
+        NetGraph g;
+        SimProgram prog;
+        EventSim sim;
+        Netlist_BuildCombinedGraph(&g, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+        Sim_Compile(&g, &prog);
+        EventSim_Compile(&g, &delays, 0, 0, &sim);
+
+        // Checking pass: outputs must have settled before each change
+        int mismatches = 0;
+        uint64_t glitches = 0;
+        uint64_t t = 0;
+        for (int k = 0; k < CHANGES; k++) {
+            t += SPACING;
+            EventSim_SetInputs(&sim, t, masks[k]);
+            EventSim_RunUntil(&sim, t + SPACING - 1);
+            uint32_t expected = Sim_Evaluate(&prog, masks[k]);
+            for (int i = 0; i < sim.output_count; i++) {
+                mismatches += (EventSim_OutputValue(&sim, i) != (bool)((expected >> i) & 1));
+            }
+        }
+        for (int i = 0; i < sim.output_count; i++) glitches += sim.outputs[i].glitches;
+
+        // Timed passes: input changes only, events processed as time moves on
+        uint64_t events_before = sim.events;
+        long long iterations = 0, elapsed = 0;
+        long long start = Timer_GetNanos();
+        do {
+            for (int k = 0; k < CHANGES; k++) {
+                t += SPACING;
+                EventSim_SetInputs(&sim, t, masks[k]);
+            }
+            EventSim_Settle(&sim);
+            iterations++;
+            elapsed = Timer_GetNanos() - start;
+        } while (elapsed < BENCH_MIN_NS);
+
+        double ns_per_change = (double)elapsed / (double)(iterations * CHANGES);
+        double events_per_change = (double)(sim.events - events_before) / (double)(iterations * CHANGES);
+        char line[320];
+        snprintf(line, sizeof(line),
+                 "{\"tree_nodes\": %d, \"gates\": %d, \"events_per_change\": %.1f, \"ns_per_change\": %.0f, \"changes_per_sec\": %.0f, \"events_per_sec\": %.0f, \"glitches\": %llu, \"mismatches\": %d},",
+                 SIZES[s] * 4, sim.gate_count, events_per_change, ns_per_change,
+                 1e9 / ns_per_change, 1e9 / ns_per_change * events_per_change,
+                 (unsigned long long)glitches, mismatches);
+        DynBuf_AppendStr(out, line);
+
+        EventSim_Free(&sim);
+        Sim_Free(&prog);
+        Graph_Free(&g);
+        for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+/*
+ * Function: bench_seq
+ * -------------------
+ * Clocks small state machines with the cycle simulator and reports
+ * cycles per second. Each machine's period (inputs held at 0) is
+ * measured from its first cycles as a correctness check.
+ */
+static void bench_seq(const char* args, DynBuf* out) {
+    (void)args;
+    typedef struct {
+        const char* name;
+        const char* eq[SEQ_CHANNELS];
+        int period;
+    } Machine;
+
+    static const Machine MACHINES[] = {
+        { "counter4", { "@(!X)", "@(Y^X)", "@(Z^X*Y)", "@(W^X*Y*Z)" }, 16 },
+        { "lfsr4",    { "@((Z^W)')", "@(X)", "@(Y)", "@(Z)" }, 15 },
+        { "johnson4", { "@(W')", "@(X)", "@(Y)", "@(Z)" }, 8 },
+    };
+    enum { CYCLES = 1 << 16 };
+
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (size_t m = 0; m < sizeof(MACHINES) / sizeof(MACHINES[0]); m++) {
+        LogicNode* roots[SEQ_CHANNELS];
+        for (int i = 0; i < SEQ_CHANNELS; i++) roots[i] = Parser_ParseString(MACHINES[m].eq[i]);
+
+        SeqProgram prog;
+        if (Seq_Compile(roots, &prog) != SEQ_OK) {
+            for (int i = 0; i < SEQ_CHANNELS; i++) AST_Free(roots[i]);
+            continue;
+        }
+
+        uint32_t trace[64];
+        for (int k = 0; k < 64; k++) trace[k] = Seq_Step(&prog, 0);
+        int period = 0;
+        for (int p = 1; p < 32 && !period; p++) {
+            bool repeats = true;
+            for (int k = 0; k + p < 64 && repeats; k++) repeats = (trace[k] == trace[k + p]);
+            if (repeats) period = p;
+        }
+
+        uint32_t sink = 0;
+        long long iterations = 0, elapsed = 0;
+        long long start = Timer_GetNanos();
+        do {
+            for (int k = 0; k < CYCLES; k++) sink ^= Seq_Step(&prog, 0);
+            iterations++;
+            elapsed = Timer_GetNanos() - start;
+        } while (elapsed < BENCH_MIN_NS);
+        double ns_per_cycle = (double)elapsed / ((double)iterations * CYCLES);
+
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "{\"machine\": \"%s\", \"registers\": %d, \"gates\": %d, \"period\": %d, \"period_ok\": %s, \"ns_per_cycle\": %.1f, \"cycles_per_sec\": %.0f, \"sink\": %u},",
+                 MACHINES[m].name, prog.reg_count, prog.gate_count, period,
+                 period == MACHINES[m].period ? "true" : "false",
+                 ns_per_cycle, 1e9 / ns_per_cycle, sink);
+        DynBuf_AppendStr(out, line);
+
+        Seq_Free(&prog);
+        for (int i = 0; i < SEQ_CHANNELS; i++) AST_Free(roots[i]);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+/*
+ * Function: bench_par
+ * -------------------
+ * Scaling of both parallel modes (logic_par.h) on a large random
+ * netlist, for 1..N threads (N from the arguments, default 4 or the
+ * CPU count if larger). Every run is checked against the serial result.
+ */
+static void bench_par(const char* args, DynBuf* out) {
+    enum { TREE_NODES = 131072, VECTORS = 1 << 14 };
+    static uint32_t masks[VECTORS], expected[VECTORS], results[VECTORS];
+
+    int max_threads = args ? atoi(args) : 0;
+    if (max_threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        max_threads = online > 4 ? (int)online : 4;
+    }
+    if (max_threads > PAR_MAX_THREADS) max_threads = PAR_MAX_THREADS;
+
+    unsigned int seed = 0x9A7Au;
+    for (int k = 0; k < VECTORS; k++) masks[k] = bench_rand(&seed) & 63u;
+
+    LogicNode* roots[4];
+    for (int i = 0; i < 4; i++) roots[i] = build_random_tree(TREE_NODES, &seed);
+    NetGraph g;
+    SimProgram prog;
+    ParPlan plan;
+    Netlist_BuildCombinedGraph(&g, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+    Sim_Compile(&g, &prog);
+    ParPlan_Build(&prog, 0, &plan);
+    Sim_EvaluateBatch(&prog, masks, VECTORS, expected);
+
+    // Slice inputs for the gate-parallel mode: the first 64 vectors
+    uint64_t slice_in[SIM_MAX_VARS] = { 0 }, slice_out[SIM_MAX_OUTPUTS], slice_ref[SIM_MAX_OUTPUTS];
+    for (int v = 0; v < 6; v++) {
+        for (int k = 0; k < SIM_LANES; k++) slice_in[v] |= (uint64_t)((masks[k] >> v) & 1u) << k;
+    }
+    Sim_EvaluateSlice(&prog, slice_in, slice_ref);
+
+    char line[320];
+    snprintf(line, sizeof(line),
+             "\"gates\": %d, \"levels\": %d, \"chunks\": %d, \"root_chunks\": %d, \"cpus\": %ld, \"results\": [",
+             prog.gate_count, prog.level_count, plan.chunk_count, plan.root_count,
+             sysconf(_SC_NPROCESSORS_ONLN));
+    DynBuf_AppendStr(out, line);
+
+    double slice_base = 0, batch_base = 0;
+    for (int t = 1; t <= max_threads; t++) {
+        ParPool* pool = ParPool_Create(t);
+        int mismatches = 0;
+
+        long long iterations = 0, elapsed = 0;
+        long long start = Timer_GetNanos();
+        do {
+            Par_EvaluateSlice(pool, &plan, &prog, slice_in, slice_out);
+            iterations++;
+            elapsed = Timer_GetNanos() - start;
+        } while (elapsed < BENCH_MIN_NS);
+        double slice_us = (double)elapsed / (double)iterations / 1000.0;
+        for (int i = 0; i < prog.output_count; i++) mismatches += (slice_out[i] != slice_ref[i]);
+
+        iterations = 0;
+        start = Timer_GetNanos();
+        do {
+            Par_EvaluateBatch(pool, &prog, masks, VECTORS, results);
+            iterations++;
+            elapsed = Timer_GetNanos() - start;
+        } while (elapsed < BENCH_MIN_NS);
+        double batch_ms = (double)elapsed / (double)iterations / 1e6;
+        for (int k = 0; k < VECTORS; k++) mismatches += (results[k] != expected[k]);
+
+        if (t == 1) {
+            slice_base = slice_us;
+            batch_base = batch_ms;
+        }
+        snprintf(line, sizeof(line),
+                 "{\"threads\": %d, \"slice_us\": %.1f, \"slice_speedup\": %.2f, \"batch_ms\": %.2f, \"batch_speedup\": %.2f, \"vectors_per_sec\": %.0f, \"mismatches\": %d},",
+                 ParPool_Threads(pool), slice_us, slice_base / slice_us, batch_ms, batch_base / batch_ms,
+                 (double)VECTORS / batch_ms * 1000.0, mismatches);
+        DynBuf_AppendStr(out, line);
+        ParPool_Destroy(pool);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+
+    ParPlan_Free(&plan);
+    Sim_Free(&prog);
+    Graph_Free(&g);
+    for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+}
+
+/*
+ * Function: bench_fault
+ * ---------------------
+ * Fault simulation over random circuits with all 64 combinations of
+ * A-F. Reports collapsing, coverage and simulation time, and checks
+ * that the collapsed list covers exactly as many faults as simulating
+ * the uncollapsed one.
+ */
+static void bench_fault(const char* args, DynBuf* out) {
+    (void)args;
+    static const int SIZES[] = { 16, 256, 4096 };
+    uint32_t masks[64];
+    for (int k = 0; k < 64; k++) masks[k] = (uint32_t)k;
+
+    unsigned int seed = 0xFA17u;
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+        LogicNode* roots[4];
+        for (int i = 0; i < 4; i++) roots[i] = build_random_tree(SIZES[s], &seed);
+        NetGraph g;
+        Netlist_BuildCombinedGraph(&g, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+
+        FaultList raw, collapsed;
+        memset(&collapsed, 0, sizeof(collapsed));
+        Fault_Enumerate(&g, false, &raw);
+        Fault_Simulate(&g, &raw, masks, 64);
+
+        long long iterations = 0, elapsed = 0;
+        long long start = Timer_GetNanos();
+        do {
+            Fault_Free(&collapsed);
+            Fault_Enumerate(&g, true, &collapsed);
+            Fault_Simulate(&g, &collapsed, masks, 64);
+            iterations++;
+            elapsed = Timer_GetNanos() - start;
+        } while (elapsed < BENCH_MIN_NS);
+        double us = (double)elapsed / (double)iterations / 1000.0;
+
+        char line[320];
+        snprintf(line, sizeof(line),
+                 "{\"ast_nodes\": %d, \"graph_nodes\": %d, \"faults\": %d, \"collapsed\": %d, \"coverage\": %.4f, \"us\": %.1f, \"collapse_consistent\": %s},",
+                 4 * SIZES[s], g.node_count, collapsed.total, collapsed.count, Fault_Coverage(&collapsed), us,
+                 raw.detected == collapsed.detected_total ? "true" : "false");
+        DynBuf_AppendStr(out, line);
+
+        Fault_Free(&raw);
+        Fault_Free(&collapsed);
+        Graph_Free(&g);
+        for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+static LogicNode* negated(LogicNode* node) {
+    LogicNode* n = AST_CreateNode(NODE_NOT);
+    n->left = node;
+    return n;
+}
+
+static LogicNode* gate_of(NodeType type, LogicNode* left, LogicNode* right) {
+    LogicNode* n = AST_CreateNode(type);
+    n->left = left;
+    n->right = right;
+    return n;
+}
+
+/*
+ * Function: rewrite_copy
+ * ----------------------
+ * Copies a tree computing the same function with a different structure.
+ * Every two-input gate goes through De Morgan (AND(a,b) -> NOR(!a,!b),
+ * ...), which structural hashing in the CNF encoder undoes. With
+ * 'expand_xor', XORs also become a*!b + !a*b, which it cannot: proving
+ * that copy equivalent takes real SAT search.
+ */
+static LogicNode* rewrite_copy(LogicNode* node, bool expand_xor) {
+    if (node->type == NODE_VAR) return AST_CreateVar(node->var_name);
+    if (node->type == NODE_NOT) return negated(rewrite_copy(node->left, expand_xor));
+    if (node->type == NODE_XOR && expand_xor) {
+        LogicNode* l = rewrite_copy(node->left, true);
+        LogicNode* r = rewrite_copy(node->right, true);
+        return gate_of(NODE_OR, gate_of(NODE_AND, l, negated(r)),
+                       gate_of(NODE_AND, negated(rewrite_copy(node->left, true)), rewrite_copy(node->right, true)));
+    }
+
+    NodeType dual;
+    switch (node->type) {
+        case NODE_AND:  dual = NODE_NOR;  break;
+        case NODE_OR:   dual = NODE_NAND; break;
+        case NODE_NAND: dual = NODE_OR;   break;
+        case NODE_NOR:  dual = NODE_AND;  break;
+        default:        dual = NODE_XOR;  break; // a^b = !a^!b
+    }
+    return gate_of(dual, negated(rewrite_copy(node->left, expand_xor)), negated(rewrite_copy(node->right, expand_xor)));
+}
+
+// Turns the 'target'-th two-input gate (preorder) into a different gate type
+static void mutate_gate(LogicNode* node, int* target) {
+    if (!node || node->type == NODE_VAR) return;
+    if (node->type != NODE_NOT && (*target)-- == 0) {
+        node->type = (node->type == NODE_XOR) ? NODE_OR : NODE_XOR;
+        return;
+    }
+    mutate_gate(node->left, target);
+    mutate_gate(node->right, target);
+}
+
+/*
+ * Function: bench_solve_miter
+ * ---------------------------
+ * Solves the miter of two trees.
+ *
+ * returns: The result; *witness is the separating input on SAT_SAT.
+ */
+static SatResult bench_solve_miter(LogicNode* a, LogicNode* b, uint32_t* witness, long long* conflicts) {
+    SatSolver s;
+    Sat_Init(&s);
+    CnfEncoder enc;
+    Cnf_Init(&enc, &s);
+    int miter = Cnf_Xor(&enc, Cnf_AddTree(&enc, a), Cnf_AddTree(&enc, b));
+    SatResult r = SAT_UNKNOWN;
+    if (miter >= 0) {
+        Sat_AddClause(&s, &miter, 1);
+        r = Sat_Solve(&s, 0);
+        if (r == SAT_SAT) *witness = Cnf_InputMask(&enc);
+    }
+    *conflicts = s.conflicts;
+    Cnf_Free(&enc);
+    Sat_Free(&s);
+    return r;
+}
+
+/*
+ * Function: bench_sat
+ * -------------------
+ * CDCL solver and Tseitin encoding. First random 3-SAT at the hard
+ * clause/variable ratio 4.26 (models are checked against the clauses),
+ * then equivalence miters over 24 inputs, too wide for truth tables. A
+ * random tree is compared with its rewrites (rewrite_copy; both must be
+ * "equivalent") and with a copy with one gate changed (a witness, when
+ * found, must really separate the two; the change may also be masked).
+ */
+static void bench_sat(const char* args, DynBuf* out) {
+    (void)args;
+    static const int VARS[] = { 50, 100, 150 };
+    static const int SIZES[] = { 256, 1024, 4096, 32768 };
+    enum { INSTANCES = 8, MITER_VARS = 24, MITER_EXPAND_MAX = 1024 };
+    unsigned int seed = 0x5A7u;
+    char line[320];
+
+    DynBuf_AppendStr(out, "\"random_3sat\": [");
+    for (size_t v = 0; v < sizeof(VARS) / sizeof(VARS[0]); v++) {
+        int n = VARS[v];
+        int m = (int)(n * 4.26);
+        int* clauses = malloc((size_t)m * 3 * sizeof(int));
+        if (!clauses) break;
+        int sat = 0, unsat = 0, bad = 0;
+        long long conflicts = 0;
+        long long start = Timer_GetNanos();
+        for (int t = 0; t < INSTANCES; t++) {
+            SatSolver s;
+            Sat_Init(&s);
+            for (int i = 0; i < n; i++) Sat_NewVar(&s);
+            for (int c = 0; c < m; c++) {
+                for (int k = 0; k < 3; k++) {
+                    clauses[3 * c + k] = SAT_LIT((int)(bench_rand(&seed) % (unsigned int)n), bench_rand(&seed) & 1);
+                }
+                Sat_AddClause(&s, &clauses[3 * c], 3);
+            }
+            SatResult r = Sat_Solve(&s, 0);
+            if (r == SAT_SAT) {
+                sat++;
+                for (int c = 0; c < m; c++) {
+                    bool satisfied = false;
+                    for (int k = 0; k < 3; k++) {
+                        int lit = clauses[3 * c + k];
+                        if (Sat_ModelValue(&s, SAT_VAR(lit)) != (bool)(lit & 1)) satisfied = true;
+                    }
+                    if (!satisfied) {
+                        bad++;
+                        break;
+                    }
+                }
+            } else if (r == SAT_UNSAT) {
+                unsat++;
+            }
+            conflicts += s.conflicts;
+            Sat_Free(&s);
+        }
+        double ms = (double)(Timer_GetNanos() - start) / INSTANCES / 1e6;
+        free(clauses);
+
+        snprintf(line, sizeof(line),
+                 "{\"vars\": %d, \"clauses\": %d, \"sat\": %d, \"unsat\": %d, \"bad_models\": %d, \"avg_conflicts\": %lld, \"avg_ms\": %.2f},",
+                 n, m, sat, unsat, bad, conflicts / INSTANCES, ms);
+        DynBuf_AppendStr(out, line);
+    }
+    DynBuf_TrimChar(out, ',');
+
+    DynBuf_AppendStr(out, "], \"miters\": [");
+    for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); i++) {
+        LogicNode* tree = build_wide_tree(SIZES[i], MITER_VARS, &seed);
+        LogicNode* mutant = rewrite_copy(tree, false);
+        int target = (int)(bench_rand(&seed) % (unsigned int)(SIZES[i] / 4));
+        mutate_gate(mutant, &target);
+
+        // Mutant last: its witness is checked below
+        LogicNode* others[3] = {
+            rewrite_copy(tree, false),
+            SIZES[i] <= MITER_EXPAND_MAX ? rewrite_copy(tree, true) : NULL,
+            mutant
+        };
+        const char* names[3] = { "rewrite", "xor_expanded", "mutant" };
+        uint32_t witness = 0;
+        snprintf(line, sizeof(line), "{\"ast_nodes\": %d, \"inputs\": %d", count_nodes(tree), MITER_VARS);
+        DynBuf_AppendStr(out, line);
+        for (int k = 0; k < 3; k++) {
+            if (!others[k]) continue;
+            long long conflicts = 0;
+            long long start = Timer_GetNanos();
+            SatResult r = bench_solve_miter(tree, others[k], &witness, &conflicts);
+            double ms = (double)(Timer_GetNanos() - start) / 1e6;
+            snprintf(line, sizeof(line), ", \"%s\": \"%s\", \"%s_ms\": %.2f, \"%s_conflicts\": %lld",
+                     names[k], r == SAT_SAT ? "different" : (r == SAT_UNSAT ? "equivalent" : "unknown"),
+                     names[k], ms, names[k], conflicts);
+            DynBuf_AppendStr(out, line);
+            if (k == 2 && r == SAT_SAT) {
+                bool separates = AST_Evaluate(tree, (int)witness) != AST_Evaluate(mutant, (int)witness);
+                DynBuf_AppendStr(out, separates ? ", \"witness_ok\": true" : ", \"witness_ok\": false");
+            }
+        }
+        DynBuf_AppendStr(out, "},");
+
+        AST_Free(tree);
+        for (int k = 0; k < 3; k++) AST_Free(others[k]);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+// --- Registry ---
+
+typedef struct {
+    const char* name;
+    void (*run)(const char* args, DynBuf* out);
+} BenchEntry;
+
+/*
+ * Function: bench_stim
+ * --------------------
+ * Generated-stimulus throughput (logic_stim.h) for every mode over a
+ * random 20-input circuit, serially and on the shared pool. Checks that
+ * both runs agree and that Gray counting, a reordering of the binary
+ * count, sees the same number of ones.
+ */
+static void bench_stim(const char* args, DynBuf* out) {
+    (void)args;
+    enum { TREE_NODES = 1024, VARS = 20 };
+    static const StimMode MODES[] = { STIM_EXHAUSTIVE, STIM_GRAY, STIM_LFSR, STIM_WEIGHTED, STIM_WALKING };
+
+    unsigned int seed = 0x5714u;
+    LogicNode* roots[4];
+    for (int i = 0; i < 4; i++) roots[i] = build_wide_tree(TREE_NODES, VARS, &seed);
+    NetGraph g;
+    SimProgram prog;
+    Netlist_BuildCombinedGraph(&g, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+    Sim_Compile(&g, &prog);
+
+    StimConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.var_mask = prog.var_mask;
+    cfg.count = 1LL << __builtin_popcount(prog.var_mask);
+    cfg.seed = 1;
+    for (int j = 0; j < SIM_MAX_VARS; j++) cfg.weight[j] = (uint16_t)(32 + 24 * (j % 8));
+
+    ParPool* pool = Par_SharedPool();
+    char line[320];
+    snprintf(line, sizeof(line), "\"gates\": %d, \"inputs\": %d, \"vectors\": %lld, \"threads\": %d, \"results\": [",
+             prog.gate_count, __builtin_popcount(prog.var_mask), cfg.count, ParPool_Threads(pool));
+    DynBuf_AppendStr(out, line);
+
+    long long binary_ones[SIM_MAX_OUTPUTS] = { 0 };
+    for (size_t m = 0; m < sizeof(MODES) / sizeof(MODES[0]); m++) {
+        cfg.mode = MODES[m];
+        StimStats serial, parallel;
+
+        long long start = Timer_GetNanos();
+        Stim_Run(NULL, &prog, &cfg, &serial);
+        long long serial_ns = Timer_GetNanos() - start;
+        start = Timer_GetNanos();
+        Stim_Run(pool, &prog, &cfg, &parallel);
+        long long parallel_ns = Timer_GetNanos() - start;
+
+        bool consistent = memcmp(serial.ones, parallel.ones, sizeof(serial.ones)) == 0 &&
+                          memcmp(serial.toggles, parallel.toggles, sizeof(serial.toggles)) == 0;
+        if (cfg.mode == STIM_EXHAUSTIVE) memcpy(binary_ones, serial.ones, sizeof(binary_ones));
+        bool ones_match = cfg.mode != STIM_GRAY || memcmp(binary_ones, serial.ones, sizeof(binary_ones)) == 0;
+
+        snprintf(line, sizeof(line),
+                 "{\"mode\": \"%s\", \"serial_vps\": %.0f, \"parallel_vps\": %.0f, \"x_ones\": %lld, \"x_toggles\": %lld, \"thread_consistent\": %s, \"ones_match\": %s},",
+                 Stim_ModeName(cfg.mode), (double)cfg.count * 1e9 / (double)serial_ns,
+                 (double)cfg.count * 1e9 / (double)parallel_ns, serial.ones[0], serial.toggles[0],
+                 consistent ? "true" : "false", ones_match ? "true" : "false");
+        DynBuf_AppendStr(out, line);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+
+    Sim_Free(&prog);
+    Graph_Free(&g);
+    for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+}
+
+/*
+ * Struct: SuiteTally
+ * ------------------
+ * Collects what bench_verify's sink received.
+ */
+typedef struct {
+    int packets;
+    int partial;
+    size_t largest;
+    long long failed;
+} SuiteTally;
+
+static void tally_packet(const char* packet, void* ctx) {
+    SuiteTally* t = ctx;
+    size_t len = strlen(packet);
+    t->packets++;
+    if (len > t->largest) t->largest = len;
+    if (strstr(packet, "\"status\": \"partial\"")) {
+        t->partial++;
+        return;
+    }
+    const char* failed = strstr(packet, "\"failed\": ");
+    if (failed) t->failed = atoll(failed + 10);
+}
+
+/*
+ * Function: bench_verify
+ * ----------------------
+ * Test-suite throughput (Verification_CheckProgram) on a random
+ * four-channel circuit: suites whose expected masks come from the
+ * simulator itself, with every 'stride'-th step corrupted. Checks the
+ * failure count and that no packet outgrows the flush threshold by much.
+ */
+static void bench_verify(const char* args, DynBuf* out) {
+    (void)args;
+    static const int STEPS[] = { 1000, 100000, 1000000 };
+    enum { TREE_NODES = 1024, STRIDE = 97 };
+
+    unsigned int seed = 0x7E57u;
+    LogicNode* roots[4];
+    for (int i = 0; i < 4; i++) roots[i] = build_random_tree(TREE_NODES, &seed);
+    NetGraph g;
+    SimProgram prog;
+    Netlist_BuildCombinedGraph(&g, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+    Sim_Compile(&g, &prog);
+
+    int channel_output[4];
+    for (int c = 0; c < 4; c++) {
+        char name[2] = { "XYZW"[c], '\0' };
+        channel_output[c] = Sim_FindOutput(&prog, name);
+    }
+
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (size_t s = 0; s < sizeof(STEPS) / sizeof(STEPS[0]); s++) {
+        int steps = STEPS[s];
+        uint32_t* masks = malloc((size_t)steps * sizeof(uint32_t));
+        uint32_t* results = malloc((size_t)steps * sizeof(uint32_t));
+        for (int i = 0; i < steps; i++) masks[i] = bench_rand(&seed) & 63u;
+        Sim_EvaluateBatch(&prog, masks, steps, results);
+
+        DynBuf suite;
+        DynBuf_Init(&suite);
+        long long corrupted = 0;
+        for (int i = 0; i < steps; i++) {
+            uint32_t expected = 0;
+            for (int c = 0; c < 4; c++) expected |= ((results[i] >> channel_output[c]) & 1u) << c;
+            if (i % STRIDE == 0) {
+                expected ^= 1u << (i / STRIDE % 4);
+                corrupted++;
+            }
+            char step[32];
+            snprintf(step, sizeof(step), "%u:1:%u,", masks[i], expected);
+            DynBuf_AppendStr(&suite, step);
+        }
+        free(masks);
+        free(results);
+
+        SuiteTally tally;
+        memset(&tally, 0, sizeof(tally));
+        long long start = Timer_GetNanos();
+        Verification_CheckProgram(&prog, suite.data, tally_packet, &tally);
+        double ms = (double)(Timer_GetNanos() - start) / 1e6;
+
+        char line[320];
+        snprintf(line, sizeof(line),
+                 "{\"steps\": %d, \"ms\": %.2f, \"steps_per_sec\": %.0f, \"failed\": %lld, \"packets\": %d, \"partial\": %d, \"largest_packet\": %zu, \"counts_ok\": %s},",
+                 steps, ms, (double)steps / ms * 1000.0, tally.failed, tally.packets, tally.partial,
+                 tally.largest, tally.failed == corrupted ? "true" : "false");
+        DynBuf_AppendStr(out, line);
+        DynBuf_Free(&suite);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+
+    Sim_Free(&prog);
+    Graph_Free(&g);
+    for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+}
+
+/*
+ * Function: bench_vectors
+ * -----------------------
+ * A one-million-step suite run from text and from a memory-mapped
+ * vector file (app_vectors.h), including the conversion. Both runs must
+ * report the same failures. The files go to /tmp and are removed.
+ */
+static void bench_vectors(const char* args, DynBuf* out) {
+    (void)args;
+    enum { STEPS = 1000000, TREE_NODES = 1024, STRIDE = 1009 };
+    static const char* TEXT_PATH = "/tmp/logic_sim_bench.txt";
+    static const char* VECTOR_PATH = "/tmp/logic_sim_bench.lstv";
+
+    unsigned int seed = 0x7EC5u;
+    LogicNode* roots[4];
+    for (int i = 0; i < 4; i++) roots[i] = build_random_tree(TREE_NODES, &seed);
+    NetGraph g;
+    SimProgram prog;
+    Netlist_BuildCombinedGraph(&g, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+    Sim_Compile(&g, &prog);
+
+    uint32_t* masks = malloc(STEPS * sizeof(uint32_t));
+    uint32_t* results = malloc(STEPS * sizeof(uint32_t));
+    for (int i = 0; i < STEPS; i++) masks[i] = bench_rand(&seed) & 63u;
+    Sim_EvaluateBatch(&prog, masks, STEPS, results);
+
+    // One step per line, every STRIDE-th expected mask wrong in one output
+    DynBuf suite;
+    DynBuf_Init(&suite);
+    for (int i = 0; i < STEPS; i++) {
+        uint32_t expected = 0;
+        for (int c = 0; c < 4; c++) {
+            char name[2] = { "XYZW"[c], '\0' };
+            expected |= ((results[i] >> Sim_FindOutput(&prog, name)) & 1u) << c;
+        }
+        if (i % STRIDE == 0) expected ^= 1u << (i / STRIDE % 4);
+        char step[32];
+        snprintf(step, sizeof(step), "%u:1:%u\n", masks[i], expected);
+        DynBuf_AppendStr(&suite, step);
+    }
+    FILE* f = fopen(TEXT_PATH, "w");
+    if (f) {
+        fwrite(suite.data, 1, suite.len, f);
+        fclose(f);
+    }
+
+    long long converted = 0;
+    const char* error = NULL;
+    long long start = Timer_GetNanos();
+    bool ok = f && Vectors_ConvertText(TEXT_PATH, VECTOR_PATH, &converted, &error);
+    double convert_ms = (double)(Timer_GetNanos() - start) / 1e6;
+
+    SuiteTally text, mapped;
+    memset(&text, 0, sizeof(text));
+    memset(&mapped, 0, sizeof(mapped));
+    for (size_t k = 0; k < suite.len; k++) {
+        if (suite.data[k] == '\n') suite.data[k] = ',';
+    }
+    start = Timer_GetNanos();
+    Verification_CheckProgram(&prog, suite.data, tally_packet, &text);
+    double text_ms = (double)(Timer_GetNanos() - start) / 1e6;
+
+    double map_ms = 0;
+    long long file_bytes = 0;
+    VectorFile file;
+    if (ok && Vectors_Open(VECTOR_PATH, &file, &error)) {
+        file_bytes = (long long)file.size;
+        start = Timer_GetNanos();
+        Verification_CheckVectors(&prog, &file, tally_packet, &mapped);
+        map_ms = (double)(Timer_GetNanos() - start) / 1e6;
+        Vectors_Close(&file);
+    }
+
+    char line[400];
+    snprintf(line, sizeof(line),
+             "\"steps\": %d, \"text_bytes\": %zu, \"file_bytes\": %lld, \"convert_ms\": %.1f, \"text_ms\": %.1f, \"mmap_ms\": %.1f, \"speedup\": %.2f, \"mmap_steps_per_sec\": %.0f, \"failed\": %lld, \"consistent\": %s",
+             STEPS, suite.len, file_bytes, convert_ms, text_ms, map_ms, map_ms > 0 ? text_ms / map_ms : 0.0,
+             map_ms > 0 ? STEPS / map_ms * 1000.0 : 0.0, mapped.failed,
+             converted == STEPS && text.failed == mapped.failed ? "true" : "false");
+    DynBuf_AppendStr(out, line);
+
+    remove(TEXT_PATH);
+    remove(VECTOR_PATH);
+    DynBuf_Free(&suite);
+    free(masks);
+    free(results);
+    Sim_Free(&prog);
+    Graph_Free(&g);
+    for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+}
+
+// --- Transport round trips ---
+
+/*
+ * Struct: EchoPeer
+ * ----------------
+ * The far end of a transport round trip, run on its own thread: sends
+ * every message back, over the socket or from ring 'in' to ring 'out'.
+ */
+typedef struct {
+    int sock;       // Connected to the near end's socket
+    ShmRing* in;    // NULL: echo datagrams
+    ShmRing* out;
+    int rounds;
+} EchoPeer;
+
+static void ring_doorbell(int sock) {
+    const char bell = (char)SHM_DOORBELL;
+    send(sock, &bell, 1, 0);
+}
+
+static void echo_message(const char* data, size_t len, void* ctx) {
+    EchoPeer* peer = ctx;
+    bool doorbell;
+    if (ShmRing_Write(peer->out, data, len, &doorbell) && doorbell) ring_doorbell(peer->sock);
+}
+
+static void* echo_main(void* arg) {
+    EchoPeer* peer = arg;
+    static char buf[65536];
+    for (int done = 0; done < peer->rounds;) {
+        ssize_t n = recv(peer->sock, buf, sizeof(buf), 0);
+        if (n < 0) break;
+        if (peer->in) {
+            done += ShmRing_Drain(peer->in, echo_message, peer);
+        } else {
+            send(peer->sock, buf, (size_t)n, 0);
+            done++;
+        }
+    }
+    return NULL;
+}
+
+static void skip_message(const char* data, size_t len, void* ctx) {
+    (void)data;
+    (void)len;
+    (void)ctx;
+}
+
+/*
+ * Function: connected_pair
+ * ------------------------
+ * Two loopback UDP sockets connected to each other.
+ */
+static bool connected_pair(int fds[2]) {
+    struct sockaddr_in addr[2];
+    for (int i = 0; i < 2; i++) {
+        fds[i] = socket(AF_INET, SOCK_DGRAM, 0);
+        memset(&addr[i], 0, sizeof(addr[i]));
+        addr[i].sin_family = AF_INET;
+        addr[i].sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr[i]);
+        if (fds[i] < 0 || bind(fds[i], (struct sockaddr*)&addr[i], len) != 0 ||
+            getsockname(fds[i], (struct sockaddr*)&addr[i], &len) != 0) return false;
+    }
+    return connect(fds[0], (struct sockaddr*)&addr[1], sizeof(addr[1])) == 0 &&
+           connect(fds[1], (struct sockaddr*)&addr[0], sizeof(addr[0])) == 0;
+}
+
+/*
+ * Function: round_trip_us
+ * -----------------------
+ * Average microseconds for 'rounds' messages of 'bytes' sent to an echo
+ * thread and back: as datagrams, or through two rings (net_shm.h) with
+ * datagram doorbells like the bridge transport.
+ */
+static double round_trip_us(bool rings, size_t bytes, int rounds) {
+    int fds[2];
+    ShmRing to_peer, from_peer;
+    const char* error = NULL;
+    bool ok = connected_pair(fds);
+    if (ok && rings) {
+        ok = ShmRing_Create(&to_peer, "/logic_sim_bench_a", 1 << 20, &error) &&
+             ShmRing_Create(&from_peer, "/logic_sim_bench_b", 1 << 20, &error);
+    }
+
+    double us = -1;
+    if (ok) {
+        EchoPeer peer = { fds[1], rings ? &to_peer : NULL, rings ? &from_peer : NULL, rounds };
+        pthread_t thread;
+        pthread_create(&thread, NULL, echo_main, &peer);
+
+        char* msg = calloc(1, bytes);
+        char* buf = malloc(65536);
+        long long start = Timer_GetNanos();
+        for (int r = 0; r < rounds; r++) {
+            if (rings) {
+                bool doorbell;
+                ShmRing_Write(&to_peer, msg, bytes, &doorbell);
+                if (doorbell) ring_doorbell(fds[0]);
+                while (ShmRing_Drain(&from_peer, skip_message, NULL) == 0) recv(fds[0], buf, 65536, 0);
+            } else {
+                send(fds[0], msg, bytes, 0);
+                recv(fds[0], buf, 65536, 0);
+            }
+        }
+        us = (double)(Timer_GetNanos() - start) / rounds / 1000.0;
+        pthread_join(thread, NULL);
+        free(msg);
+        free(buf);
+    }
+
+    if (rings) {
+        ShmRing_Destroy(&to_peer);
+        ShmRing_Destroy(&from_peer);
+    }
+    close(fds[0]);
+    close(fds[1]);
+    return us;
+}
+
+/*
+ * Function: bench_transport
+ * -------------------------
+ * Round-trip latency of loopback UDP against the shared-memory rings
+ * for a small command and packets up to a large netlist.
+ */
+static void bench_transport(const char* args, DynBuf* out) {
+    (void)args;
+    static const size_t SIZES[] = { 64, 2048, 16384, 60000 };
+    enum { ROUNDS = 5000 };
+
+    DynBuf_AppendStr(out, "\"rounds\": ");
+    DynBuf_AppendInt(out, ROUNDS);
+    DynBuf_AppendStr(out, ", \"results\": [");
+    for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); i++) {
+        double udp_us = round_trip_us(false, SIZES[i], ROUNDS);
+        double shm_us = round_trip_us(true, SIZES[i], ROUNDS);
+        char line[200];
+        snprintf(line, sizeof(line), "{\"bytes\": %zu, \"udp_us\": %.2f, \"shm_us\": %.2f, \"speedup\": %.2f},",
+                 SIZES[i], udp_us, shm_us, shm_us > 0 ? udp_us / shm_us : 0.0);
+        DynBuf_AppendStr(out, line);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+}
+
+/*
+ * Function: bench_proto
+ * ---------------------
+ * The text protocol against binary frames (net_proto.h) for a kmap
+ * command with 32 minterms and its result reply: nanoseconds to parse
+ * the command into a truth table, to serialize the reply, and the bytes
+ * of each. Both parses must produce the same minterms.
+ */
+static void bench_proto(const char* args, DynBuf* out) {
+    (void)args;
+    static const char* SOP = "A'B'C + AB'D + BC'DE + A'CDEF + ABCF'";
+    static const char* POS = "(A + B + C')(A' + B + D')(B' + C + D' + E')";
+
+    uint64_t mask = 0;
+    int minterms[64], count = 0;
+    unsigned int seed = 0x9B07u;
+    while (count < 32) {
+        int m = (int)(bench_rand(&seed) & 63u);
+        if (mask >> m & 1u) continue;
+        mask |= 1ULL << m;
+        minterms[count++] = m;
+    }
+
+    // The command both ways
+    DynBuf text, frame;
+    DynBuf_Init(&text);
+    DynBuf_Init(&frame);
+    DynBuf_AppendStr(&text, "u1|kmap x ");
+    for (int i = 0; i < count; i++) {
+        DynBuf_AppendInt(&text, minterms[i]);
+        DynBuf_AppendChar(&text, ',');
+    }
+    DynBuf_TrimChar(&text, ',');
+    NetProto_Begin(&frame, NET_OP_KMAP, "u1");
+    NetProto_AppendString(&frame, NET_TAG_TARGET, "x");
+    NetProto_AppendMinterms(&frame, NET_TAG_MINTERMS, mask);
+
+    char* scratch = malloc(text.len + 1);
+    TruthTable text_tt, frame_tt;
+    long long iterations = 0, elapsed = 0;
+    long long start = Timer_GetNanos();
+    do {
+        // What process_command and Program_From_Minterms do
+        memcpy(scratch, text.data, text.len + 1);
+        char* cmd = strchr(scratch, '|') + 1;
+        text_tt.count = 0;
+        if (strncmp(cmd, "kmap ", 5) == 0) {
+            char* save = NULL;
+            for (char* tok = strtok_r(cmd + 7, ",", &save); tok && text_tt.count < MAX_MINTERMS; tok = strtok_r(NULL, ",", &save)) {
+                text_tt.minterms[text_tt.count++] = atoi(tok);
+            }
+        }
+        iterations++;
+        elapsed = Timer_GetNanos() - start;
+    } while (elapsed < BENCH_MIN_NS);
+    double text_parse_ns = (double)elapsed / (double)iterations;
+
+    iterations = 0;
+    start = Timer_GetNanos();
+    do {
+        NetFrame f;
+        uint64_t m = 0;
+        char target[4];
+        frame_tt.count = 0;
+        if (NetProto_Parse(frame.data, frame.len, &f) && f.opcode == NET_OP_KMAP &&
+            NetProto_FindString(&f, NET_TAG_TARGET, target, sizeof(target)) &&
+            NetProto_FindMinterms(&f, NET_TAG_MINTERMS, &m)) {
+            for (int k = 0; k < 64; k++) {
+                if (m >> k & 1u) frame_tt.minterms[frame_tt.count++] = k;
+            }
+        }
+        iterations++;
+        elapsed = Timer_GetNanos() - start;
+    } while (elapsed < BENCH_MIN_NS);
+    double frame_parse_ns = (double)elapsed / (double)iterations;
+
+    bool same = text_tt.count == frame_tt.count;
+    uint64_t text_mask = 0;
+    for (int i = 0; i < text_tt.count; i++) text_mask |= 1ULL << text_tt.minterms[i];
+    same = same && text_mask == mask;
+
+    // The result reply both ways, as NetUDP_SendLogicResult builds it
+    DynBuf reply;
+    DynBuf_Init(&reply);
+    iterations = 0;
+    start = Timer_GetNanos();
+    do {
+        DynBuf_Reset(&reply);
+        DynBuf_AppendStr(&reply, "{ \"uid\": \"u1\", \"type\": \"result\", \"mode\": ");
+        DynBuf_AppendJsonString(&reply, "kmap");
+        DynBuf_AppendStr(&reply, ", \"target\": ");
+        DynBuf_AppendJsonString(&reply, "x");
+        DynBuf_AppendStr(&reply, ", \"sop\": ");
+        DynBuf_AppendJsonString(&reply, SOP);
+        DynBuf_AppendStr(&reply, ", \"pos\": ");
+        DynBuf_AppendJsonString(&reply, POS);
+        DynBuf_AppendStr(&reply, ", \"minterms\": ");
+        DynBuf_AppendJsonIntArray(&reply, minterms, count);
+        DynBuf_AppendStr(&reply, " }");
+        iterations++;
+        elapsed = Timer_GetNanos() - start;
+    } while (elapsed < BENCH_MIN_NS);
+    double json_ns = (double)elapsed / (double)iterations;
+    size_t json_bytes = reply.len;
+
+    iterations = 0;
+    start = Timer_GetNanos();
+    do {
+        uint64_t m = 0;
+        for (int i = 0; i < count; i++) m |= 1ULL << minterms[i];
+        DynBuf_Reset(&reply);
+        NetProto_Begin(&reply, NET_OP_RESULT, "u1");
+        NetProto_AppendString(&reply, NET_TAG_TARGET, "x");
+        NetProto_AppendString(&reply, NET_TAG_MODE_NAME, "kmap");
+        NetProto_AppendString(&reply, NET_TAG_SOP, SOP);
+        NetProto_AppendString(&reply, NET_TAG_POS, POS);
+        NetProto_AppendMinterms(&reply, NET_TAG_MINTERMS, m);
+        iterations++;
+        elapsed = Timer_GetNanos() - start;
+    } while (elapsed < BENCH_MIN_NS);
+    double frame_ns = (double)elapsed / (double)iterations;
+
+    char line[400];
+    snprintf(line, sizeof(line),
+             "\"command\": {\"text_bytes\": %zu, \"frame_bytes\": %zu, \"text_parse_ns\": %.1f, \"frame_parse_ns\": %.1f, \"speedup\": %.2f}, "
+             "\"reply\": {\"json_bytes\": %zu, \"frame_bytes\": %zu, \"json_ns\": %.1f, \"frame_ns\": %.1f, \"speedup\": %.2f}, \"consistent\": %s",
+             text.len, frame.len, text_parse_ns, frame_parse_ns, text_parse_ns / frame_parse_ns,
+             json_bytes, reply.len, json_ns, frame_ns, json_ns / frame_ns, same ? "true" : "false");
+    DynBuf_AppendStr(out, line);
+
+    free(scratch);
+    DynBuf_Free(&reply);
+    DynBuf_Free(&text);
+    DynBuf_Free(&frame);
+}
+
+/*
+ * Function: bench_compress
+ * ------------------------
+ * LZ4 (utils_lz4.h) on the payloads it is meant for: combined netlists
+ * in JSON and binary, and a verify report with 2000 mismatches. Reports
+ * the ratio and compress/decompress throughput; every payload must
+ * round-trip unchanged. The context and output buffer are reused, as
+ * the sender does.
+ */
+static void bench_compress(const char* args, DynBuf* out) {
+    (void)args;
+    enum { PAYLOADS = 4 };
+    static const char* NAMES[PAYLOADS] = { "netlist_json_1k", "netlist_json_16k", "netlist_binary_16k", "verify_report" };
+
+    DynBuf payloads[PAYLOADS];
+    for (int p = 0; p < PAYLOADS; p++) DynBuf_Init(&payloads[p]);
+
+    unsigned int seed = 0x12A4u;
+    for (int p = 0; p < 3; p++) {
+        LogicNode* roots[4];
+        for (int i = 0; i < 4; i++) roots[i] = build_random_tree(p == 0 ? 256 : 4096, &seed);
+        if (p < 2) Netlist_GenerateCombinedJSON("X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3], &payloads[p]);
+        else Netlist_GenerateCombinedBinary("X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3], &payloads[p]);
+        for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+    }
+
+    // Shaped like the mismatch list of a failing verify run
+    DynBuf* report = &payloads[3];
+    static const char* DIFFS[] = { "X", "Y", "XZ", "W", "YW" };
+    DynBuf_AppendStr(report, "{ \"type\": \"verify\", \"status\": \"fail\", \"mismatches\": [");
+    for (int i = 0; i < 2000; i++) {
+        if (i > 0) DynBuf_AppendStr(report, ", ");
+        DynBuf_AppendStr(report, "{ \"step\": ");
+        DynBuf_AppendInt(report, i * 3);
+        DynBuf_AppendStr(report, ", \"time\": ");
+        DynBuf_AppendInt(report, i * 150);
+        DynBuf_AppendStr(report, ", \"inputs\": ");
+        DynBuf_AppendInt(report, bench_rand(&seed) & 63u);
+        DynBuf_AppendStr(report, ", \"expected\": ");
+        DynBuf_AppendInt(report, bench_rand(&seed) & 15u);
+        DynBuf_AppendStr(report, ", \"actual\": ");
+        DynBuf_AppendInt(report, bench_rand(&seed) & 15u);
+        DynBuf_AppendStr(report, ", \"diff\": ");
+        DynBuf_AppendJsonString(report, DIFFS[bench_rand(&seed) % 5]);
+        DynBuf_AppendStr(report, " }");
+    }
+    DynBuf_AppendStr(report, "] }");
+
+    Lz4Context* ctx = malloc(sizeof(Lz4Context));
+    DynBuf packed;
+    DynBuf_Init(&packed);
+    DynBuf_AppendStr(out, "\"results\": [");
+    for (int p = 0; p < PAYLOADS && ctx; p++) {
+        const DynBuf* in = &payloads[p];
+        long long iterations = 0, elapsed = 0;
+        long long start = Timer_GetNanos();
+        do {
+            DynBuf_Reset(&packed);
+            Lz4_Compress(ctx, in->data, in->len, &packed);
+            iterations++;
+            elapsed = Timer_GetNanos() - start;
+        } while (elapsed < BENCH_MIN_NS);
+        double compress_ns = (double)elapsed / (double)iterations;
+
+        char* unpacked = malloc(in->len);
+        bool same = false;
+        iterations = 0;
+        start = Timer_GetNanos();
+        do {
+            same = unpacked && Lz4_Decompress(packed.data, packed.len, unpacked, in->len);
+            iterations++;
+            elapsed = Timer_GetNanos() - start;
+        } while (elapsed < BENCH_MIN_NS && same);
+        double decompress_ns = (double)elapsed / (double)iterations;
+        same = same && memcmp(unpacked, in->data, in->len) == 0;
+        free(unpacked);
+
+        char line[320];
+        snprintf(line, sizeof(line),
+                 "{\"payload\": \"%s\", \"bytes\": %zu, \"compressed\": %zu, \"ratio\": %.2f, \"compress_us\": %.2f, "
+                 "\"compress_mb_per_s\": %.1f, \"decompress_mb_per_s\": %.1f, \"round_trip\": %s},",
+                 NAMES[p], in->len, packed.len, packed.len ? (double)in->len / (double)packed.len : 0.0,
+                 compress_ns / 1000.0, (double)in->len * 1000.0 / compress_ns,
+                 (double)in->len * 1000.0 / decompress_ns, same ? "true" : "false");
+        DynBuf_AppendStr(out, line);
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
+
+    free(ctx);
+    DynBuf_Free(&packed);
+    for (int p = 0; p < PAYLOADS; p++) DynBuf_Free(&payloads[p]);
+}
+
+static const BenchEntry BENCHES[] = {
+    { "json", bench_json },
+    { "netlist", bench_netlist_sizes },
+    { "delta", bench_delta },
+    { "layout", bench_layout },
+    { "sim", bench_sim },
+    { "event", bench_event },
+    { "seq", bench_seq },
+    { "par", bench_par },
+    { "fault", bench_fault },
+    { "sat", bench_sat },
+    { "stim", bench_stim },
+    { "verify", bench_verify },
+    { "vectors", bench_vectors },
+    { "transport", bench_transport },
+    { "proto", bench_proto },
+    { "compress", bench_compress },
+};
+
+#define BENCH_COUNT ((int)(sizeof(BENCHES) / sizeof(BENCHES[0])))
+
+bool Bench_Run(const char* name, const char* args, DynBuf* out) {
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        if (strcmp(name, BENCHES[i].name) == 0) {
+            fprintf(stderr, "[Bench] Running '%s'...\n", name);
+            DynBuf_AppendStr(out, "{ \"type\": \"bench\", \"name\": ");
+            DynBuf_AppendJsonString(out, name);
+            DynBuf_AppendStr(out, ", ");
+            BENCHES[i].run(args, out);
+            DynBuf_AppendStr(out, " }");
+            return true;
+        }
+    }
+    return false;
+}
+
+void Bench_ListJSON(DynBuf* out) {
+    DynBuf_AppendChar(out, '[');
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        if (i > 0) DynBuf_AppendChar(out, ',');
+        DynBuf_AppendJsonString(out, BENCHES[i].name);
+    }
+    DynBuf_AppendChar(out, ']');
+}
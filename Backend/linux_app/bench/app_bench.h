@@ -0,0 +1,40 @@
+/*
+ * File: app_bench.h
+ * Version: 1.1.0
+ * Description:
+ * Micro-benchmarks for the engine's hot paths.
+ * Benchmarks are built into their own executable, logic_bench (see
+ * bench_main.c), from the same engine sources and flags as logic_sim,
+ * so numbers are taken with the code that ships without the daemon
+ * exposing them to its clients.
+ *
+ * Each benchmark appends a JSON report object to the supplied buffer.
+ */
+
+#ifndef APP_BENCH_H
+#define APP_BENCH_H
+
+#include <stdbool.h>
+#include "utils_buffer.h"
+
+/*
+ * Function: Bench_Run
+ * -------------------
+ * Runs the benchmark called 'name' and writes its report.
+ *
+ * name: Benchmark identifier (e.g., "json").
+ * args: Optional benchmark-specific argument string (may be NULL).
+ * out:  Buffer the JSON report object is appended to.
+ *
+ * returns: false if 'name' is not a known benchmark.
+ */
+bool Bench_Run(const char* name, const char* args, DynBuf* out);
+
+/*
+ * Function: Bench_ListJSON
+ * ------------------------
+ * Appends a JSON array with the names of all available benchmarks.
+ */
+void Bench_ListJSON(DynBuf* out);
+
+#endif
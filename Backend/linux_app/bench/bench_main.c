@@ -0,0 +1,48 @@
+/*
+ * File: bench_main.c
+ * Version: 1.0.0
+ * Description:
+ * Entry point of logic_bench, the benchmark runner (see app_bench.h).
+ *
+ * Usage: logic_bench [name [args...]]
+ * Prints the benchmark's JSON report; without a name (or with an
+ * unknown one) prints the list of available benchmarks.
+ */
+
+#include "app_bench.h"
+#include "utils_buffer.h"
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char** argv) {
+    // Remaining words are the benchmark's argument string, as "bench" took it
+    DynBuf args;
+    DynBuf_Init(&args);
+    for (int i = 2; i < argc; i++) {
+        if (i > 2) DynBuf_AppendChar(&args, ' ');
+        DynBuf_AppendStr(&args, argv[i]);
+    }
+
+    bool args_ok = argc <= 2 || DynBuf_Ok(&args);
+
+    DynBuf report;
+    DynBuf_Init(&report);
+    bool ran = argc > 1 && Bench_Run(argv[1], args.data, &report);
+    if (!ran) {
+        DynBuf_AppendStr(&report, "{ \"type\": \"bench\", \"available\": ");
+        Bench_ListJSON(&report);
+        DynBuf_AppendStr(&report, " }");
+    }
+
+    int status = 0;
+    if (DynBuf_Ok(&report) && args_ok) {
+        printf("%s\n", report.data);
+        if (!ran && argc > 1) status = 2;
+    } else {
+        fprintf(stderr, "logic_bench: out of memory\n");
+        status = 1;
+    }
+    DynBuf_Free(&report);
+    DynBuf_Free(&args);
+    return status;
+}
@@ -0,0 +1,123 @@
+/*
+ * File: app_capture.h
+ * Version: 1.1.1
+ * Description:
+ * Waveform captures (utils_trace.h) of three sources:
+ *
+ * - CAPTURE_VERIFY: every test suite run (app_verification.h) is dumped
+ *   while the capture is on, one trace per run (a file is rewritten).
+ *   Signals: the circuit's inputs, the outputs it has, and "mismatch",
+ *   high on steps whose outputs differ from the expected ones. Time is
+ *   the suite's step start time in ms (step number for vector files
+ *   without durations).
+ * - CAPTURE_TIMING: the live event-driven simulator (app_timing.h),
+ *   glitches included. Time is the timing view's clock in ns.
+ * - CAPTURE_GPIO: the engine's pins, sampled whenever the main loop
+ *   drives them. Time is ns since the capture started.
+ *   For both live sources the signals are inputs A-F and outputs X-W.
+ *
+ * A capture goes to a file in CAPTURE_DIR (VCD or binary) or, for VCD,
+ * to the network as "trace" packets of about CAPTURE_STREAM_CHUNK bytes,
+ * sent to the session that started the capture.
+ * While no capture is on, the hooks cost one flag test.
+ *
+ * All functions are thread-safe.
+ */
+
+#ifndef APP_CAPTURE_H
+#define APP_CAPTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils_buffer.h"
+#include "utils_trace.h"
+#include "net_session.h"
+
+#define CAPTURE_DIR          "traces"  // Relative to the engine's working directory
+#define CAPTURE_STREAM_CHUNK 8192
+#define CAPTURE_LIVE_INPUTS  6         // A-F; outputs X-W follow as signals 6-9
+
+typedef enum {
+    CAPTURE_VERIFY,
+    CAPTURE_TIMING,
+    CAPTURE_GPIO,
+    CAPTURE_SOURCE_COUNT
+} CaptureSource;
+
+/*
+ * Function: Capture_SourceFromName
+ * --------------------------------
+ * Parses "verify", "timing" or "gpio".
+ */
+bool Capture_SourceFromName(const char* name, CaptureSource* source);
+
+/*
+ * Function: Capture_Start
+ * -----------------------
+ * Starts capturing 'source', replacing any capture of it. A file target
+ * is created (with CAPTURE_DIR) and checked at once, for CAPTURE_VERIFY
+ * too, although its runs only write it later.
+ *
+ * target: A plain file name inside CAPTURE_DIR, or "udp" to stream.
+ * format: TRACE_VCD or TRACE_BINARY (files only).
+ * owner:  UID of the session streamed packets go to ("" = everyone).
+ *
+ * returns: false with a message in 'error' if it cannot start.
+ */
+bool Capture_Start(CaptureSource source, const char* target, TraceFormat format, const char* owner,
+                   const char** error);
+
+/*
+ * Function: Capture_Stop
+ * ----------------------
+ * Ends the capture of 'source' and appends a "trace" packet with its
+ * totals (or status "idle" if none was on).
+ */
+void Capture_Stop(CaptureSource source, DynBuf* out);
+
+/*
+ * Function: Capture_BeginRun
+ * --------------------------
+ * For CAPTURE_VERIFY: opens a fresh trace for one run. The caller adds
+ * its signals and samples, then calls Capture_EndRun; the capture stays
+ * locked in between.
+ *
+ * timescale: Power of ten of the run's time unit (see utils_trace.h).
+ *
+ * returns: The writer, or NULL if the source is not being captured or
+ *          its trace cannot be opened (then with a message in 'error').
+ */
+TraceWriter* Capture_BeginRun(CaptureSource source, int timescale, const char** error);
+
+/*
+ * Function: Capture_EndRun
+ * ------------------------
+ * Finishes the trace opened by Capture_BeginRun.
+ */
+void Capture_EndRun(CaptureSource source);
+
+/*
+ * Function: Capture_Live
+ * ----------------------
+ * Samples a live source: all inputs and outputs at 'time' (ns; ignored
+ * for CAPTURE_GPIO, which uses its own clock).
+ *
+ * outputs: Bit 0 = X ... bit 3 = W.
+ */
+void Capture_Live(CaptureSource source, uint64_t time, uint32_t inputs, uint32_t outputs);
+
+/*
+ * Function: Capture_LiveInputs
+ * ----------------------------
+ * Samples new inputs of a live source, keeping its outputs.
+ */
+void Capture_LiveInputs(CaptureSource source, uint64_t time, uint32_t inputs);
+
+/*
+ * Function: Capture_LiveOutput
+ * ----------------------------
+ * Samples one output (0 = X ... 3 = W) of a live source.
+ */
+void Capture_LiveOutput(CaptureSource source, uint64_t time, int channel, bool value);
+
+#endif
@@ -0,0 +1,71 @@
+/*
+ * File: app_cycle.h
+ * Version: 1.0.1
+ * Description:
+ * Clocked execution of the programmed channels.
+ *
+ * Holds the cycle simulator (logic_seq.h) for the four equations and its
+ * register state. The "run" command clocks it for any number of cycles
+ * and replies with a single packet holding a compressed per-cycle trace.
+ * While the equations contain registers, the GPIO outputs show the
+ * current cycle's outputs instead of the stateless evaluation.
+ *
+ * Trace encoding: one hex digit per cycle, the output mask (bit 0 = X,
+ * bit 1 = Y, bit 2 = Z, bit 3 = W). A run of five or more equal cycles
+ * is written as "<digit>*<count>," instead, e.g. "0*1000,123".
+ *
+ * All functions are thread-safe.
+ */
+
+#ifndef APP_CYCLE_H
+#define APP_CYCLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils_buffer.h"
+
+#define CYCLE_MAX_RUN        50000000  // Cycles per "run" command
+#define CYCLE_TRACE_MAX      32768     // Trace characters per reply
+#define CYCLE_MAX_STIMULUS   256       // Input masks per "run" command
+
+/*
+ * Function: Cycle_Update
+ * ----------------------
+ * Recompiles when the equations changed (the registers are reset);
+ * otherwise does nothing.
+ */
+void Cycle_Update(const char* x, const char* y, const char* z, const char* w);
+
+/*
+ * Function: Cycle_GetOutputs
+ * --------------------------
+ * Reports the current cycle's outputs for 'input_mask' (no clock edge).
+ *
+ * returns: false if the equations are purely combinational (or do not
+ *          compile), in which case *outputs is untouched.
+ */
+bool Cycle_GetOutputs(uint8_t input_mask, uint32_t* outputs);
+
+/*
+ * Function: Cycle_Reset
+ * ---------------------
+ * Clears the registers and the cycle counter.
+ */
+void Cycle_Reset(void);
+
+/*
+ * Function: Cycle_Run
+ * -------------------
+ * Clocks the circuit and appends a "run" packet with the trace. The
+ * cycles run on a copy of the program, outside the lock; the final
+ * register state is kept only if nothing replaced the program or its
+ * state in the meantime.
+ *
+ * cycles:   Number of clock cycles (clamped to CYCLE_MAX_RUN).
+ * stimulus: Input masks for successive cycles; the last one is held for
+ *           the remaining cycles. NULL / 0 holds 'input_mask' throughout.
+ */
+void Cycle_Run(long long cycles, const uint8_t* stimulus, int stimulus_count,
+               uint8_t input_mask, DynBuf* out);
+
+#endif
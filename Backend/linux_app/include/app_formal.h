@@ -0,0 +1,53 @@
+/*
+ * File: app_formal.h
+ * Version: 1.1.0
+ * Description:
+ * Formal questions about the programmed channels. Small circuits are
+ * enumerated; wide ones go to the SAT solver (logic_sat.h, logic_cnf.h),
+ * so the answers stay exact far past what a truth table can cover.
+ *
+ * - equiv: does a channel compute the same function as another channel
+ *   or a candidate expression? Both are compiled into one program and
+ *   checked in tiers, cheapest first:
+ *   1. Up to FORMAL_TRUTH_TABLE_VARS inputs, one 64-lane sweep yields
+ *      both 64-bit truth tables; comparing them decides the question.
+ *   2. Otherwise FORMAL_RANDOM_SWEEPS sweeps of pseudo-random vectors,
+ *      which finds most differences in microseconds.
+ *   3. If simulation finds none, SAT: the circuits are encoded over
+ *      shared inputs, their outputs XORed (a "miter") and the XOR
+ *      asserted. UNSAT proves equivalence; a model is a counterexample.
+ * - sat: can a channel output a given value at all?
+ *
+ * Witness vectors are plain input masks (bit 0 = A) and can be applied
+ * with "set_input". Each one is re-checked with AST_Evaluate before it
+ * is reported. Searches give up after FORMAL_CONFLICT_LIMIT conflicts
+ * and then answer "unknown".
+ */
+
+#ifndef APP_FORMAL_H
+#define APP_FORMAL_H
+
+#include "utils_buffer.h"
+
+#define FORMAL_CONFLICT_LIMIT   1000000
+#define FORMAL_TRUTH_TABLE_VARS 6    // Inputs one 64-lane sweep covers exhaustively
+#define FORMAL_RANDOM_SWEEPS    256  // 64-vector random sweeps before falling back to SAT
+
+/*
+ * Function: Formal_Equiv
+ * ----------------------
+ * Appends an "equiv" packet comparing channel 'a' (x, y, z or w) with
+ * 'b', another channel or (anything but a lone channel name) a logic
+ * expression. The packet names the tier that decided ("truth_table",
+ * "simulation" or "sat") and the first counterexample found.
+ */
+void Formal_Equiv(const char* a, const char* b, DynBuf* out);
+
+/*
+ * Function: Formal_Sat
+ * --------------------
+ * Appends a "sat" packet telling whether 'channel' can output 'value'.
+ */
+void Formal_Sat(const char* channel, int value, DynBuf* out);
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * File: app_publish.h
+ * Version: 1.3.0
+ * Description:
+ * Schedules the broadcast updates the main loop sends to every client.
+ *
+ * An update comes in two classes:
+ * - state: the small state packet (mode, input mask, equations, valid
+ *   flags). Needed after every input or mode change.
+ * - heavy: per-channel results and netlists plus the combined netlist.
+ *   Only needed when an equation changed.
+ * Each class is published at most at its own rate (PUBLISH_STATE_HZ,
+ * PUBLISH_HEAVY_HZ by default). Changes arriving faster are coalesced:
+ * the pending update is simply sent later with the latest state, so
+ * intermediate states are never sent. When both classes are due, the
+ * state packet goes first.
+ *
+ * Rates are per session (Session_SetRates). Updates are built at the
+ * fastest rate any client asked for; the bridge and the WebSocket
+ * endpoint then hold each browser to its own rate.
+ *
+ * Only topics some client subscribes to (Session_Demand) are built:
+ * the state packet and the pin "outputs" packet travel in the state
+ * class, per-channel results, netlists and the combined view in the
+ * heavy class, and "metrics" once a second.
+ *
+ * All functions are thread-safe; Publish_Poll runs on the main loop,
+ * which sleeps until Publish_NextDue (or a state change) so rates up to
+ * PUBLISH_MAX_HZ are reachable.
+ */
+
+#ifndef APP_PUBLISH_H
+#define APP_PUBLISH_H
+
+#include <stdbool.h>
+#include "app_state.h"
+#include "net_session.h"
+#include "utils_buffer.h"
+
+#define PUBLISH_STATE_HZ 50
+#define PUBLISH_HEAVY_HZ 10
+#define PUBLISH_MAX_HZ   1000
+#define PUBLISH_METRICS_MS 1000
+
+/*
+ * Struct: PublishStats
+ * --------------------
+ * Counters since start.
+ */
+typedef struct {
+    long long requests;         // Changes reported with Publish_Request
+    long long state_sent;
+    long long heavy_sent;
+    long long state_coalesced;  // Changes folded into a pending state update
+    long long heavy_coalesced;  // Equation changes folded into a pending heavy update
+    long long skipped;          // Updates not built because nobody subscribes
+} PublishStats;
+
+/*
+ * Function: Publish_Request
+ * -------------------------
+ * Reports a state change ('st' is the new state). Schedules a state
+ * update, and a heavy one if an equation differs from the last request.
+ */
+void Publish_Request(const SharedState* st);
+
+/*
+ * Function: Publish_Outputs
+ * -------------------------
+ * Reports the input and output masks driven on the pins; a change is
+ * published as an "outputs" packet with the next state update.
+ */
+void Publish_Outputs(uint32_t inputs, uint32_t outputs);
+
+/*
+ * Function: Publish_RequestFull
+ * -----------------------------
+ * Schedules both classes (e.g. a client asked for a refresh or
+ * subscribed to a topic).
+ */
+void Publish_RequestFull(void);
+
+/*
+ * Function: Publish_Poll
+ * ----------------------
+ * Sends the updates that are pending and allowed by their rate, built
+ * from the current state, in one send batch.
+ */
+void Publish_Poll(void);
+
+/*
+ * Function: Publish_NextDue
+ * -------------------------
+ * returns: Milliseconds until Publish_Poll has something to send (a
+ *          pending update or a held WebSocket broadcast reaching its
+ *          slot), at most 'max_ms'; 0 if something is due now.
+ */
+int Publish_NextDue(int max_ms);
+
+/*
+ * Function: Publish_SetRates
+ * --------------------------
+ * Sets the maximum rates in Hz (1..PUBLISH_MAX_HZ) at which session 's'
+ * receives broadcasts; on the broadcast session, the defaults.
+ *
+ * returns: false if a rate is out of range (nothing changes).
+ */
+bool Publish_SetRates(Session* s, int state_hz, int heavy_hz);
+
+/*
+ * Function: Publish_WriteReport
+ * -----------------------------
+ * Appends { "type": "publish", rates of 's', counters } to 'out'.
+ * "default" tells whether 's' follows the default rates; "publish_*_hz"
+ * are the rates updates are currently built at.
+ */
+void Publish_WriteReport(Session* s, DynBuf* out);
+
+#endif
@@ -1,6 +1,6 @@
 /*
  * File: app_state.h
- * Version: 1.1.0
+ * Version: 1.2.0
  * Description:
  * Defines the shared application state structure and thread synchronization mechanisms.
  * This module acts as the central data repository for the application, holding
@@ -155,6 +155,16 @@ void AppState_SetValidation(bool vx, bool vy, bool vz, bool vw);
  */
 bool AppState_IsDirty(void);
 
+/*
+ * Function: AppState_WaitDirty
+ * ----------------------------
+ * Sleeps until the state is modified or 'timeout_ms' milliseconds pass,
+ * whichever comes first (returns at once if it is already dirty).
+ *
+ * returns: true if the state is dirty.
+ */
+bool AppState_WaitDirty(int timeout_ms);
+
 /*
  * Function: AppState_ClearDirty
  * -----------------------------
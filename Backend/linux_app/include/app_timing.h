@@ -0,0 +1,73 @@
+/*
+ * File: app_timing.h
+ * Version: 1.1.0
+ * Description:
+ * Live timing view of the programmed circuit.
+ *
+ * Keeps an event-driven simulator (logic_event.h) of the four channels
+ * running alongside the zero-delay engine. Every input change (set_input,
+ * rotary toggles) is applied to it at its real arrival time, in
+ * nanoseconds since the circuit was compiled, so the per-output timelines
+ * show what the GPIO pins do between settled states, glitches included.
+ *
+ * The simulator is only rebuilt when an equation or a gate delay changes;
+ * input changes never allocate. All functions are thread-safe.
+ */
+
+#ifndef APP_TIMING_H
+#define APP_TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils_buffer.h"
+
+/*
+ * Function: Timing_Update
+ * -----------------------
+ * Brings the simulator in line with the programmed equations. Does
+ * nothing if they are unchanged, so it can be called on every refresh.
+ *
+ * x, y, z, w: Current equation strings.
+ * input_mask: Inputs the circuit starts settled at when rebuilt.
+ */
+void Timing_Update(const char* x, const char* y, const char* z, const char* w, uint8_t input_mask);
+
+/*
+ * Function: Timing_SetInputs
+ * --------------------------
+ * Applies an input change at the current time.
+ */
+void Timing_SetInputs(uint8_t input_mask);
+
+/*
+ * Function: Timing_Sync
+ * ---------------------
+ * Runs the simulator up to the current time and samples its full state
+ * into the timing capture (app_capture.h), e.g. when one starts or ends.
+ */
+void Timing_Sync(void);
+
+/*
+ * Function: Timing_SetDelay
+ * -------------------------
+ * Sets the propagation delay of one gate type and rebuilds the
+ * simulator (timelines are cleared).
+ *
+ * gate:  "and", "or", "xor", "not", "nand" or "nor" (any case).
+ * ticks: Delay in nanoseconds, clamped to 1..EVENT_MAX_DELAY.
+ *
+ * returns: false if 'gate' is not a gate type.
+ */
+bool Timing_SetDelay(const char* gate, int ticks);
+
+/*
+ * Function: Timing_WriteReport
+ * ----------------------------
+ * Runs the simulator up to the current time and appends a "timing"
+ * packet: gate delays, and for each output its present value, glitch
+ * count and the transitions recorded since the last report. The
+ * timelines are cleared afterwards.
+ */
+void Timing_WriteReport(DynBuf* out);
+
+#endif
@@ -1,18 +1,20 @@
 /*
  * File: app_utils.h
- * Version: 1.0.0
+ * Version: 1.2.0
  * Description:
  * Provides high-level utility functions that bridge the gap between
  * raw logic parsing and the application state.
  *
  * This module handles the orchestration of compiling equations,
  * updating the global state, and triggering network updates.
+ * Results go to the Session (net_session.h) passed in.
  */
 
 #ifndef APP_UTILS_H
 #define APP_UTILS_H
 
 #include <stdbool.h>
+#include "net_session.h"
 
 /*
  * Function: Process_Equation
@@ -29,29 +31,40 @@
  *
  * returns:    true if the equation was successfully parsed and processed.
  */
-bool Process_Equation(const char* label, const char* expression, const char* mode);
+bool Process_Equation(Session* session, const char* label, const char* expression, const char* mode);
+
+/*
+ * Function: Process_EquationTopics
+ * --------------------------------
+ * Process_Equation limited to the broadcast topics in 'topics'
+ * (SessionTopic): the result is only minimized and sent with the
+ * channel's TOPIC_RESULT_* bit, the netlist only built and sent with
+ * TOPIC_NETLIST. The expression is always parsed for the return value.
+ */
+bool Process_EquationTopics(Session* session, const char* label, const char* expression, const char* mode, uint32_t topics);
 
 /*
  * Function: Send_Combined_Update
  * ------------------------------
  * Aggregates the current state of all four channels (X, Y, Z, W)
- * and broadcasts a unified JSON update to all connected clients.
- * This ensures the front-end view remains synchronized.
+ * and sends a unified JSON update to 'session' (all connected clients
+ * for Session_Broadcast()). This keeps the front-end view synchronized.
  *
  * in_x, in_y...: The current input strings for each channel.
  */
-void Send_Combined_Update(const char* in_x, const char* in_y, const char* in_z, const char* in_w);
+void Send_Combined_Update(Session* session, const char* in_x, const char* in_y, const char* in_z, const char* in_w);
 
 /*
  * Function: Process_Stateless
  * ---------------------------
  * Compiles and evaluates an equation without saving it to the
  * persistent application state. Useful for "Check Syntax" features
- * or temporary calculations.
+ * or temporary calculations. For a channel label ("x".."w") the
+ * expression is kept as the session's scratch copy of that channel.
  *
  * label:      Identifier for the operation.
  * expression: The boolean string to evaluate.
  */
-void Process_Stateless(const char* label, const char* expression);
+void Process_Stateless(Session* session, const char* label, const char* expression);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+/*
+ * File: app_vectors.h
+ * Version: 1.0.0
+ * Description:
+ * Binary test-vector files. Regression suites with millions of steps
+ * are kept on disk in a fixed layout that the verification engine
+ * (app_verification.h) maps into memory and feeds to the simulator in
+ * place, with no parsing and no copy.
+ *
+ * Layout (all fields little-endian, every section 4-byte aligned):
+ *   VectorFileHeader                         32 bytes
+ *   uint32_t masks[count]                    Input mask per step (bit 0 = A)
+ *   uint32_t expected[count]                 If VECTORS_FLAG_EXPECTED: output
+ *                                            mask per step (bit 0 = X ... bit
+ *                                            3 = W), or 0xFFFFFFFF = unchecked
+ *   uint32_t durations[count]                If VECTORS_FLAG_DURATIONS: ms
+ *
+ * Files are created from the "mask:duration[:expected]" text format by
+ * Vectors_ConvertText. Over UDP both ends are restricted to plain file
+ * names inside VECTORS_DIR.
+ */
+
+#ifndef APP_VECTORS_H
+#define APP_VECTORS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define VECTORS_MAGIC    "LSTV"
+#define VECTORS_VERSION  1
+#define VECTORS_DIR      "vectors"  // Relative to the engine's working directory
+#define VECTORS_PATH_MAX 256
+
+#define VECTORS_FLAG_EXPECTED  0x1u
+#define VECTORS_FLAG_DURATIONS 0x2u
+
+/*
+ * Struct: VectorFileHeader
+ * ------------------------
+ * input_bits:  Inputs the masks use (every mask < 2^input_bits).
+ * output_bits: Outputs the expected masks cover (4: X, Y, Z, W).
+ * flags:       VECTORS_FLAG_* sections present after 'masks'.
+ * count:       Steps in the file.
+ */
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint8_t input_bits;
+    uint8_t output_bits;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t reserved2;
+} VectorFileHeader;
+
+/*
+ * Struct: VectorFile
+ * ------------------
+ * An open, mapped vector file. 'expected' and 'durations' are NULL when
+ * the file lacks them. All pointers stay valid until Vectors_Close.
+ */
+typedef struct {
+    void* map;
+    size_t size;
+    const VectorFileHeader* header;
+    const uint32_t* masks;
+    const uint32_t* expected;
+    const uint32_t* durations;
+    long long count;
+} VectorFile;
+
+/*
+ * Function: Vectors_ResolvePath
+ * -----------------------------
+ * Turns a plain file name into a path inside VECTORS_DIR.
+ *
+ * returns: false for empty names, names with a '/' or a leading '.',
+ *          or paths longer than 'size'.
+ */
+bool Vectors_ResolvePath(const char* name, char* path, size_t size);
+
+/*
+ * Function: Vectors_Open
+ * ----------------------
+ * Maps a vector file read-only and checks its header against its size.
+ *
+ * returns: false with a message in 'error' if the file cannot be used.
+ */
+bool Vectors_Open(const char* path, VectorFile* file, const char** error);
+
+/*
+ * Function: Vectors_Close
+ * -----------------------
+ * Unmaps a file opened with Vectors_Open.
+ */
+void Vectors_Close(VectorFile* file);
+
+/*
+ * Function: Vectors_Write
+ * -----------------------
+ * Writes 'count' steps as a vector file. 'expected' and 'durations' may
+ * be NULL; each section is only stored if it holds any information.
+ *
+ * returns: false with a message in 'error' if the file cannot be written.
+ */
+bool Vectors_Write(const char* path, const uint32_t* masks, const uint32_t* expected,
+                   const uint32_t* durations, long long count, const char** error);
+
+/*
+ * Function: Vectors_ConvertText
+ * -----------------------------
+ * Converts a text suite ("mask:duration[:expected]" entries separated by
+ * commas or line breaks) into a vector file.
+ *
+ * count: Receives the number of steps written.
+ *
+ * returns: false with a message in 'error' on failure.
+ */
+bool Vectors_ConvertText(const char* text_path, const char* vector_path, long long* count, const char** error);
+
+#endif
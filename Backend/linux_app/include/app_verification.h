@@ -1,6 +1,6 @@
 /*
  * File: app_verification.h
- * Version: 1.0.0
+ * Version: 1.4.0
  * Description:
  * Manages the verification and testing suite for the digital logic server.
  * This module is responsible for parsing test vectors (formatted as text strings),
@@ -15,6 +15,10 @@
 #define APP_VERIFICATION_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "utils_buffer.h"
+#include "logic_sim.h"
+#include "app_vectors.h"
 
 /*
  * Constant: MAX_TEST_STEPS
@@ -24,6 +28,14 @@
  */
 #define MAX_TEST_STEPS 100
 
+#define VERIFICATION_FAULT_EXHAUSTIVE_VARS 20   // Inputs up to which "faults" without vectors tries every combination
+#define VERIFICATION_FAULT_LIST_MAX        256  // Undetected faults listed per report
+#define VERIFICATION_STIM_DEFAULT_VECTORS  (1LL << 20)  // Random stimulus runs without a count
+#define VERIFICATION_CHUNK_STEPS           4096  // Suite steps parsed and evaluated per batch
+#define VERIFICATION_PACKET_BYTES          8192  // A suite's mismatch list is flushed past this size
+#define VERIFICATION_MISMATCH_LIST_MAX     4096  // Mismatches listed per suite (all are counted)
+#define VERIFICATION_NO_EXPECTED           0xFFFFFFFFu  // Step without expected outputs
+
 /*
  * Struct: TestResult
  * ------------------
@@ -42,23 +54,128 @@ typedef struct {
     bool out_y;
 } TestResult;
 
+/*
+ * Struct: TestSteps
+ * -----------------
+ * A parsed test sequence: step i applies input mask masks[i] for
+ * durations[i] milliseconds and expects the outputs expected[i]
+ * (bit 0 = X ... bit 3 = W), or VERIFICATION_NO_EXPECTED. Grown as
+ * needed while parsing.
+ */
+typedef struct {
+    uint32_t* masks;
+    long long* durations;
+    uint32_t* expected;
+    int count;
+    int cap;
+} TestSteps;
+
+/*
+ * Typedef: VerificationSink
+ * -------------------------
+ * Receives each complete JSON packet of a streamed report, in order.
+ */
+typedef void (*VerificationSink)(const char* packet, void* ctx);
+
+/*
+ * Function: Verification_ParseSteps
+ * ---------------------------------
+ * Parses a test sequence (format as for Verification_CheckProgram)
+ * into 'steps'. Malformed entries are skipped. Other modules that take test
+ * vectors (e.g. fault coverage) use the same format through this.
+ *
+ * returns: false if memory ran out (nothing to free then).
+ */
+bool Verification_ParseSteps(const char* test_sequence, TestSteps* steps);
+
+/*
+ * Function: Verification_FreeSteps
+ * --------------------------------
+ * Releases a parsed sequence.
+ */
+void Verification_FreeSteps(TestSteps* steps);
+
+/*
+ * Function: Verification_CheckProgram
+ * -----------------------------------
+ * Runs a test suite against a compiled program whose outputs are named
+ * X, Y, Z and W (any subset) and streams the report to 'sink'.
+ *
+ * test_sequence: "InputMask:DurationMS[:Expected], ..."
+ * Example: "0:100:0, 1:100:1, 3:50"
+ * - Inputs 0 (all low) for 100ms; expect every output low.
+ * - Inputs 1 (A high) for 100ms; expect X high, the rest low.
+ * - Inputs 3 (A and B high) for 50ms; outputs not checked.
+ * Expected masks use bit 0 = X ... bit 3 = W; bits of outputs the
+ * program lacks are ignored. Malformed entries are skipped.
+ *
+ * The suite is parsed and evaluated VERIFICATION_CHUNK_STEPS steps at a
+ * time, and only mismatches are reported, so its length is bounded by
+ * the input alone. Each mismatch names the step, its start time, the
+ * inputs, the expected and actual output masks and the differing
+ * outputs. Whenever the pending list passes VERIFICATION_PACKET_BYTES it
+ * is sent as a "verify" packet with status "partial"; the last packet
+ * has status "pass", "fail" or "error" and the summary counts.
+ */
+void Verification_CheckProgram(SimProgram* p, const char* test_sequence,
+                               VerificationSink sink, void* ctx);
+
 /*
  * Function: Verification_RunSuite
  * -------------------------------
- * Parses a formatted command string and executes a timed simulation sequence.
- *
- * This function decodes the string, applies the inputs to the AST, waits for
- * the specified duration, and records the output state.
+ * Verification_CheckProgram on the programmed channels (all four).
+ */
+void Verification_RunSuite(const char* test_sequence, VerificationSink sink, void* ctx);
+
+/*
+ * Function: Verification_CheckVectors
+ * -----------------------------------
+ * Verification_CheckProgram on a mapped vector file (app_vectors.h).
+ * The file's sections are evaluated in place, chunk by chunk; the
+ * report is the same.
+ */
+void Verification_CheckVectors(SimProgram* p, const VectorFile* file, VerificationSink sink, void* ctx);
+
+/*
+ * Function: Verification_RunFile
+ * ------------------------------
+ * Verification_CheckVectors on the programmed channels, for the vector
+ * file 'name' in VECTORS_DIR.
+ */
+void Verification_RunFile(const char* name, VerificationSink sink, void* ctx);
+
+/*
+ * Function: Verification_FaultCoverage
+ * ------------------------------------
+ * Measures how many stuck-at faults of the programmed circuit (all four
+ * channels) a test sequence detects, and appends a "faults" packet:
+ * fault counts before and after collapsing, coverage (0..1) and the
+ * undetected faults, each named by netlist node ID ("n12"), the pin
+ * ("out", or an input pin index plus the driving node in "from") and the
+ * stuck-at value.
  *
- * test_sequence: A string defining the test pattern.
- * Format: "InputMask:DurationMS, InputMask:DurationMS, ..."
- * Example: "0:100, 1:100, 3:50"
- * - Sets inputs to 0 (All Low) for 100ms.
- * - Sets inputs to 1 (A High) for 100ms.
- * - Sets inputs to 3 (A and B High) for 50ms.
+ * test_sequence: Vectors in the Verification_CheckProgram format
+ *                (durations and expected outputs are ignored). NULL or ""
+ *                applies every combination of the circuit's inputs (up
+ *                to VERIFICATION_FAULT_EXHAUSTIVE_VARS).
+ */
+void Verification_FaultCoverage(const char* test_sequence, DynBuf* out);
+
+/*
+ * Function: Verification_RunStimulus
+ * ----------------------------------
+ * Streams generated vectors (logic_stim.h) through all four channels and
+ * appends a "stim" packet with, per output, how many vectors drove it to
+ * 1 and how often it toggled, plus the run's throughput.
  *
- * returns: void (Results are typically stored in a global state or broadcast via UDP).
+ * args: "<mode> [vectors] [seed] [p1,p2,...]"
+ *       mode:    exhaustive, gray, lfsr, weighted or walking.
+ *       vectors: Defaults to one full cycle for exhaustive, gray (2^n)
+ *                and walking (n), else VERIFICATION_STIM_DEFAULT_VECTORS.
+ *       seed:    For the random modes; default 1.
+ *       p1,...:  For weighted: percent chance of a 1 for inputs A, B, ...;
+ *                inputs past the list use the last value (default 50).
  */
-void Verification_RunSuite(const char* test_sequence);
+void Verification_RunStimulus(const char* args, DynBuf* out);
 
-#endif
\ No newline at end of file
+#endif
@@ -1,8 +1,9 @@
 /*
  * File: logic_ast.h
- * Version: 1.1.0
+ * Version: 1.2.0
  * Description:
  * Updated to support NAND and NOR nodes.
+ * Version 1.2.0 adds D flip-flops (NODE_DFF) for sequential circuits.
  */
 
 #ifndef LOGIC_AST_H
@@ -23,6 +24,10 @@
  * NODE_NAND: Represents a NAND gate.
  * NODE_NOR:  Represents a NOR gate.
  * NODE_XNOR: Represents an XNOR gate.
+ * NODE_DFF:  Represents a D flip-flop (@). The left child is the next-state
+ *            expression; the node's value is the stored state. Only the
+ *            cycle simulator (logic_seq.h) clocks registers: everywhere
+ *            else a register reads as its reset value, 0.
  */
 typedef enum {
     NODE_VAR,
@@ -31,7 +36,8 @@ typedef enum {
     NODE_XOR,
     NODE_NOT,
     NODE_NAND, // New
-    NODE_NOR   // New
+    NODE_NOR,  // New
+    NODE_DFF
 } NodeType;
 
 /*
@@ -44,7 +50,7 @@ typedef enum {
  * Ignored for operator nodes.
  * left:     Pointer to the left child node (Operand 1).
  * right:    Pointer to the right child node (Operand 2).
- * (Note: NODE_NOT uses only the left child; NODE_VAR uses neither).
+ * (Note: NODE_NOT and NODE_DFF use only the left child; NODE_VAR uses neither).
  */
 typedef struct LogicNode {
     NodeType type;
@@ -0,0 +1,140 @@
+/*
+ * File: logic_cnf.h
+ * Version: 1.0.0
+ * Description:
+ * Tseitin encoding of circuit graphs into SAT clauses (logic_sat.h).
+ *
+ * Every gate of a NetGraph gets one solver variable constrained to equal
+ * the gate's function of its inputs, so the clause count grows linearly
+ * with the circuit instead of exponentially like a truth table:
+ *
+ *   o = AND(a, b):  (!o | a), (!o | b), (o | !a | !b)
+ *   o = XOR(a, b):  four clauses
+ *   OR, NAND, NOR:  AND with negated inputs and/or output (De Morgan)
+ *   NOT:            the negated literal; no variable of its own
+ *
+ * Gates are structurally hashed as they are encoded, the way AIG-based
+ * equivalence checkers do it: an AND (XOR) input that is itself an AND
+ * (XOR) built here is flattened into its own inputs, the leaves are
+ * sorted and rebuilt as a balanced tree of two-input gates, XOR inputs
+ * give up their negations to the output, and a two-input gate already
+ * built from the same literals is reused. Circuits that differ only by De Morgan
+ * rewrites, inverter pairs, or the order and grouping of AND/OR/XOR
+ * inputs therefore map onto the very same literals, and their miter
+ * folds away before the solver runs; without this, plain CDCL can take
+ * seconds on an XOR-rich rewrite of a few thousand gates.
+ *
+ * Gate semantics follow the compiled simulator (logic_sim.h): a gate
+ * without inputs is constant (inverting gates 1, others 0) and a register
+ * (NODE_DFF) reads as its reset value, 0.
+ *
+ * Input variables are shared by everything encoded with the same
+ * encoder, which is what makes a miter: encode two circuits, XOR their
+ * outputs, and assert the XOR. The formula is satisfiable exactly when
+ * some input vector tells them apart.
+ */
+
+#ifndef LOGIC_CNF_H
+#define LOGIC_CNF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "logic_graph.h"
+#include "logic_sat.h"
+
+#define CNF_MAX_VARS    32  // Input variables A.. (same range as AST_Evaluate)
+#define CNF_FLATTEN_MAX 64  // Leaves a gate is flattened into at most
+
+/*
+ * Struct: CnfGate
+ * ---------------
+ * A two-input gate already encoded: op (NODE_AND or NODE_XOR), sorted
+ * input literals a < b, and the literal of its output.
+ */
+typedef struct {
+    uint8_t op;
+    int a;
+    int b;
+    int out;
+} CnfGate;
+
+/*
+ * Struct: CnfEncoder
+ * ------------------
+ * solver:    Receives the clauses.
+ * input_var: Solver variable of each circuit input, -1 until first used.
+ * true_lit:  A literal fixed to true (constants are encoded with it).
+ * gates:     Encoded two-input gates; 'table' indexes them by structure.
+ * var_gate:  Per solver variable, the gate it is the output of (or -1).
+ * leaves:    Scratch for flattening.
+ */
+typedef struct {
+    SatSolver* solver;
+    int input_var[CNF_MAX_VARS];
+    int true_lit;
+    CnfGate* gates;
+    int gate_count;
+    int gate_cap;
+    int* table;
+    int table_cap;
+    int* var_gate;
+    int var_gate_cap;
+    int* leaves;
+    int leaf_cap;
+} CnfEncoder;
+
+/*
+ * Function: Cnf_Init / Cnf_Free
+ * -----------------------------
+ * Binds an encoder to a solver / releases the encoder's own storage
+ * (not the solver, nor the clauses already added to it).
+ *
+ * returns: false if memory ran out.
+ */
+bool Cnf_Init(CnfEncoder* e, SatSolver* solver);
+void Cnf_Free(CnfEncoder* e);
+
+/*
+ * Function: Cnf_InputLit
+ * ----------------------
+ * returns: The literal of circuit input 'var' (0 = A), or -1 if memory
+ *          ran out. Inputs outside CNF_MAX_VARS read as constant 0.
+ */
+int Cnf_InputLit(CnfEncoder* e, int var);
+
+/*
+ * Function: Cnf_AddGraph
+ * ----------------------
+ * Encodes a finalized graph and stores the literal of each named output,
+ * in graph order, into 'output_lits' (at most 'max_outputs').
+ *
+ * returns: Number of outputs the graph has, or -1 if memory ran out.
+ */
+int Cnf_AddGraph(CnfEncoder* e, const NetGraph* g, int* output_lits, int max_outputs);
+
+/*
+ * Function: Cnf_AddTree
+ * ---------------------
+ * Encodes a single (non-NULL) logic tree.
+ *
+ * returns: The literal of its output, or -1 if memory ran out.
+ */
+int Cnf_AddTree(CnfEncoder* e, LogicNode* root);
+
+/*
+ * Function: Cnf_Xor
+ * -----------------
+ * returns: A literal equal to a XOR b, or -1 if memory ran out.
+ */
+int Cnf_Xor(CnfEncoder* e, int a, int b);
+
+/*
+ * Function: Cnf_InputMask
+ * -----------------------
+ * Reads the circuit inputs out of the solver's model after SAT_SAT.
+ *
+ * returns: Input vector, bit v = input v (unused inputs are 0).
+ */
+uint32_t Cnf_InputMask(const CnfEncoder* e);
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * File: logic_event.h
+ * Version: 1.1.0
+ * Description:
+ * Event-driven gate-level simulator with propagation delays.
+ *
+ * The compiled simulator (logic_sim.h) is zero-delay: it answers "what
+ * do the outputs settle to", not "what do the pins do on the way there".
+ * An EventSim keeps every gate's current value and moves time forward in
+ * integer ticks (nanoseconds in the engine), so hazards show up as real
+ * glitches on the output timelines.
+ *
+ * Model:
+ * - Gates are the graph's n-input gates (logic_graph.h), not lowered
+ *   two-input trees, and each gate type has its own delay.
+ * - Inertial delay: a gate output follows its inputs only if the new
+ *   value is still computed when the delay has passed. Pulses shorter
+ *   than the gate's delay are absorbed, as in a real CMOS gate. This
+ *   also means a gate never has more than one pending event.
+ * - Only gates with an input that changed are re-evaluated, once per
+ *   time step, after every event of that step has been applied.
+ * - Registers (NODE_DFF) hold their reset value, 0; clocked behaviour
+ *   is the cycle simulator's job (logic_seq.h).
+ *
+ * Pending events live in a timing wheel: one slot per tick, a power of
+ * two larger than the longest delay, so every pending event falls in a
+ * distinct slot and scheduling, cancelling and popping are O(1). Each
+ * gate is its own (intrusive) event record, and output timelines are
+ * fixed-size rings, so running the simulator never allocates: storage
+ * is sized once by EventSim_Compile.
+ */
+
+#ifndef LOGIC_EVENT_H
+#define LOGIC_EVENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "logic_graph.h"
+
+#define EVENT_MAX_VARS    32    // Input variables A.. (one input mask bit each)
+#define EVENT_MAX_OUTPUTS 32    // Outputs with a timeline
+#define EVENT_MAX_DELAY   1023  // Longest gate delay in ticks
+#define EVENT_TRACE_CAP   256   // Transitions kept per output timeline
+
+#define EVENT_NET_ZERO       EVENT_MAX_VARS   // Driven by gates with no inputs
+#define EVENT_FIRST_GATE_NET (EVENT_MAX_VARS + 1)
+
+/*
+ * Struct: EventDelays
+ * -------------------
+ * Propagation delay in ticks for each gate type, indexed by NodeType
+ * (the NODE_VAR entry is unused). Values are clamped to 1..EVENT_MAX_DELAY.
+ */
+typedef struct {
+    int ticks[NODE_NOR + 1];
+} EventDelays;
+
+/*
+ * Struct: EventTransition
+ * -----------------------
+ * One edge on an output: at 'time' the output became 'value'.
+ */
+typedef struct {
+    uint64_t time;
+    uint8_t value;
+} EventTransition;
+
+/*
+ * Typedef: EventEdgeFn
+ * --------------------
+ * Called for every transition of output 'output', as it is recorded.
+ */
+typedef void (*EventEdgeFn)(void* ctx, int output, uint64_t time, uint8_t value);
+
+/*
+ * Struct: EventOutput
+ * -------------------
+ * name:     Output name from the graph ("X", "Y", ...).
+ * net:      Net driving the output.
+ * trace:    Ring of the most recent transitions; 'trace_count' are valid,
+ *           the oldest at 'trace_start'. Older ones are counted in 'dropped'.
+ * glitches: Input changes after which this output toggled more than once
+ *           before settling (a hazard made visible).
+ */
+typedef struct {
+    char name[16];
+    int net;
+    EventTransition trace[EVENT_TRACE_CAP];
+    int trace_start;
+    int trace_count;
+    uint32_t dropped;
+    uint32_t glitches;
+    int toggles;  // Transitions since the last input change
+} EventOutput;
+
+/*
+ * Struct: EventSim
+ * ----------------
+ * Nets: 0..EVENT_MAX_VARS-1 are input variables, then constant 0, then
+ * one net per gate (gate i drives net EVENT_FIRST_GATE_NET + i).
+ *
+ * op, delay:           Per gate.
+ * in_start, in_net:    Gate i reads nets in_net[in_start[i] .. in_start[i+1]).
+ * fan_start, fan_gate: Net n feeds gates fan_gate[fan_start[n] .. fan_start[n+1]).
+ * value:               Current value per net.
+ * out_mask:            Per net, bit o set if the net drives output o.
+ * wheel:               Per slot, the first pending gate (-1 if empty);
+ *                      next/prev link gates in the same slot.
+ * occupied:            One bit per wheel slot with a pending event.
+ * eval_list/eval_mark: Gates to re-evaluate in the current step.
+ */
+typedef struct {
+    uint8_t* op;
+    uint16_t* delay;
+    int* in_start;
+    int* in_net;
+    int gate_count;
+
+    int* fan_start;
+    int* fan_gate;
+    int net_count;
+
+    uint8_t* value;
+    uint32_t* out_mask;
+    uint32_t var_mask;
+
+    uint8_t* pending;
+    uint64_t* pending_time;
+    int* next;
+    int* prev;
+    int* wheel;
+    uint64_t* occupied;
+    int wheel_size;
+    int pending_count;
+
+    int* eval_list;
+    uint8_t* eval_mark;
+    int eval_count;
+
+    EventOutput* outputs;
+    int output_count;
+    EventEdgeFn on_edge;  // Optional, see EventSim_SetEdgeHook
+    void* edge_ctx;
+
+    uint64_t now;
+    uint32_t input_mask;
+    uint64_t events;       // Events applied so far
+    uint64_t evaluations;  // Gate evaluations so far
+} EventSim;
+
+/*
+ * Function: EventDelays_Default
+ * -----------------------------
+ * Fills in typical 74HC-family delays in nanoseconds.
+ */
+void EventDelays_Default(EventDelays* d);
+
+/*
+ * Function: EventSim_Compile
+ * --------------------------
+ * Builds a simulator for a finalized graph. The circuit starts settled
+ * for 'input_mask' at time 'start' (no pending events).
+ *
+ * returns: false if memory ran out (the simulator is left empty).
+ */
+bool EventSim_Compile(const NetGraph* g, const EventDelays* delays, uint32_t input_mask,
+                      uint64_t start, EventSim* s);
+
+/*
+ * Function: EventSim_Free
+ * -----------------------
+ * Releases the simulator's storage.
+ */
+void EventSim_Free(EventSim* s);
+
+/*
+ * Function: EventSim_RunUntil
+ * ---------------------------
+ * Processes every pending event due at or before 'time', then moves the
+ * clock to 'time' (never backwards).
+ */
+void EventSim_RunUntil(EventSim* s, uint64_t time);
+
+/*
+ * Function: EventSim_SetInputs
+ * ----------------------------
+ * Runs up to 'time', then changes the inputs to 'input_mask' at that
+ * time and schedules the gates they feed. Times in the past are taken
+ * as "now".
+ */
+void EventSim_SetInputs(EventSim* s, uint64_t time, uint32_t input_mask);
+
+/*
+ * Function: EventSim_Settle
+ * -------------------------
+ * Processes events until none are pending.
+ *
+ * returns: The time of the last event (or the current time if none).
+ */
+uint64_t EventSim_Settle(EventSim* s);
+
+/*
+ * Function: EventSim_OutputValue
+ * ------------------------------
+ * returns: The present value of output 'output'.
+ */
+bool EventSim_OutputValue(const EventSim* s, int output);
+
+/*
+ * Function: EventSim_SetEdgeHook
+ * ------------------------------
+ * Streams output transitions to 'fn' as they happen, in time order,
+ * in addition to the timelines (which only keep the latest ones).
+ * NULL removes the hook.
+ */
+void EventSim_SetEdgeHook(EventSim* s, EventEdgeFn fn, void* ctx);
+
+/*
+ * Function: EventSim_ClearTraces
+ * ------------------------------
+ * Empties every output timeline and resets the glitch counters.
+ */
+void EventSim_ClearTraces(EventSim* s);
+
+#endif
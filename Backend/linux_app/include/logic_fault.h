@@ -0,0 +1,115 @@
+/*
+ * File: logic_fault.h
+ * Version: 1.0.0
+ * Description:
+ * Parallel-pattern stuck-at fault simulator.
+ *
+ * Faults are enumerated on the NetGraph (logic_graph.h), the same graph
+ * the netlist is serialized from, so a fault is named by the node IDs
+ * the client already draws: the output of node "n12" (a stem fault), or
+ * input pin 1 of node "n12", the edge "e5_12_1" (a branch fault). Every
+ * site can be stuck at 0 or at 1. Variables and gates have output
+ * faults; gates and named outputs have input faults.
+ *
+ * Equivalent faults (every test that detects one detects the other) are
+ * collapsed onto one representative:
+ * - A pin driven by a node with no other fan-out is the same wire as
+ *   that node's output.
+ * - A gate input stuck at the gate's controlling value equals the output
+ *   stuck at the value it forces: AND in/0 = out/0, NAND in/0 = out/1,
+ *   OR in/1 = out/1, NOR in/1 = out/0; NOT in/v = out/!v.
+ * Coverage is reported over the uncollapsed fault count, each
+ * representative weighing as much as its class.
+ *
+ * Simulation is parallel-pattern single-fault propagation: 64 vectors
+ * at a time, the fault-free circuit is evaluated once, then each fault
+ * still undetected is injected and propagated forward, event-driven,
+ * only through nodes whose value actually changed. A fault is detected
+ * when some output differs in some lane, and is dropped from further
+ * simulation.
+ *
+ * Registers (NODE_DFF) read as their reset value, 0, as in the other
+ * combinational simulators; faults behind them are reported undetected.
+ */
+
+#ifndef LOGIC_FAULT_H
+#define LOGIC_FAULT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "logic_graph.h"
+
+#define FAULT_PIN_OUT (-1)  // Fault on the node's output rather than an input pin
+
+/*
+ * Struct: Fault
+ * -------------
+ * node:         Graph node index (its stable ID is g->nodes[node].id).
+ * pin:          Input pin, or FAULT_PIN_OUT.
+ * stuck:        Stuck-at value, 0 or 1.
+ * class_size:   Faults this one stands for (1 when not collapsed).
+ * detected:     Set once some vector detects it.
+ * first_vector: Index of the first detecting vector (-1 if undetected).
+ */
+typedef struct {
+    int node;
+    int pin;
+    uint8_t stuck;
+    int class_size;
+    bool detected;
+    long long first_vector;
+} Fault;
+
+/*
+ * Struct: FaultList
+ * -----------------
+ * total:          Faults before collapsing.
+ * detected:       Entries of 'faults' detected so far.
+ * detected_total: Uncollapsed faults covered by the detected entries.
+ * vectors:        Vectors simulated so far.
+ */
+typedef struct {
+    Fault* faults;
+    int count;
+    int total;
+    int detected;
+    int detected_total;
+    long long vectors;
+} FaultList;
+
+/*
+ * Function: Fault_Enumerate
+ * -------------------------
+ * Lists every stuck-at fault of a finalized graph, collapsed into
+ * equivalence classes when 'collapse' is set.
+ *
+ * returns: false if memory ran out (the list is left empty).
+ */
+bool Fault_Enumerate(const NetGraph* g, bool collapse, FaultList* list);
+
+/*
+ * Function: Fault_Free
+ * --------------------
+ * Releases the list's storage.
+ */
+void Fault_Free(FaultList* list);
+
+/*
+ * Function: Fault_Simulate
+ * ------------------------
+ * Applies 'count' input vectors (bit v of a mask is variable v, bit 0 =
+ * A) and marks the faults they detect. Detected faults are skipped, so
+ * calling again with more vectors continues where the last call ended.
+ *
+ * returns: false if memory ran out (the list is unchanged).
+ */
+bool Fault_Simulate(const NetGraph* g, FaultList* list, const uint32_t* masks, int count);
+
+/*
+ * Function: Fault_Coverage
+ * ------------------------
+ * returns: Detected share of all (uncollapsed) faults, 0..1.
+ */
+double Fault_Coverage(const FaultList* list);
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ * File: logic_graph.h
+ * Version: 1.0.1
+ * Description:
+ * Hash-consed circuit graph built from one or more logic trees.
+ *
+ * Structurally identical subtrees collapse into a single node, so a gate
+ * shared by several outputs appears once with fan-out. Every node carries
+ * a 64-bit structural hash (op + ordered input hashes) which is interned
+ * into a small "stable ID": the same structure gets the same ID in every
+ * equation and every version of the history, which is what lets two
+ * versions of the netlist be diffed. IDs no graph in the history uses
+ * are eventually forgotten (a structure seen again then gets a new one)
+ * but never reassigned to another structure.
+ *
+ * Associative operators (AND, OR, XOR) are flattened and the inputs of
+ * commutative operators are put in canonical order, so "A*B" and "B*A"
+ * share a node.
+ *
+ * The module also keeps a short history of published graph versions,
+ * so updates can be sent as a delta against whatever a client last saw.
+ */
+
+#ifndef LOGIC_GRAPH_H
+#define LOGIC_GRAPH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "logic_ast.h"
+
+/*
+ * Enum: NetlistNodeKind
+ * ---------------------
+ * Node categories understood by the renderer. The numeric values are
+ * part of the binary wire format and must not be reordered.
+ */
+typedef enum {
+    NETLIST_NODE_VAR = 0,
+    NETLIST_NODE_GATE = 1,
+    NETLIST_NODE_OUTPUT = 2
+} NetlistNodeKind;
+
+/*
+ * Struct: GraphNode
+ * -----------------
+ * id:          Stable ID (see file description). JSON id is "n<id>".
+ * hash:        Structural hash the ID was derived from.
+ * kind:        Variable, gate or named output.
+ * op:          Gate operator (only meaningful for NETLIST_NODE_GATE).
+ * label:       Display label ("A", "AND", "X", ...).
+ * first_input: Index of this node's first entry in NetGraph.inputs.
+ * input_count: Number of inputs (pins), in canonical order.
+ */
+typedef struct {
+    uint32_t id;
+    uint64_t hash;
+    NetlistNodeKind kind;
+    NodeType op;
+    char label[16];
+    int first_input;
+    int input_count;
+} GraphNode;
+
+/*
+ * Struct: NetGraph
+ * ----------------
+ * nodes are stored in topological order: every node's inputs appear
+ * before it. 'inputs' holds node indices (not IDs) for all pins.
+ * 'hash' summarizes the whole graph once Graph_Finalize has run.
+ */
+typedef struct {
+    GraphNode* nodes;
+    int node_count;
+    int node_cap;
+
+    int* inputs;
+    int input_count;
+    int input_cap;
+
+    int* table;       // Open-addressing index: node hash -> node index
+    int table_cap;
+
+    int* pending;     // Operand stack used while building
+    int pending_count;
+    int pending_cap;
+
+    uint64_t hash;
+} NetGraph;
+
+/*
+ * Function: Graph_Init / Graph_Free
+ * ---------------------------------
+ * Prepare an empty graph / release all of its storage.
+ */
+void Graph_Init(NetGraph* g);
+void Graph_Free(NetGraph* g);
+
+/*
+ * Function: Graph_AddOutput
+ * -------------------------
+ * Adds a logic tree and a named output node driven by it.
+ * A NULL root adds nothing (the channel is unprogrammed).
+ *
+ * returns: false if memory ran out; the graph is then unusable.
+ */
+bool Graph_AddOutput(NetGraph* g, const char* name, LogicNode* root);
+
+/*
+ * Function: Graph_Finalize
+ * ------------------------
+ * Computes the whole-graph hash. Call after the last Graph_AddOutput.
+ */
+void Graph_Finalize(NetGraph* g);
+
+/*
+ * Function: Graph_NodeInput
+ * -------------------------
+ * returns: The node index driving pin 'pin' of node 'index'.
+ */
+int Graph_NodeInput(const NetGraph* g, int index, int pin);
+
+// --- Version History ---
+
+/*
+ * Function: GraphHistory_Lock / GraphHistory_Unlock
+ * -------------------------------------------------
+ * The history is shared by the main loop and the UDP thread. Hold the
+ * lock from Commit until you are done reading the returned graphs.
+ */
+void GraphHistory_Lock(void);
+void GraphHistory_Unlock(void);
+
+/*
+ * Function: GraphHistory_Commit
+ * -----------------------------
+ * Publishes a finalized graph. Ownership of its storage moves into the
+ * history (the caller's struct is reset). If the graph is identical to a
+ * version still in the history, that version is reused instead.
+ *
+ * returns: The version number now describing this graph.
+ */
+uint32_t GraphHistory_Commit(NetGraph* g);
+
+/*
+ * Function: GraphHistory_Get
+ * --------------------------
+ * returns: The graph for 'version', or NULL if it has been evicted.
+ */
+const NetGraph* GraphHistory_Get(uint32_t version);
+
+// --- Diff ---
+
+/*
+ * Struct: GraphEdge
+ * -----------------
+ * One wire: node index 'src' drives pin 'pin' of node index 'dst'.
+ */
+typedef struct {
+    int src;
+    int dst;
+    int pin;
+} GraphEdge;
+
+/*
+ * Struct: GraphDelta
+ * ------------------
+ * Operations turning graph 'from' into graph 'to'.
+ * removed_* refer to node indices in 'from'; added_* to indices in 'to'.
+ * kept_from[i] / kept_to[i] are the indices of a node present in both,
+ * for callers that attach per-node data (e.g. layout) to the diff.
+ */
+typedef struct {
+    int* removed_nodes;
+    int removed_node_count;
+    int* added_nodes;
+    int added_node_count;
+    int* kept_from;
+    int* kept_to;
+    int kept_node_count;
+    GraphEdge* removed_edges;
+    int removed_edge_count;
+    GraphEdge* added_edges;
+    int added_edge_count;
+} GraphDelta;
+
+/*
+ * Function: GraphDelta_Compute
+ * ----------------------------
+ * Diffs two graphs by stable node ID and (source, target, pin) edge key.
+ *
+ * returns: false if memory ran out.
+ */
+bool GraphDelta_Compute(const NetGraph* from, const NetGraph* to, GraphDelta* delta);
+
+/*
+ * Function: GraphDelta_Free
+ * -------------------------
+ * Releases the operation lists.
+ */
+void GraphDelta_Free(GraphDelta* delta);
+
+/*
+ * Function: GraphDelta_OpCount
+ * ----------------------------
+ * returns: Total number of add/remove operations in the delta
+ *          (kept nodes are not operations).
+ */
+int GraphDelta_OpCount(const GraphDelta* delta);
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * File: logic_layout.h
+ * Version: 1.0.0
+ * Description:
+ * Layered ("Sugiyama") layout for circuit graphs, computed in the engine
+ * so the browser only has to draw. Signals flow left to right:
+ *
+ * 1. Levelization: every node sits one layer right of its deepest input
+ *    (longest path). Inputs are the left column, outputs the right one.
+ * 2. Crossing reduction: edges spanning several layers are split by
+ *    dummy nodes, then layers are reordered by barycenter sweeps
+ *    (down and up), keeping the order with the fewest crossings.
+ * 3. Coordinates: x comes from the layer; y starts from the order and is
+ *    pulled toward the mean of each node's neighbours while keeping a
+ *    minimum spacing, so straight runs stay straight.
+ *
+ * Layouts depend only on graph structure, so they are cached by graph
+ * hash: re-sending an unchanged circuit costs no layout work.
+ */
+
+#ifndef LOGIC_LAYOUT_H
+#define LOGIC_LAYOUT_H
+
+#include <stdbool.h>
+#include "logic_graph.h"
+
+#define LAYOUT_LAYER_SPACING 180  // Horizontal distance between layers (px)
+#define LAYOUT_NODE_SPACING  80   // Minimum vertical distance within a layer (px)
+
+/*
+ * Struct: GraphLayout
+ * -------------------
+ * Top-left origin pixel coordinates, indexed like NetGraph.nodes.
+ */
+typedef struct {
+    int* x;
+    int* y;
+    int count;
+} GraphLayout;
+
+/*
+ * Function: Layout_Init / Layout_Free
+ * -----------------------------------
+ * Prepare an empty layout / release its storage.
+ */
+void Layout_Init(GraphLayout* layout);
+void Layout_Free(GraphLayout* layout);
+
+/*
+ * Function: Layout_Compute
+ * ------------------------
+ * Runs the full layout for 'g' without consulting the cache.
+ *
+ * returns: false if memory ran out.
+ */
+bool Layout_Compute(const NetGraph* g, GraphLayout* out);
+
+/*
+ * Function: Layout_Get
+ * --------------------
+ * Cached Layout_Compute: returns a copy of the layout last computed for
+ * a graph with the same hash, computing and caching it on a miss.
+ * Thread-safe.
+ *
+ * returns: false if memory ran out.
+ */
+bool Layout_Get(const NetGraph* g, GraphLayout* out);
+
+#endif
@@ -1,17 +1,79 @@
 /*
  * File: logic_netlist.h
- * Version: 1.0.0
+ * Version: 1.4.0
  * Description:
  * Handles the generation of JSON-formatted netlists.
  * A "Netlist" in this context is a serialized representation of the
  * logic tree structure, intended for the front-end UI to render
  * circuit diagrams visually.
+ *
+ * Netlists are serialized from a hash-consed NetGraph (logic_graph.h):
+ * node IDs are stable across versions, so shared structure keeps its ID
+ * and a client can be sent only what changed.
+ *
+ * Two encodings are available:
+ * - JSON: Cytoscape element array. Verbose, but readable for debugging.
+ * - Binary ("NB" v3): the same graph, typically 10-20x smaller.
+ *
+ * Either form can carry layout coordinates (logic_layout.h). In JSON they
+ * are Cytoscape "position" objects, so the browser can draw the graph
+ * with a preset layout instead of running its own.
+ *
+ * Binary layout (all integers are LEB128 varints unless noted):
+ *   'N' 'B' <version byte = 3>
+ *   label_count,  then per label: byte_length, UTF-8 bytes
+ *   node_count,   then per node:  node ID, kind byte (NetlistNodeKind), label index
+ *   edge_count,   then per edge:  source node ID, target node ID, target pin
+ *   layout byte (0 or 1); if 1, per node in node order: x, y
+ * Node N is "nN" in JSON; edge (S, T, P) is "eS_T_P".
+ * Version 2 is identical without the layout byte.
  */
 
 #ifndef LOGIC_NETLIST_H
 #define LOGIC_NETLIST_H
 
 #include "logic_ast.h"
+#include "logic_graph.h"
+#include "logic_layout.h"
+#include "utils_buffer.h"
+
+#define NETLIST_BIN_MAGIC0  'N'
+#define NETLIST_BIN_MAGIC1  'B'
+#define NETLIST_BIN_VERSION 3
+
+/*
+ * Function: Netlist_WriteJSON
+ * ---------------------------
+ * Serializes a graph as a Cytoscape element array.
+ *
+ * layout: Node coordinates, or NULL to leave placement to the client.
+ * out:    Growable buffer the JSON array is appended to.
+ */
+void Netlist_WriteJSON(const NetGraph* g, const GraphLayout* layout, DynBuf* out);
+
+/*
+ * Function: Netlist_WriteBinary
+ * -----------------------------
+ * Serializes a graph in the "NB" binary format.
+ */
+void Netlist_WriteBinary(const NetGraph* g, const GraphLayout* layout, DynBuf* out);
+
+/*
+ * Function: Netlist_WriteDeltaJSON
+ * --------------------------------
+ * Serializes the operations of a GraphDelta as a JSON object:
+ *   { "add_nodes": [...], "remove_nodes": ["nX", ...],
+ *     "add_edges": [...], "remove_edges": ["eS_T_P", ...] }
+ * Added elements use the same form as Netlist_WriteJSON. With a layout
+ * for 'to', the object also has "move_nodes": [{ "id", "position" }, ...]
+ * for kept nodes whose coordinates differ from 'from_layout'.
+ *
+ * from, to:   The graphs the delta was computed between.
+ * *_layout:   Their layouts, or NULL.
+ */
+void Netlist_WriteDeltaJSON(const NetGraph* from, const GraphLayout* from_layout,
+                            const NetGraph* to, const GraphLayout* to_layout,
+                            const GraphDelta* delta, DynBuf* out);
 
 /*
  * Function: Netlist_GenerateJSON
@@ -20,10 +82,9 @@
  *
  * target_name: The name of the output (e.g., "Output X").
  * root:        Pointer to the AST root for this output.
- * buffer:      Buffer to store the resulting JSON string.
- * max_len:     Maximum capacity of the buffer.
+ * out:         Growable buffer the JSON array is appended to.
  */
-void Netlist_GenerateJSON(const char* target_name, LogicNode* root, char* buffer, int max_len);
+void Netlist_GenerateJSON(const char* target_name, LogicNode* root, DynBuf* out);
 
 /*
  * Function: Netlist_GenerateCombinedJSON
@@ -36,15 +97,52 @@ void Netlist_GenerateJSON(const char* target_name, LogicNode* root, char* buffer
  * n2, r2: Name and Root Node for the second circuit (Y).
  * n3, r3: Name and Root Node for the third circuit (Z).
  * n4, r4: Name and Root Node for the fourth circuit (W).
- * buffer: Output buffer for the JSON string.
- * max_len: Buffer size limit.
+ * out:    Growable buffer the JSON array is appended to.
  */
 void Netlist_GenerateCombinedJSON(
     const char* n1, LogicNode* r1,
     const char* n2, LogicNode* r2,
     const char* n3, LogicNode* r3,
     const char* n4, LogicNode* r4,
-    char* buffer, int max_len
+    DynBuf* out
+);
+
+/*
+ * Function: Netlist_GenerateBinary
+ * --------------------------------
+ * Binary-encoded equivalent of Netlist_GenerateJSON.
+ *
+ * out: Growable buffer the binary netlist is appended to.
+ */
+void Netlist_GenerateBinary(const char* target_name, LogicNode* root, DynBuf* out);
+
+/*
+ * Function: Netlist_GenerateCombinedBinary
+ * ----------------------------------------
+ * Binary-encoded equivalent of Netlist_GenerateCombinedJSON.
+ */
+void Netlist_GenerateCombinedBinary(
+    const char* n1, LogicNode* r1,
+    const char* n2, LogicNode* r2,
+    const char* n3, LogicNode* r3,
+    const char* n4, LogicNode* r4,
+    DynBuf* out
+);
+
+/*
+ * Function: Netlist_BuildCombinedGraph
+ * ------------------------------------
+ * Builds and finalizes the graph for the four primary outputs.
+ * NULL roots are skipped.
+ *
+ * returns: false if memory ran out (the graph is freed).
+ */
+bool Netlist_BuildCombinedGraph(
+    NetGraph* g,
+    const char* n1, LogicNode* r1,
+    const char* n2, LogicNode* r2,
+    const char* n3, LogicNode* r3,
+    const char* n4, LogicNode* r4
 );
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,150 @@
+/*
+ * File: logic_par.h
+ * Version: 1.2.0
+ * Description:
+ * Multi-threaded evaluation of compiled programs (logic_sim.h).
+ *
+ * Two ways to spread a SimProgram over cores:
+ *
+ * - Gate-parallel (Par_EvaluateSlice): one 64-vector sweep of a large
+ *   netlist is split into chunks. A ParPlan cuts the level-major gate
+ *   list into contiguous chunks of about PAR_CHUNK_GATES gates: a wide
+ *   level is split into several chunks, consecutive narrow levels are
+ *   merged into one. Chunk-to-chunk dependencies are precomputed, and a
+ *   chunk becomes runnable as soon as the chunks it reads from are done,
+ *   so there is no barrier between levels: a deep, narrow cone can run
+ *   ahead while a wide level is still being worked on elsewhere.
+ *
+ * - Stimulus-parallel (Par_EvaluateBatch): a long list of input vectors
+ *   is cut into blocks of whole 64-lane slices and every thread sweeps
+ *   the full program for its blocks into its own value array. No
+ *   dependencies at all, so this is the mode for batch and verification
+ *   runs; gate-parallel only pays off when a single sweep is large.
+ *
+ * A ParPool is a fixed set of worker threads; the calling thread always
+ * joins in as worker 0. Gate-parallel scheduling is work-stealing: every
+ * worker pushes the chunks it makes runnable onto its own deque and pops
+ * them back LIFO (their inputs are still in its cache), and an idle
+ * worker steals the oldest chunk from another worker's deque.
+ *
+ * A pool runs one job at a time; concurrent callers are serialized and
+ * served in the order they arrived.
+ */
+
+#ifndef LOGIC_PAR_H
+#define LOGIC_PAR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "logic_sim.h"
+
+#define PAR_MAX_THREADS   64
+#define PAR_CHUNK_GATES   2048  // Target gates per scheduled chunk
+#define PAR_BATCH_SLICES  4     // 64-lane slices claimed at a time in batch mode
+
+typedef struct ParPool ParPool;
+
+/*
+ * Struct: ParPlan
+ * ---------------
+ * Chunk partition of one program.
+ *
+ * chunk_start:         Chunk c is gates [chunk_start[c], chunk_start[c+1]).
+ * succ_start, succ:    Chunk c makes chunks succ[succ_start[c] .. succ_start[c+1]) one
+ *                      step closer to runnable.
+ * dep_count:           Number of chunks each chunk reads from.
+ * roots:               Chunks with no dependencies.
+ * pending:             Scratch countdown per chunk for the sweep in progress.
+ */
+typedef struct {
+    int* chunk_start;
+    int chunk_count;
+    int* succ_start;
+    int* succ;
+    int* dep_count;
+    int* roots;
+    int root_count;
+    int* pending;
+} ParPlan;
+
+/*
+ * Function: ParPool_Create
+ * ------------------------
+ * Starts a pool of 'threads' workers in total, counting the caller.
+ * 0 or less means one per online CPU. Clamped to PAR_MAX_THREADS.
+ *
+ * returns: NULL if the pool could not be created.
+ */
+ParPool* ParPool_Create(int threads);
+
+/*
+ * Function: ParPool_Destroy
+ * -------------------------
+ * Stops and joins the workers and frees the pool.
+ */
+void ParPool_Destroy(ParPool* pool);
+
+/*
+ * Function: ParPool_Threads
+ * -------------------------
+ * returns: The pool's thread count (1 for a NULL pool).
+ */
+int ParPool_Threads(const ParPool* pool);
+
+/*
+ * Function: Par_SharedPool
+ * ------------------------
+ * The engine-wide pool, one thread per online CPU, created on first use.
+ *
+ * returns: NULL if it could not be created (callers then run serially).
+ */
+ParPool* Par_SharedPool(void);
+
+/*
+ * Function: ParPool_Run
+ * ---------------------
+ * Calls 'job' once on every thread of the pool (the caller as worker 0,
+ * the others as 1 .. ParPool_Threads-1) and returns when all are done.
+ * For work that is neither a batch nor a sweep, e.g. generated stimulus.
+ * A NULL pool runs job(ctx, 0) on the caller.
+ */
+typedef void (*ParJobFn)(void* ctx, int worker);
+void ParPool_Run(ParPool* pool, ParJobFn job, void* ctx);
+
+/*
+ * Function: ParPlan_Build
+ * -----------------------
+ * Partitions a compiled program. 'chunk_gates' <= 0 uses PAR_CHUNK_GATES.
+ *
+ * returns: false if memory ran out (the plan is left empty).
+ */
+bool ParPlan_Build(const SimProgram* p, int chunk_gates, ParPlan* plan);
+
+/*
+ * Function: ParPlan_Free
+ * ----------------------
+ * Releases the plan's storage.
+ */
+void ParPlan_Free(ParPlan* plan);
+
+/*
+ * Function: Par_EvaluateSlice
+ * ---------------------------
+ * Sim_EvaluateSlice with the gates spread over the pool. Uses the
+ * program's own value array, so the same rules apply: one evaluation of
+ * a program (and its plan) at a time. A NULL pool, or a plan with a
+ * single chunk, runs serially.
+ */
+void Par_EvaluateSlice(ParPool* pool, const ParPlan* plan, SimProgram* p, const uint64_t* inputs,
+                       uint64_t* outputs);
+
+/*
+ * Function: Par_EvaluateBatch
+ * ---------------------------
+ * Sim_EvaluateBatch with the vectors spread over the pool. Results are
+ * identical to the serial call. Batches of a single slice, or a NULL
+ * pool, run serially.
+ */
+void Par_EvaluateBatch(ParPool* pool, SimProgram* p, const uint32_t* masks, int count, uint32_t* results);
+
+#endif
@@ -1,6 +1,6 @@
 /*
  * File: logic_program.h
- * Version: 1.0.0
+ * Version: 1.1.0
  * Description:
  * Utilities for "programming" the logic server via direct minterm lists.
  * This allows setting the behavior of an output by specifying exactly
@@ -11,6 +11,8 @@
 #ifndef LOGIC_PROGRAM_H
 #define LOGIC_PROGRAM_H
 
+#include <stdint.h>
+
 /*
  * Function: Program_From_Minterms
  * -------------------------------
@@ -22,4 +24,12 @@
  */
 void Program_From_Minterms(const char* target, char* minterm_csv);
 
+/*
+ * Function: Program_From_Mask
+ * ---------------------------
+ * Like Program_From_Minterms, with the minterms as a bit mask (bit n set
+ * = minterm n), as sent in binary command frames.
+ */
+void Program_From_Mask(const char* target, uint64_t mask);
+
 #endif
\ No newline at end of file
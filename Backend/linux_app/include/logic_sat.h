@@ -0,0 +1,158 @@
+/*
+ * File: logic_sat.h
+ * Version: 1.0.0
+ * Description:
+ * Compact CDCL SAT solver.
+ *
+ * Truth tables and exhaustive simulation cost 2^n; past about 25 inputs
+ * they stop being an option. This solver answers "is there an input
+ * vector such that ..." questions (equivalence miters, reachability of
+ * an output value) without enumerating inputs. It is a conventional
+ * conflict-driven clause-learning solver:
+ *
+ * - Two watched literals per clause for unit propagation.
+ * - First-UIP conflict analysis with local clause minimization.
+ * - VSIDS branching (activity heap) with phase saving.
+ * - Luby restarts; at restarts the learnt clause database is halved
+ *   by LBD (literal block distance) when it grows too large, and the
+ *   clause arena is compacted.
+ *
+ * Literals are ints: variable v is 2v (positive) or 2v+1 (negative).
+ * Clauses live in one int arena: [size, flags, lit0, lit1, ...].
+ *
+ * Usage: Sat_Init, Sat_NewVar / Sat_AddClause to build the formula,
+ * Sat_Solve, then Sat_ModelValue for a satisfying assignment. Clauses
+ * can be added between solves.
+ */
+
+#ifndef LOGIC_SAT_H
+#define LOGIC_SAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SAT_LIT(var, negated) (2 * (var) + ((negated) ? 1 : 0))
+#define SAT_NOT(lit)          ((lit) ^ 1)
+#define SAT_VAR(lit)          ((lit) >> 1)
+
+/*
+ * Enum: SatResult
+ * ---------------
+ * SAT_UNKNOWN means the conflict budget ran out (or memory did).
+ */
+typedef enum {
+    SAT_UNKNOWN = 0,
+    SAT_SAT = 10,
+    SAT_UNSAT = 20
+} SatResult;
+
+/*
+ * Struct: SatVec
+ * --------------
+ * Growable int array (watch lists, clause lists).
+ */
+typedef struct {
+    int* data;
+    int count;
+    int cap;
+} SatVec;
+
+/*
+ * Struct: SatSolver
+ * -----------------
+ * arena:            Clause storage; a clause is referred to by its offset.
+ * problem, learnts: Offsets of the original and of the learnt clauses.
+ * watches:          Per literal, clauses watching it.
+ * value:            Per variable: 1, 0, or -1 (unassigned).
+ * level, reason:    Decision level and implying clause (-1: decision or unit).
+ * trail, trail_lim: Assigned literals in order; where each level starts.
+ * heap:             Unassigned variables by activity (VSIDS).
+ * model:            Assignment found by the last SAT_SAT.
+ * ok:               false once the formula is known unsatisfiable.
+ * failed:           Set when memory ran out; results are then SAT_UNKNOWN.
+ */
+typedef struct {
+    int var_count;
+    int var_cap;
+
+    int* arena;
+    int arena_len;
+    int arena_cap;
+    SatVec problem;
+    SatVec learnts;
+    SatVec* watches;
+
+    int8_t* value;
+    int8_t* phase;
+    int8_t* model;
+    uint8_t* seen;
+    int* level;
+    int* reason;
+    double* activity;
+    double var_inc;
+
+    int* heap;
+    int* heap_index;
+    int heap_count;
+
+    int* trail;
+    int trail_count;
+    int* trail_lim;
+    int level_count;
+    int qhead;
+
+    SatVec scratch;     // Learnt clause under construction
+    SatVec to_clear;    // Variables marked 'seen' during analysis
+    int max_learnts;
+
+    bool ok;
+    bool failed;
+
+    long long conflicts;
+    long long decisions;
+    long long propagations;
+    long long restarts;
+} SatSolver;
+
+/*
+ * Function: Sat_Init / Sat_Free
+ * -----------------------------
+ * Prepare an empty solver / release all of its storage.
+ */
+void Sat_Init(SatSolver* s);
+void Sat_Free(SatSolver* s);
+
+/*
+ * Function: Sat_NewVar
+ * --------------------
+ * returns: The new variable's index, or -1 if memory ran out.
+ */
+int Sat_NewVar(SatSolver* s);
+
+/*
+ * Function: Sat_AddClause
+ * -----------------------
+ * Adds the disjunction of 'count' literals (copied; duplicates and
+ * tautologies are fine).
+ *
+ * returns: false if the formula is now known to be unsatisfiable.
+ */
+bool Sat_AddClause(SatSolver* s, const int* lits, int count);
+
+/*
+ * Function: Sat_Solve
+ * -------------------
+ * conflict_limit: Give up after this many conflicts (<= 0: no limit).
+ *
+ * returns: SAT_SAT (see Sat_ModelValue), SAT_UNSAT or SAT_UNKNOWN.
+ */
+SatResult Sat_Solve(SatSolver* s, long long conflict_limit);
+
+/*
+ * Function: Sat_ModelValue
+ * ------------------------
+ * returns: The variable's value in the last model (false if none).
+ */
+bool Sat_ModelValue(const SatSolver* s, int var);
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * File: logic_seq.h
+ * Version: 1.0.2
+ * Description:
+ * Cycle-based simulator for sequential circuits.
+ *
+ * Sequential equations use two extensions of the expression language:
+ * - "@(expr)" is a D flip-flop (NODE_DFF) loaded with 'expr' on every
+ *   clock. Its value is the stored state, 0 after reset.
+ * - The channel names X, Y, Z and W can be used as variables. They read
+ *   that channel's value in the current cycle, so state is fed back by
+ *   naming the channel that holds it. Example, a 2-bit counter:
+ *       X = @(!X)
+ *       Y = @(Y ^ X)
+ *
+ * A reference that reaches its own channel without passing through a
+ * register is a combinational loop; the compiler rejects it.
+ *
+ * Cycle semantics, with inputs in(n) and register state Q(n):
+ *   outputs(n) = f(in(n), Q(n))
+ *   Q(n + 1)   = D(in(n), Q(n))
+ *
+ * The four channels are compiled straight from their ASTs into a flat
+ * list of two-input gates (SimOp, logic_sim.h) in dependency order, so a
+ * cycle is one linear sweep plus a register copy. Slots 0..SEQ_MAX_VARS-1
+ * are input variables, then constant 0 and 1, then one slot per register
+ * (its Q), then one per gate.
+ */
+
+#ifndef LOGIC_SEQ_H
+#define LOGIC_SEQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "logic_ast.h"
+
+#define SEQ_CHANNELS  4    // X, Y, Z, W: bit i of an output mask is channel i
+#define SEQ_MAX_VARS  32
+#define SEQ_SLOT_ZERO SEQ_MAX_VARS
+#define SEQ_SLOT_ONE  (SEQ_MAX_VARS + 1)
+#define SEQ_FIRST_REG_SLOT (SEQ_MAX_VARS + 2)
+
+// Reply for combinational-only analyses (verify, faults, equiv, ...)
+// asked about a tree for which Seq_IsSequential holds
+#define SEQ_COMBINATIONAL_ONLY "Sequential circuit: registers and channel references are only simulated by 'run'"
+
+/*
+ * Enum: SeqStatus
+ * ---------------
+ * Result of Seq_Compile.
+ */
+typedef enum {
+    SEQ_OK = 0,
+    SEQ_ERR_LOOP,     // A channel depends on itself without a register
+    SEQ_ERR_MEMORY
+} SeqStatus;
+
+/*
+ * Struct: SeqProgram
+ * ------------------
+ * op, in0, in1: Gate i computes op[i](slot in0[i], slot in1[i]) into
+ *               slot first_gate_slot + i.
+ * reg_next:     Slot holding register r's next state (its D input).
+ * out_slot:     Slot of each channel's value (valid if bit set in out_mask).
+ * values:       Slot values (0/1), including the register state.
+ * next_state:   Scratch for the register update.
+ * cycle:        Clock edges since the last reset.
+ */
+typedef struct {
+    uint8_t* op;
+    uint32_t* in0;
+    uint32_t* in1;
+    int gate_count;
+
+    uint32_t* reg_next;
+    int reg_count;
+    uint32_t first_gate_slot;
+
+    uint32_t out_slot[SEQ_CHANNELS];
+    uint32_t out_mask;
+    uint32_t var_mask;
+
+    uint8_t* values;
+    uint8_t* next_state;
+    uint64_t cycle;
+} SeqProgram;
+
+/*
+ * Function: Seq_Compile
+ * ---------------------
+ * Compiles the four channel trees (X, Y, Z, W order; NULL = unprogrammed,
+ * reads as 0). The program starts in reset.
+ *
+ * returns: SEQ_OK, or the reason it failed (the program is left empty).
+ */
+SeqStatus Seq_Compile(LogicNode* const roots[SEQ_CHANNELS], SeqProgram* p);
+
+/*
+ * Function: Seq_Free
+ * ------------------
+ * Releases the program's storage.
+ */
+void Seq_Free(SeqProgram* p);
+
+/*
+ * Function: Seq_Copy
+ * ------------------
+ * Makes 'dst' an independent copy of 'src', register state included, so
+ * it can be clocked without touching the original.
+ *
+ * returns: SEQ_OK, or SEQ_ERR_MEMORY (dst is left empty).
+ */
+SeqStatus Seq_Copy(const SeqProgram* src, SeqProgram* dst);
+
+/*
+ * Function: Seq_IsSequential
+ * --------------------------
+ * returns: true if 'root' contains a register or a channel reference,
+ *          i.e. its value is not a function of the inputs alone.
+ */
+bool Seq_IsSequential(const LogicNode* root);
+
+/*
+ * Function: Seq_Reset
+ * -------------------
+ * Clears every register and the cycle counter.
+ */
+void Seq_Reset(SeqProgram* p);
+
+/*
+ * Function: Seq_Outputs
+ * ---------------------
+ * Evaluates the current cycle without clocking.
+ *
+ * returns: Output mask for 'input_mask' and the present state.
+ */
+uint32_t Seq_Outputs(SeqProgram* p, uint32_t input_mask);
+
+/*
+ * Function: Seq_Step
+ * ------------------
+ * Runs one clock cycle: evaluates the outputs, then loads every register.
+ *
+ * returns: The outputs of the cycle (before the clock edge).
+ */
+uint32_t Seq_Step(SeqProgram* p, uint32_t input_mask);
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ * File: logic_sim.h
+ * Version: 1.1.0
+ * Description:
+ * Levelized compiled simulator for circuit graphs.
+ *
+ * AST_Evaluate walks each output's tree recursively, so logic shared
+ * between outputs is evaluated once per output, every time. A SimProgram
+ * instead compiles a NetGraph (logic_graph.h, where shared logic is
+ * already merged) once into a flat list of two-input gates:
+ *
+ * 1. Lowering: n-input AND/OR/XOR become a balanced tree of two-input
+ *    gates; NAND/NOR invert only the last one. Outputs are not gates,
+ *    they just name the slot that drives them.
+ * 2. Levelization: every gate sits one level above its deepest input,
+ *    and gates are stored level by level (level-major), so a gate's
+ *    inputs always come earlier in the arrays.
+ * 3. Storage: structure-of-arrays (op[], in0[], in1[]) over a flat value
+ *    array of "slots". Slots 0..SIM_MAX_VARS-1 hold input variables A, B,
+ *    ... (bit 0 of the input mask is A), followed by constant 0 and 1,
+ *    followed by one slot per gate in gate order.
+ *
+ * Evaluation is one linear sweep over the gate arrays. Slot values are
+ * 64-bit words, so the same sweep evaluates 64 input vectors at once
+ * ("bit-slicing": lane k of every word belongs to vector k).
+ *
+ * A program holds its own value scratch; a single program must not be
+ * evaluated from two threads at once through it. The compiled gate
+ * arrays are read-only after Sim_Compile, though, so threads can share a
+ * program by each sweeping into their own value array (Sim_AllocValues;
+ * this is what logic_par.h does).
+ */
+
+#ifndef LOGIC_SIM_H
+#define LOGIC_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "logic_ast.h"
+#include "logic_graph.h"
+
+#define SIM_MAX_VARS    32   // Input variables A.. (one input mask bit each)
+#define SIM_MAX_OUTPUTS 32   // Outputs reported in a result mask
+#define SIM_LANES       64   // Vectors per bit-sliced sweep
+
+#define SIM_SLOT_ZERO       SIM_MAX_VARS
+#define SIM_SLOT_ONE        (SIM_MAX_VARS + 1)
+#define SIM_FIRST_GATE_SLOT (SIM_MAX_VARS + 2)
+
+/*
+ * Enum: SimOp
+ * -----------
+ * Two-input gate operations (NOT ignores in1).
+ */
+typedef enum {
+    SIM_OP_AND,
+    SIM_OP_OR,
+    SIM_OP_XOR,
+    SIM_OP_NAND,
+    SIM_OP_NOR,
+    SIM_OP_NOT
+} SimOp;
+
+/*
+ * Struct: SimOutput
+ * -----------------
+ * name: Output name from the graph ("X", "Y", ...).
+ * slot: Slot holding the output's value.
+ */
+typedef struct {
+    char name[16];
+    uint32_t slot;
+} SimOutput;
+
+/*
+ * Struct: SimProgram
+ * ------------------
+ * op, in0, in1: Gate i computes op[i](slot in0[i], slot in1[i]) into
+ *               slot SIM_FIRST_GATE_SLOT + i.
+ * level_start:  Gates of level L are [level_start[L], level_start[L+1]).
+ * var_mask:     Bit v set if variable v is read by any gate or output.
+ * values:       Scratch slot values, one word per slot.
+ */
+typedef struct {
+    uint8_t* op;
+    uint32_t* in0;
+    uint32_t* in1;
+    int gate_count;
+
+    int* level_start;
+    int level_count;
+
+    SimOutput outputs[SIM_MAX_OUTPUTS];
+    int output_count;
+
+    uint32_t var_mask;
+    uint64_t* values;
+} SimProgram;
+
+/*
+ * Function: Sim_Compile
+ * ---------------------
+ * Compiles a finalized graph. Outputs keep the graph's order; outputs
+ * past SIM_MAX_OUTPUTS are ignored.
+ *
+ * returns: false if memory ran out (the program is left empty).
+ */
+bool Sim_Compile(const NetGraph* g, SimProgram* p);
+
+/*
+ * Function: Sim_CompileTree
+ * -------------------------
+ * Convenience wrapper: compiles a single logic tree as output "F".
+ * A NULL root gives a program with no outputs (Sim_TruthTable reports 0).
+ *
+ * returns: false if memory ran out.
+ */
+bool Sim_CompileTree(LogicNode* root, SimProgram* p);
+
+/*
+ * Function: Sim_Free
+ * ------------------
+ * Releases the program's storage.
+ */
+void Sim_Free(SimProgram* p);
+
+/*
+ * Function: Sim_FindOutput
+ * ------------------------
+ * returns: Index of the output called 'name', or -1 if there is none
+ *          (e.g. an unprogrammed channel).
+ */
+int Sim_FindOutput(const SimProgram* p, const char* name);
+
+/*
+ * Function: Sim_Evaluate
+ * ----------------------
+ * Evaluates a single input vector.
+ *
+ * input_mask: Bit v is variable v (bit 0 = A).
+ *
+ * returns: Output mask; bit i is output i.
+ */
+uint32_t Sim_Evaluate(SimProgram* p, uint32_t input_mask);
+
+/*
+ * Function: Sim_EvaluateSlice
+ * ---------------------------
+ * Evaluates up to 64 vectors in one sweep, in bit-sliced form.
+ *
+ * inputs:  SIM_MAX_VARS words; lane k of inputs[v] is variable v of vector k.
+ * outputs: output_count words; lane k of outputs[i] is output i of vector k.
+ */
+void Sim_EvaluateSlice(SimProgram* p, const uint64_t* inputs, uint64_t* outputs);
+
+/*
+ * Function: Sim_EvaluateBatch
+ * ---------------------------
+ * Evaluates a list of input masks, 64 per sweep.
+ *
+ * masks:   'count' input masks (as for Sim_Evaluate).
+ * results: 'count' output masks (as returned by Sim_Evaluate).
+ */
+void Sim_EvaluateBatch(SimProgram* p, const uint32_t* masks, int count, uint32_t* results);
+
+/*
+ * Function: Sim_AllocValues
+ * -------------------------
+ * Allocates a private value array for 'p' (constants filled in), for the
+ * *With / Sim_SweepRange variants. Free it with free().
+ *
+ * returns: NULL if memory ran out.
+ */
+uint64_t* Sim_AllocValues(const SimProgram* p);
+
+/*
+ * Function: Sim_SweepRange
+ * ------------------------
+ * Evaluates gates [first, last) into 'values'. Every slot those gates
+ * read (variables and earlier gates) must already be set there.
+ */
+void Sim_SweepRange(const SimProgram* p, uint64_t* values, int first, int last);
+
+/*
+ * Function: Sim_EvaluateBatchWith
+ * -------------------------------
+ * Sim_EvaluateBatch using the value array 'values' instead of the
+ * program's own scratch, so several threads can share 'p'.
+ */
+void Sim_EvaluateBatchWith(const SimProgram* p, uint64_t* values, const uint32_t* masks, int count,
+                           uint32_t* results);
+
+/*
+ * Function: Sim_TruthTable
+ * ------------------------
+ * Evaluates all 64 combinations of inputs A-F in a single sweep
+ * (variables past F are 0).
+ *
+ * returns: Bit m is the value of output 'output' for input mask m.
+ */
+uint64_t Sim_TruthTable(SimProgram* p, int output);
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ * File: logic_stim.h
+ * Version: 1.1.0
+ * Description:
+ * Generated stimulus streamed through compiled programs (logic_sim.h).
+ *
+ * Test steps typed in as "mask:duration" pairs are fine for a handful
+ * of vectors; coverage-style runs want millions or billions. Here the
+ * vectors are never stored: each 64-lane slice of inputs is generated
+ * in bit-sliced form straight into a sweep's value array, and only
+ * aggregate statistics come out (how often each output was 1, and how
+ * often it toggled between consecutive vectors).
+ *
+ * Modes, over the variables in 'var_mask' (the j-th of them is "input j"):
+ * - STIM_EXHAUSTIVE: vector i has input j = bit j of i (binary counting).
+ * - STIM_GRAY:       the same with i replaced by its Gray code i ^ (i >> 1),
+ *                    so consecutive vectors differ in exactly one input.
+ * - STIM_LFSR:       pseudo-random from 'seed'.
+ * - STIM_WEIGHTED:   pseudo-random, input j is 1 with probability
+ *                    weight[j] / 256.
+ * - STIM_WALKING:    walking ones: vector i sets only input i mod n.
+ *
+ * Every slice is computed from its index alone. The random modes seed
+ * each slice from 'seed' and the slice index (splitmix64) and then run
+ * a xorshift64 generator, a linear-feedback shift register over GF(2),
+ * one 64-bit word per input. Runs are therefore reproducible, and
+ * threads can take contiguous ranges of slices with no shared state;
+ * results do not depend on the thread count.
+ *
+ * Note: Version 1.1.0 caps a run at 2^32 vectors (a full exhaustive
+ * sweep of all SIM_MAX_VARS inputs) and runs it on the pool in rounds
+ * of about STIM_ROUND_WORK gate sweeps per thread, so other callers of
+ * the pool (e.g. a verify) get a turn between rounds.
+ */
+
+#ifndef LOGIC_STIM_H
+#define LOGIC_STIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "logic_sim.h"
+#include "logic_par.h"
+
+#define STIM_MAX_VECTORS (1LL << 32)  // Per run
+#define STIM_ROUND_WORK  (1L << 22)   // Gates x slices per thread per pool job
+
+typedef enum {
+    STIM_EXHAUSTIVE,
+    STIM_GRAY,
+    STIM_LFSR,
+    STIM_WEIGHTED,
+    STIM_WALKING
+} StimMode;
+
+/*
+ * Struct: StimConfig
+ * ------------------
+ * var_mask: Variables driven (bit v = variable v); the rest stay 0.
+ * count:    Vectors to apply.
+ * weight:   STIM_WEIGHTED only: per input j, P(1) = weight[j] / 256
+ *           (256 = always 1).
+ */
+typedef struct {
+    StimMode mode;
+    uint32_t var_mask;
+    long long count;
+    uint64_t seed;
+    uint16_t weight[SIM_MAX_VARS];
+} StimConfig;
+
+/*
+ * Struct: StimStats
+ * -----------------
+ * ones[i]:    Vectors on which output i was 1.
+ * toggles[i]: Consecutive vector pairs on which output i changed.
+ */
+typedef struct {
+    long long vectors;
+    int output_count;
+    long long ones[SIM_MAX_OUTPUTS];
+    long long toggles[SIM_MAX_OUTPUTS];
+} StimStats;
+
+/*
+ * Function: Stim_ModeFromName
+ * ---------------------------
+ * Parses "exhaustive", "gray", "lfsr", "weighted" or "walking".
+ *
+ * returns: false for any other name.
+ */
+bool Stim_ModeFromName(const char* name, StimMode* mode);
+
+/*
+ * Function: Stim_ModeName
+ * -----------------------
+ * returns: The name Stim_ModeFromName accepts for 'mode'.
+ */
+const char* Stim_ModeName(StimMode mode);
+
+/*
+ * Function: Stim_Slice
+ * --------------------
+ * Generates vectors 64 * slice .. 64 * slice + 63 in bit-sliced form:
+ * lane k of inputs[v] is variable v of vector 64 * slice + k.
+ *
+ * inputs: SIM_MAX_VARS words.
+ */
+void Stim_Slice(const StimConfig* cfg, long long slice, uint64_t* inputs);
+
+/*
+ * Function: Stim_Run
+ * ------------------
+ * Applies cfg->count vectors (clamped to STIM_MAX_VECTORS) to 'p',
+ * spread over 'pool' (NULL runs serially) one round at a time.
+ *
+ * returns: false if memory ran out.
+ */
+bool Stim_Run(ParPool* pool, const SimProgram* p, const StimConfig* cfg, StimStats* stats);
+
+#endif
@@ -1,6 +1,6 @@
 /*
  * File: net_json.h
- * Version: 1.0.0
+ * Version: 1.1.0
  * Description:
  * Helper module for serializing application state into JSON format.
  * Used primarily for communicating status updates to connected UDP clients
@@ -11,6 +11,7 @@
 #define NET_JSON_H
 
 #include "app_state.h"
+#include "utils_buffer.h"
 
 /*
  * Function: JSON_SerializeState
@@ -19,10 +20,9 @@
  * This includes current input values, output calculations, and mode flags.
  *
  * state:  Pointer to the global application state.
- * buffer: Output buffer for the JSON string.
- * len:    Maximum length of the buffer.
+ * out:    Growable buffer the JSON object is appended to.
  */
-void JSON_SerializeState(const SharedState* state, char* buffer, int len);
+void JSON_SerializeState(const SharedState* state, DynBuf* out);
 
 /*
  * Function: JSON_SerializeMessage
@@ -31,9 +31,8 @@ void JSON_SerializeState(const SharedState* state, char* buffer, int len);
  * Format: { "message": "your text here" }
  *
  * msg:    The raw text message to encapsulate.
- * buffer: Output buffer for the JSON string.
- * len:    Maximum length of the buffer.
+ * out:    Growable buffer the JSON object is appended to.
  */
-void JSON_SerializeMessage(const char* msg, char* buffer, int len);
+void JSON_SerializeMessage(const char* msg, DynBuf* out);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+/*
+ * File: net_proto.h
+ * Version: 1.0.0
+ * Description:
+ * Binary command/response frames, an alternative to the ASCII commands
+ * and JSON replies for high-rate clients (stimulus drivers, the bridge).
+ *
+ * Frame layout:
+ *   0xB2, version, opcode, uid_length, uid bytes, TLVs...
+ * Each TLV is a tag byte, a LEB128 varint length and the value. Numbers
+ * are varints inside the value; minterm sets are 8-byte little-endian
+ * bit masks (bit n = minterm n). Unknown tags are skipped, so fields can
+ * be added without a version bump; the version changes only when the
+ * meaning of an existing opcode or tag does.
+ *
+ * Request opcodes are below 0x80 and index the dispatch table in
+ * net_udp.c; replies have the high bit set. A session chooses binary
+ * replies with NET_OP_PROTO (or the text command "proto binary").
+ */
+
+#ifndef NET_PROTO_H
+#define NET_PROTO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils_buffer.h"
+
+#define NET_PROTO_MAGIC   0xB2
+#define NET_PROTO_VERSION 1
+#define NET_PROTO_HEADER  4    // magic, version, opcode, uid_length
+
+/*
+ * Enum: NetOpcode
+ * ---------------
+ * Requests (tags they read) and replies (tags they carry).
+ */
+typedef enum {
+    NET_OP_TEXT = 0,         // TEXT: any ASCII command
+    NET_OP_SET_INPUT = 1,    // MASK
+    NET_OP_PROGRAM = 2,      // TARGET, TEXT (equation)
+    NET_OP_PREVIEW = 3,      // TARGET, TEXT (equation)
+    NET_OP_KMAP = 4,         // TARGET, MINTERMS
+    NET_OP_ACK = 5,          // VERSION
+    NET_OP_NETSYNC = 6,      // VERSION
+    NET_OP_PROTO = 7,        // MODE (0 = JSON replies, 1 = binary)
+    NET_OP_PING = 8,         // NONCE (echoed)
+    NET_OP_REQUEST_COUNT,
+
+    NET_OP_RESULT = 0x80,    // TARGET, MODE_NAME, SOP, POS, MINTERMS
+    NET_OP_STATUS = 0x81,    // TEXT
+    NET_OP_PONG = 0x82,      // NONCE
+    NET_OP_ERROR = 0x83      // TEXT
+} NetOpcode;
+
+/*
+ * Enum: NetTag
+ * ------------
+ * TLV tags.
+ */
+typedef enum {
+    NET_TAG_TEXT = 1,
+    NET_TAG_TARGET = 2,      // Channel letter
+    NET_TAG_MASK = 3,        // Varint
+    NET_TAG_MINTERMS = 4,    // 8-byte bit mask
+    NET_TAG_VERSION = 5,     // Varint
+    NET_TAG_MODE = 6,        // Varint
+    NET_TAG_MODE_NAME = 7,
+    NET_TAG_SOP = 8,
+    NET_TAG_POS = 9,
+    NET_TAG_NONCE = 10       // Opaque bytes
+} NetTag;
+
+/*
+ * Struct: NetFrame
+ * ----------------
+ * A parsed frame. 'uid' and 'tlv' point into the received bytes.
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t opcode;
+    const char* uid;
+    size_t uid_len;
+    const uint8_t* tlv;
+    size_t tlv_len;
+} NetFrame;
+
+/*
+ * Function: NetProto_IsFrame
+ * --------------------------
+ * true if the datagram starts like a binary frame.
+ */
+bool NetProto_IsFrame(const void* data, size_t len);
+
+/*
+ * Function: NetProto_Parse
+ * ------------------------
+ * Splits a frame into header, UID and TLV area and checks that every
+ * TLV lies inside the frame.
+ *
+ * returns: false for short or malformed frames.
+ */
+bool NetProto_Parse(const void* data, size_t len, NetFrame* frame);
+
+/*
+ * Function: NetProto_Find
+ * -----------------------
+ * Finds the first TLV with 'tag'.
+ *
+ * returns: false if the frame has none.
+ */
+bool NetProto_Find(const NetFrame* frame, uint8_t tag, const uint8_t** value, size_t* len);
+
+/*
+ * Function: NetProto_FindVarint / NetProto_FindString / NetProto_FindMinterms
+ * ---------------------------------------------------------------------------
+ * Typed lookups. Strings are copied NUL-terminated into 'out' and must
+ * fit in 'size'; minterm masks must be exactly 8 bytes.
+ *
+ * returns: false if the tag is missing or malformed.
+ */
+bool NetProto_FindVarint(const NetFrame* frame, uint8_t tag, uint64_t* value);
+bool NetProto_FindString(const NetFrame* frame, uint8_t tag, char* out, size_t size);
+bool NetProto_FindMinterms(const NetFrame* frame, uint8_t tag, uint64_t* mask);
+
+/*
+ * Function: NetProto_Begin
+ * ------------------------
+ * Writes a frame header for 'opcode' addressed to 'uid' ("" = broadcast).
+ */
+void NetProto_Begin(DynBuf* b, uint8_t opcode, const char* uid);
+
+/*
+ * Function: NetProto_AppendTlv / NetProto_AppendString / NetProto_AppendVarint / NetProto_AppendMinterms
+ * -------------------------------------------------------------------------------------------------------
+ * Writes one TLV.
+ */
+void NetProto_AppendTlv(DynBuf* b, uint8_t tag, const void* value, size_t len);
+void NetProto_AppendString(DynBuf* b, uint8_t tag, const char* str);
+void NetProto_AppendVarint(DynBuf* b, uint8_t tag, uint64_t value);
+void NetProto_AppendMinterms(DynBuf* b, uint8_t tag, uint64_t mask);
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * File: net_reactor.h
+ * Version: 1.5.1
+ * Description:
+ * Event loop that owns the engine's UDP socket.
+ *
+ * One reactor thread waits in epoll on the (non-blocking) socket and an
+ * eventfd used to stop it. Each datagram it drains is queued as a
+ * command for a small pool of worker threads, so a slow command (a big
+ * minimization, a long verify run) only holds up its own worker.
+ * Commands with the same session key (by default the text before '|')
+ * still run one at a time, in the order they arrived.
+ *
+ * Replies go to a destination's send queue. A packet is sent straight
+ * away when nothing is queued ahead of it; when the socket buffer is
+ * full it waits in the queue and the reactor sends it once the socket
+ * is writable again, so no thread ever blocks on a send.
+ *
+ * Syscalls are batched both ways: the reactor reads up to
+ * REACTOR_RECV_BATCH datagrams per recvmmsg, and packets sent between
+ * NetReactor_BeginBatch and NetReactor_EndBatch (each worker command is
+ * one batch) leave together in one sendmmsg per REACTOR_SEND_BATCH.
+ *
+ * Other sockets (the WebSocket listener and its clients, net_ws.h) can
+ * join the same epoll loop with NetReactor_Watch; their callbacks run
+ * on the reactor thread and must not block.
+ *
+ * All functions except Start/Stop are thread-safe.
+ */
+
+#ifndef NET_REACTOR_H
+#define NET_REACTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <netinet/in.h>
+
+#define REACTOR_MAX_DATAGRAM    65536      // Largest command accepted (a UDP payload is at most 65507 bytes)
+#define REACTOR_WORKERS         4
+#define REACTOR_MAX_PENDING     1024       // Commands waiting for a worker; more are dropped
+#define REACTOR_MAX_DESTINATIONS 8
+#define REACTOR_QUEUE_BYTES     (4 << 20)  // Per destination; packets beyond it are dropped
+#define REACTOR_KEY_MAX         64
+#define REACTOR_RECV_BATCH      16         // Datagrams per recvmmsg
+#define REACTOR_SEND_BATCH      32         // Packets per sendmmsg; a fuller batch is sent early
+#define REACTOR_BATCH_BYTES     (256 << 10)  // A batch holding this much is sent early
+#define REACTOR_MAX_WATCHES     64         // Extra descriptors (NetReactor_Watch)
+
+/*
+ * Typedef: ReactorCommandFn
+ * -------------------------
+ * Runs one received datagram on a worker thread. 'msg' is a private,
+ * NUL-terminated copy the handler may modify; 'from' is its sender.
+ */
+typedef void (*ReactorCommandFn)(char* msg, size_t len, const struct sockaddr_in* from);
+
+/*
+ * Typedef: ReactorKeyFn
+ * ---------------------
+ * Writes the session key of a received command into 'key' (at most
+ * REACTOR_KEY_MAX - 1 characters plus the NUL).
+ */
+typedef void (*ReactorKeyFn)(const char* msg, size_t len, char* key);
+
+/*
+ * Typedef: ReactorWatchFn
+ * -----------------------
+ * Handles epoll 'events' on a watched descriptor, on the reactor thread.
+ */
+typedef void (*ReactorWatchFn)(int fd, uint32_t events, void* ctx);
+
+/*
+ * Struct: ReactorStats
+ * --------------------
+ * Counters since the reactor started.
+ */
+typedef struct {
+    long long received;
+    long long recv_calls;        // recvmmsg calls
+    long long dropped_commands;  // REACTOR_MAX_PENDING was reached
+    long long sent;
+    long long send_calls;        // sendmmsg calls
+    long long queued;            // Sends that had to wait for the socket
+    long long dropped_packets;   // A send queue was full, or sending failed
+} ReactorStats;
+
+/*
+ * Function: NetReactor_Start
+ * --------------------------
+ * Binds the UDP socket to 'port' and starts the reactor thread and
+ * REACTOR_WORKERS workers running 'handler'. 'key' finds each command's
+ * session key (NULL: the text before '|', or "" without one).
+ *
+ * returns: false if the socket, epoll or threads cannot be set up.
+ */
+bool NetReactor_Start(int port, ReactorCommandFn handler, ReactorKeyFn key);
+
+/*
+ * Function: NetReactor_Stop
+ * -------------------------
+ * Wakes the reactor through its eventfd, lets the workers finish the
+ * command they are running, drops the rest and closes everything.
+ */
+void NetReactor_Stop(void);
+
+/*
+ * Function: NetReactor_Submit
+ * ---------------------------
+ * Queues a command that arrived another way (e.g. a shared-memory ring)
+ * exactly like a received datagram. 'from' is NULL for commands that
+ * did not come from a UDP peer; the handler then sees an address whose
+ * sin_family is AF_UNSPEC.
+ */
+void NetReactor_Submit(const char* data, size_t len, const struct sockaddr_in* from);
+
+/*
+ * Function: NetReactor_Watch
+ * --------------------------
+ * Adds a descriptor to the loop, or changes the epoll 'events' (e.g.
+ * EPOLLIN | EPOLLOUT) it is watched for. Level-triggered. A NULL
+ * 'fn' keeps the callback and context of a watched descriptor.
+ *
+ * returns: false if the reactor is not running or REACTOR_MAX_WATCHES
+ *          descriptors are watched already.
+ */
+bool NetReactor_Watch(int fd, uint32_t events, ReactorWatchFn fn, void* ctx);
+
+/*
+ * Function: NetReactor_Unwatch
+ * ----------------------------
+ * Removes a descriptor from the loop (before closing it).
+ */
+void NetReactor_Unwatch(int fd);
+
+/*
+ * Function: NetReactor_AddDestination
+ * -----------------------------------
+ * Registers a destination with its own send queue.
+ *
+ * returns: Its handle, or -1 if the address is invalid or the table is full.
+ */
+int NetReactor_AddDestination(const char* ip, int port);
+
+/*
+ * Function: NetReactor_IsLoopback
+ * -------------------------------
+ * true if the destination is on this machine (127.0.0.0/8).
+ */
+bool NetReactor_IsLoopback(int destination);
+
+/*
+ * Function: NetReactor_Send
+ * -------------------------
+ * Sends one datagram to a destination without blocking.
+ */
+void NetReactor_Send(int destination, const void* data, size_t len);
+
+/*
+ * Function: NetReactor_BeginBatch
+ * -------------------------------
+ * Holds this thread's following sends until the matching
+ * NetReactor_EndBatch (pairs nest), so they cost as few syscalls as
+ * possible. Order is kept.
+ */
+void NetReactor_BeginBatch(void);
+
+/*
+ * Function: NetReactor_EndBatch
+ * -----------------------------
+ * Sends everything held since the outermost NetReactor_BeginBatch.
+ */
+void NetReactor_EndBatch(void);
+
+/*
+ * Function: NetReactor_GetStats
+ * -----------------------------
+ * Copies the counters.
+ */
+void NetReactor_GetStats(ReactorStats* stats);
+
+#endif
@@ -0,0 +1,223 @@
+/*
+ * File: net_session.h
+ * Version: 1.5.0
+ * Description:
+ * Per-client session table.
+ *
+ * Every command arrives as "UID|command"; the UID names a browser
+ * session behind the Node bridge. A Session holds what the engine
+ * remembers about that client and is the destination of every reply,
+ * passed explicitly down to the send functions (net_udp.h). The session
+ * with an empty UID is the broadcast session: packets sent to it reach
+ * every client, and its settings are the defaults for the others.
+ *
+ * Sessions are created on first use. When the table is full, the one
+ * idle for longest is recycled (a client that comes back just starts
+ * from the defaults again, e.g. with a full netlist snapshot). If every
+ * slot is held, the new client is refused rather than served through
+ * the broadcast session.
+ *
+ * Clients choose the broadcast topics they receive ("subscribe"). The
+ * union over all clients, Session_Demand, tells the publisher which
+ * topics are worth computing at all.
+ *
+ * Clients also choose how often they receive broadcasts ("rate"): the
+ * broadcast session's rates are the defaults, a client session may set
+ * its own. The publisher runs at the fastest of them (Session_FastestRates)
+ * and each destination is held to its own.
+ *
+ * A session's fields are guarded by its 'lock'; the table itself is
+ * thread-safe.
+ */
+
+#ifndef NET_SESSION_H
+#define NET_SESSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define SESSION_MAX      64
+#define SESSION_UID_MAX  64
+#define SESSION_EQ_MAX   256
+#define SESSION_CHANNELS 4   // X, Y, Z, W
+
+/*
+ * Enum: SessionTopic
+ * ------------------
+ * Broadcast topics, bits of Session.subscriptions.
+ */
+typedef enum {
+    TOPIC_STATE    = 1u << 0,  // State packet: mode, inputs, equations, valid flags
+    TOPIC_OUTPUTS  = 1u << 1,  // { "type": "outputs" }: input and output masks on the pins
+    TOPIC_RESULT_X = 1u << 2,  // Per-channel SOP/POS results
+    TOPIC_RESULT_Y = 1u << 3,
+    TOPIC_RESULT_Z = 1u << 4,
+    TOPIC_RESULT_W = 1u << 5,
+    TOPIC_NETLIST  = 1u << 6,  // Per-channel netlists
+    TOPIC_COMBINED = 1u << 7,  // Combined view: all minterms and the combined netlist
+    TOPIC_VERIFY   = 1u << 8,  // Verification summaries of every session
+    TOPIC_METRICS  = 1u << 9   // Engine counters, once a second
+} SessionTopic;
+
+#define TOPIC_RESULTS  (TOPIC_RESULT_X | TOPIC_RESULT_Y | TOPIC_RESULT_Z | TOPIC_RESULT_W)
+#define TOPIC_ALL      0x3FFu
+#define TOPIC_CLASS_STATE (TOPIC_STATE | TOPIC_OUTPUTS)                    // Limited by state_hz
+#define TOPIC_CLASS_HEAVY (TOPIC_RESULTS | TOPIC_NETLIST | TOPIC_COMBINED)  // Limited by heavy_hz
+#define SESSION_TOPICS_DEFAULT (TOPIC_STATE | TOPIC_RESULTS | TOPIC_NETLIST | TOPIC_COMBINED)  // What the browser UI shows
+
+/*
+ * Enum: NetlistFormat
+ * -------------------
+ * Encoding negotiated with the "netfmt" command.
+ */
+typedef enum {
+    NETFMT_JSON = 0,
+    NETFMT_BINARY = 1
+} NetlistFormat;
+
+/*
+ * Struct: Session
+ * ---------------
+ * uid:           Client ID; "" for the broadcast session. Fixed while
+ *                the session is held.
+ * authenticated: Passed "login".
+ * format:        Netlist encoding from "netfmt" (valid when has_format;
+ *                otherwise the broadcast session's).
+ * acked_version: Last netlist version the client confirmed with "ack"
+ *                (valid when has_ack); combined updates are sent to it
+ *                as a delta against this version. For the broadcast
+ *                session: the version last broadcast.
+ * binary_replies: Chose binary reply frames (net_proto.h) with "proto".
+ * subscriptions: Bit mask of the broadcast topics the client receives
+ *                (SessionTopic).
+ * compress_min:  Packets of at least this many bytes are sent LZ4
+ *                compressed ("compress"); 0 = never.
+ * state_hz, heavy_hz: Maximum broadcast rates of the two classes
+ *                (TOPIC_CLASS_*) from "rate"; 0 = the broadcast session's.
+ * preview:       Scratch equations from "preview" per channel (X..W;
+ *                "" = show the programmed one).
+ */
+typedef struct {
+    char uid[SESSION_UID_MAX];
+    pthread_mutex_t lock;
+    bool authenticated;
+    NetlistFormat format;
+    bool has_format;
+    uint32_t acked_version;
+    bool has_ack;
+    bool binary_replies;
+    uint32_t subscriptions;
+    uint32_t compress_min;
+    int state_hz;
+    int heavy_hz;
+    char preview[SESSION_CHANNELS][SESSION_EQ_MAX];
+
+    // Table bookkeeping
+    int refs;              // Holders; a held session is never recycled
+    long long last_used_ms;
+} Session;
+
+/*
+ * Function: Session_Acquire
+ * -------------------------
+ * Finds or creates the session for 'uid' and holds it until
+ * Session_Release. An empty or NULL uid gives the broadcast session.
+ *
+ * returns: NULL if every slot is held; the caller refuses the client.
+ */
+Session* Session_Acquire(const char* uid);
+
+/*
+ * Function: Session_Release
+ * -------------------------
+ * Drops a hold taken by Session_Acquire.
+ */
+void Session_Release(Session* s);
+
+/*
+ * Function: Session_Broadcast
+ * ---------------------------
+ * The broadcast session (always valid, no hold needed).
+ */
+Session* Session_Broadcast(void);
+
+/*
+ * Function: Session_IsBroadcast
+ * -----------------------------
+ * true for the broadcast session.
+ */
+bool Session_IsBroadcast(const Session* s);
+
+/*
+ * Function: Session_SetPreview
+ * ----------------------------
+ * Stores a scratch equation for channel 0 (X) .. 3 (W); "" clears it.
+ */
+void Session_SetPreview(Session* s, int channel, const char* expression);
+
+/*
+ * Function: Session_ClearPreviews
+ * -------------------------------
+ * Drops all of the session's scratch equations.
+ */
+void Session_ClearPreviews(Session* s);
+
+/*
+ * Function: Session_Subscribe
+ * ---------------------------
+ * Adds ('on') or removes the topics in 'topics'.
+ *
+ * returns: The session's new subscriptions.
+ */
+uint32_t Session_Subscribe(Session* s, uint32_t topics, bool on);
+
+/*
+ * Function: Session_SetRates
+ * --------------------------
+ * Sets the session's maximum broadcast rates in Hz (0 = follow the
+ * broadcast session's). On the broadcast session: the defaults.
+ */
+void Session_SetRates(Session* s, int state_hz, int heavy_hz);
+
+/*
+ * Function: Session_GetRates
+ * --------------------------
+ * The broadcast rates that apply to 's'.
+ *
+ * returns: true if they are the session's own, false if the defaults.
+ */
+bool Session_GetRates(Session* s, int* state_hz, int* heavy_hz);
+
+/*
+ * Function: Session_FastestRates
+ * ------------------------------
+ * The highest rates any client session subscribed to a topic receives
+ * broadcasts at; with none, the defaults.
+ */
+void Session_FastestRates(int* state_hz, int* heavy_hz);
+
+/*
+ * Function: Session_ResultTopic
+ * -----------------------------
+ * The TOPIC_RESULT_* bit of a channel label ("X".."W", either case);
+ * other labels (e.g. "preview") count as every channel.
+ */
+uint32_t Session_ResultTopic(const char* label);
+
+/*
+ * Function: Session_Demand
+ * ------------------------
+ * Topics at least one client subscribes to. With no client sessions yet,
+ * the broadcast session's subscriptions (plain UDP listeners).
+ */
+uint32_t Session_Demand(void);
+
+/*
+ * Function: Session_Count
+ * -----------------------
+ * Number of client sessions in the table (the broadcast one excluded).
+ */
+int Session_Count(void);
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * File: net_shm.h
+ * Version: 1.1.0
+ * Description:
+ * Shared-memory ring buffers for a bridge on the same host.
+ *
+ * A ring is a POSIX shared-memory object (/dev/shm/<name>) holding a
+ * small header and a circular data area. Messages are written as a
+ * little-endian uint32 length plus the bytes, padded to 4 bytes; a
+ * message that would run past the end leaves a SHM_RING_PAD marker and
+ * starts over at offset 0, so every message is contiguous and the
+ * consumer can use it in place.
+ *
+ * Layout (offsets in bytes, integers little-endian):
+ *   0    magic "LSRB", uint32 capacity (power of two)
+ *   64   uint64 head    - consumer position (bytes ever consumed)
+ *   128  uint64 tail    - producer position (bytes ever written)
+ *   192  uint32 waiting - 1 while the consumer sleeps
+ *   256  data[capacity]
+ *
+ * The consumer sets 'waiting' before it sleeps and checks 'tail' once
+ * more. A producer that finds 'waiting' set clears it and rings the
+ * doorbell: one SHM_DOORBELL byte sent as a datagram on the socket the
+ * consumer already listens on. A busy consumer gets no doorbells.
+ *
+ * One ring carries one direction. Writes are thread-safe (producers
+ * take the ring's lock); only one thread may drain a ring at a time.
+ *
+ * Note: Version 1.1.0 checks every length word against the ring before
+ * using it. A ring whose producer wrote something impossible is marked
+ * broken and never drained again.
+ */
+
+#ifndef NET_SHM_H
+#define NET_SHM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define SHM_RING_MAGIC     "LSRB"
+#define SHM_RING_DATA      256         // Offset of the data area
+#define SHM_RING_BYTES     (4 << 20)   // Default capacity
+#define SHM_RING_PAD       0xFFFFFFFFu // Length marking the skipped end of the area
+#define SHM_DOORBELL       0xD0        // The doorbell datagram's only byte
+
+/*
+ * Struct: ShmRing
+ * ---------------
+ * A mapped ring. 'base' is NULL when the ring is not open.
+ */
+typedef struct {
+    char name[64];
+    char* base;
+    size_t capacity;
+    pthread_mutex_t lock;  // Producers
+    bool broken;           // Set by the consumer on a malformed message
+} ShmRing;
+
+/*
+ * Typedef: ShmMessageFn
+ * ---------------------
+ * Receives one message while a ring is drained. 'data' points into the
+ * ring and is only valid during the call.
+ */
+typedef void (*ShmMessageFn)(const char* data, size_t len, void* ctx);
+
+/*
+ * Function: ShmRing_Create
+ * ------------------------
+ * Creates (or replaces) the shared-memory object 'name' (e.g.
+ * "/logic_sim_out") with an empty ring of 'capacity' bytes, a power of
+ * two. Replacing unlinks the old object, so peers that still map it can
+ * tell by its inode that they must reopen.
+ *
+ * returns: false with a message in 'error' if it cannot be set up.
+ */
+bool ShmRing_Create(ShmRing* ring, const char* name, size_t capacity, const char** error);
+
+/*
+ * Function: ShmRing_Destroy
+ * -------------------------
+ * Unmaps the ring and removes its shared-memory object.
+ */
+void ShmRing_Destroy(ShmRing* ring);
+
+/*
+ * Function: ShmRing_Write
+ * -----------------------
+ * Appends one message.
+ *
+ * doorbell: Set to true if the consumer was asleep; the caller must
+ *           then send it a SHM_DOORBELL datagram.
+ * returns:  false if the message does not fit in the free space.
+ */
+bool ShmRing_Write(ShmRing* ring, const void* data, size_t len, bool* doorbell);
+
+/*
+ * Function: ShmRing_Drain
+ * -----------------------
+ * Passes every waiting message to 'fn', then marks the consumer asleep
+ * (unless messages arrived meanwhile, which are drained too). The ring
+ * is shared with another process, so a length or position that does
+ * not fit between head and tail, or runs past the end of the data area,
+ * stops the drain and marks the ring broken.
+ *
+ * returns: The number of messages handled, or -1 if the ring is broken.
+ */
+int ShmRing_Drain(ShmRing* ring, ShmMessageFn fn, void* ctx);
+
+#endif
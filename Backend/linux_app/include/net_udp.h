@@ -6,6 +6,10 @@
  * Handles broadcasting state updates to listeners and sending
  * specific data payloads like netlists or analysis results.
  *
+ * Every send takes the Session (net_session.h) the packet is for; its
+ * UID is spliced into the packet so the bridge can route it. Packets
+ * for Session_Broadcast() go to every client.
+ *
  * Note: Version 1.1.0 will expand this to include hardware-in-the-loop
  * communication protocols.
  */
@@ -13,21 +17,77 @@
 #ifndef NET_UDP_H
 #define NET_UDP_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "logic_ast.h"
+#include "utils_buffer.h"
+#include "net_session.h"
+
+/*
+ * Constant: NET_BINARY_ENVELOPE
+ * -----------------------------
+ * First byte of a binary datagram. JSON packets always start with '{',
+ * so the bridge can tell the two apart from the first byte alone.
+ *
+ * Envelope layout (integers are LEB128 varints):
+ *   0xB1, uid_length, uid bytes, header_length, header JSON, netlist bytes
+ * The header is the packet's JSON object without its "elements" key; the
+ * trailing bytes are a binary netlist (see logic_netlist.h).
+ */
+#define NET_BINARY_ENVELOPE 0xB1
+
+/*
+ * Constant: NET_CHUNK_MAGIC
+ * -------------------------
+ * First byte of one chunk of a packet too large for a single datagram
+ * (a big netlist, a long report). The bridge reassembles the chunks into
+ * the original packet (JSON or binary envelope) and handles that.
+ *
+ * Chunk layout (integers are LEB128 varints):
+ *   0xC4, message_id, chunk_index, chunk_count, payload bytes
+ * Chunks carry NET_CHUNK_LOCAL bytes of payload to a bridge on this
+ * machine and NET_CHUNK_REMOTE bytes (below a typical path MTU) to one
+ * elsewhere. Over a remote link the bridge can ask for missing chunks
+ * with "nack <message_id> <i,j,...>"; the last NET_CHUNK_CACHE messages
+ * are kept for that.
+ */
+#define NET_CHUNK_MAGIC  0xC4
+#define NET_CHUNK_LOCAL  60000
+#define NET_CHUNK_REMOTE 1200
+#define NET_CHUNK_CACHE  32
+#define NET_CHUNK_CACHE_BYTES (4 << 20)
+
+/*
+ * Constant: NET_COMPRESSED_MAGIC
+ * ------------------------------
+ * First byte of a compressed packet, sent to sessions that asked for
+ * it with "compress lz4" once a packet reaches their threshold
+ * (NET_COMPRESS_MIN by default). Decompressing gives the original
+ * packet (JSON or binary envelope), UID included. Compression comes
+ * before chunking: a large compressed packet is sent in chunks like
+ * any other.
+ *
+ * Layout: 0xC5, original_length (LEB128 varint), LZ4 block (utils_lz4.h)
+ * Packets that do not shrink are sent as they are.
+ */
+#define NET_COMPRESSED_MAGIC   0xC5
+#define NET_COMPRESS_MIN       1024
+#define NET_COMPRESS_MIN_FLOOR 64    // Smaller packets never pay for the header
 
 /*
  * Function: NetUDP_Init
  * ---------------------
- * Initializes the UDP socket, sets up broadcast permissions, and
- * binds to the configured port. Must be called at startup.
+ * Binds the configured port and starts the network reactor
+ * (net_reactor.h), which runs commands on its worker threads.
+ * Must be called at startup.
  */
 void NetUDP_Init(void);
 
 /*
  * Function: NetUDP_Cleanup
  * ------------------------
- * Closes the socket and releases networking resources.
- * Should be called during the application shutdown sequence.
+ * Stops the reactor, waits for commands still running, and closes the
+ * socket. Should be called during the application shutdown sequence.
  */
 void NetUDP_Cleanup(void);
 
@@ -39,29 +99,83 @@ void NetUDP_Cleanup(void);
  */
 void NetUDP_BroadcastState(void);
 
+/*
+ * Function: NetUDP_BroadcastOutputs
+ * ---------------------------------
+ * Sends { "type": "outputs", "inputs": <mask>, "outputs": <mask> } to all
+ * clients (bit 0 = X ... bit 3 = W for the outputs).
+ */
+void NetUDP_BroadcastOutputs(uint32_t inputs, uint32_t outputs);
+
+/*
+ * Function: NetUDP_BroadcastMetrics
+ * ---------------------------------
+ * Sends the "netstats" counters as a { "type": "metrics" } packet to all
+ * clients.
+ */
+void NetUDP_BroadcastMetrics(void);
+
 /*
  * Function: NetUDP_SendLogicResult
  * --------------------------------
- * Transmits the results of the logic minimization process to a specific target.
+ * Transmits the results of the logic minimization process to a session.
  *
- * target:   IP address or hostname of the recipient.
+ * target:   Channel or label the result is for.
  * sop:      The Sum-of-Products equation string.
  * pos:      The Product-of-Sums equation string.
  * minterms: Array of minterm integers.
  * count:    Number of items in the minterms array.
  * mode:     The current operational mode identifier.
  */
-void NetUDP_SendLogicResult(const char* target, const char* sop, const char* pos, const int* minterms, int count, const char* mode);
+void NetUDP_SendLogicResult(Session* session, const char* target, const char* sop, const char* pos, const int* minterms, int count, const char* mode);
 
 /*
  * Function: NetUDP_SendNetlist
  * ----------------------------
- * Transmits the circuit topology (JSON Netlist) to a specific target.
+ * Transmits the circuit topology (JSON Netlist) to a session.
  *
- * target:    IP address or hostname of the recipient.
+ * target:    Channel or label the netlist is for.
  * json_data: The complete JSON string describing the circuit.
  */
-void NetUDP_SendNetlist(const char* target, const char* json_data);
+void NetUDP_SendNetlist(Session* session, const char* target, const char* json_data);
+
+/*
+ * Function: NetUDP_GetNetlistFormat
+ * ---------------------------------
+ * Returns the netlist encoding for a session: its own choice if it
+ * negotiated one, otherwise the broadcast default. JSON unless a client
+ * asked for binary.
+ */
+NetlistFormat NetUDP_GetNetlistFormat(Session* session);
+
+/*
+ * Function: NetUDP_GetBaseVersion
+ * -------------------------------
+ * Finds the netlist version a session already holds: the version it
+ * last acknowledged, or for the broadcast session the version last
+ * broadcast.
+ *
+ * returns: false if unknown (the client needs a full snapshot).
+ */
+bool NetUDP_GetBaseVersion(Session* session, uint32_t* version);
+
+/*
+ * Function: NetUDP_NoteSentVersion
+ * --------------------------------
+ * Records that a netlist version went out. Only broadcasts are tracked
+ * here; sessions confirm their version with the "ack" command.
+ */
+void NetUDP_NoteSentVersion(Session* session, uint32_t version);
+
+/*
+ * Function: NetUDP_SendBinaryNetlist
+ * ----------------------------------
+ * Sends a JSON header plus a binary netlist in one binary envelope.
+ *
+ * header_json: JSON object describing the packet (without "elements").
+ * netlist:     Binary netlist produced by Netlist_Generate*Binary.
+ */
+void NetUDP_SendBinaryNetlist(Session* session, const char* header_json, const DynBuf* netlist);
 
 /*
  * Function: NetUDP_SendRaw
@@ -70,7 +184,23 @@ void NetUDP_SendNetlist(const char* target, const char* json_data);
  *
  * json_data: The raw string payload to transmit.
  */
-void NetUDP_SendRaw(const char* json_data);
+void NetUDP_SendRaw(Session* session, const char* json_data);
+
+/*
+ * Function: NetUDP_BeginBatch
+ * ---------------------------
+ * Holds the calling thread's packets until NetUDP_EndBatch and sends
+ * them with as few syscalls as possible (see net_reactor.h). Commands
+ * are batched already; the main loop wraps each update cycle.
+ */
+void NetUDP_BeginBatch(void);
+
+/*
+ * Function: NetUDP_EndBatch
+ * -------------------------
+ * Sends the packets held since NetUDP_BeginBatch.
+ */
+void NetUDP_EndBatch(void);
 
 int NetUDP_ExitRequested(void);
 
@@ -0,0 +1,126 @@
+/*
+ * File: net_ws.h
+ * Version: 1.2.0
+ * Description:
+ * Minimal RFC 6455 WebSocket endpoint, so browsers can talk to the
+ * engine without the Node bridge in between.
+ *
+ * The listener and its clients are watched by the reactor's epoll loop
+ * (NetReactor_Watch); nothing here has a thread of its own. Each client
+ * gets its own session, UID "ws:<n>" (':' never occurs in bridge
+ * socket IDs). Its messages are the same as on UDP, without a UID:
+ * - a text message is one command ("set_input 5"),
+ * - a binary message is one command frame (net_proto.h); its UID is
+ *   replaced by the client's.
+ * Both are queued to the reactor's workers like datagrams.
+ *
+ * Every packet for the session, and every broadcast whose topic the
+ * session subscribes to, goes out as one message: JSON as text, binary
+ * envelopes and reply frames as binary. There is no datagram size
+ * limit, so nothing is chunked. No extensions are negotiated.
+ *
+ * Broadcasts are held to the session's rates ("rate"): a state or
+ * outputs packet that comes too soon waits for the client's next slot
+ * and is replaced by a newer one; results, netlists and combined
+ * updates wait in order. NetWs_Poll sends them when they are due.
+ *
+ * Sends never block: what the socket does not take waits in the
+ * client's backlog (at most WS_MAX_BACKLOG; messages beyond it are
+ * dropped) and is flushed when the socket is writable.
+ *
+ * A browser's handshake names the page's site (Origin). Only sites in
+ * the allowlist given to NetWs_Start get a connection; others get a 403,
+ * so a page from elsewhere cannot drive the engine through a visitor's
+ * browser.
+ *
+ * All functions are thread-safe.
+ */
+
+#ifndef NET_WS_H
+#define NET_WS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils_buffer.h"
+
+#define WS_DEFAULT_PORT   8090
+#define WS_MAX_CLIENTS    16
+#define WS_MAX_MESSAGE    (64 << 10)   // Largest client message (one command)
+#define WS_MAX_BACKLOG    (4 << 20)    // Unsent bytes per client
+#define WS_MAX_HANDSHAKE  4096
+#define WS_UID_PREFIX     "ws:"
+#define WS_MAX_ORIGINS    512          // Bytes of the Origin allowlist
+
+/*
+ * Function: NetWs_Start
+ * ---------------------
+ * Listens on TCP 'port' (the reactor must be running). Starting again
+ * closes the old listener and its clients first.
+ *
+ * address: IPv4 address to listen on; NULL or "" for every interface.
+ * origins: Comma-separated Origin allowlist. An entry with "://"
+ *          ("http://10.0.0.5:8088") must match the whole Origin, any
+ *          other entry ("10.0.0.5", "localhost") its host; "*" allows
+ *          every site. Handshakes without Origin (not from a browser)
+ *          are always accepted.
+ * returns: false if the address or allowlist is invalid or the port
+ *          cannot be bound.
+ */
+bool NetWs_Start(const char* address, int port, const char* origins);
+
+/*
+ * Function: NetWs_Stop
+ * --------------------
+ * Closes the listener and every client.
+ */
+void NetWs_Stop(void);
+
+/*
+ * Function: NetWs_IsClient
+ * ------------------------
+ * true if 'uid' names a WebSocket client's session.
+ */
+bool NetWs_IsClient(const char* uid);
+
+/*
+ * Function: NetWs_Send
+ * --------------------
+ * Sends one message to the client with session 'uid' (dropped if it is
+ * gone).
+ */
+void NetWs_Send(const char* uid, const void* data, size_t len);
+
+/*
+ * Function: NetWs_Broadcast
+ * -------------------------
+ * Sends one message to every client whose session subscribes to one of
+ * 'topics' (SessionTopic bits; 0 = every client), except the one with
+ * session 'except_uid' (NULL for none).
+ */
+void NetWs_Broadcast(const void* data, size_t len, uint32_t topics, const char* except_uid);
+
+/*
+ * Function: NetWs_Poll
+ * --------------------
+ * Sends the held broadcasts whose client's slot has come (main loop).
+ */
+void NetWs_Poll(void);
+
+/*
+ * Function: NetWs_NextDue
+ * -----------------------
+ * returns: When (Timer_GetMillis) the earliest held broadcast is due,
+ *          or -1 if none is held.
+ */
+long long NetWs_NextDue(void);
+
+/*
+ * Function: NetWs_WriteReport
+ * ---------------------------
+ * Appends { "type": "websocket", "port", "address", "origins",
+ * "clients", counters } to 'out'.
+ */
+void NetWs_WriteReport(DynBuf* out);
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * File: utils_buffer.h
+ * Version: 1.1.0
+ * Description:
+ * A growable byte buffer with helpers for writing JSON text.
+ * Every serializer in the engine (state, results, netlists) writes into
+ * a DynBuf instead of formatting into fixed-size stack arrays, so a packet
+ * can never be silently truncated into invalid JSON.
+ *
+ * If an allocation ever fails, the buffer latches the 'failed' flag and
+ * ignores further writes. Callers check DynBuf_Ok() once before sending.
+ */
+
+#ifndef UTILS_BUFFER_H
+#define UTILS_BUFFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Struct: DynBuf
+ * --------------
+ * data:   Heap storage. Always NUL-terminated after any successful write.
+ * len:    Number of bytes written (excluding the terminator).
+ * cap:    Allocated capacity of 'data'.
+ * failed: Latched to true when a reallocation fails.
+ */
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} DynBuf;
+
+/*
+ * Function: DynBuf_Init
+ * ---------------------
+ * Prepares an empty buffer. No memory is allocated until the first write.
+ */
+void DynBuf_Init(DynBuf* b);
+
+/*
+ * Function: DynBuf_Free
+ * ---------------------
+ * Releases the storage and returns the buffer to the empty state.
+ */
+void DynBuf_Free(DynBuf* b);
+
+/*
+ * Function: DynBuf_Reset
+ * ----------------------
+ * Empties the buffer but keeps the allocation for reuse.
+ */
+void DynBuf_Reset(DynBuf* b);
+
+/*
+ * Function: DynBuf_Reserve
+ * ------------------------
+ * Ensures room for at least 'extra' more bytes plus the terminator.
+ *
+ * returns: false if the buffer has failed or could not grow.
+ */
+bool DynBuf_Reserve(DynBuf* b, size_t extra);
+
+/*
+ * Function: DynBuf_Ok
+ * -------------------
+ * returns: true if every write so far has succeeded.
+ */
+bool DynBuf_Ok(const DynBuf* b);
+
+// --- Raw Writers ---
+void DynBuf_Append(DynBuf* b, const void* data, size_t n);
+void DynBuf_AppendStr(DynBuf* b, const char* str);
+void DynBuf_AppendChar(DynBuf* b, char c);
+
+/*
+ * Function: DynBuf_AppendInt / DynBuf_AppendUInt
+ * ----------------------------------------------
+ * Writes a decimal integer without going through printf.
+ */
+void DynBuf_AppendInt(DynBuf* b, long long value);
+void DynBuf_AppendUInt(DynBuf* b, unsigned long long value);
+
+/*
+ * Function: DynBuf_TrimChar
+ * -------------------------
+ * Removes the last byte if it equals 'c'. Used to drop trailing commas
+ * after emitting a list element-by-element.
+ */
+void DynBuf_TrimChar(DynBuf* b, char c);
+
+/*
+ * Function: DynBuf_AppendVarint
+ * -----------------------------
+ * Writes an unsigned LEB128 varint (7 bits per byte, high bit = more).
+ * Used by the binary wire formats; values below 128 take one byte.
+ */
+void DynBuf_AppendVarint(DynBuf* b, unsigned long long value);
+
+// --- JSON Writers ---
+
+/*
+ * Function: DynBuf_AppendJsonString
+ * ---------------------------------
+ * Writes 'str' as a quoted JSON string literal, escaping quotes,
+ * backslashes and control characters. NULL is written as "".
+ */
+void DynBuf_AppendJsonString(DynBuf* b, const char* str);
+
+/*
+ * Function: DynBuf_AppendJsonBool
+ * -------------------------------
+ * Writes the literal true or false.
+ */
+void DynBuf_AppendJsonBool(DynBuf* b, bool value);
+
+/*
+ * Function: DynBuf_AppendJsonIntArray
+ * -----------------------------------
+ * Writes a JSON array of integers, e.g. [1,5,7].
+ */
+void DynBuf_AppendJsonIntArray(DynBuf* b, const int* values, int count);
+
+#endif
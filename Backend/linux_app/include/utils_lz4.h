@@ -0,0 +1,67 @@
+/*
+ * File: utils_lz4.h
+ * Version: 1.0.0
+ * Description:
+ * Dependency-free compressor and decompressor for the LZ4 block format,
+ * used to shrink large, repetitive packets (netlists, verify reports).
+ *
+ * The output is a plain LZ4 block: sequences of a token (literal length
+ * << 4 | match length - 4), extra literal length bytes, the literals, a
+ * 2-byte little-endian match offset and extra match length bytes; the
+ * last sequence has literals only. Any LZ4 block decoder reads it, and
+ * Lz4_Decompress reads any valid block. The block does not store the
+ * original size; the packet carrying it does.
+ *
+ * The compressor is the greedy single-probe kind (one hash table of
+ * recent 4-byte sequences): fast rather than tight, which suits packets
+ * that are compressed once and sent right away.
+ */
+
+#ifndef UTILS_LZ4_H
+#define UTILS_LZ4_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils_buffer.h"
+
+#define LZ4_HASH_LOG  12  // 4096 table entries (16 KB per context)
+
+/*
+ * Struct: Lz4Context
+ * ------------------
+ * The compressor's hash table. Keep one per thread and reuse it: it is
+ * too big for the stack of every send, and reusing it costs nothing.
+ */
+typedef struct {
+    uint32_t table[1 << LZ4_HASH_LOG];
+} Lz4Context;
+
+/*
+ * Function: Lz4_Bound
+ * -------------------
+ * Largest block 'len' input bytes can compress to (incompressible data
+ * grows slightly).
+ */
+size_t Lz4_Bound(size_t len);
+
+/*
+ * Function: Lz4_Compress
+ * ----------------------
+ * Appends the LZ4 block of 'len' bytes to 'out'.
+ *
+ * returns: false if 'out' could not grow (it is then marked failed).
+ */
+bool Lz4_Compress(Lz4Context* ctx, const void* src, size_t len, DynBuf* out);
+
+/*
+ * Function: Lz4_Decompress
+ * ------------------------
+ * Decodes a block that expands to exactly 'dst_len' bytes into 'dst'.
+ * Never reads or writes out of bounds, whatever the input.
+ *
+ * returns: false if the block is malformed or its size is not 'dst_len'.
+ */
+bool Lz4_Decompress(const void* src, size_t len, void* dst, size_t dst_len);
+
+#endif
@@ -1,6 +1,6 @@
 /*
  * File: utils_timer.h
- * Version: 1.0.0
+ * Version: 1.1.0
  * Description:
  * Provides high-resolution timing utilities for benchmarking and sequencing.
  * Essential for the verification suite where precise millisecond-level
@@ -29,6 +29,17 @@ void Timer_Init(void);
  */
 long long Timer_GetMillis(void);
 
+/*
+ * Function: Timer_GetNanos
+ * ------------------------
+ * Reads the monotonic clock with nanosecond resolution.
+ * Intended for benchmarks and throughput counters, where the millisecond
+ * wall-clock is far too coarse.
+ *
+ * Returns an arbitrary-origin timestamp in nanoseconds.
+ */
+long long Timer_GetNanos(void);
+
 /*
  * Function: Timer_SleepMs
  * -----------------------
@@ -0,0 +1,139 @@
+/*
+ * File: utils_trace.h
+ * Version: 1.0.0
+ * Description:
+ * Streaming waveform writer for one-bit signals.
+ *
+ * Only value changes are written (each sample is XORed with the last
+ * one), into a buffer that is handed to a file or to a sink callback
+ * whenever it passes 'chunk' bytes, so a capture of any length costs a
+ * fixed amount of memory. Two formats:
+ *
+ * - TRACE_VCD: IEEE 1364 Value Change Dump text, readable by GTKWave and
+ *   other waveform viewers. "#<time>" lines are only written for times
+ *   at which something changed.
+ * - TRACE_BINARY: compact form for very long captures. Header: magic
+ *   "LSWT", uint8 version (1), int8 timescale exponent (-9 = ns), uint8
+ *   signal count, then each signal name NUL-terminated. Then one LEB128
+ *   varint per change: (time delta << 7) | (signal << 1) | value, the
+ *   delta counted from the previous change. Simultaneous changes take
+ *   one byte each; the first change's delta is from time 0.
+ *
+ * The first sample writes every signal (the VCD $dumpvars block).
+ * Samples must not go back in time; earlier times are taken as the last.
+ */
+
+#ifndef UTILS_TRACE_H
+#define UTILS_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "utils_buffer.h"
+
+#define TRACE_MAX_SIGNALS  64
+#define TRACE_NAME_MAX     16
+#define TRACE_FILE_CHUNK   65536  // Bytes buffered before a file write
+
+typedef enum {
+    TRACE_VCD,
+    TRACE_BINARY
+} TraceFormat;
+
+/*
+ * Typedef: TraceSink
+ * ------------------
+ * Receives the next 'len' bytes of a trace.
+ */
+typedef void (*TraceSink)(const char* data, size_t len, void* ctx);
+
+/*
+ * Struct: TraceWriter
+ * -------------------
+ * values:  Last written value of every signal (bit i = signal i).
+ * started: Header and initial values are out.
+ * changes: Value changes written so far.
+ * bytes:   Bytes handed to the file or sink so far.
+ * failed:  A write or allocation failed; the trace is incomplete.
+ */
+typedef struct {
+    TraceFormat format;
+    int timescale;  // Power of ten of one time unit (seconds): -9 = ns, -3 = ms
+    char names[TRACE_MAX_SIGNALS][TRACE_NAME_MAX];
+    int signal_count;
+
+    FILE* file;
+    TraceSink sink;
+    void* ctx;
+    size_t chunk;
+    DynBuf buf;
+
+    uint64_t values;
+    uint64_t time;
+    bool started;
+    bool time_written;  // VCD: "#<time>" for 'time' is out
+    long long changes;
+    long long bytes;
+    bool failed;
+} TraceWriter;
+
+/*
+ * Function: TraceWriter_OpenFile
+ * ------------------------------
+ * Starts a trace written to 'path' (created or truncated).
+ *
+ * timescale: Power of ten of the time unit, -15 (fs) .. 0 (s).
+ *
+ * returns: false if the file cannot be created.
+ */
+bool TraceWriter_OpenFile(TraceWriter* w, TraceFormat format, int timescale, const char* path);
+
+/*
+ * Function: TraceWriter_OpenSink
+ * ------------------------------
+ * Starts a trace delivered to 'sink' in pieces of about 'chunk' bytes.
+ */
+void TraceWriter_OpenSink(TraceWriter* w, TraceFormat format, int timescale, size_t chunk,
+                          TraceSink sink, void* ctx);
+
+/*
+ * Function: TraceWriter_AddSignal
+ * -------------------------------
+ * Declares the next signal. Only before the first sample.
+ *
+ * returns: The signal index, or -1 if there is no room or it is too late.
+ */
+int TraceWriter_AddSignal(TraceWriter* w, const char* name);
+
+/*
+ * Function: TraceWriter_Sample
+ * ----------------------------
+ * Records the values of all signals at 'time' (bit i = signal i);
+ * only the ones that changed are written.
+ */
+void TraceWriter_Sample(TraceWriter* w, uint64_t time, uint64_t values);
+
+/*
+ * Function: TraceWriter_Change
+ * ----------------------------
+ * Records one signal's value at 'time', if it changed.
+ */
+void TraceWriter_Change(TraceWriter* w, uint64_t time, int signal, bool value);
+
+/*
+ * Function: TraceWriter_Flush
+ * ---------------------------
+ * Hands everything buffered to the file or sink.
+ */
+void TraceWriter_Flush(TraceWriter* w);
+
+/*
+ * Function: TraceWriter_Close
+ * ---------------------------
+ * Flushes, closes the file (if any) and releases the buffer.
+ *
+ * returns: false if any part of the trace was lost.
+ */
+bool TraceWriter_Close(TraceWriter* w);
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * File: app_capture.c
+ * Version: 1.1.2
+ * Description:
+ * Owns the waveform captures (see app_capture.h). Each source has its
+ * own writer and lock; 'open' is read without the lock first so the
+ * hooks stay cheap while nothing is captured.
+ *
+ * Note: Version 1.1.1 creates CAPTURE_DIR, checks a verify capture's
+ * file when it starts and reports runs that cannot open their trace.
+ */
+
+#include "app_capture.h"
+#include "net_udp.h"
+#include "utils_timer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+static const char* SOURCE_NAMES[CAPTURE_SOURCE_COUNT] = { "verify", "timing", "gpio" };
+static const char* LIVE_NAMES[CAPTURE_LIVE_INPUTS + 4] = { "A", "B", "C", "D", "E", "F", "X", "Y", "Z", "W" };
+
+/*
+ * Struct: Capture
+ * ---------------
+ * active: A capture was started (for CAPTURE_VERIFY, runs get traced).
+ * open:   'writer' holds an open trace.
+ * stream: The target is the network rather than 'path'.
+ * owner:  UID of the session stream packets go to.
+ * seq:    Stream packets sent for the current trace.
+ * epoch:  CAPTURE_GPIO: Timer_GetNanos() at the start.
+ */
+typedef struct {
+    volatile bool active;
+    volatile bool open;
+    bool stream;
+    char path[256];
+    char target[64];
+    char owner[SESSION_UID_MAX];
+    TraceFormat format;
+    TraceWriter writer;
+    int seq;
+    long long epoch;
+    pthread_mutex_t lock;
+} Capture;
+
+static Capture captures[CAPTURE_SOURCE_COUNT] = {
+    { .lock = PTHREAD_MUTEX_INITIALIZER },
+    { .lock = PTHREAD_MUTEX_INITIALIZER },
+    { .lock = PTHREAD_MUTEX_INITIALIZER },
+};
+
+bool Capture_SourceFromName(const char* name, CaptureSource* source) {
+    for (int i = 0; i < CAPTURE_SOURCE_COUNT; i++) {
+        if (strcmp(name, SOURCE_NAMES[i]) == 0) {
+            *source = (CaptureSource)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Function: stream_chunk
+ * ----------------------
+ * TraceSink of streamed captures: one "trace" packet per chunk, sent to
+ * the session that started the capture.
+ */
+static void stream_chunk(const char* data, size_t len, void* ctx) {
+    Capture* c = ctx;
+    DynBuf text;
+    DynBuf_Init(&text);
+    DynBuf_Append(&text, data, len);
+
+    DynBuf packet;
+    DynBuf_Init(&packet);
+    DynBuf_AppendStr(&packet, "{ \"type\": \"trace\", \"source\": ");
+    DynBuf_AppendJsonString(&packet, SOURCE_NAMES[c - captures]);
+    DynBuf_AppendStr(&packet, ", \"format\": \"vcd\", \"seq\": ");
+    DynBuf_AppendInt(&packet, c->seq++);
+    DynBuf_AppendStr(&packet, ", \"data\": ");
+    DynBuf_AppendJsonString(&packet, text.data);
+    DynBuf_AppendStr(&packet, " }");
+    if (DynBuf_Ok(&text) && DynBuf_Ok(&packet)) {
+        Session* owner = Session_Acquire(c->owner);
+        if (owner) NetUDP_SendRaw(owner, packet.data);  // No free session: the chunk is lost
+        Session_Release(owner);
+    }
+    DynBuf_Free(&packet);
+    DynBuf_Free(&text);
+}
+
+/*
+ * Function: open_writer
+ * ---------------------
+ * Opens the capture's trace. The caller holds the lock.
+ */
+static bool open_writer(Capture* c, int timescale) {
+    c->seq = 0;
+    if (c->stream) {
+        TraceWriter_OpenSink(&c->writer, TRACE_VCD, timescale, CAPTURE_STREAM_CHUNK, stream_chunk, c);
+    } else if (!TraceWriter_OpenFile(&c->writer, c->format, timescale, c->path)) {
+        TraceWriter_Close(&c->writer);
+        return false;
+    }
+    c->open = true;
+    return true;
+}
+
+/*
+ * Function: close_writer
+ * ----------------------
+ * Flushes and closes the capture's trace, optionally appending its
+ * totals to 'out'. The caller holds the lock.
+ */
+static void close_writer(Capture* c, DynBuf* out) {
+    if (!c->open) return;
+    c->open = false;
+    long long changes = c->writer.changes;
+    bool ok = TraceWriter_Close(&c->writer);
+    long long bytes = c->writer.bytes;
+    if (!out) return;
+
+    DynBuf_AppendStr(out, ", \"changes\": ");
+    DynBuf_AppendInt(out, changes);
+    DynBuf_AppendStr(out, ", \"bytes\": ");
+    DynBuf_AppendInt(out, bytes);
+    DynBuf_AppendStr(out, ", \"complete\": ");
+    DynBuf_AppendJsonBool(out, ok);
+}
+
+/*
+ * Function: prepare_file
+ * ----------------------
+ * Creates CAPTURE_DIR if needed and makes sure 'path' can be written,
+ * without truncating it (a verify capture only writes on its first run).
+ */
+static bool prepare_file(const char* path) {
+    if (mkdir(CAPTURE_DIR, 0755) != 0 && errno != EEXIST) return false;
+    FILE* f = fopen(path, "ab");
+    if (!f) return false;
+    fclose(f);
+    return true;
+}
+
+bool Capture_Start(CaptureSource source, const char* target, TraceFormat format, const char* owner,
+                   const char** error) {
+    Capture* c = &captures[source];
+    bool stream = strcmp(target, "udp") == 0;
+    if (stream && format != TRACE_VCD) {
+        *error = "Binary traces can only be written to files";
+        return false;
+    }
+    if (!stream && (target[0] == '\0' || target[0] == '.' || strchr(target, '/'))) {
+        *error = "Invalid file name";
+        return false;
+    }
+
+    pthread_mutex_lock(&c->lock);
+    close_writer(c, NULL);
+    c->active = false;
+    c->stream = stream;
+    c->format = format;
+    strncpy(c->target, target, sizeof(c->target) - 1);
+    c->target[sizeof(c->target) - 1] = '\0';
+    strncpy(c->owner, owner, sizeof(c->owner) - 1);
+    c->owner[sizeof(c->owner) - 1] = '\0';
+    snprintf(c->path, sizeof(c->path), "%s/%s", CAPTURE_DIR, target);
+
+    // Live sources trace continuously from now on; runs open their own
+    bool ok = stream || prepare_file(c->path);
+    if (ok && source != CAPTURE_VERIFY) {
+        ok = open_writer(c, -9);
+        for (int i = 0; ok && i < CAPTURE_LIVE_INPUTS + 4; i++) TraceWriter_AddSignal(&c->writer, LIVE_NAMES[i]);
+        c->epoch = Timer_GetNanos();
+    }
+    c->active = ok;
+    pthread_mutex_unlock(&c->lock);
+
+    if (!ok) *error = "Cannot create file";
+    return ok;
+}
+
+void Capture_Stop(CaptureSource source, DynBuf* out) {
+    Capture* c = &captures[source];
+    pthread_mutex_lock(&c->lock);
+    DynBuf_AppendStr(out, "{ \"type\": \"trace\", \"source\": ");
+    DynBuf_AppendJsonString(out, SOURCE_NAMES[source]);
+    DynBuf_AppendStr(out, ", \"status\": ");
+    DynBuf_AppendStr(out, c->active ? "\"stopped\", \"target\": " : "\"idle\"");
+    if (c->active) DynBuf_AppendJsonString(out, c->target);
+    close_writer(c, out);
+    DynBuf_AppendStr(out, " }");
+    c->active = false;
+    pthread_mutex_unlock(&c->lock);
+}
+
+TraceWriter* Capture_BeginRun(CaptureSource source, int timescale, const char** error) {
+    Capture* c = &captures[source];
+    if (!c->active) return NULL;
+    pthread_mutex_lock(&c->lock);
+    if (c->active && !c->open) {
+        if (open_writer(c, timescale)) return &c->writer;
+        *error = "Cannot create the capture's trace file";
+    }
+    pthread_mutex_unlock(&c->lock);
+    return NULL;
+}
+
+void Capture_EndRun(CaptureSource source) {
+    Capture* c = &captures[source];
+    close_writer(c, NULL);
+    pthread_mutex_unlock(&c->lock);
+}
+
+void Capture_Live(CaptureSource source, uint64_t time, uint32_t inputs, uint32_t outputs) {
+    Capture* c = &captures[source];
+    if (!c->open) return;
+    pthread_mutex_lock(&c->lock);
+    if (source == CAPTURE_GPIO) time = (uint64_t)(Timer_GetNanos() - c->epoch);
+    uint64_t values = (inputs & ((1u << CAPTURE_LIVE_INPUTS) - 1)) | ((uint64_t)(outputs & 0xF) << CAPTURE_LIVE_INPUTS);
+    if (c->open) TraceWriter_Sample(&c->writer, time, values);
+    pthread_mutex_unlock(&c->lock);
+}
+
+void Capture_LiveInputs(CaptureSource source, uint64_t time, uint32_t inputs) {
+    Capture* c = &captures[source];
+    if (!c->open) return;
+    pthread_mutex_lock(&c->lock);
+    if (c->open) {
+        uint64_t mask = (1u << CAPTURE_LIVE_INPUTS) - 1;
+        TraceWriter_Sample(&c->writer, time, (c->writer.values & ~mask) | (inputs & mask));
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+void Capture_LiveOutput(CaptureSource source, uint64_t time, int channel, bool value) {
+    Capture* c = &captures[source];
+    if (!c->open || channel < 0 || channel > 3) return;
+    pthread_mutex_lock(&c->lock);
+    if (c->open) TraceWriter_Change(&c->writer, time, CAPTURE_LIVE_INPUTS + channel, value);
+    pthread_mutex_unlock(&c->lock);
+}
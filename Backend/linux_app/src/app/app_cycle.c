@@ -0,0 +1,192 @@
+/*
+ * File: app_cycle.c
+ * Version: 1.0.1
+ * Description:
+ * Owns the clocked simulator of the four channels and encodes run
+ * traces (see app_cycle.h).
+ *
+ * Note: Version 1.0.1 clocks "run" on a private copy of the program so
+ * the mutex is only held for the copy and the state write-back.
+ */
+
+#include "app_cycle.h"
+#include "logic_parser.h"
+#include "logic_seq.h"
+#include "utils_colors.h"
+#include "utils_timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#define TRACE_RUN_MIN 5  // Shorter runs are cheaper written out digit by digit
+
+static SeqProgram prog;
+static SeqStatus prog_status = SEQ_ERR_MEMORY;
+static bool sequential = false;
+static bool compiled_once = false;
+static char equations[SEQ_CHANNELS][256];
+static uint64_t generation = 0;  // Bumped whenever the program or its state is replaced
+static pthread_mutex_t cycle_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void Cycle_Update(const char* x, const char* y, const char* z, const char* w) {
+    const char* next[SEQ_CHANNELS] = { x, y, z, w };
+
+    pthread_mutex_lock(&cycle_mutex);
+    bool changed = !compiled_once;
+    for (int i = 0; i < SEQ_CHANNELS; i++) {
+        if (strcmp(equations[i], next[i]) != 0) {
+            strncpy(equations[i], next[i], sizeof(equations[i]) - 1);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        if (prog_status == SEQ_OK) Seq_Free(&prog);
+
+        LogicNode* roots[SEQ_CHANNELS];
+        sequential = false;
+        for (int i = 0; i < SEQ_CHANNELS; i++) {
+            roots[i] = Parser_ParseString(equations[i]);
+            if (Seq_IsSequential(roots[i])) sequential = true;
+        }
+        prog_status = Seq_Compile(roots, &prog);
+        compiled_once = true;
+        generation++;
+        for (int i = 0; i < SEQ_CHANNELS; i++) AST_Free(roots[i]);
+
+        if (prog_status == SEQ_ERR_LOOP) {
+            printf(C_B_RED "[Cycle] Combinational loop: a channel depends on itself without a register" C_RESET "\n");
+        } else if (prog_status != SEQ_OK) {
+            printf(C_B_RED "[Cycle] Out of memory compiling circuit" C_RESET "\n");
+        } else if (sequential) {
+            printf("[Cycle] Sequential circuit: %d registers, %d gates\n", prog.reg_count, prog.gate_count);
+        }
+    }
+    pthread_mutex_unlock(&cycle_mutex);
+}
+
+bool Cycle_GetOutputs(uint8_t input_mask, uint32_t* outputs) {
+    bool ok;
+    pthread_mutex_lock(&cycle_mutex);
+    ok = sequential && prog_status == SEQ_OK;
+    if (ok) *outputs = Seq_Outputs(&prog, input_mask);
+    pthread_mutex_unlock(&cycle_mutex);
+    return ok;
+}
+
+void Cycle_Reset(void) {
+    pthread_mutex_lock(&cycle_mutex);
+    if (prog_status == SEQ_OK) Seq_Reset(&prog);
+    generation++;
+    pthread_mutex_unlock(&cycle_mutex);
+}
+
+// --- Trace Encoding ---
+
+/*
+ * Struct: TraceWriter
+ * -------------------
+ * Run-length encoder for the per-cycle output masks. 'traced' counts the
+ * cycles written so far; once the text reaches CYCLE_TRACE_MAX further
+ * cycles are dropped (the reply says how many made it).
+ */
+typedef struct {
+    DynBuf* text;
+    uint32_t value;
+    long long run;
+    long long traced;
+    bool full;
+} TraceWriter;
+
+static void trace_flush(TraceWriter* t) {
+    static const char HEX[] = "0123456789abcdef";
+    if (t->run == 0 || t->full) return;
+
+    if (t->run >= TRACE_RUN_MIN) {
+        DynBuf_AppendChar(t->text, HEX[t->value & 15]);
+        DynBuf_AppendChar(t->text, '*');
+        DynBuf_AppendInt(t->text, t->run);
+        DynBuf_AppendChar(t->text, ',');
+    } else {
+        for (long long i = 0; i < t->run; i++) DynBuf_AppendChar(t->text, HEX[t->value & 15]);
+    }
+    t->traced += t->run;
+    t->run = 0;
+    if (t->text->len >= CYCLE_TRACE_MAX) t->full = true;
+}
+
+static inline void trace_push(TraceWriter* t, uint32_t value) {
+    if (t->run > 0 && value == t->value) {
+        t->run++;
+        return;
+    }
+    trace_flush(t);
+    t->value = value;
+    t->run = 1;
+}
+
+void Cycle_Run(long long cycles, const uint8_t* stimulus, int stimulus_count,
+               uint8_t input_mask, DynBuf* out) {
+    if (cycles < 0) cycles = 0;
+    if (cycles > CYCLE_MAX_RUN) cycles = CYCLE_MAX_RUN;
+
+    pthread_mutex_lock(&cycle_mutex);
+    SeqStatus status = prog_status;
+    SeqProgram run;
+    if (status == SEQ_OK) status = Seq_Copy(&prog, &run);
+    bool run_sequential = sequential;
+    uint64_t run_generation = generation;
+    pthread_mutex_unlock(&cycle_mutex);
+
+    if (status != SEQ_OK) {
+        DynBuf_AppendStr(out, "{ \"type\": \"run\", \"status\": \"error\", \"message\": ");
+        DynBuf_AppendJsonString(out, status == SEQ_ERR_LOOP
+            ? "Combinational loop: a channel depends on itself without a register"
+            : "Circuit could not be compiled");
+        DynBuf_AppendStr(out, " }");
+        return;
+    }
+
+    DynBuf trace;
+    DynBuf_Init(&trace);
+    DynBuf_Reserve(&trace, CYCLE_TRACE_MAX + 32);
+    TraceWriter writer = { &trace, 0, 0, 0, false };
+    uint64_t start_cycle = run.cycle;
+
+    long long start = Timer_GetNanos();
+    long long n = 0;
+    for (; n < stimulus_count && n < cycles; n++) trace_push(&writer, Seq_Step(&run, stimulus[n]));
+    uint32_t held = stimulus_count > 0 ? stimulus[stimulus_count - 1] : input_mask;
+    for (; n < cycles; n++) trace_push(&writer, Seq_Step(&run, held));
+    trace_flush(&writer);
+    long long elapsed = Timer_GetNanos() - start;
+
+    // Keep the final state unless the equations changed, the registers were
+    // reset or another run finished first while this one was clocking
+    pthread_mutex_lock(&cycle_mutex);
+    if (generation == run_generation && prog_status == SEQ_OK) {
+        memcpy(prog.values + SEQ_FIRST_REG_SLOT, run.values + SEQ_FIRST_REG_SLOT, (size_t)run.reg_count);
+        prog.cycle = run.cycle;
+        generation++;
+    }
+    pthread_mutex_unlock(&cycle_mutex);
+
+    DynBuf_AppendStr(out, "{ \"type\": \"run\", \"status\": \"ok\", \"sequential\": ");
+    DynBuf_AppendJsonBool(out, run_sequential);
+    DynBuf_AppendStr(out, ", \"registers\": ");
+    DynBuf_AppendInt(out, run.reg_count);
+    DynBuf_AppendStr(out, ", \"start_cycle\": ");
+    DynBuf_AppendUInt(out, start_cycle);
+    DynBuf_AppendStr(out, ", \"cycles\": ");
+    DynBuf_AppendInt(out, cycles);
+    DynBuf_AppendStr(out, ", \"traced\": ");
+    DynBuf_AppendInt(out, writer.traced);
+    DynBuf_AppendStr(out, ", \"elapsed_us\": ");
+    DynBuf_AppendInt(out, elapsed / 1000);
+    DynBuf_AppendStr(out, ", \"trace\": ");
+    DynBuf_AppendJsonString(out, trace.data ? trace.data : "");
+    DynBuf_AppendStr(out, " }");
+    if (!DynBuf_Ok(&trace)) out->failed = true;
+    DynBuf_Free(&trace);
+    Seq_Free(&run);
+}
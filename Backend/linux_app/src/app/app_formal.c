@@ -0,0 +1,346 @@
+/*
+ * File: app_formal.c
+ * Version: 1.1.1
+ * Description:
+ * Equivalence and satisfiability checks of the channels (see
+ * app_formal.h).
+ *
+ * Version 1.1.0 checks equivalence in tiers (truth table, random
+ * simulation, SAT) and accepts a candidate expression as either side.
+ * Version 1.1.1 refuses sequential equations (logic_seq.h): the checks
+ * below are purely combinational.
+ */
+
+#include "app_formal.h"
+#include "app_state.h"
+#include "logic_cnf.h"
+#include "logic_parser.h"
+#include "logic_seq.h"
+#include "logic_sim.h"
+#include "utils_timer.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Function: channel_expression
+ * ----------------------------
+ * returns: The equation of channel x/y/z/w (either case) in 'st', or
+ *          NULL for any other name.
+ */
+static const char* channel_expression(const SharedState* st, const char* name) {
+    if (name == NULL || name[0] == '\0' || name[1] != '\0') return NULL;
+    switch (tolower((unsigned char)name[0])) {
+        case 'x': return st->input_x;
+        case 'y': return st->input_y;
+        case 'z': return st->input_z;
+        case 'w': return st->input_w;
+        default:  return NULL;
+    }
+}
+
+/*
+ * Function: reject_sequential
+ * ---------------------------
+ * Registers and channel references have no meaning in a single
+ * combinational evaluation (a register would read 0, a channel name a
+ * free input), so such trees are freed and reported instead.
+ */
+static LogicNode* reject_sequential(LogicNode* root, const char** error) {
+    if (!Seq_IsSequential(root)) return root;
+    if (!*error) *error = SEQ_COMBINATIONAL_ONLY;
+    AST_Free(root);
+    return NULL;
+}
+
+/*
+ * Function: parse_channel
+ * -----------------------
+ * Parses a channel's equation; on failure sets *error and returns NULL.
+ */
+static LogicNode* parse_channel(const SharedState* st, const char* name, const char** error) {
+    const char* expr = channel_expression(st, name);
+    if (expr == NULL) {
+        if (!*error) *error = "Unknown channel (expected x, y, z or w)";
+        return NULL;
+    }
+    LogicNode* root = Parser_ParseString(expr);
+    if (root == NULL && !*error) *error = "Channel is not programmed";
+    return reject_sequential(root, error);
+}
+
+static void write_error(DynBuf* out, const char* type, const char* message) {
+    DynBuf_AppendStr(out, "{ \"type\": \"");
+    DynBuf_AppendStr(out, type);
+    DynBuf_AppendStr(out, "\", \"status\": \"error\", \"message\": ");
+    DynBuf_AppendJsonString(out, message);
+    DynBuf_AppendStr(out, " }");
+}
+
+static void write_stats(DynBuf* out, const SatSolver* s) {
+    DynBuf_AppendStr(out, ", \"vars\": ");
+    DynBuf_AppendInt(out, s->var_count);
+    DynBuf_AppendStr(out, ", \"clauses\": ");
+    DynBuf_AppendInt(out, s->problem.count);
+    DynBuf_AppendStr(out, ", \"conflicts\": ");
+    DynBuf_AppendInt(out, s->conflicts);
+    DynBuf_AppendStr(out, ", \"decisions\": ");
+    DynBuf_AppendInt(out, s->decisions);
+}
+
+// Builds the literal to assert from the trees' output literals
+typedef int (*CombineFn)(CnfEncoder* e, const int* lits, int value);
+
+/*
+ * Function: solve_assertion
+ * -------------------------
+ * Encodes the trees (at most two), asserts the literal 'combine' builds
+ * from their output literals, and solves.
+ *
+ * returns: The result; *witness holds the input vector on SAT_SAT.
+ */
+static SatResult solve_assertion(SatSolver* s, LogicNode** roots, int count, CombineFn combine,
+                                 int value, uint32_t* witness) {
+    CnfEncoder enc;
+    int lits[2];
+    bool ok = Cnf_Init(&enc, s);
+    for (int i = 0; ok && i < count; i++) {
+        lits[i] = Cnf_AddTree(&enc, roots[i]);
+        ok = (lits[i] >= 0);
+    }
+    int goal = ok ? combine(&enc, lits, value) : -1;
+
+    SatResult result = SAT_UNKNOWN;
+    if (goal >= 0) {
+        Sat_AddClause(s, &goal, 1);
+        result = Sat_Solve(s, FORMAL_CONFLICT_LIMIT);
+        if (result == SAT_SAT) *witness = Cnf_InputMask(&enc);
+    }
+    Cnf_Free(&enc);
+    return result;
+}
+
+static int combine_miter(CnfEncoder* e, const int* lits, int value) {
+    (void)value;
+    return Cnf_Xor(e, lits[0], lits[1]);
+}
+
+static int combine_value(CnfEncoder* e, const int* lits, int value) {
+    (void)e;
+    return value ? lits[0] : SAT_NOT(lits[0]);
+}
+
+static const char* result_name(SatResult r, const char* sat, const char* unsat) {
+    return r == SAT_SAT ? sat : (r == SAT_UNSAT ? unsat : "unknown");
+}
+
+// --- Equivalence ---
+
+/*
+ * Function: lane_mask
+ * -------------------
+ * returns: The input mask of vector 'lane' of a bit-sliced input array.
+ */
+static uint32_t lane_mask(const uint64_t* inputs, uint32_t var_mask, int lane) {
+    uint32_t mask = 0;
+    for (uint32_t vars = var_mask; vars; vars &= vars - 1) {
+        int v = __builtin_ctz(vars);
+        if ((inputs[v] >> lane) & 1) mask |= 1u << v;
+    }
+    return mask;
+}
+
+/*
+ * Function: simulate_miter
+ * ------------------------
+ * Compares outputs 'oa' and 'ob' of a compiled program 64 vectors per
+ * sweep. With at most 6 inputs one sweep covers every combination (the
+ * 64-bit truth tables are compared); otherwise FORMAL_RANDOM_SWEEPS
+ * sweeps of reproducible pseudo-random vectors are tried.
+ *
+ * returns: true if the outputs differ on some vector; *witness is the
+ *          first one (for truth tables, the lowest such input mask).
+ */
+static bool simulate_miter(SimProgram* p, int oa, int ob, bool exhaustive, uint32_t* witness, long long* vectors) {
+    uint64_t inputs[SIM_MAX_VARS] = { 0 };
+    uint64_t outputs[SIM_MAX_OUTPUTS];
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    int sweeps = exhaustive ? 1 : FORMAL_RANDOM_SWEEPS;
+
+    for (int s = 0; s < sweeps; s++) {
+        int j = 0;
+        for (uint32_t vars = p->var_mask; vars; vars &= vars - 1, j++) {
+            uint64_t word = 0;
+            if (exhaustive) {
+                // Input j of lane k is bit j of k: the truth-table column
+                for (int k = 0; k < SIM_LANES; k++) word |= (uint64_t)((k >> j) & 1) << k;
+            } else {
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                word = seed;
+            }
+            inputs[__builtin_ctz(vars)] = word;
+        }
+        Sim_EvaluateSlice(p, inputs, outputs);
+        *vectors += exhaustive ? (1LL << __builtin_popcount(p->var_mask)) : SIM_LANES;
+
+        uint64_t diff = outputs[oa] ^ outputs[ob];
+        if (diff) {
+            *witness = lane_mask(inputs, p->var_mask, __builtin_ctzll(diff));
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Function: parse_operand
+ * -----------------------
+ * A lone channel name (x, y, z, w) is that channel's equation; anything
+ * else is parsed as a candidate expression.
+ */
+static LogicNode* parse_operand(const SharedState* st, const char* operand, const char** error) {
+    if (channel_expression(st, operand)) return parse_channel(st, operand, error);
+    LogicNode* root = Parser_ParseString(operand);
+    if (root == NULL && !*error) *error = "Invalid expression";
+    return reject_sequential(root, error);
+}
+
+void Formal_Equiv(const char* a, const char* b, DynBuf* out) {
+    SharedState st = AppState_GetSnapshot();
+    const char* error = NULL;
+    LogicNode* roots[2] = { parse_channel(&st, a, &error), parse_operand(&st, b, &error) };
+    long long start = Timer_GetNanos();
+
+    // Both sides in one graph, so shared logic is compiled once
+    NetGraph graph;
+    SimProgram prog;
+    bool compiled = false;
+    if (!error) {
+        Graph_Init(&graph);
+        compiled = Graph_AddOutput(&graph, "a", roots[0]) && Graph_AddOutput(&graph, "b", roots[1]);
+        if (compiled) {
+            Graph_Finalize(&graph);
+            compiled = Sim_Compile(&graph, &prog);
+        }
+        Graph_Free(&graph);
+        if (!compiled) error = "Out of memory";
+    }
+
+    // Tiers: truth tables decide small circuits outright; otherwise random
+    // simulation catches most differences cheaply, and SAT proves the rest
+    const char* method = NULL;
+    int inputs = compiled ? __builtin_popcount(prog.var_mask) : 0;
+    long long vectors = 0;
+    uint32_t witness = 0;
+    SatResult result = SAT_UNKNOWN;
+    SatSolver solver;
+    Sat_Init(&solver);
+    if (compiled) {
+        bool exhaustive = (inputs <= FORMAL_TRUTH_TABLE_VARS);
+        bool differ = simulate_miter(&prog, Sim_FindOutput(&prog, "a"), Sim_FindOutput(&prog, "b"),
+                                     exhaustive, &witness, &vectors);
+        if (differ || exhaustive) {
+            method = exhaustive ? "truth_table" : "simulation";
+            result = differ ? SAT_SAT : SAT_UNSAT;
+        } else {
+            method = "sat";
+            result = solve_assertion(&solver, roots, 2, combine_miter, 1, &witness);
+            if (solver.failed) error = "Out of memory";
+        }
+        Sim_Free(&prog);
+    }
+    long long elapsed = Timer_GetNanos() - start;
+
+    // A counterexample must really separate the two; anything else is a bug
+    bool va = false, vb = false;
+    if (!error && result == SAT_SAT) {
+        va = AST_Evaluate(roots[0], (int)witness);
+        vb = AST_Evaluate(roots[1], (int)witness);
+        if (va == vb) error = "Internal error: counterexample does not separate the circuits";
+    }
+
+    if (error) {
+        write_error(out, "equiv", error);
+    } else {
+        DynBuf_AppendStr(out, "{ \"type\": \"equiv\", \"status\": \"ok\", \"a\": ");
+        DynBuf_AppendJsonString(out, a);
+        DynBuf_AppendStr(out, ", \"b\": ");
+        DynBuf_AppendJsonString(out, b);
+        DynBuf_AppendStr(out, ", \"result\": \"");
+        DynBuf_AppendStr(out, result_name(result, "different", "equivalent"));
+        DynBuf_AppendStr(out, "\", \"method\": \"");
+        DynBuf_AppendStr(out, method);
+        DynBuf_AppendStr(out, "\", \"inputs\": ");
+        DynBuf_AppendInt(out, inputs);
+        DynBuf_AppendStr(out, ", \"vectors\": ");
+        DynBuf_AppendInt(out, vectors);
+        if (result == SAT_SAT) {
+            DynBuf_AppendStr(out, ", \"witness\": ");
+            DynBuf_AppendUInt(out, witness);
+            DynBuf_AppendStr(out, ", \"values\": [");
+            DynBuf_AppendInt(out, va);
+            DynBuf_AppendStr(out, ", ");
+            DynBuf_AppendInt(out, vb);
+            DynBuf_AppendChar(out, ']');
+        }
+        if (strcmp(method, "sat") == 0) write_stats(out, &solver);
+        DynBuf_AppendStr(out, ", \"elapsed_us\": ");
+        DynBuf_AppendInt(out, elapsed / 1000);
+        DynBuf_AppendStr(out, " }");
+        printf("[Formal] equiv %s %s: %s by %s in %lld us\n", a, b,
+               result_name(result, "different", "equivalent"), method, elapsed / 1000);
+    }
+
+    Sat_Free(&solver);
+    AST_Free(roots[0]);
+    AST_Free(roots[1]);
+}
+
+void Formal_Sat(const char* channel, int value, DynBuf* out) {
+    SharedState st = AppState_GetSnapshot();
+    const char* error = NULL;
+    LogicNode* root = parse_channel(&st, channel, &error);
+    value = value ? 1 : 0;
+
+    SatSolver solver;
+    Sat_Init(&solver);
+    uint32_t witness = 0;
+    SatResult result = SAT_UNKNOWN;
+    long long start = Timer_GetNanos();
+    if (!error) {
+        result = solve_assertion(&solver, &root, 1, combine_value, value, &witness);
+        if (solver.failed) error = "Out of memory";
+    }
+    long long elapsed = Timer_GetNanos() - start;
+
+    if (!error && result == SAT_SAT && AST_Evaluate(root, (int)witness) != value) {
+        error = "Internal error: witness does not produce the value";
+    }
+
+    if (error) {
+        write_error(out, "sat", error);
+    } else {
+        DynBuf_AppendStr(out, "{ \"type\": \"sat\", \"status\": \"ok\", \"channel\": ");
+        DynBuf_AppendJsonString(out, channel);
+        DynBuf_AppendStr(out, ", \"value\": ");
+        DynBuf_AppendInt(out, value);
+        DynBuf_AppendStr(out, ", \"result\": \"");
+        DynBuf_AppendStr(out, result_name(result, "sat", "unsat"));
+        DynBuf_AppendChar(out, '"');
+        if (result == SAT_SAT) {
+            DynBuf_AppendStr(out, ", \"witness\": ");
+            DynBuf_AppendUInt(out, witness);
+        }
+        write_stats(out, &solver);
+        DynBuf_AppendStr(out, ", \"elapsed_us\": ");
+        DynBuf_AppendInt(out, elapsed / 1000);
+        DynBuf_AppendStr(out, " }");
+        printf("[Formal] sat %s=%d: %s after %lld conflicts\n", channel, value,
+               result_name(result, "sat", "unsat"), solver.conflicts);
+    }
+
+    Sat_Free(&solver);
+    AST_Free(root);
+}
@@ -0,0 +1,181 @@
+/*
+ * File: app_publish.c
+ * Version: 1.3.0
+ * Description:
+ * Implements the broadcast update scheduler (see app_publish.h).
+ * Requests only set flags; Publish_Poll reads the state afresh when it
+ * sends, which is what makes coalescing free.
+ *
+ * Note: Version 1.1.0 builds only the topics clients subscribe to
+ * (net_session.h) and adds the "outputs" and "metrics" packets.
+ * Version 1.2.0 moves the rates into the sessions: updates are built
+ * at the fastest session's rate, and WebSocket clients that asked for
+ * less get theirs from NetWs_Poll. Version 1.3.0 adds Publish_NextDue
+ * for the main loop's sleep.
+ */
+
+#include "app_publish.h"
+#include "app_utils.h"
+#include "net_udp.h"
+#include "net_ws.h"
+#include "utils_timer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+static pthread_mutex_t publish_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool state_pending = false;
+static bool heavy_pending = true;   // Nothing has been published yet
+static long long last_state_ms = 0;
+static long long last_heavy_ms = 0;
+static char requested[4][256];      // Equations of the last request
+static bool outputs_pending = false;
+static uint32_t pin_inputs = 0, pin_outputs = 0;
+static bool pins_known = false;
+static long long last_metrics_ms = 0;
+static PublishStats stats;
+
+void Publish_Request(const SharedState* st) {
+    const char* equations[4] = { st->input_x, st->input_y, st->input_z, st->input_w };
+    pthread_mutex_lock(&publish_lock);
+    bool changed = false;
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(requested[i], equations[i]) != 0) {
+            snprintf(requested[i], sizeof(requested[i]), "%s", equations[i]);
+            changed = true;
+        }
+    }
+    stats.requests++;
+    if (state_pending) stats.state_coalesced++;
+    state_pending = true;
+    if (changed) {
+        if (heavy_pending) stats.heavy_coalesced++;
+        heavy_pending = true;
+    }
+    pthread_mutex_unlock(&publish_lock);
+}
+
+void Publish_Outputs(uint32_t inputs, uint32_t outputs) {
+    pthread_mutex_lock(&publish_lock);
+    if (!pins_known || inputs != pin_inputs || outputs != pin_outputs) {
+        pin_inputs = inputs;
+        pin_outputs = outputs;
+        pins_known = true;
+        outputs_pending = true;
+    }
+    pthread_mutex_unlock(&publish_lock);
+}
+
+void Publish_RequestFull(void) {
+    pthread_mutex_lock(&publish_lock);
+    state_pending = true;
+    heavy_pending = true;
+    outputs_pending = pins_known;
+    pthread_mutex_unlock(&publish_lock);
+}
+
+void Publish_Poll(void) {
+    NetWs_Poll();  // Held broadcasts of slower WebSocket clients
+
+    long long now = Timer_GetMillis();
+    uint32_t demand = Session_Demand();
+    int state_hz, heavy_hz;
+    Session_FastestRates(&state_hz, &heavy_hz);
+    pthread_mutex_lock(&publish_lock);
+    bool send_state = (state_pending || outputs_pending) && now - last_state_ms >= 1000 / state_hz;
+    bool send_heavy = heavy_pending && now - last_heavy_ms >= 1000 / heavy_hz;
+    bool send_outputs = send_state && outputs_pending;
+    bool send_metrics = (demand & TOPIC_METRICS) && now - last_metrics_ms >= PUBLISH_METRICS_MS;
+    uint32_t inputs = pin_inputs, outputs = pin_outputs;
+    if (send_state) {
+        if (!(demand & TOPIC_CLASS_STATE)) stats.skipped++;
+        else stats.state_sent++;
+        state_pending = false;
+        outputs_pending = false;
+        last_state_ms = now;
+    }
+    if (send_heavy) {
+        if (!(demand & TOPIC_CLASS_HEAVY)) stats.skipped++;
+        else stats.heavy_sent++;
+        heavy_pending = false;
+        last_heavy_ms = now;
+    }
+    if (send_metrics) last_metrics_ms = now;
+    pthread_mutex_unlock(&publish_lock);
+    if (!send_state && !send_heavy && !send_metrics) return;
+
+    SharedState st = AppState_GetSnapshot();
+    NetUDP_BeginBatch();  // The update's packets leave in one syscall
+    if (send_state && (demand & TOPIC_STATE)) NetUDP_BroadcastState();  // Small packets first
+    if (send_outputs && (demand & TOPIC_OUTPUTS)) NetUDP_BroadcastOutputs(inputs, outputs);
+    if (send_heavy) {
+        // Parsed even without subscribers: the valid flags need it
+        uint32_t topics = demand & (TOPIC_RESULTS | TOPIC_NETLIST);
+        bool vx = Process_EquationTopics(Session_Broadcast(), "X", st.input_x, "run", topics);
+        bool vy = Process_EquationTopics(Session_Broadcast(), "Y", st.input_y, "run", topics);
+        bool vz = Process_EquationTopics(Session_Broadcast(), "Z", st.input_z, "run", topics);
+        bool vw = Process_EquationTopics(Session_Broadcast(), "W", st.input_w, "run", topics);
+
+        // A change marks the state dirty, so the flags follow in a state update
+        if (st.valid_x != vx || st.valid_y != vy || st.valid_z != vz || st.valid_w != vw)
+            AppState_SetValidation(vx, vy, vz, vw);
+
+        if (demand & TOPIC_COMBINED)
+            Send_Combined_Update(Session_Broadcast(), st.input_x, st.input_y, st.input_z, st.input_w);
+    }
+    if (send_metrics) NetUDP_BroadcastMetrics();
+    NetUDP_EndBatch();
+}
+
+int Publish_NextDue(int max_ms) {
+    long long now = Timer_GetMillis();
+    long long due = now + max_ms;
+    long long held = NetWs_NextDue();
+    if (held >= 0 && held < due) due = held;
+
+    int state_hz, heavy_hz;
+    Session_FastestRates(&state_hz, &heavy_hz);
+    pthread_mutex_lock(&publish_lock);
+    if ((state_pending || outputs_pending) && last_state_ms + 1000 / state_hz < due) due = last_state_ms + 1000 / state_hz;
+    if (heavy_pending && last_heavy_ms + 1000 / heavy_hz < due) due = last_heavy_ms + 1000 / heavy_hz;
+    pthread_mutex_unlock(&publish_lock);
+    return due > now ? (int)(due - now) : 0;
+}
+
+bool Publish_SetRates(Session* s, int new_state_hz, int new_heavy_hz) {
+    if (new_state_hz < 1 || new_state_hz > PUBLISH_MAX_HZ || new_heavy_hz < 1 || new_heavy_hz > PUBLISH_MAX_HZ) return false;
+    Session_SetRates(s, new_state_hz, new_heavy_hz);
+    return true;
+}
+
+void Publish_WriteReport(Session* session, DynBuf* out) {
+    int shz, hhz, fastest_shz, fastest_hhz;
+    bool own = Session_GetRates(session, &shz, &hhz);
+    Session_FastestRates(&fastest_shz, &fastest_hhz);
+    pthread_mutex_lock(&publish_lock);
+    PublishStats s = stats;
+    pthread_mutex_unlock(&publish_lock);
+
+    DynBuf_AppendStr(out, "{ \"type\": \"publish\", \"state_hz\": ");
+    DynBuf_AppendInt(out, shz);
+    DynBuf_AppendStr(out, ", \"heavy_hz\": ");
+    DynBuf_AppendInt(out, hhz);
+    DynBuf_AppendStr(out, own ? ", \"default\": false" : ", \"default\": true");
+    DynBuf_AppendStr(out, ", \"publish_state_hz\": ");
+    DynBuf_AppendInt(out, fastest_shz);
+    DynBuf_AppendStr(out, ", \"publish_heavy_hz\": ");
+    DynBuf_AppendInt(out, fastest_hhz);
+    DynBuf_AppendStr(out, ", \"requests\": ");
+    DynBuf_AppendInt(out, s.requests);
+    DynBuf_AppendStr(out, ", \"state_sent\": ");
+    DynBuf_AppendInt(out, s.state_sent);
+    DynBuf_AppendStr(out, ", \"heavy_sent\": ");
+    DynBuf_AppendInt(out, s.heavy_sent);
+    DynBuf_AppendStr(out, ", \"state_coalesced\": ");
+    DynBuf_AppendInt(out, s.state_coalesced);
+    DynBuf_AppendStr(out, ", \"heavy_coalesced\": ");
+    DynBuf_AppendInt(out, s.heavy_coalesced);
+    DynBuf_AppendStr(out, ", \"skipped\": ");
+    DynBuf_AppendInt(out, s.skipped);
+    DynBuf_AppendStr(out, " }");
+}
@@ -1,6 +1,6 @@
 /*
  * File: app_state.c
- * Version: 1.1.0
+ * Version: 1.2.0
  * Description:
  * Implements the central data store for the application.
  * This module manages the 'SharedState' structure, which acts as the
@@ -11,11 +11,16 @@
  * 2. Managing the system operational mode.
  * 3. Providing thread-safe access via mutex locking to prevent race conditions
  * between the UDP networking thread and the main execution loop.
+ *
+ * Note: Version 1.2.0 signals every change, so the main loop can sleep
+ * until one arrives (AppState_WaitDirty) instead of polling on a tick.
  */
 
 #include "app_state.h"
+#include <errno.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 
 // Global instance of the application state
 static SharedState global_state;
@@ -23,6 +28,19 @@ static SharedState global_state;
 // Mutex to protect concurrent access to global_state
 static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// Signalled whenever the dirty flag is set (state_mutex held)
+static pthread_cond_t dirty_cond = PTHREAD_COND_INITIALIZER;
+
+/*
+ * Function: mark_dirty
+ * --------------------
+ * Sets the dirty flag and wakes AppState_WaitDirty. Caller holds state_mutex.
+ */
+static void mark_dirty(void) {
+    global_state.is_dirty = true;
+    pthread_cond_broadcast(&dirty_cond);
+}
+
 /*
  * Function: AppState_Init
  * -----------------------
@@ -53,6 +71,7 @@ void AppState_Init(void) {
  * Destroys the mutex. Used during system shutdown.
  */
 void AppState_Cleanup(void) {
+    pthread_cond_destroy(&dirty_cond);
     pthread_mutex_destroy(&state_mutex);
 }
 
@@ -81,7 +100,7 @@ void AppState_SetMode(SystemMode new_mode) {
     pthread_mutex_lock(&state_mutex);
     if (global_state.mode != new_mode) {
         global_state.mode = new_mode;
-        global_state.is_dirty = true;
+        mark_dirty();
     }
     pthread_mutex_unlock(&state_mutex);
 }
@@ -96,7 +115,7 @@ void AppState_SetInputX(const char* str) {
     pthread_mutex_lock(&state_mutex);
     strncpy(global_state.input_x, str, 255);
     global_state.input_x[255] = '\0'; // Ensure null-termination
-    global_state.is_dirty = true;
+    mark_dirty();
     pthread_mutex_unlock(&state_mutex);
 }
 
@@ -109,7 +128,7 @@ void AppState_SetInputY(const char* str) {
     pthread_mutex_lock(&state_mutex);
     strncpy(global_state.input_y, str, 255);
     global_state.input_y[255] = '\0';
-    global_state.is_dirty = true;
+    mark_dirty();
     pthread_mutex_unlock(&state_mutex);
 }
 
@@ -122,7 +141,7 @@ void AppState_SetInputZ(const char* str) {
     pthread_mutex_lock(&state_mutex);
     strncpy(global_state.input_z, str, 255);
     global_state.input_z[255] = '\0';
-    global_state.is_dirty = true;
+    mark_dirty();
     pthread_mutex_unlock(&state_mutex);
 }
 
@@ -135,7 +154,7 @@ void AppState_SetInputW(const char* str) {
     pthread_mutex_lock(&state_mutex);
     strncpy(global_state.input_w, str, 255);
     global_state.input_w[255] = '\0';
-    global_state.is_dirty = true;
+    mark_dirty();
     pthread_mutex_unlock(&state_mutex);
 }
 
@@ -152,7 +171,7 @@ void AppState_SetValidation(bool vx, bool vy, bool vz, bool vw) {
     global_state.valid_y = vy;
     global_state.valid_z = vz;
     global_state.valid_w = vw;
-    global_state.is_dirty = true;
+    mark_dirty();
     pthread_mutex_unlock(&state_mutex);
 }
 
@@ -169,6 +188,30 @@ bool AppState_IsDirty(void) {
     return d;
 }
 
+/*
+ * Function: AppState_WaitDirty
+ * ----------------------------
+ * Blocks until the dirty flag is set or 'timeout_ms' has passed.
+ */
+bool AppState_WaitDirty(int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&state_mutex);
+    while (!global_state.is_dirty) {
+        if (pthread_cond_timedwait(&dirty_cond, &state_mutex, &deadline) == ETIMEDOUT) break;
+    }
+    bool d = global_state.is_dirty;
+    pthread_mutex_unlock(&state_mutex);
+    return d;
+}
+
 /*
  * Function: AppState_ClearDirty
  * -----------------------------
@@ -187,7 +230,7 @@ void AppState_ClearDirty(void) {
  */
 void AppState_Touch(void) {
     pthread_mutex_lock(&state_mutex);
-    global_state.is_dirty = true;
+    mark_dirty();
     pthread_mutex_unlock(&state_mutex);
 }
 
@@ -200,7 +243,7 @@ void AppState_SetInputMask(uint8_t mask) {
     pthread_mutex_lock(&state_mutex);
     if (global_state.input_signal_state != mask) {
         global_state.input_signal_state = mask;
-        global_state.is_dirty = true;
+        mark_dirty();
     }
     pthread_mutex_unlock(&state_mutex);
 }
@@ -0,0 +1,228 @@
+/*
+ * File: app_timing.c
+ * Version: 1.1.0
+ * Description:
+ * Owns the live event-driven simulator of the four channels (see
+ * app_timing.h) and serializes its output timelines. Version 1.1.0
+ * feeds input changes and output edges to the timing capture
+ * (app_capture.h).
+ */
+
+#include "app_timing.h"
+#include "app_capture.h"
+#include "logic_event.h"
+#include "logic_netlist.h"
+#include "logic_parser.h"
+#include "utils_colors.h"
+#include "utils_timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+
+static const struct {
+    const char* name;
+    NodeType type;
+} GATE_NAMES[] = {
+    { "AND", NODE_AND }, { "OR", NODE_OR }, { "XOR", NODE_XOR },
+    { "NOT", NODE_NOT }, { "NAND", NODE_NAND }, { "NOR", NODE_NOR },
+};
+
+#define GATE_NAME_COUNT ((int)(sizeof(GATE_NAMES) / sizeof(GATE_NAMES[0])))
+
+static EventSim sim;
+static bool sim_ready = false;
+static EventDelays delays;
+static bool delays_ready = false;
+static char equations[4][256];
+static uint8_t current_mask = 0;
+static long long epoch_ns = 0;
+static pthread_mutex_t timing_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Function: now_ticks
+ * -------------------
+ * Simulation time: nanoseconds since the first circuit was compiled.
+ * One clock for the whole run, so timelines stay monotonic across
+ * rebuilds.
+ */
+static uint64_t now_ticks(void) {
+    if (epoch_ns == 0) epoch_ns = Timer_GetNanos();
+    return (uint64_t)(Timer_GetNanos() - epoch_ns);
+}
+
+/*
+ * Function: channel_of
+ * --------------------
+ * returns: 0..3 for output X, Y, Z, W; -1 for anything else.
+ */
+static int channel_of(const char* name) {
+    static const char CHANNELS[] = "XYZW";
+    const char* at = name[0] ? strchr(CHANNELS, name[0]) : NULL;
+    return at ? (int)(at - CHANNELS) : -1;
+}
+
+/*
+ * Function: capture_edge
+ * ----------------------
+ * EventEdgeFn forwarding output edges to the timing capture.
+ */
+static void capture_edge(void* ctx, int output, uint64_t time, uint8_t value) {
+    (void)ctx;
+    Capture_LiveOutput(CAPTURE_TIMING, time, channel_of(sim.outputs[output].name), value);
+}
+
+/*
+ * Function: capture_state
+ * -----------------------
+ * Samples every input and output into the timing capture. The caller
+ * holds timing_mutex.
+ */
+static void capture_state(void) {
+    uint32_t outputs = 0;
+    for (int i = 0; sim_ready && i < sim.output_count; i++) {
+        int channel = channel_of(sim.outputs[i].name);
+        if (channel >= 0 && EventSim_OutputValue(&sim, i)) outputs |= 1u << channel;
+    }
+    Capture_Live(CAPTURE_TIMING, sim_ready ? sim.now : now_ticks(), current_mask, outputs);
+}
+
+/*
+ * Function: rebuild
+ * -----------------
+ * Recompiles the simulator from the stored equations. The caller holds
+ * timing_mutex.
+ */
+static void rebuild(void) {
+    if (!delays_ready) {
+        EventDelays_Default(&delays);
+        delays_ready = true;
+    }
+    if (sim_ready) EventSim_Free(&sim);
+    sim_ready = false;
+
+    LogicNode* roots[4];
+    for (int i = 0; i < 4; i++) roots[i] = Parser_ParseString(equations[i]);
+
+    NetGraph graph;
+    if (Netlist_BuildCombinedGraph(&graph, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3])) {
+        sim_ready = EventSim_Compile(&graph, &delays, current_mask, now_ticks(), &sim);
+        Graph_Free(&graph);
+    }
+    if (sim_ready) {
+        EventSim_SetEdgeHook(&sim, capture_edge, NULL);
+        capture_state();  // The new circuit starts settled
+    }
+    if (!sim_ready) printf(C_B_RED "[Timing] Out of memory compiling circuit" C_RESET "\n");
+
+    for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+}
+
+void Timing_Update(const char* x, const char* y, const char* z, const char* w, uint8_t input_mask) {
+    const char* next[4] = { x, y, z, w };
+
+    pthread_mutex_lock(&timing_mutex);
+    bool changed = !sim_ready;
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(equations[i], next[i]) != 0) {
+            strncpy(equations[i], next[i], sizeof(equations[i]) - 1);
+            changed = true;
+        }
+    }
+    if (changed) {
+        current_mask = input_mask;
+        rebuild();
+    }
+    pthread_mutex_unlock(&timing_mutex);
+}
+
+void Timing_SetInputs(uint8_t input_mask) {
+    pthread_mutex_lock(&timing_mutex);
+    current_mask = input_mask;
+    if (sim_ready) {
+        EventSim_SetInputs(&sim, now_ticks(), input_mask);
+        Capture_LiveInputs(CAPTURE_TIMING, sim.now, input_mask);
+    }
+    pthread_mutex_unlock(&timing_mutex);
+}
+
+void Timing_Sync(void) {
+    pthread_mutex_lock(&timing_mutex);
+    if (sim_ready) EventSim_RunUntil(&sim, now_ticks());
+    capture_state();
+    pthread_mutex_unlock(&timing_mutex);
+}
+
+bool Timing_SetDelay(const char* gate, int ticks) {
+    for (int i = 0; i < GATE_NAME_COUNT; i++) {
+        if (strcasecmp(gate, GATE_NAMES[i].name) != 0) continue;
+
+        pthread_mutex_lock(&timing_mutex);
+        if (!delays_ready) {
+            EventDelays_Default(&delays);
+            delays_ready = true;
+        }
+        if (ticks < 1) ticks = 1;
+        if (ticks > EVENT_MAX_DELAY) ticks = EVENT_MAX_DELAY;
+        delays.ticks[GATE_NAMES[i].type] = ticks;
+        rebuild();
+        pthread_mutex_unlock(&timing_mutex);
+        return true;
+    }
+    return false;
+}
+
+void Timing_WriteReport(DynBuf* out) {
+    pthread_mutex_lock(&timing_mutex);
+    if (!delays_ready) {
+        EventDelays_Default(&delays);
+        delays_ready = true;
+    }
+
+    DynBuf_AppendStr(out, "{ \"type\": \"timing\", \"time_unit\": \"ns\", \"delays\": {");
+    for (int i = 0; i < GATE_NAME_COUNT; i++) {
+        DynBuf_AppendJsonString(out, GATE_NAMES[i].name);
+        DynBuf_AppendStr(out, ": ");
+        DynBuf_AppendInt(out, delays.ticks[GATE_NAMES[i].type]);
+        DynBuf_AppendChar(out, ',');
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendStr(out, "}, \"outputs\": [");
+
+    if (sim_ready) {
+        EventSim_RunUntil(&sim, now_ticks());
+        for (int i = 0; i < sim.output_count; i++) {
+            const EventOutput* o = &sim.outputs[i];
+            DynBuf_AppendStr(out, "{\"name\": ");
+            DynBuf_AppendJsonString(out, o->name);
+            DynBuf_AppendStr(out, ", \"value\": ");
+            DynBuf_AppendInt(out, EventSim_OutputValue(&sim, i));
+            DynBuf_AppendStr(out, ", \"glitches\": ");
+            DynBuf_AppendUInt(out, o->glitches);
+            DynBuf_AppendStr(out, ", \"dropped\": ");
+            DynBuf_AppendUInt(out, o->dropped);
+            DynBuf_AppendStr(out, ", \"transitions\": [");
+            for (int k = 0; k < o->trace_count; k++) {
+                const EventTransition* t = &o->trace[(o->trace_start + k) % EVENT_TRACE_CAP];
+                DynBuf_AppendChar(out, '[');
+                DynBuf_AppendUInt(out, t->time);
+                DynBuf_AppendChar(out, ',');
+                DynBuf_AppendInt(out, t->value);
+                DynBuf_AppendStr(out, "],");
+            }
+            DynBuf_TrimChar(out, ',');
+            DynBuf_AppendStr(out, "]},");
+        }
+        DynBuf_TrimChar(out, ',');
+    }
+    DynBuf_AppendStr(out, "], \"now\": ");
+    DynBuf_AppendUInt(out, sim_ready ? sim.now : now_ticks());
+    DynBuf_AppendStr(out, ", \"events\": ");
+    DynBuf_AppendUInt(out, sim_ready ? sim.events : 0);
+    DynBuf_AppendStr(out, ", \"evaluations\": ");
+    DynBuf_AppendUInt(out, sim_ready ? sim.evaluations : 0);
+    DynBuf_AppendStr(out, " }");
+
+    if (sim_ready) EventSim_ClearTraces(&sim);
+    pthread_mutex_unlock(&timing_mutex);
+}
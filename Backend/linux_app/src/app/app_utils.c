@@ -1,11 +1,15 @@
 /*
  * File: app_utils.c
- * Version: 1.0.0
+ * Version: 1.5.1
  * Description:
  * High-level utility logic for the application.
  * This module orchestrates the data flow between the Parser, Minimizer,
  * and Network modules. It abstracts the complex sequence of compiling
  * a logic string into a broadcastable result.
+ *
+ * Note: Version 1.4.0 sends every result to an explicit Session
+ * (net_session.h), and previews are kept per session. Version 1.5.0
+ * skips the parts of an equation update nobody subscribes to.
  */
 
 #include "app_utils.h"
@@ -19,7 +23,10 @@
 #include "logic_parser.h"
 #include "logic_minimizer.h"
 #include "logic_netlist.h"
+#include "logic_graph.h"
+#include "logic_layout.h"
 #include "utils_colors.h" 
+#include "utils_buffer.h"
 
 /*
  * Function: Process_Equation
@@ -34,13 +41,23 @@
  *
  * Returns true if the entire pipeline succeeded.
  */
-bool Process_Equation(const char* label, const char* expression, const char* mode) {
+bool Process_Equation(Session* session, const char* label, const char* expression, const char* mode) {
+    return Process_EquationTopics(session, label, expression, mode, TOPIC_ALL);
+}
+
+/*
+ * Function: Process_EquationTopics
+ * --------------------------------
+ * Process_Equation with steps 2-5 limited to the topics requested: the
+ * parse always runs, since the caller needs the validity either way.
+ */
+bool Process_EquationTopics(Session* session, const char* label, const char* expression, const char* mode, uint32_t topics) {
     // Empty expression is technically valid (Logic 0) but we skip processing
     if (strlen(expression) == 0) return true;
 
     // Step 1: Parse
     LogicNode* root = Parser_ParseString(expression);
-    if (root) {
+    if (root && (topics & Session_ResultTopic(label))) {
         // Step 2: SOP Minimization
         TruthTable tt = Minimizer_GenerateTruthTable(root);
         ImplicantList primes = Minimizer_FindPrimeImplicants(tt);
@@ -54,13 +71,29 @@ bool Process_Equation(const char* label, const char* expression, const char* mod
         Minimizer_PrintPOS(&zero_primes, pos_buffer);
 
         // Step 4: Send Analysis Data
-        NetUDP_SendLogicResult(label, sop_buffer, pos_buffer, tt.minterms, tt.count, mode);
-
+        NetUDP_SendLogicResult(session, label, sop_buffer, pos_buffer, tt.minterms, tt.count, mode);
+    }
+    if (root && (topics & TOPIC_NETLIST)) {
         // Step 5: Generate and Send Visualization Data
-        char netlist_json[8192]; 
-        Netlist_GenerateJSON(label, root, netlist_json, sizeof(netlist_json));
-        NetUDP_SendNetlist(label, netlist_json);
+        DynBuf netlist;
+        DynBuf_Init(&netlist);
+        if (NetUDP_GetNetlistFormat(session) == NETFMT_BINARY) {
+            Netlist_GenerateBinary(label, root, &netlist);
 
+            DynBuf header;
+            DynBuf_Init(&header);
+            DynBuf_AppendStr(&header, "{ \"type\": \"netlist\", \"target\": ");
+            DynBuf_AppendJsonString(&header, label);
+            DynBuf_AppendStr(&header, " }");
+            if (DynBuf_Ok(&header)) NetUDP_SendBinaryNetlist(session, header.data, &netlist);
+            DynBuf_Free(&header);
+        } else {
+            Netlist_GenerateJSON(label, root, &netlist);
+            if (DynBuf_Ok(&netlist)) NetUDP_SendNetlist(session, label, netlist.data);
+        }
+        DynBuf_Free(&netlist);
+    }
+    if (root) {
         // Cleanup
         AST_Free(root);
         return true;
@@ -68,6 +101,83 @@ bool Process_Equation(const char* label, const char* expression, const char* mod
     return false;
 }
 
+/*
+ * Function: append_netlist_update
+ * -------------------------------
+ * Appends the netlist part of a combined packet (the caller has written
+ * everything up to it) and sends the packet.
+ *
+ * If the destination already holds a version that is still in the graph
+ * history, only the difference is sent:
+ *   "base": <held version>, "delta": { add/remove lists }
+ * Otherwise, or when the delta would not be much smaller than the graph
+ * itself, a full snapshot goes out as "elements" (or as a binary netlist
+ * for sessions that negotiated it). Deltas are always JSON: they are
+ * small, and the bridge passes them straight through.
+ *
+ * Node coordinates from the layered layout ride along with either form
+ * (cached by graph hash, so unchanged circuits cost no layout work).
+ * If a layout cannot be computed the netlist is sent without one and
+ * the browser falls back to laying it out itself.
+ */
+static void append_netlist_update(Session* session, DynBuf* packet, NetGraph* graph) {
+    GraphHistory_Lock();
+    uint32_t version = GraphHistory_Commit(graph);
+    const NetGraph* current = GraphHistory_Get(version);
+
+    uint32_t base = 0;
+    const NetGraph* previous = NULL;
+    if (NetUDP_GetBaseVersion(session, &base)) previous = GraphHistory_Get(base);
+
+    GraphLayout current_layout, previous_layout;
+    bool has_layout = Layout_Get(current, &current_layout);
+    bool has_previous_layout = false;
+
+    DynBuf_AppendStr(packet, ", \"version\": ");
+    DynBuf_AppendUInt(packet, version);
+
+    bool sent = false;
+    if (previous) {
+        has_previous_layout = Layout_Get(previous, &previous_layout);
+        GraphDelta delta;
+        if (GraphDelta_Compute(previous, current, &delta)) {
+            int elements = current->node_count + current->input_count;
+            if (GraphDelta_OpCount(&delta) * 2 <= elements) {
+                DynBuf_AppendStr(packet, ", \"base\": ");
+                DynBuf_AppendUInt(packet, base);
+                DynBuf_AppendStr(packet, ", \"delta\": ");
+                Netlist_WriteDeltaJSON(previous, has_previous_layout ? &previous_layout : NULL,
+                                       current, has_layout ? &current_layout : NULL, &delta, packet);
+                DynBuf_AppendStr(packet, " }");
+                if (DynBuf_Ok(packet)) NetUDP_SendRaw(session, packet->data);
+                sent = true;
+            }
+            GraphDelta_Free(&delta);
+        }
+    }
+
+    if (!sent && NetUDP_GetNetlistFormat(session) == NETFMT_BINARY) {
+        DynBuf_AppendStr(packet, " }");
+
+        DynBuf netlist;
+        DynBuf_Init(&netlist);
+        Netlist_WriteBinary(current, has_layout ? &current_layout : NULL, &netlist);
+        if (DynBuf_Ok(packet) && DynBuf_Ok(&netlist)) NetUDP_SendBinaryNetlist(session, packet->data, &netlist);
+        else packet->failed = true;
+        DynBuf_Free(&netlist);
+    } else if (!sent) {
+        DynBuf_AppendStr(packet, ", \"elements\": ");
+        Netlist_WriteJSON(current, has_layout ? &current_layout : NULL, packet);
+        DynBuf_AppendStr(packet, " }");
+        if (DynBuf_Ok(packet)) NetUDP_SendRaw(session, packet->data);
+    }
+    GraphHistory_Unlock();
+
+    if (has_layout) Layout_Free(&current_layout);
+    if (has_previous_layout) Layout_Free(&previous_layout);
+    if (DynBuf_Ok(packet)) NetUDP_NoteSentVersion(session, version);
+}
+
 /*
  * Function: Send_Combined_Update
  * ------------------------------
@@ -75,48 +185,45 @@ bool Process_Equation(const char* label, const char* expression, const char* mod
  * It parses all four channels, generates a composite JSON netlist,
  * and aggregates the truth tables into a single packet.
  *
- * Note: This function allocates large buffers on the static segment to
- * avoid stack overflow.
+ * The packet is built in one growable buffer: the netlist is appended
+ * in place rather than formatted separately and copied in. Every packet
+ * carries the netlist "version"; see append_netlist_update for when the
+ * netlist is sent as a delta.
  */
-void Send_Combined_Update(const char* in_x, const char* in_y, const char* in_z, const char* in_w) {
+void Send_Combined_Update(Session* session, const char* in_x, const char* in_y, const char* in_z, const char* in_w) {
     // Parse all inputs temporarily
     LogicNode* rX = Parser_ParseString(in_x);
     LogicNode* rY = Parser_ParseString(in_y);
     LogicNode* rZ = Parser_ParseString(in_z);
     LogicNode* rW = Parser_ParseString(in_w);
-    
-    static char combined_netlist[65536]; 
-    Netlist_GenerateCombinedJSON("X", rX, "Y", rY, "Z", rZ, "W", rW, combined_netlist, sizeof(combined_netlist));
 
     TruthTable tX = Minimizer_GenerateTruthTable(rX);
     TruthTable tY = Minimizer_GenerateTruthTable(rY);
     TruthTable tZ = Minimizer_GenerateTruthTable(rZ);
     TruthTable tW = Minimizer_GenerateTruthTable(rW);
     
-    static char packet[131072]; 
-    int offset = 0;
+    DynBuf packet;
+    DynBuf_Init(&packet);
 
-    // Start JSON object
-    offset += sprintf(packet + offset, "{ \"type\": \"combined\", ");
-    
-    // Helper macro to format JSON arrays for minterms
-    #define APPEND_ARR(key, tt) \
-        offset += sprintf(packet+offset, "\"%s\": [", key); \
-        for(int i=0; i<tt.count; i++) { \
-            offset += sprintf(packet+offset, "%d", tt.minterms[i]); \
-            if(i < tt.count-1) offset += sprintf(packet+offset, ","); \
-        } \
-        offset += sprintf(packet+offset, "], ");
-
-    APPEND_ARR("mintermsX", tX);
-    APPEND_ARR("mintermsY", tY);
-    APPEND_ARR("mintermsZ", tZ);
-    APPEND_ARR("mintermsW", tW);
+    // Start JSON object, then one minterm array per channel
+    DynBuf_AppendStr(&packet, "{ \"type\": \"combined\", \"mintermsX\": ");
+    DynBuf_AppendJsonIntArray(&packet, tX.minterms, tX.count);
+    DynBuf_AppendStr(&packet, ", \"mintermsY\": ");
+    DynBuf_AppendJsonIntArray(&packet, tY.minterms, tY.count);
+    DynBuf_AppendStr(&packet, ", \"mintermsZ\": ");
+    DynBuf_AppendJsonIntArray(&packet, tZ.minterms, tZ.count);
+    DynBuf_AppendStr(&packet, ", \"mintermsW\": ");
+    DynBuf_AppendJsonIntArray(&packet, tW.minterms, tW.count);
 
     // Append the netlist graph
-    offset += sprintf(packet+offset, "\"elements\": %s }", combined_netlist);
-
-    NetUDP_SendRaw(packet);
+    NetGraph graph;
+    if (Netlist_BuildCombinedGraph(&graph, "X", rX, "Y", rY, "Z", rZ, "W", rW)) {
+        append_netlist_update(session, &packet, &graph);
+    } else {
+        packet.failed = true;
+    }
+    if (!DynBuf_Ok(&packet)) printf(C_B_RED "[Combined] Out of memory building update" C_RESET "\n");
+    DynBuf_Free(&packet);
 
     // Clean up temporary trees
     if(rX) AST_Free(rX);
@@ -132,22 +239,33 @@ void Send_Combined_Update(const char* in_x, const char* in_y, const char* in_z,
  * Processes an equation for display without saving it to the persistent
  * app state. This allows users to type and see real-time updates
  * without overwriting their saved configuration.
+ *
+ * The expression becomes the session's scratch copy of its channel, so
+ * the combined view shows every channel the session is previewing on
+ * top of the saved equations, and other sessions keep seeing theirs.
  */
-void Process_Stateless(const char* label, const char* expression) {
+void Process_Stateless(Session* session, const char* label, const char* expression) {
     printf(C_B_CYAN "  [Stateless] Previewing %s: \"%s\"...\n" C_RESET, label, expression);
     
     // Run standard processing with "preview" mode tag
-    Process_Equation(label, expression, "preview");
+    Process_Equation(session, label, expression, "preview");
+
+    static const char* CHANNELS[SESSION_CHANNELS] = { "x", "y", "z", "w" };
+    for (int i = 0; i < SESSION_CHANNELS; i++) {
+        if (strcmp(label, CHANNELS[i]) == 0) Session_SetPreview(session, i, expression);
+    }
 
-    // Create a temporary view of the world where 'label' is replaced by 'expression'
-    // but other channels remain as they are in the state.
+    // Saved equations, with the session's scratch copies in their place
     SharedState st = AppState_GetSnapshot();
-    const char *x = st.input_x, *y = st.input_y, *z = st.input_z, *w = st.input_w;
-    
-    if (strcmp(label, "x") == 0) x = expression;
-    else if (strcmp(label, "y") == 0) y = expression;
-    else if (strcmp(label, "z") == 0) z = expression;
-    else if (strcmp(label, "w") == 0) w = expression;
+    char* view[SESSION_CHANNELS] = { st.input_x, st.input_y, st.input_z, st.input_w };
+    pthread_mutex_lock(&session->lock);
+    for (int i = 0; i < SESSION_CHANNELS; i++) {
+        if (session->preview[i][0] != '\0') {
+            strncpy(view[i], session->preview[i], sizeof(st.input_x) - 1);
+            view[i][sizeof(st.input_x) - 1] = '\0';
+        }
+    }
+    pthread_mutex_unlock(&session->lock);
 
-    Send_Combined_Update(x, y, z, w);
-}
\ No newline at end of file
+    Send_Combined_Update(session, view[0], view[1], view[2], view[3]);
+}
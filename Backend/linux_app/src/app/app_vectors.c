@@ -0,0 +1,180 @@
+/*
+ * File: app_vectors.c
+ * Version: 1.0.1
+ * Description:
+ * Binary test-vector files (see app_vectors.h). Files are mapped with
+ * MAP_PRIVATE and read front to back, so the kernel is told to read
+ * ahead and drop pages behind.
+ *
+ * Note: Version 1.0.1 creates VECTORS_DIR before writing into it.
+ */
+
+#include "app_vectors.h"
+#include "app_verification.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool Vectors_ResolvePath(const char* name, char* path, size_t size) {
+    if (!name || name[0] == '\0' || name[0] == '.' || strchr(name, '/')) return false;
+    int n = snprintf(path, size, "%s/%s", VECTORS_DIR, name);
+    return n > 0 && (size_t)n < size;
+}
+
+bool Vectors_Open(const char* path, VectorFile* file, const char** error) {
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        *error = "Cannot open file";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(VectorFileHeader)) {
+        close(fd);
+        *error = "Not a vector file";
+        return false;
+    }
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file open
+    if (map == MAP_FAILED) {
+        *error = "Cannot map file";
+        return false;
+    }
+
+    const VectorFileHeader* h = map;
+    int sections = 1 + ((h->flags & VECTORS_FLAG_EXPECTED) ? 1 : 0) + ((h->flags & VECTORS_FLAG_DURATIONS) ? 1 : 0);
+    uint64_t limit = ((uint64_t)st.st_size - sizeof(VectorFileHeader)) / sizeof(uint32_t) / (uint64_t)sections;
+    if (memcmp(h->magic, VECTORS_MAGIC, 4) != 0) {
+        *error = "Not a vector file";
+    } else if (h->version != VECTORS_VERSION) {
+        *error = "Unsupported vector file version";
+    } else if (h->count > limit) {
+        *error = "Vector file is truncated";
+    } else {
+        madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+        const uint32_t* words = (const uint32_t*)(h + 1);
+        file->map = map;
+        file->size = (size_t)st.st_size;
+        file->header = h;
+        file->count = (long long)h->count;
+        file->masks = words;
+        words += h->count;
+        if (h->flags & VECTORS_FLAG_EXPECTED) {
+            file->expected = words;
+            words += h->count;
+        }
+        if (h->flags & VECTORS_FLAG_DURATIONS) file->durations = words;
+        return true;
+    }
+    munmap(map, (size_t)st.st_size);
+    return false;
+}
+
+void Vectors_Close(VectorFile* file) {
+    if (file->map) munmap(file->map, file->size);
+    memset(file, 0, sizeof(*file));
+}
+
+bool Vectors_Write(const char* path, const uint32_t* masks, const uint32_t* expected,
+                   const uint32_t* durations, long long count, const char** error) {
+    VectorFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, VECTORS_MAGIC, 4);
+    h.version = VECTORS_VERSION;
+    h.output_bits = 4;
+    h.count = (uint64_t)count;
+
+    uint32_t used = 0;
+    for (long long i = 0; i < count; i++) {
+        used |= masks[i];
+        if (expected && expected[i] != VERIFICATION_NO_EXPECTED) h.flags |= VECTORS_FLAG_EXPECTED;
+        if (durations && durations[i] != 0) h.flags |= VECTORS_FLAG_DURATIONS;
+    }
+    while (h.input_bits < 32 && (used >> h.input_bits) != 0) h.input_bits++;
+
+    // The directory is not shipped; the first conversion creates it
+    size_t dir_len = strlen(VECTORS_DIR);
+    if (strncmp(path, VECTORS_DIR, dir_len) == 0 && path[dir_len] == '/' &&
+        mkdir(VECTORS_DIR, 0755) != 0 && errno != EEXIST) {
+        *error = "Cannot create the vectors directory";
+        return false;
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        *error = "Cannot create file";
+        return false;
+    }
+    size_t n = (size_t)count;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(masks, sizeof(uint32_t), n, f) == n;
+    if (ok && (h.flags & VECTORS_FLAG_EXPECTED)) ok = fwrite(expected, sizeof(uint32_t), n, f) == n;
+    if (ok && (h.flags & VECTORS_FLAG_DURATIONS)) ok = fwrite(durations, sizeof(uint32_t), n, f) == n;
+    if (fclose(f) != 0) ok = false;
+    if (!ok) {
+        remove(path);
+        *error = "Write failed";
+    }
+    return ok;
+}
+
+/*
+ * Function: read_text
+ * -------------------
+ * Reads a whole text file with line breaks turned into commas.
+ *
+ * returns: A heap string, or NULL.
+ */
+static char* read_text(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    char* text = NULL;
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+    if (size >= 0 && fseek(f, 0, SEEK_SET) == 0) text = malloc((size_t)size + 1);
+    if (text) {
+        size_t got = fread(text, 1, (size_t)size, f);
+        text[got] = '\0';
+        for (char* c = text; *c; c++) {
+            if (*c == '\n' || *c == '\r') *c = ',';
+        }
+    }
+    fclose(f);
+    return text;
+}
+
+bool Vectors_ConvertText(const char* text_path, const char* vector_path, long long* count, const char** error) {
+    *count = 0;
+    char* text = read_text(text_path);
+    if (!text) {
+        *error = "Cannot read text file";
+        return false;
+    }
+
+    TestSteps steps;
+    bool parsed = Verification_ParseSteps(text, &steps);
+    free(text);
+    if (!parsed) {
+        *error = "Out of memory";
+        return false;
+    }
+
+    // Durations are parsed as long long; the file stores milliseconds in 32 bits
+    uint32_t* durations = malloc((size_t)(steps.count > 0 ? steps.count : 1) * sizeof(uint32_t));
+    bool ok = durations != NULL;
+    if (!ok) *error = "Out of memory";
+    for (int i = 0; ok && i < steps.count; i++) {
+        long long ms = steps.durations[i];
+        durations[i] = ms < 0 ? 0 : (ms > (long long)UINT32_MAX ? UINT32_MAX : (uint32_t)ms);
+    }
+    if (ok) ok = Vectors_Write(vector_path, steps.masks, steps.expected, durations, steps.count, error);
+    if (ok) *count = steps.count;
+
+    free(durations);
+    Verification_FreeSteps(&steps);
+    return ok;
+}
@@ -1,18 +1,42 @@
 /*
  * File: app_verification.c
- * Version: 1.0.0
+ * Version: 1.7.3
  * Description:
  * Execution engine for the Automated Test Suite.
  * This module provides a software-in-the-loop verification capability,
  * allowing users to script input sequences and verify logic outputs
  * against expected behavior.
+ *
+ * Version 1.1.0 evaluates steps with the compiled simulator, 64 per
+ * sweep, and builds the report in a growable buffer (long sequences no
+ * longer overrun a fixed CSV buffer). Version 1.2.0 spreads long
+ * sequences over the shared thread pool (logic_par.h). Version 1.3.0
+ * adds stuck-at fault coverage of a test sequence (logic_fault.h).
+ * Version 1.4.0 adds generated stimulus runs (logic_stim.h). Version
+ * 1.5.0 checks all four outputs against expected values and streams
+ * only the mismatches, chunk by chunk. Version 1.6.0 runs memory-mapped
+ * vector files (app_vectors.h) through the same engine. Version 1.7.0
+ * dumps suite runs to the verify waveform capture (app_capture.h).
+ * Version 1.7.2 refuses sequential equations instead of simulating them
+ * as if registers were 0 and channel names free inputs. Version 1.7.3
+ * fails a run whose verify capture cannot open its trace.
  */
 
 #include "app_verification.h"
 #include "app_state.h"
 #include "logic_ast.h"
 #include "logic_parser.h"
-#include "net_udp.h"
+#include "logic_netlist.h"
+#include "logic_sim.h"
+#include "logic_par.h"
+#include "logic_fault.h"
+#include "logic_stim.h"
+#include "logic_seq.h"
+#include "app_vectors.h"
+#include "app_capture.h"
+#include "utils_buffer.h"
+#include "utils_colors.h"
+#include "utils_timer.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,70 +54,668 @@ static long long current_time_ms() {
     return spec.tv_sec * 1000 + spec.tv_nsec / 1.0e6;
 }
 
+static bool steps_push(TestSteps* list, uint32_t mask, long long duration, uint32_t expected) {
+    if (list->count == list->cap) {
+        int new_cap = list->cap ? list->cap * 2 : 64;
+        uint32_t* masks = realloc(list->masks, (size_t)new_cap * sizeof(uint32_t));
+        if (!masks) return false;
+        list->masks = masks;
+        long long* durations = realloc(list->durations, (size_t)new_cap * sizeof(long long));
+        if (!durations) return false;
+        list->durations = durations;
+        uint32_t* expect = realloc(list->expected, (size_t)new_cap * sizeof(uint32_t));
+        if (!expect) return false;
+        list->expected = expect;
+        list->cap = new_cap;
+    }
+    list->masks[list->count] = mask;
+    list->durations[list->count] = duration;
+    list->expected[list->count] = expected;
+    list->count++;
+    return true;
+}
+
+/*
+ * Function: parse_step
+ * --------------------
+ * Parses one "Mask:Duration[:Expected]" entry.
+ *
+ * returns: false if the entry is malformed.
+ */
+static bool parse_step(const char* pair, uint32_t* mask, long long* duration, uint32_t* expected) {
+    int input_mask = 0;
+    int ms = 0;
+    int expect = 0;
+    int fields = sscanf(pair, "%d:%d:%d", &input_mask, &ms, &expect);
+    if (fields < 2) return false;
+    *mask = (uint32_t)input_mask;
+    *duration = ms;
+    *expected = (fields == 3 && expect >= 0) ? (uint32_t)expect : VERIFICATION_NO_EXPECTED;
+    return true;
+}
+
+bool Verification_ParseSteps(const char* test_sequence, TestSteps* steps) {
+    memset(steps, 0, sizeof(*steps));
+    char* seq_copy = strdup(test_sequence);
+    if (!seq_copy) return false;
+
+    bool ok = true;
+    char* save = NULL;
+    for (char* pair = strtok_r(seq_copy, ",", &save); ok && pair != NULL; pair = strtok_r(NULL, ",", &save)) {
+        uint32_t mask, expected;
+        long long duration;
+        if (parse_step(pair, &mask, &duration, &expected)) ok = steps_push(steps, mask, duration, expected);
+    }
+    free(seq_copy);
+    if (!ok) Verification_FreeSteps(steps);
+    return ok;
+}
+
+void Verification_FreeSteps(TestSteps* steps) {
+    free(steps->masks);
+    free(steps->durations);
+    free(steps->expected);
+    memset(steps, 0, sizeof(*steps));
+}
+
+// --- Test Suites ---
+
+static const char CHANNEL_NAMES[4] = { 'X', 'Y', 'Z', 'W' };
+
+/*
+ * Struct: SuiteReport
+ * -------------------
+ * Running totals of a suite plus the mismatches not yet sent.
+ */
+typedef struct {
+    VerificationSink sink;
+    void* ctx;
+    int channel_output[4];  // Program output of each channel, or -1
+    uint32_t present;       // Channels the program has
+    DynBuf pending;         // Mismatch entries, comma-separated
+    int chunks;             // "partial" packets sent
+    long long start;        // Timer_GetNanos() at suite_begin
+    long long time;         // Start time of the next step (ms)
+    long long steps;
+    long long checked;
+    long long failed;
+    long long listed;
+    long long output_failures[4];
+    TraceWriter* trace;      // Waveform capture of this run, or NULL
+    int trace_vars[SIM_MAX_VARS];  // Variable behind each traced input
+    int trace_inputs;
+} SuiteReport;
+
+static void write_channels(DynBuf* out, uint32_t channels) {
+    DynBuf_AppendChar(out, '"');
+    for (int c = 0; c < 4; c++) {
+        if ((channels >> c) & 1) DynBuf_AppendChar(out, CHANNEL_NAMES[c]);
+    }
+    DynBuf_AppendChar(out, '"');
+}
+
+static void flush_mismatches(SuiteReport* r) {
+    DynBuf packet;
+    DynBuf_Init(&packet);
+    DynBuf_AppendStr(&packet, "{ \"type\": \"verify\", \"status\": \"partial\", \"chunk\": ");
+    DynBuf_AppendInt(&packet, r->chunks++);
+    DynBuf_AppendStr(&packet, ", \"mismatches\": [");
+    if (r->pending.len > 0) DynBuf_Append(&packet, r->pending.data, r->pending.len);
+    DynBuf_AppendStr(&packet, "] }");
+    if (DynBuf_Ok(&packet)) r->sink(packet.data, r->ctx);
+    DynBuf_Free(&packet);
+    DynBuf_Reset(&r->pending);
+}
+
+static void add_mismatch(SuiteReport* r, long long step, long long time, uint32_t mask,
+                         uint32_t expected, uint32_t actual) {
+    if (r->listed >= VERIFICATION_MISMATCH_LIST_MAX) return;
+    r->listed++;
+
+    DynBuf* out = &r->pending;
+    if (out->len > 0) DynBuf_AppendStr(out, ", ");
+    DynBuf_AppendStr(out, "{ \"step\": ");
+    DynBuf_AppendInt(out, step);
+    DynBuf_AppendStr(out, ", \"time\": ");
+    DynBuf_AppendInt(out, time);
+    DynBuf_AppendStr(out, ", \"inputs\": ");
+    DynBuf_AppendUInt(out, mask);
+    DynBuf_AppendStr(out, ", \"expected\": ");
+    DynBuf_AppendUInt(out, expected);
+    DynBuf_AppendStr(out, ", \"actual\": ");
+    DynBuf_AppendUInt(out, actual);
+    DynBuf_AppendStr(out, ", \"diff\": ");
+    write_channels(out, expected ^ actual);
+    DynBuf_AppendStr(out, " }");
+    if (out->len >= VERIFICATION_PACKET_BYTES) flush_mismatches(r);
+}
+
+static void send_suite_error(VerificationSink sink, void* ctx, const char* message) {
+    DynBuf packet;
+    DynBuf_Init(&packet);
+    DynBuf_AppendStr(&packet, "{ \"type\": \"verify\", \"status\": \"error\", \"message\": ");
+    DynBuf_AppendJsonString(&packet, message);
+    DynBuf_AppendStr(&packet, " }");
+    if (DynBuf_Ok(&packet)) sink(packet.data, ctx);
+    DynBuf_Free(&packet);
+}
+
+/*
+ * Function: suite_begin
+ * ---------------------
+ * Prepares 'r' for a suite against 'p'.
+ *
+ * returns: false (after sending the error) if 'p' has no channels or
+ *          the verify capture cannot open its trace.
+ */
+static bool suite_begin(SuiteReport* r, const SimProgram* p, VerificationSink sink, void* ctx) {
+    memset(r, 0, sizeof(*r));
+    r->sink = sink;
+    r->ctx = ctx;
+    DynBuf_Init(&r->pending);
+
+    // Result bit i is program output i; reports use bit c = CHANNEL_NAMES[c]
+    for (int c = 0; c < 4; c++) {
+        char name[2] = { CHANNEL_NAMES[c], '\0' };
+        r->channel_output[c] = Sim_FindOutput(p, name);
+        if (r->channel_output[c] >= 0) r->present |= 1u << c;
+    }
+    if (r->present == 0) {
+        send_suite_error(sink, ctx, "No outputs programmed");
+        return false;
+    }
+
+    // Trace signals: the inputs, the outputs present, then "mismatch"
+    const char* error = NULL;
+    r->trace = Capture_BeginRun(CAPTURE_VERIFY, -3, &error);
+    if (error) {
+        send_suite_error(sink, ctx, error);
+        return false;
+    }
+    if (r->trace) {
+        for (uint32_t vars = p->var_mask; vars; vars &= vars - 1) {
+            char name[2] = { (char)('A' + __builtin_ctz(vars)), '\0' };
+            r->trace_vars[r->trace_inputs++] = __builtin_ctz(vars);
+            TraceWriter_AddSignal(r->trace, name);
+        }
+        for (int c = 0; c < 4; c++) {
+            char name[2] = { CHANNEL_NAMES[c], '\0' };
+            if (r->channel_output[c] >= 0) TraceWriter_AddSignal(r->trace, name);
+        }
+        TraceWriter_AddSignal(r->trace, "mismatch");
+    }
+    r->start = Timer_GetNanos();
+    return true;
+}
+
+/*
+ * Function: trace_step
+ * --------------------
+ * Samples one step into the run's waveform capture.
+ */
+static void trace_step(SuiteReport* r, uint64_t time, uint32_t mask, uint32_t actual, bool mismatch) {
+    uint64_t values = 0;
+    int bit = 0;
+    for (; bit < r->trace_inputs; bit++) values |= (uint64_t)((mask >> r->trace_vars[bit]) & 1u) << bit;
+    for (int c = 0; c < 4; c++) {
+        if (r->channel_output[c] >= 0) values |= (uint64_t)((actual >> c) & 1u) << bit++;
+    }
+    values |= (uint64_t)mismatch << bit;
+    TraceWriter_Sample(r->trace, time, values);
+}
+
+/*
+ * Function: suite_chunk
+ * ---------------------
+ * Evaluates up to VERIFICATION_CHUNK_STEPS steps across the pool and
+ * records their mismatches. 'expected' and 'durations' may be NULL.
+ *
+ * results: Scratch space for 'count' words.
+ */
+static void suite_chunk(SuiteReport* r, SimProgram* p, const uint32_t* masks, const uint32_t* expected,
+                        const uint32_t* durations, int count, uint32_t* results) {
+    Par_EvaluateBatch(Par_SharedPool(), p, masks, count, results);
+
+    for (int i = 0; i < count; i++, r->steps++) {
+        long long time = r->time;
+        if (durations) r->time += durations[i];
+        bool check = expected && expected[i] != VERIFICATION_NO_EXPECTED;
+        if (!check && !r->trace) continue;
+
+        uint32_t actual = 0;
+        for (int c = 0; c < 4; c++) {
+            if (r->channel_output[c] >= 0) actual |= ((results[i] >> r->channel_output[c]) & 1u) << c;
+        }
+        uint32_t want = check ? expected[i] & r->present : actual;
+        if (r->trace) trace_step(r, durations ? (uint64_t)time : (uint64_t)r->steps, masks[i], actual, actual != want);
+        if (!check) continue;
+
+        r->checked++;
+        if (actual == want) continue;
+
+        r->failed++;
+        for (int c = 0; c < 4; c++) r->output_failures[c] += ((actual ^ want) >> c) & 1u;
+        add_mismatch(r, r->steps, time, masks[i], want, actual);
+    }
+}
+
+/*
+ * Function: suite_end
+ * -------------------
+ * Sends the summary packet with the remaining mismatches and releases 'r'.
+ */
+static void suite_end(SuiteReport* r) {
+    long long elapsed = Timer_GetNanos() - r->start;
+    if (r->trace) Capture_EndRun(CAPTURE_VERIFY);
+
+    DynBuf packet;
+    DynBuf_Init(&packet);
+    DynBuf_AppendStr(&packet, "{ \"type\": \"verify\", \"status\": ");
+    DynBuf_AppendStr(&packet, r->failed ? "\"fail\"" : "\"pass\"");
+    DynBuf_AppendStr(&packet, ", \"outputs\": ");
+    write_channels(&packet, r->present);
+    DynBuf_AppendStr(&packet, ", \"steps\": ");
+    DynBuf_AppendInt(&packet, r->steps);
+    DynBuf_AppendStr(&packet, ", \"checked\": ");
+    DynBuf_AppendInt(&packet, r->checked);
+    DynBuf_AppendStr(&packet, ", \"passed\": ");
+    DynBuf_AppendInt(&packet, r->checked - r->failed);
+    DynBuf_AppendStr(&packet, ", \"failed\": ");
+    DynBuf_AppendInt(&packet, r->failed);
+    DynBuf_AppendStr(&packet, ", \"output_failures\": {");
+    for (int c = 0, first = 1; c < 4; c++) {
+        if (!((r->present >> c) & 1)) continue;
+        DynBuf_AppendStr(&packet, first ? " \"" : ", \"");
+        DynBuf_AppendChar(&packet, CHANNEL_NAMES[c]);
+        DynBuf_AppendStr(&packet, "\": ");
+        DynBuf_AppendInt(&packet, r->output_failures[c]);
+        first = 0;
+    }
+    DynBuf_AppendStr(&packet, " }, \"duration_ms\": ");
+    DynBuf_AppendInt(&packet, r->time);
+    DynBuf_AppendStr(&packet, ", \"elapsed_us\": ");
+    DynBuf_AppendInt(&packet, elapsed / 1000);
+    DynBuf_AppendStr(&packet, ", \"chunks\": ");
+    DynBuf_AppendInt(&packet, r->chunks);
+    DynBuf_AppendStr(&packet, ", \"listed\": ");
+    DynBuf_AppendInt(&packet, r->listed);
+    DynBuf_AppendStr(&packet, ", \"mismatches\": [");
+    if (r->pending.len > 0) DynBuf_Append(&packet, r->pending.data, r->pending.len);
+    DynBuf_AppendStr(&packet, "] }");
+
+    if (DynBuf_Ok(&packet) && !r->pending.failed) {  // No mismatches: never allocated
+        r->sink(packet.data, r->ctx);
+    } else {
+        send_suite_error(r->sink, r->ctx, "Out of memory");
+    }
+    DynBuf_Free(&packet);
+    DynBuf_Free(&r->pending);
+}
+
+/*
+ * Function: suite_abort
+ * ---------------------
+ * Ends a suite with an error packet instead of the summary.
+ */
+static void suite_abort(SuiteReport* r, const char* message) {
+    if (r->trace) Capture_EndRun(CAPTURE_VERIFY);
+    DynBuf_Free(&r->pending);
+    send_suite_error(r->sink, r->ctx, message);
+}
+
+void Verification_CheckProgram(SimProgram* p, const char* test_sequence,
+                               VerificationSink sink, void* ctx) {
+    SuiteReport r;
+    if (!suite_begin(&r, p, sink, ctx)) return;
+
+    char* seq_copy = strdup(test_sequence ? test_sequence : "");
+    uint32_t* masks = malloc(VERIFICATION_CHUNK_STEPS * sizeof(uint32_t));
+    uint32_t* expected = malloc(VERIFICATION_CHUNK_STEPS * sizeof(uint32_t));
+    uint32_t* durations = malloc(VERIFICATION_CHUNK_STEPS * sizeof(uint32_t));
+    uint32_t* results = malloc(VERIFICATION_CHUNK_STEPS * sizeof(uint32_t));
+    if (seq_copy && masks && expected && durations && results) {
+        char* save = NULL;
+        char* pair = strtok_r(seq_copy, ",", &save);
+        while (pair != NULL) {
+            int count = 0;
+            for (; pair != NULL && count < VERIFICATION_CHUNK_STEPS; pair = strtok_r(NULL, ",", &save)) {
+                long long duration;
+                if (!parse_step(pair, &masks[count], &duration, &expected[count])) continue;
+                durations[count++] = duration > 0 ? (uint32_t)duration : 0;
+            }
+            suite_chunk(&r, p, masks, expected, durations, count, results);
+        }
+        suite_end(&r);
+    } else {
+        suite_abort(&r, "Out of memory");
+    }
+
+    free(seq_copy);
+    free(masks);
+    free(expected);
+    free(durations);
+    free(results);
+}
+
+void Verification_CheckVectors(SimProgram* p, const VectorFile* file, VerificationSink sink, void* ctx) {
+    SuiteReport r;
+    if (!suite_begin(&r, p, sink, ctx)) return;
+
+    uint32_t* results = malloc(VERIFICATION_CHUNK_STEPS * sizeof(uint32_t));
+    if (!results) {
+        suite_abort(&r, "Out of memory");
+        return;
+    }
+    // The mapped sections are fed to the simulator in place
+    for (long long at = 0; at < file->count; at += VERIFICATION_CHUNK_STEPS) {
+        long long left = file->count - at;
+        int count = left < VERIFICATION_CHUNK_STEPS ? (int)left : VERIFICATION_CHUNK_STEPS;
+        suite_chunk(&r, p, file->masks + at, file->expected ? file->expected + at : NULL,
+                    file->durations ? file->durations + at : NULL, count, results);
+    }
+    suite_end(&r);
+    free(results);
+}
+
 /*
- * Function: Verification_RunSuite
- * -------------------------------
- * Parses a comma-separated test vector string and executes the simulation.
- * * Sequence Format: "InputMask:Duration, InputMask:Duration"
- * Example: "0:100, 1:50" -> Input 0 for 100ms, then Input 1 for 50ms.
+ * Function: any_sequential
+ * ------------------------
+ * returns: true if any of the four channel trees holds a register or a
+ *          channel reference. The combinational simulator would read a
+ *          register as 0 and a channel name as a free input, so such
+ *          circuits are refused rather than reported on wrongly.
+ */
+static bool any_sequential(LogicNode* const roots[4]) {
+    for (int i = 0; i < 4; i++) {
+        if (Seq_IsSequential(roots[i])) return true;
+    }
+    return false;
+}
+
+/*
+ * Function: compile_channels
+ * --------------------------
+ * Compiles all four programmed channels into 'prog'.
  *
- * Logic Flow:
- * 1. Snapshot the current logic equations from AppState.
- * 2. Parse them into ASTs.
- * 3. Iterate through the test vector steps.
- * 4. Evaluate ASTs for each step and log the result.
- * 5. Package results as a CSV inside a JSON packet.
+ * returns: NULL, or why nothing was compiled (nothing to free then).
  */
-void Verification_RunSuite(const char* test_sequence) {
+static const char* compile_channels(SimProgram* prog) {
+    SharedState st = AppState_GetSnapshot();
+    LogicNode* roots[4] = {
+        Parser_ParseString(st.input_x), Parser_ParseString(st.input_y),
+        Parser_ParseString(st.input_z), Parser_ParseString(st.input_w)
+    };
+
+    NetGraph graph;
+    const char* error = "Out of memory";
+    if (any_sequential(roots)) {
+        error = SEQ_COMBINATIONAL_ONLY;
+    } else if (Netlist_BuildCombinedGraph(&graph, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3])) {
+        if (Sim_Compile(&graph, prog)) error = NULL;
+        Graph_Free(&graph);
+    }
+    for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+    return error;
+}
+
+void Verification_RunSuite(const char* test_sequence, VerificationSink sink, void* ctx) {
     printf("[Verification] Starting Test Suite...\n");
 
+    SimProgram prog;
+    const char* error = compile_channels(&prog);
+    if (!error) {
+        Verification_CheckProgram(&prog, test_sequence, sink, ctx);
+        Sim_Free(&prog);
+        printf("[Verification] Test Suite Completed.\n");
+    } else {
+        printf(C_B_RED "[Verification] Test suite not run: %s" C_RESET "\n", error);
+        send_suite_error(sink, ctx, error);
+    }
+}
+
+void Verification_RunFile(const char* name, VerificationSink sink, void* ctx) {
+    char path[VECTORS_PATH_MAX];
+    VectorFile file;
+    const char* error = NULL;
+    if (!Vectors_ResolvePath(name, path, sizeof(path))) {
+        error = "Invalid file name";
+    } else if (!Vectors_Open(path, &file, &error)) {
+        // 'error' set by Vectors_Open
+    } else {
+        SimProgram prog;
+        error = compile_channels(&prog);
+        if (!error) {
+            printf("[Verification] Running %s (%lld steps)\n", path, file.count);
+            Verification_CheckVectors(&prog, &file, sink, ctx);
+            Sim_Free(&prog);
+        }
+        Vectors_Close(&file);
+    }
+    if (error) send_suite_error(sink, ctx, error);
+}
+
+// --- Fault Coverage ---
+
+/*
+ * Function: exhaustive_steps
+ * --------------------------
+ * Every combination of the variables in 'var_mask', as test steps.
+ */
+static bool exhaustive_steps(uint32_t var_mask, TestSteps* steps) {
+    memset(steps, 0, sizeof(*steps));
+    uint32_t m = 0;
+    do {
+        if (!steps_push(steps, m, 0, VERIFICATION_NO_EXPECTED)) {
+            Verification_FreeSteps(steps);
+            return false;
+        }
+        m = (m - var_mask) & var_mask;  // Next subset of var_mask
+    } while (m != 0);
+    return true;
+}
+
+static void write_fault(DynBuf* out, const NetGraph* g, const Fault* f) {
+    const GraphNode* node = &g->nodes[f->node];
+    DynBuf_AppendStr(out, "{ \"node\": \"n");
+    DynBuf_AppendUInt(out, node->id);
+    DynBuf_AppendStr(out, "\", \"label\": ");
+    DynBuf_AppendJsonString(out, node->label);
+    if (f->pin == FAULT_PIN_OUT) {
+        DynBuf_AppendStr(out, ", \"pin\": \"out\"");
+    } else {
+        // The faulty pin is edge "e<from>_<node>_<pin>" of the netlist
+        DynBuf_AppendStr(out, ", \"pin\": ");
+        DynBuf_AppendInt(out, f->pin);
+        DynBuf_AppendStr(out, ", \"from\": \"n");
+        DynBuf_AppendUInt(out, g->nodes[Graph_NodeInput(g, f->node, f->pin)].id);
+        DynBuf_AppendChar(out, '"');
+    }
+    DynBuf_AppendStr(out, ", \"stuck\": ");
+    DynBuf_AppendInt(out, f->stuck);
+    DynBuf_AppendStr(out, ", \"equivalent\": ");
+    DynBuf_AppendInt(out, f->class_size);
+    DynBuf_AppendStr(out, " }");
+}
+
+void Verification_FaultCoverage(const char* test_sequence, DynBuf* out) {
     SharedState st = AppState_GetSnapshot();
-    LogicNode* rootX = Parser_ParseString(st.input_x);
-    LogicNode* rootY = Parser_ParseString(st.input_y);
+    LogicNode* roots[4] = {
+        Parser_ParseString(st.input_x), Parser_ParseString(st.input_y),
+        Parser_ParseString(st.input_z), Parser_ParseString(st.input_w)
+    };
 
-    // Allocate buffer for CSV data (Time, Mask, X, Y)
-    char* csv_data = malloc(65536); 
-    int offset = 0;
-    
-    // Write Header (Note: \\n is used to escape newline for JSON transport)
-    offset += sprintf(csv_data + offset, "Time,Mask,X,Y\\n");
+    NetGraph graph;
+    bool built = false;
+    const char* error = SEQ_COMBINATIONAL_ONLY;
+    if (!any_sequential(roots)) {
+        built = Netlist_BuildCombinedGraph(&graph, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3]);
+        error = built ? NULL : "Out of memory";
+    }
 
-    char* seq_copy = strdup(test_sequence);
-    char* pair = strtok(seq_copy, ",");
-    long long accumulated_time = 0;
-
-    // Iterate over "Mask:Duration" pairs
-    while (pair != NULL) {
-        int input_mask = 0;
-        int duration = 0;
-        
-        if (sscanf(pair, "%d:%d", &input_mask, &duration) == 2) {
-            // Evaluate Logic
-            bool resX = rootX ? AST_Evaluate(rootX, input_mask) : false;
-            bool resY = rootY ? AST_Evaluate(rootY, input_mask) : false;
-
-            // Log Record
-            offset += sprintf(csv_data + offset, "%lld,%d,%d,%d\\n",
-                              accumulated_time, input_mask, resX, resY);
-            
-            accumulated_time += duration;
+    // Without vectors: every combination of the variables the circuit reads
+    uint32_t var_mask = 0;
+    for (int i = 0; built && i < graph.node_count; i++) {
+        int v = graph.nodes[i].label[0] - 'A';
+        if (graph.nodes[i].kind == NETLIST_NODE_VAR && v >= 0 && v < 32) var_mask |= 1u << v;
+    }
+    bool exhaustive = (test_sequence == NULL || test_sequence[0] == '\0');
+    TestSteps steps;
+    bool have_steps = false;
+    if (!error && exhaustive && __builtin_popcount(var_mask) > VERIFICATION_FAULT_EXHAUSTIVE_VARS) {
+        error = "Too many inputs to test exhaustively; give test vectors";
+    } else if (!error) {
+        have_steps = exhaustive ? exhaustive_steps(var_mask, &steps) : Verification_ParseSteps(test_sequence, &steps);
+        if (!have_steps) error = "Out of memory";
+    }
+
+    FaultList faults;
+    bool have_faults = false;
+    long long start = Timer_GetNanos();
+    if (!error) {
+        have_faults = Fault_Enumerate(&graph, true, &faults);
+        if (!have_faults || !Fault_Simulate(&graph, &faults, steps.masks, steps.count)) error = "Out of memory";
+    }
+    long long elapsed = Timer_GetNanos() - start;
+
+    if (error) {
+        DynBuf_AppendStr(out, "{ \"type\": \"faults\", \"status\": \"error\", \"message\": ");
+        DynBuf_AppendJsonString(out, error);
+        DynBuf_AppendStr(out, " }");
+    } else {
+        char coverage[32];
+        snprintf(coverage, sizeof(coverage), "%.4f", Fault_Coverage(&faults));
+
+        DynBuf_AppendStr(out, "{ \"type\": \"faults\", \"status\": \"ok\", \"exhaustive\": ");
+        DynBuf_AppendJsonBool(out, exhaustive);
+        DynBuf_AppendStr(out, ", \"vectors\": ");
+        DynBuf_AppendInt(out, steps.count);
+        DynBuf_AppendStr(out, ", \"faults\": ");
+        DynBuf_AppendInt(out, faults.total);
+        DynBuf_AppendStr(out, ", \"collapsed\": ");
+        DynBuf_AppendInt(out, faults.count);
+        DynBuf_AppendStr(out, ", \"detected\": ");
+        DynBuf_AppendInt(out, faults.detected_total);
+        DynBuf_AppendStr(out, ", \"coverage\": ");
+        DynBuf_AppendStr(out, coverage);
+        DynBuf_AppendStr(out, ", \"elapsed_us\": ");
+        DynBuf_AppendInt(out, elapsed / 1000);
+        DynBuf_AppendStr(out, ", \"undetected\": [");
+        int listed = 0;
+        for (int i = 0; i < faults.count && listed < VERIFICATION_FAULT_LIST_MAX; i++) {
+            if (faults.faults[i].detected) continue;
+            if (listed++ > 0) DynBuf_AppendStr(out, ", ");
+            write_fault(out, &graph, &faults.faults[i]);
         }
-        pair = strtok(NULL, ",");
+        DynBuf_AppendStr(out, "], \"undetected_count\": ");
+        DynBuf_AppendInt(out, faults.count - faults.detected);
+        DynBuf_AppendStr(out, " }");
+        printf("[Verification] Fault coverage %s over %d vectors\n", coverage, steps.count);
     }
 
-    printf("[Verification] Test Suite Completed Successfully.\n");
+    if (have_faults) Fault_Free(&faults);
+    if (have_steps) Verification_FreeSteps(&steps);
+    if (built) Graph_Free(&graph);
+    for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+}
 
-    // Construct Result Packet
-    char* packet = malloc(70000);
-    sprintf(packet, "{ \"type\": \"verification\", \"status\": \"success\", \"csv\": \"%s\" }", csv_data);
-    
-    // Send to frontend
-    NetUDP_SendRaw(packet);
+// --- Generated Stimulus ---
 
-    // Cleanup resources
-    free(csv_data);
-    free(packet);
-    free(seq_copy);
-    if (rootX) AST_Free(rootX);
-    if (rootY) AST_Free(rootY);
-}
\ No newline at end of file
+/*
+ * Function: parse_stimulus
+ * ------------------------
+ * Fills 'cfg' from "<mode> [vectors] [seed] [p1,p2,...]" for a circuit
+ * reading the variables in 'var_mask'.
+ *
+ * returns: An error message, or NULL.
+ */
+static const char* parse_stimulus(const char* args, uint32_t var_mask, StimConfig* cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->var_mask = var_mask;
+    cfg->seed = 1;
+
+    char mode[16] = "";
+    long long vectors = -1;
+    unsigned long long seed = 1;
+    char weights[128] = "";
+    int fields = sscanf(args, "%15s %lld %llu %127s", mode, &vectors, &seed, weights);
+    if (fields < 1 || !Stim_ModeFromName(mode, &cfg->mode)) {
+        return "Unknown mode (expected exhaustive, gray, lfsr, weighted or walking)";
+    }
+    if (fields >= 3) cfg->seed = seed;
+
+    int n = __builtin_popcount(var_mask);
+    if (fields >= 2 && vectors >= 0) {
+        cfg->count = vectors;
+    } else if (cfg->mode == STIM_EXHAUSTIVE || cfg->mode == STIM_GRAY) {
+        cfg->count = 1LL << n;
+    } else if (cfg->mode == STIM_WALKING) {
+        cfg->count = n;
+    } else {
+        cfg->count = VERIFICATION_STIM_DEFAULT_VECTORS;
+    }
+    if (cfg->count > STIM_MAX_VECTORS) return "Too many vectors";
+
+    // Percentages are listed by variable (A first); input j is the j-th used one
+    int percent[SIM_MAX_VARS];
+    int listed = 0;
+    char* save = NULL;
+    for (char* tok = strtok_r(weights, ",", &save); tok && listed < SIM_MAX_VARS; tok = strtok_r(NULL, ",", &save)) {
+        int pct = atoi(tok);
+        percent[listed++] = pct < 0 ? 0 : (pct > 100 ? 100 : pct);
+    }
+    int j = 0;
+    for (uint32_t vars = var_mask; vars; vars &= vars - 1, j++) {
+        int v = __builtin_ctz(vars);
+        int pct = listed == 0 ? 50 : percent[v < listed ? v : listed - 1];
+        cfg->weight[j] = (uint16_t)((pct * 256 + 50) / 100);
+    }
+    return NULL;
+}
+
+void Verification_RunStimulus(const char* args, DynBuf* out) {
+    SimProgram prog;
+    const char* error = compile_channels(&prog);
+    bool compiled = (error == NULL);
+
+    StimConfig cfg;
+    if (!error) error = parse_stimulus(args ? args : "", prog.var_mask, &cfg);
+
+    StimStats stats;
+    long long start = Timer_GetNanos();
+    if (!error && !Stim_Run(Par_SharedPool(), &prog, &cfg, &stats)) error = "Out of memory";
+    long long elapsed = Timer_GetNanos() - start;
+
+    if (error) {
+        DynBuf_AppendStr(out, "{ \"type\": \"stim\", \"status\": \"error\", \"message\": ");
+        DynBuf_AppendJsonString(out, error);
+        DynBuf_AppendStr(out, " }");
+    } else {
+        DynBuf_AppendStr(out, "{ \"type\": \"stim\", \"status\": \"ok\", \"mode\": ");
+        DynBuf_AppendJsonString(out, Stim_ModeName(cfg.mode));
+        DynBuf_AppendStr(out, ", \"inputs\": ");
+        DynBuf_AppendInt(out, __builtin_popcount(prog.var_mask));
+        DynBuf_AppendStr(out, ", \"vectors\": ");
+        DynBuf_AppendInt(out, stats.vectors);
+        DynBuf_AppendStr(out, ", \"seed\": ");
+        DynBuf_AppendUInt(out, cfg.seed);
+        DynBuf_AppendStr(out, ", \"outputs\": [");
+        for (int i = 0; i < stats.output_count; i++) {
+            if (i > 0) DynBuf_AppendStr(out, ", ");
+            DynBuf_AppendStr(out, "{ \"name\": ");
+            DynBuf_AppendJsonString(out, prog.outputs[i].name);
+            DynBuf_AppendStr(out, ", \"ones\": ");
+            DynBuf_AppendInt(out, stats.ones[i]);
+            DynBuf_AppendStr(out, ", \"toggles\": ");
+            DynBuf_AppendInt(out, stats.toggles[i]);
+            DynBuf_AppendStr(out, " }");
+        }
+        DynBuf_AppendStr(out, "], \"elapsed_us\": ");
+        DynBuf_AppendInt(out, elapsed / 1000);
+        DynBuf_AppendStr(out, ", \"vectors_per_sec\": ");
+        DynBuf_AppendInt(out, elapsed > 0 ? (long long)((double)stats.vectors * 1e9 / (double)elapsed) : 0);
+        DynBuf_AppendStr(out, " }");
+        printf("[Verification] Stimulus '%s': %lld vectors in %lld us\n", Stim_ModeName(cfg.mode), stats.vectors, elapsed / 1000);
+    }
+
+    if (compiled) Sim_Free(&prog);
+}
@@ -1,8 +1,9 @@
 /*
  * File: logic_ast.c
- * Version: 1.1.0
+ * Version: 1.2.0
  * Description:
  * Updated evaluation logic for NAND/NOR.
+ * Registers (NODE_DFF) evaluate to their reset value.
  */
 
 #include "logic_ast.h"
@@ -51,10 +52,11 @@ void AST_Print(LogicNode* root, int level) {
         case NODE_NOT:  printf(C_B_RED "NOT" C_RESET "\n"); break;
         case NODE_NAND: printf(C_B_RED "NAND" C_RESET "\n"); break; // New
         case NODE_NOR:  printf(C_B_MAGENTA "NOR" C_RESET "\n"); break; // New
+        case NODE_DFF:  printf(C_B_CYAN "DFF" C_RESET "\n"); break;
         default:        printf("OP(%d)\n", root->type); break;
     }
 
-    if (root->type == NODE_NOT) {
+    if (root->type == NODE_NOT || root->type == NODE_DFF) {
         AST_Print(root->left, level + 1); 
     } else if (root->type != NODE_VAR) {
         AST_Print(root->left, level + 1);
@@ -70,6 +72,7 @@ bool AST_Evaluate(LogicNode* root, int input_mask) {
         if (index < 0 || index > 31) return false;
         return (input_mask >> index) & 1;
     }
+    if (root->type == NODE_DFF) return false; // Reset state; only logic_seq clocks registers
 
     bool left  = AST_Evaluate(root->left, input_mask);
     bool right = AST_Evaluate(root->right, input_mask);
@@ -0,0 +1,367 @@
+/*
+ * File: logic_cnf.c
+ * Version: 1.0.0
+ * Description:
+ * Tseitin encoder from NetGraphs to CNF (see logic_cnf.h).
+ *
+ * Constants are folded while encoding (an AND with a false input is
+ * false, a true input is dropped, ...), so the unprogrammed corners of a
+ * circuit never reach the solver.
+ */
+
+#include "logic_cnf.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool Cnf_Init(CnfEncoder* e, SatSolver* solver) {
+    memset(e, 0, sizeof(*e));
+    e->solver = solver;
+    for (int i = 0; i < CNF_MAX_VARS; i++) e->input_var[i] = -1;
+
+    int v = Sat_NewVar(solver);
+    if (v < 0) return false;
+    e->true_lit = SAT_LIT(v, false);
+    Sat_AddClause(solver, &e->true_lit, 1);
+    return !solver->failed;
+}
+
+void Cnf_Free(CnfEncoder* e) {
+    free(e->gates);
+    free(e->table);
+    free(e->var_gate);
+    free(e->leaves);
+    e->gates = NULL;
+    e->table = NULL;
+    e->var_gate = NULL;
+    e->leaves = NULL;
+    e->gate_count = e->gate_cap = e->table_cap = e->var_gate_cap = e->leaf_cap = 0;
+}
+
+int Cnf_InputLit(CnfEncoder* e, int var) {
+    if (var < 0 || var >= CNF_MAX_VARS) return SAT_NOT(e->true_lit);
+    if (e->input_var[var] < 0) e->input_var[var] = Sat_NewVar(e->solver);
+    return e->input_var[var] < 0 ? -1 : SAT_LIT(e->input_var[var], false);
+}
+
+// --- Structural Hashing ---
+
+static uint32_t gate_hash(int op, int a, int b) {
+    uint64_t h = ((uint64_t)(uint32_t)a << 32 | (uint32_t)b) * 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)(h >> 32) ^ (uint32_t)op;
+}
+
+static bool table_grow(CnfEncoder* e) {
+    int new_cap = e->table_cap ? e->table_cap * 2 : 256;
+    int* table = malloc((size_t)new_cap * sizeof(int));
+    if (!table) return false;
+    for (int i = 0; i < new_cap; i++) table[i] = -1;
+    for (int i = 0; i < e->gate_count; i++) {
+        const CnfGate* gate = &e->gates[i];
+        int slot = (int)(gate_hash(gate->op, gate->a, gate->b) & (uint32_t)(new_cap - 1));
+        while (table[slot] >= 0) slot = (slot + 1) & (new_cap - 1);
+        table[slot] = i;
+    }
+    free(e->table);
+    e->table = table;
+    e->table_cap = new_cap;
+    return true;
+}
+
+/*
+ * Function: find_or_add
+ * ---------------------
+ * Looks up the gate (op, a, b), a < b; if it is new, allocates its output
+ * variable and lets 'clauses' constrain it.
+ *
+ * returns: The gate's output literal, or -1 if memory ran out.
+ */
+static int find_or_add(CnfEncoder* e, int op, int a, int b, bool (*clauses)(CnfEncoder*, int, int, int)) {
+    // Keep the table at most half full
+    if (2 * (e->gate_count + 1) > e->table_cap && !table_grow(e)) return -1;
+
+    int slot = (int)(gate_hash(op, a, b) & (uint32_t)(e->table_cap - 1));
+    while (e->table[slot] >= 0) {
+        const CnfGate* gate = &e->gates[e->table[slot]];
+        if (gate->op == op && gate->a == a && gate->b == b) return gate->out;
+        slot = (slot + 1) & (e->table_cap - 1);
+    }
+
+    if (e->gate_count == e->gate_cap) {
+        int new_cap = e->gate_cap ? e->gate_cap * 2 : 128;
+        CnfGate* gates = realloc(e->gates, (size_t)new_cap * sizeof(CnfGate));
+        if (!gates) return -1;
+        e->gates = gates;
+        e->gate_cap = new_cap;
+    }
+    int v = Sat_NewVar(e->solver);
+    if (v < 0) return -1;
+    if (v >= e->var_gate_cap) {
+        int new_cap = e->var_gate_cap ? e->var_gate_cap * 2 : 256;
+        while (new_cap <= v) new_cap *= 2;
+        int* var_gate = realloc(e->var_gate, (size_t)new_cap * sizeof(int));
+        if (!var_gate) return -1;
+        for (int i = e->var_gate_cap; i < new_cap; i++) var_gate[i] = -1;
+        e->var_gate = var_gate;
+        e->var_gate_cap = new_cap;
+    }
+    int out = SAT_LIT(v, false);
+    if (!clauses(e, out, a, b)) return -1;
+    e->var_gate[v] = e->gate_count;
+
+    CnfGate* gate = &e->gates[e->gate_count];
+    gate->op = (uint8_t)op;
+    gate->a = a;
+    gate->b = b;
+    gate->out = out;
+    e->table[slot] = e->gate_count++;
+    return out;
+}
+
+// Adds (a | b | c), or (a | b) when c < 0
+static bool add_clause(CnfEncoder* e, int a, int b, int c) {
+    int lits[3] = { a, b, c };
+    Sat_AddClause(e->solver, lits, c < 0 ? 2 : 3);
+    return !e->solver->failed;
+}
+
+static bool and_clauses(CnfEncoder* e, int o, int a, int b) {
+    return add_clause(e, SAT_NOT(o), a, -1) && add_clause(e, SAT_NOT(o), b, -1) &&
+           add_clause(e, o, SAT_NOT(a), SAT_NOT(b));
+}
+
+static bool xor_clauses(CnfEncoder* e, int o, int a, int b) {
+    return add_clause(e, SAT_NOT(o), a, b) && add_clause(e, SAT_NOT(o), SAT_NOT(a), SAT_NOT(b)) &&
+           add_clause(e, o, SAT_NOT(a), b) && add_clause(e, o, a, SAT_NOT(b));
+}
+
+static int and2(CnfEncoder* e, int a, int b) {
+    if (a < 0 || b < 0) return -1;
+    int t = e->true_lit;
+    if (a == SAT_NOT(t) || b == SAT_NOT(t) || a == SAT_NOT(b)) return SAT_NOT(t);
+    if (a == t || a == b) return b;
+    if (b == t) return a;
+    return a < b ? find_or_add(e, NODE_AND, a, b, and_clauses) : find_or_add(e, NODE_AND, b, a, and_clauses);
+}
+
+int Cnf_Xor(CnfEncoder* e, int a, int b) {
+    if (a < 0 || b < 0) return -1;
+
+    // Negations move to the output: !a ^ b = !(a ^ b)
+    int flip = (a & 1) ^ (b & 1);
+    a &= ~1;
+    b &= ~1;
+    int t = e->true_lit;  // A positive literal, so constants survive the stripping
+    int out;
+    if (a == b) {
+        out = SAT_NOT(t);
+    } else if (a == t) {
+        out = SAT_NOT(b);
+    } else if (b == t) {
+        out = SAT_NOT(a);
+    } else {
+        out = a < b ? find_or_add(e, NODE_XOR, a, b, xor_clauses) : find_or_add(e, NODE_XOR, b, a, xor_clauses);
+    }
+    return out < 0 ? -1 : out ^ flip;
+}
+
+// --- Gates ---
+
+static int compare_lits(const void* x, const void* y) {
+    return *(const int*)x - *(const int*)y;
+}
+
+/*
+ * Function: reduce
+ * ----------------
+ * Combines 'count' literals (overwritten as scratch) pairwise into a
+ * balanced tree of two-input gates.
+ */
+static int reduce(CnfEncoder* e, int* lits, int count, int (*combine)(CnfEncoder*, int, int)) {
+    while (count > 1) {
+        int next = 0;
+        for (int i = 0; i + 1 < count; i += 2) {
+            lits[next] = combine(e, lits[i], lits[i + 1]);
+            if (lits[next++] < 0) return -1;
+        }
+        if (count & 1) lits[next++] = lits[count - 1];
+        count = next;
+    }
+    return lits[0];
+}
+
+/*
+ * Function: flatten
+ * -----------------
+ * Copies the inputs of an AND (op NODE_AND) or XOR gate into e->leaves,
+ * replacing every input that is the positive output of a gate of the
+ * same op built here by that gate's inputs, up to CNF_FLATTEN_MAX
+ * leaves. XOR inputs are stripped of their negations, counted in *flip.
+ *
+ * returns: The number of leaves, or -1 if memory ran out.
+ */
+static int flatten(CnfEncoder* e, int op, const int* lits, int count, int* flip) {
+    int cap = count + CNF_FLATTEN_MAX;
+    if (cap > e->leaf_cap) {
+        int* leaves = realloc(e->leaves, (size_t)cap * sizeof(int));
+        if (!leaves) return -1;
+        e->leaves = leaves;
+        e->leaf_cap = cap;
+    }
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        int lit = lits[i];
+        if (op == NODE_XOR) {
+            *flip ^= lit & 1;
+            lit &= ~1;
+        }
+        e->leaves[n++] = lit;
+    }
+    // Expanding a leaf replaces it in place and appends its second input
+    for (int i = 0; i < n; ) {
+        int lit = e->leaves[i];
+        int v = SAT_VAR(lit);
+        int g = (!(lit & 1) && v < e->var_gate_cap) ? e->var_gate[v] : -1;
+        if (g >= 0 && e->gates[g].op == op && n < CNF_FLATTEN_MAX) {
+            e->leaves[i] = e->gates[g].a;
+            e->leaves[n++] = e->gates[g].b;
+        } else {
+            i++;
+        }
+    }
+    return n;
+}
+
+/*
+ * Function: encode_and
+ * --------------------
+ * returns: A literal for the AND of 'count' >= 1 literals, or -1 if
+ *          memory ran out.
+ */
+static int encode_and(CnfEncoder* e, const int* inputs, int count) {
+    int unused = 0;
+    count = flatten(e, NODE_AND, inputs, count, &unused);
+    if (count < 0) return -1;
+    int* lits = e->leaves;
+
+    // Sorted, equal inputs are adjacent and so are x and !x
+    qsort(lits, (size_t)count, sizeof(int), compare_lits);
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (lits[i] == e->true_lit || (kept && lits[kept - 1] == lits[i])) continue;
+        if (lits[i] == SAT_NOT(e->true_lit) || (kept && lits[kept - 1] == SAT_NOT(lits[i]))) {
+            return SAT_NOT(e->true_lit);
+        }
+        lits[kept++] = lits[i];
+    }
+    return kept ? reduce(e, lits, kept, and2) : e->true_lit;
+}
+
+/*
+ * Function: encode_xor
+ * --------------------
+ * returns: A literal for the XOR of 'count' >= 1 literals, or -1 if
+ *          memory ran out.
+ */
+static int encode_xor(CnfEncoder* e, const int* inputs, int count) {
+    int flip = 0;
+    count = flatten(e, NODE_XOR, inputs, count, &flip);
+    if (count < 0) return -1;
+    int* lits = e->leaves;
+
+    // Pairs of equal inputs cancel; the constant true only flips
+    qsort(lits, (size_t)count, sizeof(int), compare_lits);
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (lits[i] == e->true_lit) {
+            flip ^= 1;
+        } else if (kept && lits[kept - 1] == lits[i]) {
+            kept--;
+        } else {
+            lits[kept++] = lits[i];
+        }
+    }
+    int out = kept ? reduce(e, lits, kept, Cnf_Xor) : SAT_NOT(e->true_lit);
+    return out < 0 ? -1 : out ^ flip;
+}
+
+/*
+ * Function: encode_gate
+ * ---------------------
+ * lits: The gate's input literals (scratch).
+ */
+static int encode_gate(CnfEncoder* e, NodeType op, int* lits, int count) {
+    int f = SAT_NOT(e->true_lit);
+    switch (op) {
+        case NODE_NOT:
+            return count ? SAT_NOT(lits[0]) : e->true_lit;
+        case NODE_AND:
+        case NODE_NAND: {
+            if (count == 0) return op == NODE_AND ? f : e->true_lit;
+            int o = encode_and(e, lits, count);
+            return (o < 0 || op == NODE_AND) ? o : SAT_NOT(o);
+        }
+        case NODE_OR:
+        case NODE_NOR: {
+            // OR(a..) = !AND(!a..), NOR(a..) = AND(!a..)
+            if (count == 0) return op == NODE_OR ? f : e->true_lit;
+            for (int i = 0; i < count; i++) lits[i] = SAT_NOT(lits[i]);
+            int o = encode_and(e, lits, count);
+            return (o < 0 || op == NODE_NOR) ? o : SAT_NOT(o);
+        }
+        case NODE_XOR:
+            return count ? encode_xor(e, lits, count) : f;
+        default:
+            return f; // NODE_DFF: reset value (see logic_seq.h)
+    }
+}
+
+int Cnf_AddGraph(CnfEncoder* e, const NetGraph* g, int* output_lits, int max_outputs) {
+    int max_pins = 1;
+    for (int i = 0; i < g->node_count; i++) {
+        if (g->nodes[i].input_count > max_pins) max_pins = g->nodes[i].input_count;
+    }
+    int* node_lit = malloc((size_t)g->node_count * sizeof(int) + 1);
+    int* lits = malloc((size_t)max_pins * sizeof(int));
+
+    int outputs = 0;
+    bool ok = node_lit && lits;
+    for (int i = 0; ok && i < g->node_count; i++) {
+        const GraphNode* n = &g->nodes[i];
+        if (n->kind == NETLIST_NODE_VAR) {
+            node_lit[i] = Cnf_InputLit(e, n->label[0] - 'A');
+        } else if (n->kind == NETLIST_NODE_OUTPUT) {
+            node_lit[i] = node_lit[Graph_NodeInput(g, i, 0)];
+            if (outputs < max_outputs) output_lits[outputs] = node_lit[i];
+            outputs++;
+        } else {
+            for (int pin = 0; pin < n->input_count; pin++) lits[pin] = node_lit[Graph_NodeInput(g, i, pin)];
+            node_lit[i] = encode_gate(e, n->op, lits, n->input_count);
+        }
+        ok = (node_lit[i] >= 0);
+    }
+
+    free(node_lit);
+    free(lits);
+    return ok ? outputs : -1;
+}
+
+int Cnf_AddTree(CnfEncoder* e, LogicNode* root) {
+    NetGraph g;
+    Graph_Init(&g);
+    int lit = -1;
+    if (Graph_AddOutput(&g, "F", root)) {
+        Graph_Finalize(&g);
+        if (Cnf_AddGraph(e, &g, &lit, 1) != 1) lit = -1;
+    }
+    Graph_Free(&g);
+    return lit;
+}
+
+uint32_t Cnf_InputMask(const CnfEncoder* e) {
+    uint32_t mask = 0;
+    for (int i = 0; i < CNF_MAX_VARS; i++) {
+        if (e->input_var[i] >= 0 && Sat_ModelValue(e->solver, e->input_var[i])) mask |= 1u << i;
+    }
+    return mask;
+}
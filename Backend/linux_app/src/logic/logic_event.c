@@ -0,0 +1,392 @@
+/*
+ * File: logic_event.c
+ * Version: 1.1.0
+ * Description:
+ * Implements the event-driven timing simulator (see logic_event.h).
+ *
+ * A time step pops every event in the current wheel slot, applies the
+ * new net values, and only then re-evaluates the gates those nets feed,
+ * so the result does not depend on the order events were scheduled in.
+ */
+
+#include "logic_event.h"
+#include <stdlib.h>
+#include <string.h>
+
+void EventDelays_Default(EventDelays* d) {
+    memset(d, 0, sizeof(*d));
+    d->ticks[NODE_NOT] = 7;
+    d->ticks[NODE_NAND] = 8;
+    d->ticks[NODE_NOR] = 8;
+    d->ticks[NODE_AND] = 9;
+    d->ticks[NODE_OR] = 9;
+    d->ticks[NODE_XOR] = 11;
+}
+
+static int clamp_delay(int ticks) {
+    if (ticks < 1) return 1;
+    return ticks > EVENT_MAX_DELAY ? EVENT_MAX_DELAY : ticks;
+}
+
+/*
+ * Function: eval_gate
+ * -------------------
+ * Computes a gate's output from the present values of its input nets.
+ * A gate with no inputs reads as AND/OR/XOR = 0 (NAND/NOR/NOT = 1),
+ * matching the compiled simulator.
+ */
+static uint8_t eval_gate(const EventSim* s, int gate) {
+    const int* in = s->in_net + s->in_start[gate];
+    int count = s->in_start[gate + 1] - s->in_start[gate];
+    const uint8_t* v = s->value;
+    uint8_t r = 0;
+
+    switch (s->op[gate]) {
+        case NODE_AND:
+        case NODE_NAND:
+            r = (count > 0);
+            for (int i = 0; i < count && r; i++) r = v[in[i]];
+            break;
+        case NODE_OR:
+        case NODE_NOR:
+            for (int i = 0; i < count && !r; i++) r = v[in[i]];
+            break;
+        case NODE_XOR:
+            for (int i = 0; i < count; i++) r ^= v[in[i]];
+            break;
+        default: // NODE_NOT
+            r = count > 0 ? v[in[0]] : 0;
+            break;
+    }
+    if (s->op[gate] == NODE_NAND || s->op[gate] == NODE_NOR || s->op[gate] == NODE_NOT) r ^= 1;
+    return r;
+}
+
+// --- Compilation ---
+
+bool EventSim_Compile(const NetGraph* g, const EventDelays* delays, uint32_t input_mask,
+                      uint64_t start, EventSim* s) {
+    memset(s, 0, sizeof(*s));
+
+    int gate_count = 0, pin_count = 0, output_count = 0, max_delay = 1;
+    for (int i = 0; i < g->node_count; i++) {
+        const GraphNode* n = &g->nodes[i];
+        if (n->kind == NETLIST_NODE_GATE && n->op != NODE_DFF) {
+            gate_count++;
+            pin_count += n->input_count;
+            int d = clamp_delay(delays->ticks[n->op]);
+            if (d > max_delay) max_delay = d;
+        } else if (n->kind == NETLIST_NODE_OUTPUT && output_count < EVENT_MAX_OUTPUTS) {
+            output_count++;
+        }
+    }
+
+    // Every pending event is at most max_delay ahead, so a wheel larger
+    // than that never holds two different times in one slot
+    int wheel_size = 64;
+    while (wheel_size <= max_delay) wheel_size *= 2;
+
+    s->gate_count = gate_count;
+    s->net_count = EVENT_FIRST_GATE_NET + gate_count;
+    s->wheel_size = wheel_size;
+    s->now = start;
+    s->input_mask = input_mask;
+
+    s->op = malloc((size_t)gate_count + 1);
+    s->delay = malloc((size_t)gate_count * sizeof(uint16_t) + 1);
+    s->in_start = malloc(((size_t)gate_count + 1) * sizeof(int));
+    s->in_net = malloc((size_t)pin_count * sizeof(int) + 1);
+    s->fan_start = calloc((size_t)s->net_count + 1, sizeof(int));
+    s->fan_gate = malloc((size_t)pin_count * sizeof(int) + 1);
+    s->value = calloc((size_t)s->net_count, 1);
+    s->out_mask = calloc((size_t)s->net_count, sizeof(uint32_t));
+    s->pending = calloc((size_t)gate_count + 1, 1);
+    s->pending_time = malloc((size_t)gate_count * sizeof(uint64_t) + 1);
+    s->next = malloc((size_t)gate_count * sizeof(int) + 1);
+    s->prev = malloc((size_t)gate_count * sizeof(int) + 1);
+    s->wheel = malloc((size_t)wheel_size * sizeof(int));
+    s->occupied = calloc((size_t)wheel_size / 64, sizeof(uint64_t));
+    s->eval_list = malloc((size_t)gate_count * sizeof(int) + 1);
+    s->eval_mark = calloc((size_t)gate_count + 1, 1);
+    s->outputs = calloc((size_t)output_count + 1, sizeof(EventOutput));
+    int* node_net = malloc((size_t)g->node_count * sizeof(int) + 1);
+    int* fan_fill = NULL;
+
+    bool ok = s->op && s->delay && s->in_start && s->in_net && s->fan_start && s->fan_gate &&
+              s->value && s->out_mask && s->pending && s->pending_time && s->next && s->prev &&
+              s->wheel && s->occupied && s->eval_list && s->eval_mark && s->outputs && node_net;
+
+    // Map graph nodes to nets and copy the gates (graph order is topological)
+    int gate = 0, pin = 0;
+    for (int i = 0; ok && i < g->node_count; i++) {
+        const GraphNode* n = &g->nodes[i];
+        if (n->kind == NETLIST_NODE_VAR) {
+            // Same range AST_Evaluate accepts; anything else reads as 0
+            int v = n->label[0] - 'A';
+            if (v >= 0 && v < EVENT_MAX_VARS) {
+                node_net[i] = v;
+                s->var_mask |= 1u << v;
+            } else {
+                node_net[i] = EVENT_NET_ZERO;
+            }
+        } else if (n->kind == NETLIST_NODE_GATE && n->op == NODE_DFF) {
+            node_net[i] = EVENT_NET_ZERO; // Registers are not clocked here
+        } else if (n->kind == NETLIST_NODE_OUTPUT) {
+            node_net[i] = node_net[Graph_NodeInput(g, i, 0)];
+            if (s->output_count < output_count) {
+                EventOutput* out = &s->outputs[s->output_count];
+                memcpy(out->name, n->label, sizeof(out->name));
+                out->net = node_net[i];
+                s->out_mask[out->net] |= 1u << s->output_count;
+                s->output_count++;
+            }
+        } else {
+            s->op[gate] = (uint8_t)n->op;
+            s->delay[gate] = (uint16_t)clamp_delay(delays->ticks[n->op]);
+            s->in_start[gate] = pin;
+            for (int p = 0; p < n->input_count; p++) {
+                int net = node_net[Graph_NodeInput(g, i, p)];
+                s->in_net[pin++] = net;
+                s->fan_start[net + 1]++;
+            }
+            node_net[i] = EVENT_FIRST_GATE_NET + gate;
+            gate++;
+        }
+    }
+
+    if (ok) {
+        s->in_start[gate_count] = pin_count;
+
+        // Fan-out lists: prefix-sum the counts, then fill
+        for (int n = 0; n < s->net_count; n++) s->fan_start[n + 1] += s->fan_start[n];
+        fan_fill = malloc((size_t)s->net_count * sizeof(int));
+        ok = (fan_fill != NULL);
+    }
+    if (ok) {
+        memcpy(fan_fill, s->fan_start, (size_t)s->net_count * sizeof(int));
+        for (int i = 0; i < gate_count; i++) {
+            for (int p = s->in_start[i]; p < s->in_start[i + 1]; p++) {
+                s->fan_gate[fan_fill[s->in_net[p]]++] = i;
+            }
+        }
+
+        for (int i = 0; i < wheel_size; i++) s->wheel[i] = -1;
+    }
+
+    free(node_net);
+    free(fan_fill);
+    if (!ok) {
+        EventSim_Free(s);
+        return false;
+    }
+
+    // Start settled: inputs applied, every gate at its steady value
+    for (uint32_t vars = s->var_mask; vars; vars &= vars - 1) {
+        int v = __builtin_ctz(vars);
+        s->value[v] = (input_mask >> v) & 1u;
+    }
+    for (int i = 0; i < gate_count; i++) s->value[EVENT_FIRST_GATE_NET + i] = eval_gate(s, i);
+    return true;
+}
+
+void EventSim_Free(EventSim* s) {
+    free(s->op);
+    free(s->delay);
+    free(s->in_start);
+    free(s->in_net);
+    free(s->fan_start);
+    free(s->fan_gate);
+    free(s->value);
+    free(s->out_mask);
+    free(s->pending);
+    free(s->pending_time);
+    free(s->next);
+    free(s->prev);
+    free(s->wheel);
+    free(s->occupied);
+    free(s->eval_list);
+    free(s->eval_mark);
+    free(s->outputs);
+    memset(s, 0, sizeof(*s));
+}
+
+// --- Timing Wheel ---
+
+static void wheel_insert(EventSim* s, int gate, uint64_t time) {
+    int slot = (int)(time & (uint64_t)(s->wheel_size - 1));
+    s->pending[gate] = 1;
+    s->pending_time[gate] = time;
+    s->prev[gate] = -1;
+    s->next[gate] = s->wheel[slot];
+    if (s->wheel[slot] >= 0) s->prev[s->wheel[slot]] = gate;
+    s->wheel[slot] = gate;
+    s->occupied[slot >> 6] |= 1ULL << (slot & 63);
+    s->pending_count++;
+}
+
+static void wheel_remove(EventSim* s, int gate) {
+    int slot = (int)(s->pending_time[gate] & (uint64_t)(s->wheel_size - 1));
+    if (s->prev[gate] >= 0) s->next[s->prev[gate]] = s->next[gate];
+    else s->wheel[slot] = s->next[gate];
+    if (s->next[gate] >= 0) s->prev[s->next[gate]] = s->prev[gate];
+    if (s->wheel[slot] < 0) s->occupied[slot >> 6] &= ~(1ULL << (slot & 63));
+    s->pending[gate] = 0;
+    s->pending_count--;
+}
+
+/*
+ * Function: next_event_time
+ * -------------------------
+ * Finds the first occupied slot after the current time, wrapping
+ * around the wheel once. Requires pending_count > 0.
+ */
+static uint64_t next_event_time(const EventSim* s) {
+    int words = s->wheel_size >> 6;
+    int start = (int)((s->now + 1) & (uint64_t)(s->wheel_size - 1));
+    int first_word = start >> 6;
+    int bit = start & 63;
+
+    for (int k = 0; k <= words; k++) {
+        int w = (first_word + k) & (words - 1);
+        uint64_t bits = s->occupied[w];
+        if (k == 0) bits &= ~0ULL << bit;
+        else if (k == words) bits &= (1ULL << bit) - 1;  // Wrapped back to the start
+        if (bits) return s->pending_time[s->wheel[w * 64 + __builtin_ctzll(bits)]];
+    }
+    return s->now;
+}
+
+// --- Simulation ---
+
+/*
+ * Function: schedule
+ * ------------------
+ * Inertial delay: a gate whose computed value differs from its output
+ * gets an event 'delay' ticks from now, unless one is already pending
+ * (which then carries the same value). If the computed value equals the
+ * output again, any pending event is cancelled and the pulse absorbed.
+ */
+static void schedule(EventSim* s, int gate, uint8_t value) {
+    if (value == s->value[EVENT_FIRST_GATE_NET + gate]) {
+        if (s->pending[gate]) wheel_remove(s, gate);
+    } else if (!s->pending[gate]) {
+        wheel_insert(s, gate, s->now + s->delay[gate]);
+    }
+}
+
+static void record_transition(EventSim* s, uint32_t outputs, uint8_t value) {
+    for (; outputs; outputs &= outputs - 1) {
+        EventOutput* out = &s->outputs[__builtin_ctz(outputs)];
+        int at = (out->trace_start + out->trace_count) % EVENT_TRACE_CAP;
+        if (out->trace_count == EVENT_TRACE_CAP) {
+            out->trace_start = (out->trace_start + 1) % EVENT_TRACE_CAP;
+            out->dropped++;
+        } else {
+            out->trace_count++;
+        }
+        out->trace[at].time = s->now;
+        out->trace[at].value = value;
+        if (++out->toggles == 2) out->glitches++;
+        if (s->on_edge) s->on_edge(s->edge_ctx, __builtin_ctz(outputs), s->now, value);
+    }
+}
+
+/*
+ * Function: set_net
+ * -----------------
+ * Drives a net to a new value and queues the gates it feeds.
+ */
+static void set_net(EventSim* s, int net, uint8_t value) {
+    s->value[net] = value;
+    s->events++;
+    if (s->out_mask[net]) record_transition(s, s->out_mask[net], value);
+
+    for (int f = s->fan_start[net]; f < s->fan_start[net + 1]; f++) {
+        int gate = s->fan_gate[f];
+        if (!s->eval_mark[gate]) {
+            s->eval_mark[gate] = 1;
+            s->eval_list[s->eval_count++] = gate;
+        }
+    }
+}
+
+static void evaluate_queued(EventSim* s) {
+    for (int i = 0; i < s->eval_count; i++) {
+        int gate = s->eval_list[i];
+        s->eval_mark[gate] = 0;
+        schedule(s, gate, eval_gate(s, gate));
+    }
+    s->evaluations += (uint64_t)s->eval_count;
+    s->eval_count = 0;
+}
+
+/*
+ * Function: step
+ * --------------
+ * Advances to 'time' (the next event time) and processes its slot.
+ */
+static void step(EventSim* s, uint64_t time) {
+    int slot = (int)(time & (uint64_t)(s->wheel_size - 1));
+    int gate = s->wheel[slot];
+    s->wheel[slot] = -1;
+    s->occupied[slot >> 6] &= ~(1ULL << (slot & 63));
+    s->now = time;
+
+    while (gate >= 0) {
+        int next = s->next[gate];
+        s->pending[gate] = 0;
+        s->pending_count--;
+        set_net(s, EVENT_FIRST_GATE_NET + gate, s->value[EVENT_FIRST_GATE_NET + gate] ^ 1);
+        gate = next;
+    }
+    evaluate_queued(s);
+}
+
+void EventSim_RunUntil(EventSim* s, uint64_t time) {
+    while (s->pending_count > 0) {
+        uint64_t next = next_event_time(s);
+        if (next > time) break;
+        step(s, next);
+    }
+    if (time > s->now) s->now = time;
+}
+
+void EventSim_SetInputs(EventSim* s, uint64_t time, uint32_t input_mask) {
+    EventSim_RunUntil(s, time);
+
+    uint32_t changed = (input_mask ^ s->input_mask) & s->var_mask;
+    s->input_mask = input_mask;
+    for (int i = 0; i < s->output_count; i++) s->outputs[i].toggles = 0;
+
+    for (; changed; changed &= changed - 1) {
+        int v = __builtin_ctz(changed);
+        set_net(s, v, (input_mask >> v) & 1u);
+    }
+    evaluate_queued(s);
+}
+
+uint64_t EventSim_Settle(EventSim* s) {
+    while (s->pending_count > 0) step(s, next_event_time(s));
+    return s->now;
+}
+
+bool EventSim_OutputValue(const EventSim* s, int output) {
+    if (output < 0 || output >= s->output_count) return false;
+    return s->value[s->outputs[output].net];
+}
+
+void EventSim_ClearTraces(EventSim* s) {
+    for (int i = 0; i < s->output_count; i++) {
+        EventOutput* out = &s->outputs[i];
+        out->trace_start = 0;
+        out->trace_count = 0;
+        out->dropped = 0;
+        out->glitches = 0;
+        out->toggles = 0;
+    }
+}
+
+void EventSim_SetEdgeHook(EventSim* s, EventEdgeFn fn, void* ctx) {
+    s->on_edge = fn;
+    s->edge_ctx = ctx;
+}
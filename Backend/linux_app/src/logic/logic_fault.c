@@ -0,0 +1,385 @@
+/*
+ * File: logic_fault.c
+ * Version: 1.0.0
+ * Description:
+ * Implements fault enumeration, collapsing and parallel-pattern fault
+ * simulation (see logic_fault.h).
+ *
+ * Collapsing is a union-find over the raw fault list. Raw faults are
+ * numbered node by node: a node's two output faults, then two per input
+ * pin. Unions always make the output ("stem") side the root, so class
+ * representatives are output faults wherever the class has one.
+ *
+ * Fault propagation reuses one scratch per simulation: a faulty value
+ * only counts for a node whose stamp equals the current epoch, so
+ * starting the next fault is a counter increment, not a clear.
+ */
+
+#include "logic_fault.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FAULT_MAX_VARS 32
+
+// --- Enumeration ---
+
+static bool is_site(const GraphNode* n) {
+    return !(n->kind == NETLIST_NODE_GATE && n->op == NODE_DFF);
+}
+
+static int uf_find(int* parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// 'b' becomes the root of the merged class
+static void uf_union(int* parent, int a, int b) {
+    int ra = uf_find(parent, a), rb = uf_find(parent, b);
+    if (ra != rb) parent[ra] = rb;
+}
+
+bool Fault_Enumerate(const NetGraph* g, bool collapse, FaultList* list) {
+    memset(list, 0, sizeof(*list));
+
+    int n = g->node_count;
+    int* stem_base = malloc((size_t)n * sizeof(int) + 1);
+    int* pin_base = malloc((size_t)n * sizeof(int) + 1);
+    int* fanout = calloc((size_t)n + 1, sizeof(int));
+    if (!stem_base || !pin_base || !fanout) {
+        free(stem_base);
+        free(pin_base);
+        free(fanout);
+        return false;
+    }
+
+    // Raw numbering: [out/0, out/1] then [pin p / 0, pin p / 1] per pin
+    int raw = 0;
+    for (int i = 0; i < n; i++) {
+        const GraphNode* node = &g->nodes[i];
+        stem_base[i] = -1;
+        pin_base[i] = -1;
+        if (!is_site(node)) continue;
+        if (node->kind != NETLIST_NODE_OUTPUT) {
+            stem_base[i] = raw;
+            raw += 2;
+        }
+        if (node->kind != NETLIST_NODE_VAR && node->input_count > 0) {
+            pin_base[i] = raw;
+            raw += 2 * node->input_count;
+        }
+        for (int pin = 0; pin < node->input_count; pin++) fanout[Graph_NodeInput(g, i, pin)]++;
+    }
+
+    int* parent = malloc((size_t)raw * sizeof(int) + 1);
+    int* size = calloc((size_t)raw + 1, sizeof(int));
+    bool ok = parent && size;
+
+    if (ok) {
+        for (int f = 0; f < raw; f++) parent[f] = f;
+        for (int i = 0; collapse && i < n; i++) {
+            const GraphNode* node = &g->nodes[i];
+            if (pin_base[i] < 0) continue;
+
+            for (int pin = 0; pin < node->input_count; pin++) {
+                int branch = pin_base[i] + 2 * pin;
+                int driver = Graph_NodeInput(g, i, pin);
+
+                // Sole fan-out: the pin and the driver's output are one wire
+                if (fanout[driver] == 1 && stem_base[driver] >= 0) {
+                    uf_union(parent, branch, stem_base[driver]);
+                    uf_union(parent, branch + 1, stem_base[driver] + 1);
+                }
+
+                if (node->kind != NETLIST_NODE_GATE) continue;
+                switch (node->op) {
+                    case NODE_AND:  uf_union(parent, branch + 0, stem_base[i] + 0); break;
+                    case NODE_NAND: uf_union(parent, branch + 0, stem_base[i] + 1); break;
+                    case NODE_OR:   uf_union(parent, branch + 1, stem_base[i] + 1); break;
+                    case NODE_NOR:  uf_union(parent, branch + 1, stem_base[i] + 0); break;
+                    case NODE_NOT:
+                        uf_union(parent, branch + 0, stem_base[i] + 1);
+                        uf_union(parent, branch + 1, stem_base[i] + 0);
+                        break;
+                    default:
+                        break;  // XOR has no controlling value
+                }
+            }
+        }
+
+        for (int f = 0; f < raw; f++) size[uf_find(parent, f)]++;
+        for (int f = 0; f < raw; f++) list->count += (parent[f] == f);
+        list->faults = malloc((size_t)list->count * sizeof(Fault) + 1);
+        ok = (list->faults != NULL);
+    }
+
+    if (ok) {
+        int at = 0;
+        for (int i = 0; i < n; i++) {
+            const GraphNode* node = &g->nodes[i];
+            for (int pin = FAULT_PIN_OUT; pin < node->input_count; pin++) {
+                int base = pin == FAULT_PIN_OUT ? stem_base[i] : (pin_base[i] < 0 ? -1 : pin_base[i] + 2 * pin);
+                if (base < 0) continue;
+                for (int v = 0; v < 2; v++) {
+                    if (parent[base + v] != base + v) continue;
+                    Fault* f = &list->faults[at++];
+                    f->node = i;
+                    f->pin = pin;
+                    f->stuck = (uint8_t)v;
+                    f->class_size = size[base + v];
+                    f->detected = false;
+                    f->first_vector = -1;
+                }
+            }
+        }
+        list->total = raw;
+    }
+
+    free(stem_base);
+    free(pin_base);
+    free(fanout);
+    free(parent);
+    free(size);
+    if (!ok) Fault_Free(list);
+    return ok;
+}
+
+void Fault_Free(FaultList* list) {
+    free(list->faults);
+    memset(list, 0, sizeof(*list));
+}
+
+double Fault_Coverage(const FaultList* list) {
+    return list->total > 0 ? (double)list->detected_total / (double)list->total : 0.0;
+}
+
+// --- Simulation ---
+
+/*
+ * Struct: FaultSim
+ * ----------------
+ * good:              Fault-free value of every node for the current block.
+ * faulty, stamp:     Value under the current fault, valid where stamp == epoch.
+ * queued:            Node is in the heap for the current epoch.
+ * heap:              Min-heap of node indices; graph order is topological,
+ *                    so popping the smallest index evaluates every node
+ *                    after all of its changed inputs.
+ * fan_start, fan_node: Node i feeds fan_node[fan_start[i] .. fan_start[i+1]).
+ */
+typedef struct {
+    uint64_t* good;
+    uint64_t* faulty;
+    uint32_t* stamp;
+    uint32_t* queued;
+    uint32_t epoch;
+    int* heap;
+    int heap_count;
+    int* fan_start;
+    int* fan_node;
+} FaultSim;
+
+static bool sim_init(FaultSim* s, const NetGraph* g) {
+    int n = g->node_count;
+    memset(s, 0, sizeof(*s));
+    s->good = malloc((size_t)n * sizeof(uint64_t) + 1);
+    s->faulty = malloc((size_t)n * sizeof(uint64_t) + 1);
+    s->stamp = calloc((size_t)n + 1, sizeof(uint32_t));
+    s->queued = calloc((size_t)n + 1, sizeof(uint32_t));
+    s->heap = malloc((size_t)n * sizeof(int) + 1);
+    s->fan_start = calloc((size_t)n + 1, sizeof(int));
+    s->fan_node = malloc((size_t)g->input_count * sizeof(int) + 1);
+    if (!s->good || !s->faulty || !s->stamp || !s->queued || !s->heap || !s->fan_start || !s->fan_node) {
+        return false;
+    }
+
+    for (int i = 0; i < n; i++) {
+        for (int pin = 0; pin < g->nodes[i].input_count; pin++) s->fan_start[Graph_NodeInput(g, i, pin) + 1]++;
+    }
+    for (int i = 0; i < n; i++) s->fan_start[i + 1] += s->fan_start[i];
+    int* cursor = malloc((size_t)n * sizeof(int) + 1);
+    if (!cursor) return false;
+    memcpy(cursor, s->fan_start, (size_t)n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        for (int pin = 0; pin < g->nodes[i].input_count; pin++) s->fan_node[cursor[Graph_NodeInput(g, i, pin)]++] = i;
+    }
+    free(cursor);
+    return true;
+}
+
+static void sim_free(FaultSim* s) {
+    free(s->good);
+    free(s->faulty);
+    free(s->stamp);
+    free(s->queued);
+    free(s->heap);
+    free(s->fan_start);
+    free(s->fan_node);
+}
+
+static void next_epoch(FaultSim* s, int node_count) {
+    if (++s->epoch == 0) {
+        memset(s->stamp, 0, (size_t)node_count * sizeof(uint32_t));
+        memset(s->queued, 0, (size_t)node_count * sizeof(uint32_t));
+        s->epoch = 1;
+    }
+    s->heap_count = 0;
+}
+
+static inline uint64_t value_of(const FaultSim* s, int node) {
+    return s->stamp[node] == s->epoch ? s->faulty[node] : s->good[node];
+}
+
+/*
+ * Function: eval_node
+ * -------------------
+ * Evaluates a gate or output from its inputs' current values, with pin
+ * 'forced_pin' (if not FAULT_PIN_OUT) reading 'forced' instead.
+ * Gates without inputs follow logic_sim: 0, or 1 if inverting.
+ */
+static uint64_t eval_node(const FaultSim* s, const NetGraph* g, int i, int forced_pin, uint64_t forced) {
+    const GraphNode* n = &g->nodes[i];
+    if (n->kind == NETLIST_NODE_VAR) return s->good[i];
+
+    uint64_t acc = 0;
+    bool inverted = false;
+    for (int pin = 0; pin < n->input_count; pin++) {
+        uint64_t in = pin == forced_pin ? forced : value_of(s, Graph_NodeInput(g, i, pin));
+        if (pin == 0) {
+            acc = in;
+            continue;
+        }
+        switch (n->op) {
+            case NODE_AND: case NODE_NAND: acc &= in; break;
+            case NODE_OR:  case NODE_NOR:  acc |= in; break;
+            case NODE_XOR:                 acc ^= in; break;
+            default: break;
+        }
+    }
+    if (n->kind == NETLIST_NODE_OUTPUT) return acc;
+
+    switch (n->op) {
+        case NODE_NOT: case NODE_NAND: case NODE_NOR: inverted = true; break;
+        case NODE_DFF: return 0;  // Reset value (see logic_seq.h)
+        default: break;
+    }
+    return inverted ? ~acc : acc;
+}
+
+static void heap_push(FaultSim* s, int node) {
+    int i = s->heap_count++;
+    while (i > 0) {
+        int up = (i - 1) / 2;
+        if (s->heap[up] <= node) break;
+        s->heap[i] = s->heap[up];
+        i = up;
+    }
+    s->heap[i] = node;
+}
+
+static int heap_pop(FaultSim* s) {
+    int top = s->heap[0];
+    int last = s->heap[--s->heap_count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= s->heap_count) break;
+        if (child + 1 < s->heap_count && s->heap[child + 1] < s->heap[child]) child++;
+        if (last <= s->heap[child]) break;
+        s->heap[i] = s->heap[child];
+        i = child;
+    }
+    if (s->heap_count > 0) s->heap[i] = last;
+    return top;
+}
+
+static void set_faulty(FaultSim* s, int node, uint64_t value) {
+    s->faulty[node] = value;
+    s->stamp[node] = s->epoch;
+    for (int k = s->fan_start[node]; k < s->fan_start[node + 1]; k++) {
+        int next = s->fan_node[k];
+        if (s->queued[next] == s->epoch) continue;
+        s->queued[next] = s->epoch;
+        heap_push(s, next);
+    }
+}
+
+/*
+ * Function: propagate
+ * -------------------
+ * Injects one fault into the current block and follows its effect.
+ *
+ * returns: Lanes in which some output differs from the fault-free one.
+ */
+static uint64_t propagate(FaultSim* s, const NetGraph* g, const Fault* f, uint64_t lanes) {
+    next_epoch(s, g->node_count);
+
+    uint64_t stuck = f->stuck ? ~0ULL : 0ULL;
+    int site = f->node;
+    uint64_t value = f->pin == FAULT_PIN_OUT ? stuck : eval_node(s, g, site, f->pin, stuck);
+    uint64_t diff = (value ^ s->good[site]) & lanes;
+    if (!diff) return 0;  // Not excited by any vector of the block
+    if (g->nodes[site].kind == NETLIST_NODE_OUTPUT) return diff;
+    set_faulty(s, site, value);
+
+    // Run to completion rather than stopping at the first output that
+    // differs: another output may see the fault in an earlier lane
+    uint64_t detected = 0;
+    while (s->heap_count > 0) {
+        int i = heap_pop(s);
+        value = eval_node(s, g, i, FAULT_PIN_OUT, 0);
+        diff = (value ^ s->good[i]) & lanes;
+        if (!diff) continue;
+        if (g->nodes[i].kind == NETLIST_NODE_OUTPUT) {
+            detected |= diff;
+        } else {
+            set_faulty(s, i, value);
+        }
+    }
+    return detected;
+}
+
+bool Fault_Simulate(const NetGraph* g, FaultList* list, const uint32_t* masks, int count) {
+    FaultSim s;
+    if (!sim_init(&s, g)) {
+        sim_free(&s);
+        return false;
+    }
+
+    for (int base = 0; base < count && list->detected < list->count; base += 64) {
+        int lanes = count - base < 64 ? count - base : 64;
+        uint64_t lane_mask = lanes == 64 ? ~0ULL : (1ULL << lanes) - 1;
+
+        // Fault-free pass (no stamp matches a fresh epoch)
+        next_epoch(&s, g->node_count);
+        for (int i = 0; i < g->node_count; i++) {
+            const GraphNode* n = &g->nodes[i];
+            if (n->kind == NETLIST_NODE_VAR) {
+                int v = n->label[0] - 'A';
+                uint64_t word = 0;
+                if (v >= 0 && v < FAULT_MAX_VARS) {
+                    for (int k = 0; k < lanes; k++) word |= (uint64_t)((masks[base + k] >> v) & 1u) << k;
+                }
+                s.good[i] = word;
+            } else {
+                s.good[i] = eval_node(&s, g, i, FAULT_PIN_OUT, 0);
+            }
+        }
+
+        for (int f = 0; f < list->count; f++) {
+            Fault* fault = &list->faults[f];
+            if (fault->detected) continue;
+            uint64_t hit = propagate(&s, g, fault, lane_mask);
+            if (!hit) continue;
+            fault->detected = true;
+            fault->first_vector = list->vectors + base + __builtin_ctzll(hit);
+            list->detected++;
+            list->detected_total += fault->class_size;
+        }
+    }
+    list->vectors += count;
+
+    sim_free(&s);
+    return true;
+}
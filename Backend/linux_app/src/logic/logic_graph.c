@@ -0,0 +1,578 @@
+/*
+ * File: logic_graph.c
+ * Version: 1.1.1
+ * Description:
+ * Builds hash-consed circuit graphs from ASTs, assigns stable node IDs,
+ * keeps the published version history and computes graph deltas.
+ *
+ * Structural hashes are 64-bit; two nodes with equal hashes are treated
+ * as the same structure. With the circuit sizes this engine handles the
+ * chance of an accidental collision is negligible (~n^2 / 2^65).
+ *
+ * Version 1.1.0 also reports the nodes a delta keeps, so per-node data
+ * such as layout coordinates can be diffed alongside the structure.
+ * Version 1.1.1 prunes the intern table down to the hashes the version
+ * history still uses, so it no longer grows with every graph ever built.
+ */
+
+#include "logic_graph.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define GRAPH_HISTORY_SIZE 16
+#define INTERN_PRUNE_MIN   65536  // Table entries before a commit prunes it
+
+// --- Hashing ---
+
+/*
+ * Function: mix64
+ * ---------------
+ * SplitMix64 finalizer: a cheap, well-distributed 64-bit mixing step.
+ */
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static uint64_t hash_label(uint64_t h, const char* label) {
+    while (*label) h = mix64(h ^ (unsigned char)*label++);
+    return h;
+}
+
+static bool is_associative(NodeType type) {
+    return (type == NODE_AND || type == NODE_OR || type == NODE_XOR);
+}
+
+static const char* op_label(NodeType type) {
+    switch (type) {
+        case NODE_AND:  return "AND";
+        case NODE_OR:   return "OR";
+        case NODE_XOR:  return "XOR";
+        case NODE_NOT:  return "NOT";
+        case NODE_NAND: return "NAND";
+        case NODE_NOR:  return "NOR";
+        case NODE_DFF:  return "DFF";
+        default:        return "?";
+    }
+}
+
+// --- Stable ID Interning ---
+
+/*
+ * The intern table maps structural hashes to small sequential IDs.
+ * It is shared by every thread that builds graphs. Hash 0 marks an empty
+ * slot (real hashes are never 0). Every graph built interns its nodes,
+ * including throwaway ones (verification, timing, ...), so once the table
+ * holds 'intern_prune_at' entries the next commit prunes it to the hashes
+ * of the version history (intern_prune).
+ */
+static uint64_t* intern_keys = NULL;
+static uint32_t* intern_ids = NULL;
+static size_t intern_cap = 0;
+static size_t intern_count = 0;
+static uint32_t intern_next_id = 0;
+static size_t intern_prune_at = INTERN_PRUNE_MIN;
+static pthread_mutex_t intern_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bool intern_grow(void) {
+    size_t new_cap = intern_cap ? intern_cap * 2 : 1024;
+    uint64_t* keys = calloc(new_cap, sizeof(uint64_t));
+    uint32_t* ids = malloc(new_cap * sizeof(uint32_t));
+    if (!keys || !ids) { free(keys); free(ids); return false; }
+
+    for (size_t i = 0; i < intern_cap; i++) {
+        if (!intern_keys[i]) continue;
+        size_t slot = intern_keys[i] & (new_cap - 1);
+        while (keys[slot]) slot = (slot + 1) & (new_cap - 1);
+        keys[slot] = intern_keys[i];
+        ids[slot] = intern_ids[i];
+    }
+    free(intern_keys);
+    free(intern_ids);
+    intern_keys = keys;
+    intern_ids = ids;
+    intern_cap = new_cap;
+    return true;
+}
+
+/*
+ * Function: intern_hash
+ * ---------------------
+ * Returns the stable ID for a structural hash, assigning the next free
+ * ID the first time the hash is seen.
+ */
+static bool intern_hash(uint64_t hash, uint32_t* id_out) {
+    bool ok = true;
+    pthread_mutex_lock(&intern_mutex);
+    if ((intern_count + 1) * 2 > intern_cap) ok = intern_grow();
+    if (ok) {
+        size_t slot = hash & (intern_cap - 1);
+        while (intern_keys[slot] && intern_keys[slot] != hash) slot = (slot + 1) & (intern_cap - 1);
+        if (!intern_keys[slot]) {
+            intern_keys[slot] = hash;
+            intern_ids[slot] = intern_next_id++;
+            intern_count++;
+        }
+        *id_out = intern_ids[slot];
+    }
+    pthread_mutex_unlock(&intern_mutex);
+    return ok;
+}
+
+/*
+ * Function: intern_prune
+ * ----------------------
+ * Rebuilds the intern table from the nodes of the history's graphs,
+ * keeping their IDs. Pruned IDs are never handed out again (the counter
+ * only grows), so a structure that comes back gets a fresh ID and no two
+ * versions a client can diff against disagree on what an ID means.
+ * The caller holds the history lock.
+ */
+static void intern_prune(const NetGraph* graphs, int graph_count) {
+    pthread_mutex_lock(&intern_mutex);
+    if (intern_count < intern_prune_at) {
+        pthread_mutex_unlock(&intern_mutex);
+        return;
+    }
+
+    size_t live = 0;
+    for (int g = 0; g < graph_count; g++) live += (size_t)graphs[g].node_count;
+    size_t cap = 1024;
+    while (cap < (live + 1) * 2) cap *= 2;
+    uint64_t* keys = calloc(cap, sizeof(uint64_t));
+    uint32_t* ids = malloc(cap * sizeof(uint32_t));
+    if (!keys || !ids) {
+        free(keys);
+        free(ids);
+        pthread_mutex_unlock(&intern_mutex);
+        return;
+    }
+
+    size_t count = 0;
+    for (int g = 0; g < graph_count; g++) {
+        for (int i = 0; i < graphs[g].node_count; i++) {
+            const GraphNode* node = &graphs[g].nodes[i];
+            size_t slot = node->hash & (cap - 1);
+            while (keys[slot] && keys[slot] != node->hash) slot = (slot + 1) & (cap - 1);
+            if (keys[slot]) continue;
+            keys[slot] = node->hash;
+            ids[slot] = node->id;
+            count++;
+        }
+    }
+    free(intern_keys);
+    free(intern_ids);
+    intern_keys = keys;
+    intern_ids = ids;
+    intern_cap = cap;
+    intern_count = count;
+    intern_prune_at = count * 2 > INTERN_PRUNE_MIN ? count * 2 : INTERN_PRUNE_MIN;
+    pthread_mutex_unlock(&intern_mutex);
+}
+
+// --- Graph Construction ---
+
+void Graph_Init(NetGraph* g) {
+    memset(g, 0, sizeof(*g));
+}
+
+void Graph_Free(NetGraph* g) {
+    free(g->nodes);
+    free(g->inputs);
+    free(g->table);
+    free(g->pending);
+    Graph_Init(g);
+}
+
+int Graph_NodeInput(const NetGraph* g, int index, int pin) {
+    return g->inputs[g->nodes[index].first_input + pin];
+}
+
+static bool table_grow(NetGraph* g) {
+    int new_cap = g->table_cap ? g->table_cap * 2 : 64;
+    int* table = malloc((size_t)new_cap * sizeof(int));
+    if (!table) return false;
+    for (int i = 0; i < new_cap; i++) table[i] = -1;
+
+    for (int n = 0; n < g->node_count; n++) {
+        int slot = (int)(g->nodes[n].hash & (uint64_t)(new_cap - 1));
+        while (table[slot] >= 0) slot = (slot + 1) & (new_cap - 1);
+        table[slot] = n;
+    }
+    free(g->table);
+    g->table = table;
+    g->table_cap = new_cap;
+    return true;
+}
+
+/*
+ * Function: find_node
+ * -------------------
+ * returns: The index of the node with 'hash', or -1.
+ */
+static int find_node(const NetGraph* g, uint64_t hash) {
+    if (!g->table_cap) return -1;
+    int slot = (int)(hash & (uint64_t)(g->table_cap - 1));
+    while (g->table[slot] >= 0) {
+        if (g->nodes[g->table[slot]].hash == hash) return g->table[slot];
+        slot = (slot + 1) & (g->table_cap - 1);
+    }
+    return -1;
+}
+
+/*
+ * Function: push_pending
+ * ----------------------
+ * Pushes an operand onto the build stack. Operands stay there until
+ * their gate is created, because building a nested operand creates
+ * other gates (with their own inputs) in between.
+ */
+static bool push_pending(NetGraph* g, int node_index) {
+    if (g->pending_count == g->pending_cap) {
+        int new_cap = g->pending_cap ? g->pending_cap * 2 : 64;
+        int* grown = realloc(g->pending, (size_t)new_cap * sizeof(int));
+        if (!grown) return false;
+        g->pending = grown;
+        g->pending_cap = new_cap;
+    }
+    g->pending[g->pending_count++] = node_index;
+    return true;
+}
+
+static bool reserve_inputs(NetGraph* g, int extra) {
+    if (g->input_count + extra <= g->input_cap) return true;
+    int new_cap = g->input_cap ? g->input_cap : 64;
+    while (new_cap < g->input_count + extra) new_cap *= 2;
+    int* grown = realloc(g->inputs, (size_t)new_cap * sizeof(int));
+    if (!grown) return false;
+    g->inputs = grown;
+    g->input_cap = new_cap;
+    return true;
+}
+
+/*
+ * Function: add_node
+ * ------------------
+ * Appends a node whose inputs are the top 'input_count' entries of the
+ * build stack, unless a node with the same hash exists, in which case
+ * the existing node is returned (this is the hash-consing step).
+ * Either way the operands are popped.
+ *
+ * returns: The node index, or -1 if memory ran out.
+ */
+static int add_node(NetGraph* g, uint64_t hash, NetlistNodeKind kind, NodeType op,
+                    const char* label, int input_count) {
+    if (hash == 0) hash = 1; // 0 is the empty marker in the intern table
+
+    g->pending_count -= input_count;
+    int existing = find_node(g, hash);
+    if (existing >= 0) return existing;
+
+    if (g->node_count == g->node_cap) {
+        int new_cap = g->node_cap ? g->node_cap * 2 : 32;
+        GraphNode* grown = realloc(g->nodes, (size_t)new_cap * sizeof(GraphNode));
+        if (!grown) return -1;
+        g->nodes = grown;
+        g->node_cap = new_cap;
+    }
+    if ((g->node_count + 1) * 2 > g->table_cap && !table_grow(g)) return -1;
+    if (!reserve_inputs(g, input_count)) return -1;
+
+    GraphNode* node = &g->nodes[g->node_count];
+    if (!intern_hash(hash, &node->id)) return -1;
+    node->hash = hash;
+    node->kind = kind;
+    node->op = op;
+    strncpy(node->label, label, sizeof(node->label) - 1);
+    node->label[sizeof(node->label) - 1] = '\0';
+    node->first_input = g->input_count;
+    node->input_count = input_count;
+    memcpy(g->inputs + g->input_count, g->pending + g->pending_count, (size_t)input_count * sizeof(int));
+    g->input_count += input_count;
+
+    int slot = (int)(hash & (uint64_t)(g->table_cap - 1));
+    while (g->table[slot] >= 0) slot = (slot + 1) & (g->table_cap - 1);
+    g->table[slot] = g->node_count;
+
+    return g->node_count++;
+}
+
+/*
+ * Function: sort_pins
+ * -------------------
+ * Insertion sort of a pin range by input hash. Ranges are short (a few
+ * flattened operands), so this beats qsort and needs no context pointer.
+ */
+static void sort_pins(NetGraph* g, int start, int count) {
+    int* pins = g->pending + start;
+    for (int i = 1; i < count; i++) {
+        int v = pins[i];
+        uint64_t h = g->nodes[v].hash;
+        int j = i - 1;
+        while (j >= 0 && g->nodes[pins[j]].hash > h) {
+            pins[j + 1] = pins[j];
+            j--;
+        }
+        pins[j + 1] = v;
+    }
+}
+
+static int build(NetGraph* g, LogicNode* node);
+
+/*
+ * Function: collect_operands
+ * --------------------------
+ * Pushes the operands of an associative operator onto the build stack,
+ * looking through children that use the same operator.
+ *
+ * returns: Number of operands pushed, or -1 on failure.
+ */
+static int collect_operands(NetGraph* g, LogicNode* node, NodeType op) {
+    if (!node) return 0;
+    if (node->type == op && is_associative(op)) {
+        int l = collect_operands(g, node->left, op);
+        if (l < 0) return -1;
+        int r = collect_operands(g, node->right, op);
+        if (r < 0) return -1;
+        return l + r;
+    }
+    int child = build(g, node);
+    if (child < 0 || !push_pending(g, child)) return -1;
+    return 1;
+}
+
+/*
+ * Function: build
+ * ---------------
+ * Recursively converts an AST node into a graph node.
+ *
+ * returns: The node index, or -1 on failure.
+ */
+static int build(NetGraph* g, LogicNode* node) {
+    if (node->type == NODE_VAR) {
+        char label[2] = { node->var_name, '\0' };
+        uint64_t h = mix64(0x5641520000000000ULL ^ (unsigned char)node->var_name); // "VAR"
+        return add_node(g, h, NETLIST_NODE_VAR, NODE_VAR, label, 0);
+    }
+
+    int start = g->pending_count;
+    int count;
+    if (node->type == NODE_NOT) {
+        count = node->left ? collect_operands(g, node->left, NODE_NOT) : 0;
+    } else {
+        count = collect_operands(g, node->left, node->type);
+        if (count >= 0) {
+            int r = collect_operands(g, node->right, node->type);
+            count = (r < 0) ? -1 : count + r;
+        }
+    }
+    if (count < 0) return -1;
+
+    // All remaining operators are commutative: canonical pin order
+    if (node->type != NODE_NOT) sort_pins(g, start, count);
+
+    uint64_t h = mix64(0x4741544500000000ULL ^ (uint64_t)node->type); // "GATE"
+    for (int i = 0; i < count; i++) h = mix64(h ^ g->nodes[g->pending[start + i]].hash);
+
+    return add_node(g, h, NETLIST_NODE_GATE, node->type, op_label(node->type), count);
+}
+
+bool Graph_AddOutput(NetGraph* g, const char* name, LogicNode* root) {
+    if (!root) return true;
+
+    int root_index = build(g, root);
+    if (root_index < 0 || !push_pending(g, root_index)) return false;
+
+    // Output IDs depend only on the name, so "X" keeps its ID across edits
+    // and only the wire feeding it changes.
+    uint64_t h = hash_label(0x4F55540000000000ULL, name); // "OUT"
+    return add_node(g, h, NETLIST_NODE_OUTPUT, NODE_VAR, name, 1) >= 0;
+}
+
+void Graph_Finalize(NetGraph* g) {
+    uint64_t h = 0x4752415048ULL; // "GRAPH"
+    for (int i = 0; i < g->node_count; i++) {
+        const GraphNode* n = &g->nodes[i];
+        if (n->kind != NETLIST_NODE_OUTPUT) continue;
+        h = mix64(h ^ n->hash);
+        h = mix64(h ^ g->nodes[Graph_NodeInput(g, i, 0)].hash);
+    }
+    g->hash = h;
+}
+
+// --- Version History ---
+
+static NetGraph history_graphs[GRAPH_HISTORY_SIZE];
+static uint32_t history_versions[GRAPH_HISTORY_SIZE];
+static int history_count = 0;
+static int history_next_slot = 0;
+static uint32_t history_next_version = 0;
+static pthread_mutex_t history_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void GraphHistory_Lock(void) {
+    pthread_mutex_lock(&history_mutex);
+}
+
+void GraphHistory_Unlock(void) {
+    pthread_mutex_unlock(&history_mutex);
+}
+
+uint32_t GraphHistory_Commit(NetGraph* g) {
+    // Versions start from a boot-time epoch, so a restarted engine never
+    // reuses a version number that a connected client may still hold.
+    if (history_next_version == 0) {
+        history_next_version = ((uint32_t)time(NULL) & 0xFFFFF) << 10 | 1;
+    }
+
+    for (int i = 0; i < history_count; i++) {
+        if (history_graphs[i].hash == g->hash && history_graphs[i].node_count == g->node_count) {
+            Graph_Free(g);
+            return history_versions[i];
+        }
+    }
+
+    int slot = history_next_slot;
+    if (history_count == GRAPH_HISTORY_SIZE) Graph_Free(&history_graphs[slot]);
+    else history_count++;
+
+    history_graphs[slot] = *g;
+    history_versions[slot] = history_next_version++;
+    history_next_slot = (slot + 1) % GRAPH_HISTORY_SIZE;
+    intern_prune(history_graphs, history_count);
+
+    Graph_Init(g);
+    return history_versions[slot];
+}
+
+const NetGraph* GraphHistory_Get(uint32_t version) {
+    for (int i = 0; i < history_count; i++) {
+        if (history_versions[i] == version) return &history_graphs[i];
+    }
+    return NULL;
+}
+
+// --- Diff ---
+
+typedef struct {
+    uint32_t id;
+    int index;
+} NodeKey;
+
+typedef struct {
+    uint32_t src_id;
+    uint32_t dst_id;
+    int pin;
+    GraphEdge edge;
+} EdgeKey;
+
+static int cmp_node_key(const void* a, const void* b) {
+    uint32_t x = ((const NodeKey*)a)->id, y = ((const NodeKey*)b)->id;
+    return (x > y) - (x < y);
+}
+
+static int cmp_edge_key(const void* a, const void* b) {
+    const EdgeKey* x = a;
+    const EdgeKey* y = b;
+    if (x->dst_id != y->dst_id) return (x->dst_id > y->dst_id) - (x->dst_id < y->dst_id);
+    if (x->pin != y->pin) return x->pin - y->pin;
+    return (x->src_id > y->src_id) - (x->src_id < y->src_id);
+}
+
+static NodeKey* sorted_nodes(const NetGraph* g) {
+    NodeKey* keys = malloc((size_t)(g->node_count ? g->node_count : 1) * sizeof(NodeKey));
+    if (!keys) return NULL;
+    for (int i = 0; i < g->node_count; i++) {
+        keys[i].id = g->nodes[i].id;
+        keys[i].index = i;
+    }
+    qsort(keys, (size_t)g->node_count, sizeof(NodeKey), cmp_node_key);
+    return keys;
+}
+
+static EdgeKey* sorted_edges(const NetGraph* g, int* count_out) {
+    EdgeKey* keys = malloc((size_t)(g->input_count ? g->input_count : 1) * sizeof(EdgeKey));
+    if (!keys) return NULL;
+    int n = 0;
+    for (int i = 0; i < g->node_count; i++) {
+        for (int pin = 0; pin < g->nodes[i].input_count; pin++) {
+            int src = Graph_NodeInput(g, i, pin);
+            keys[n].src_id = g->nodes[src].id;
+            keys[n].dst_id = g->nodes[i].id;
+            keys[n].pin = pin;
+            keys[n].edge.src = src;
+            keys[n].edge.dst = i;
+            keys[n].edge.pin = pin;
+            n++;
+        }
+    }
+    qsort(keys, (size_t)n, sizeof(EdgeKey), cmp_edge_key);
+    *count_out = n;
+    return keys;
+}
+
+bool GraphDelta_Compute(const NetGraph* from, const NetGraph* to, GraphDelta* d) {
+    memset(d, 0, sizeof(*d));
+
+    int from_edges = 0, to_edges = 0;
+    NodeKey* a = sorted_nodes(from);
+    NodeKey* b = sorted_nodes(to);
+    EdgeKey* ea = sorted_edges(from, &from_edges);
+    EdgeKey* eb = sorted_edges(to, &to_edges);
+
+    // Worst case every element of each side is an operation
+    d->removed_nodes = malloc((size_t)(from->node_count + 1) * sizeof(int));
+    d->added_nodes = malloc((size_t)(to->node_count + 1) * sizeof(int));
+    d->kept_from = malloc((size_t)(to->node_count + 1) * sizeof(int));
+    d->kept_to = malloc((size_t)(to->node_count + 1) * sizeof(int));
+    d->removed_edges = malloc((size_t)(from_edges + 1) * sizeof(GraphEdge));
+    d->added_edges = malloc((size_t)(to_edges + 1) * sizeof(GraphEdge));
+
+    bool ok = a && b && ea && eb && d->removed_nodes && d->added_nodes && d->kept_from && d->kept_to && d->removed_edges && d->added_edges;
+    if (ok) {
+        // Merge the two ID-sorted node lists
+        int i = 0, j = 0;
+        while (i < from->node_count || j < to->node_count) {
+            if (j == to->node_count || (i < from->node_count && a[i].id < b[j].id)) {
+                d->removed_nodes[d->removed_node_count++] = a[i++].index;
+            } else if (i == from->node_count || b[j].id < a[i].id) {
+                d->added_nodes[d->added_node_count++] = b[j++].index;
+            } else {
+                d->kept_from[d->kept_node_count] = a[i++].index;
+                d->kept_to[d->kept_node_count++] = b[j++].index;
+            }
+        }
+
+        // Same merge for edges, keyed by (target, pin, source)
+        i = 0; j = 0;
+        while (i < from_edges || j < to_edges) {
+            int c = (i == from_edges) ? 1 : (j == to_edges) ? -1 : cmp_edge_key(&ea[i], &eb[j]);
+            if (c < 0)      d->removed_edges[d->removed_edge_count++] = ea[i++].edge;
+            else if (c > 0) d->added_edges[d->added_edge_count++] = eb[j++].edge;
+            else { i++; j++; }
+        }
+    } else {
+        GraphDelta_Free(d);
+    }
+
+    free(a); free(b); free(ea); free(eb);
+    return ok;
+}
+
+void GraphDelta_Free(GraphDelta* d) {
+    free(d->removed_nodes);
+    free(d->added_nodes);
+    free(d->kept_from);
+    free(d->kept_to);
+    free(d->removed_edges);
+    free(d->added_edges);
+    memset(d, 0, sizeof(*d));
+}
+
+int GraphDelta_OpCount(const GraphDelta* d) {
+    return d->removed_node_count + d->added_node_count + d->removed_edge_count + d->added_edge_count;
+}
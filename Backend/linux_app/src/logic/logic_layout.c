@@ -0,0 +1,539 @@
+/*
+ * File: logic_layout.c
+ * Version: 1.0.0
+ * Description:
+ * Implements the layered circuit layout and its cache.
+ * See logic_layout.h for the three phases.
+ *
+ * Internally the graph is copied into a "layered graph" in which every
+ * edge spans exactly one layer (long edges are chained through dummy
+ * nodes). Dummies take part in ordering and positioning, so long wires
+ * get their own lane instead of cutting through gates, but only real
+ * nodes are returned.
+ */
+
+#include "logic_layout.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define LAYOUT_MAX_SWEEPS   12  // Down+up barycenter sweep pairs
+#define LAYOUT_MAX_STALLS   3   // Stop after this many sweeps without improvement
+#define LAYOUT_PLACE_PASSES 4   // Coordinate relaxation passes
+#define LAYOUT_CACHE_SIZE   32
+
+/*
+ * Struct: LayeredGraph
+ * --------------------
+ * Real nodes keep their NetGraph index; dummies follow them.
+ * Adjacency is stored CSR-style: the predecessors of v are
+ * preds[pred_start[v] .. pred_start[v+1]), likewise for successors.
+ * 'order' lists the nodes of layer l in order[layer_start[l] .. layer_start[l+1]),
+ * and pos[v] is v's index within its layer.
+ */
+typedef struct {
+    int count;
+    int real_count;
+    int* level;
+
+    int* pred_start;
+    int* preds;
+    int* succ_start;
+    int* succs;
+
+    int layer_count;
+    int* layer_start;
+    int* order;
+    int* pos;
+} LayeredGraph;
+
+static void layered_free(LayeredGraph* lg) {
+    free(lg->level);
+    free(lg->pred_start);
+    free(lg->preds);
+    free(lg->succ_start);
+    free(lg->succs);
+    free(lg->layer_start);
+    free(lg->order);
+    free(lg->pos);
+}
+
+/*
+ * Function: build_csr
+ * -------------------
+ * Groups an edge list by one endpoint. 'key' selects the grouping end
+ * and 'val' the stored end.
+ */
+static bool build_csr(int count, int edge_count, const int* key, const int* val, int** start_out, int** list_out) {
+    int* start = calloc((size_t)count + 1, sizeof(int));
+    int* list = malloc((size_t)(edge_count ? edge_count : 1) * sizeof(int));
+    if (!start || !list) { free(start); free(list); return false; }
+
+    for (int e = 0; e < edge_count; e++) start[key[e] + 1]++;
+    for (int v = 0; v < count; v++) start[v + 1] += start[v];
+
+    int* fill = malloc((size_t)(count ? count : 1) * sizeof(int));
+    if (!fill) { free(start); free(list); return false; }
+    memcpy(fill, start, (size_t)count * sizeof(int));
+    for (int e = 0; e < edge_count; e++) list[fill[key[e]]++] = val[e];
+    free(fill);
+
+    *start_out = start;
+    *list_out = list;
+    return true;
+}
+
+/*
+ * Function: build_layered
+ * -----------------------
+ * Phase 1: longest-path levels, dummy insertion and initial layer order.
+ */
+static bool build_layered(const NetGraph* g, LayeredGraph* lg) {
+    memset(lg, 0, sizeof(*lg));
+    int n = g->node_count;
+
+    // Longest path from the inputs; outputs share the rightmost layer
+    int* real_level = malloc((size_t)(n ? n : 1) * sizeof(int));
+    if (!real_level) return false;
+    int max_level = 0;
+    for (int i = 0; i < n; i++) {
+        int level = 0;
+        if (g->nodes[i].kind != NETLIST_NODE_OUTPUT) {
+            for (int pin = 0; pin < g->nodes[i].input_count; pin++) {
+                int in_level = real_level[Graph_NodeInput(g, i, pin)] + 1;
+                if (in_level > level) level = in_level;
+            }
+            if (level > max_level) max_level = level;
+        }
+        real_level[i] = level;
+    }
+    for (int i = 0; i < n; i++) {
+        if (g->nodes[i].kind == NETLIST_NODE_OUTPUT) real_level[i] = max_level + 1;
+    }
+
+    // Every edge spanning k layers becomes k unit edges through k-1 dummies
+    int dummies = 0, edge_count = 0;
+    for (int i = 0; i < n; i++) {
+        for (int pin = 0; pin < g->nodes[i].input_count; pin++) {
+            int span = real_level[i] - real_level[Graph_NodeInput(g, i, pin)];
+            dummies += span - 1;
+            edge_count += span;
+        }
+    }
+
+    lg->real_count = n;
+    lg->count = n + dummies;
+    lg->layer_count = n ? max_level + 2 : 0;
+    lg->level = malloc((size_t)(lg->count ? lg->count : 1) * sizeof(int));
+    int* from = malloc((size_t)(edge_count ? edge_count : 1) * sizeof(int));
+    int* to = malloc((size_t)(edge_count ? edge_count : 1) * sizeof(int));
+    bool ok = lg->level && from && to;
+
+    if (ok) {
+        memcpy(lg->level, real_level, (size_t)n * sizeof(int));
+        int next_dummy = n, e = 0;
+        for (int i = 0; i < n; i++) {
+            for (int pin = 0; pin < g->nodes[i].input_count; pin++) {
+                int src = Graph_NodeInput(g, i, pin);
+                int prev = src;
+                for (int l = real_level[src] + 1; l < real_level[i]; l++) {
+                    lg->level[next_dummy] = l;
+                    from[e] = prev; to[e] = next_dummy; e++;
+                    prev = next_dummy++;
+                }
+                from[e] = prev; to[e] = i; e++;
+            }
+        }
+        ok = build_csr(lg->count, edge_count, to, from, &lg->pred_start, &lg->preds) &&
+             build_csr(lg->count, edge_count, from, to, &lg->succ_start, &lg->succs);
+    }
+    free(from);
+    free(to);
+    free(real_level);
+
+    if (ok) {
+        lg->layer_start = calloc((size_t)lg->layer_count + 1, sizeof(int));
+        lg->order = malloc((size_t)(lg->count ? lg->count : 1) * sizeof(int));
+        lg->pos = malloc((size_t)(lg->count ? lg->count : 1) * sizeof(int));
+        ok = lg->layer_start && lg->order && lg->pos;
+    }
+    if (ok) {
+        // Initial order: creation order, i.e. topological with dummies last
+        for (int v = 0; v < lg->count; v++) lg->layer_start[lg->level[v] + 1]++;
+        for (int l = 0; l < lg->layer_count; l++) lg->layer_start[l + 1] += lg->layer_start[l];
+        int* fill = malloc((size_t)(lg->layer_count ? lg->layer_count : 1) * sizeof(int));
+        ok = (fill != NULL);
+        if (ok) {
+            memcpy(fill, lg->layer_start, (size_t)lg->layer_count * sizeof(int));
+            for (int v = 0; v < lg->count; v++) {
+                int l = lg->level[v];
+                lg->pos[v] = fill[l] - lg->layer_start[l];
+                lg->order[fill[l]++] = v;
+            }
+        }
+        free(fill);
+    }
+    if (!ok) layered_free(lg);
+    return ok;
+}
+
+// --- Phase 2: Crossing Reduction ---
+
+typedef struct {
+    double key;
+    int pos;
+    int node;
+} SortItem;
+
+static int cmp_sort_item(const void* a, const void* b) {
+    const SortItem* x = a;
+    const SortItem* y = b;
+    if (x->key < y->key) return -1;
+    if (x->key > y->key) return 1;
+    return x->pos - y->pos; // Stable: ties keep their current order
+}
+
+/*
+ * Function: order_by_barycenter
+ * -----------------------------
+ * Reorders layer 'l' by the mean position of each node's neighbours in
+ * the adjacent layer (predecessors on a down sweep, successors going up).
+ * Nodes without such neighbours keep their current position as key.
+ */
+static void order_by_barycenter(LayeredGraph* lg, int l, bool down, SortItem* items) {
+    const int* start = down ? lg->pred_start : lg->succ_start;
+    const int* adj = down ? lg->preds : lg->succs;
+    int first = lg->layer_start[l];
+    int width = lg->layer_start[l + 1] - first;
+
+    for (int i = 0; i < width; i++) {
+        int v = lg->order[first + i];
+        int deg = start[v + 1] - start[v];
+        double sum = 0.0;
+        for (int k = start[v]; k < start[v + 1]; k++) sum += lg->pos[adj[k]];
+        items[i].key = deg ? sum / deg : (double)lg->pos[v];
+        items[i].pos = lg->pos[v];
+        items[i].node = v;
+    }
+    qsort(items, (size_t)width, sizeof(SortItem), cmp_sort_item);
+    for (int i = 0; i < width; i++) {
+        lg->order[first + i] = items[i].node;
+        lg->pos[items[i].node] = i;
+    }
+}
+
+/*
+ * Function: count_crossings
+ * -------------------------
+ * Counts edge crossings between every pair of adjacent layers.
+ * Per layer pair, edges are visited sorted by (source pos, target pos);
+ * two edges cross exactly when a later one has a smaller target, which
+ * a Fenwick tree over target positions counts in O(E log V).
+ *
+ * tree, targets: Scratch arrays of at least max layer width + 1 / max degree.
+ */
+static long long count_crossings(const LayeredGraph* lg, int* tree, int* targets) {
+    long long total = 0;
+    for (int l = 0; l + 1 < lg->layer_count; l++) {
+        int width = lg->layer_start[l + 2] - lg->layer_start[l + 1];
+        memset(tree, 0, (size_t)(width + 1) * sizeof(int));
+        int inserted = 0;
+
+        for (int k = lg->layer_start[l]; k < lg->layer_start[l + 1]; k++) {
+            int u = lg->order[k];
+            int deg = 0;
+            for (int s = lg->succ_start[u]; s < lg->succ_start[u + 1]; s++) {
+                // Insertion sort: out-degrees are small
+                int p = lg->pos[lg->succs[s]];
+                int j = deg++;
+                while (j > 0 && targets[j - 1] > p) { targets[j] = targets[j - 1]; j--; }
+                targets[j] = p;
+            }
+            for (int t = 0; t < deg; t++) {
+                int p = targets[t];
+                int not_greater = 0;
+                for (int i = p + 1; i > 0; i -= i & -i) not_greater += tree[i];
+                total += inserted - not_greater;
+                for (int i = p + 1; i <= width; i += i & -i) tree[i]++;
+                inserted++;
+            }
+        }
+    }
+    return total;
+}
+
+static bool reduce_crossings(LayeredGraph* lg) {
+    int max_width = 1, max_degree = 1;
+    for (int l = 0; l < lg->layer_count; l++) {
+        int w = lg->layer_start[l + 1] - lg->layer_start[l];
+        if (w > max_width) max_width = w;
+    }
+    for (int v = 0; v < lg->count; v++) {
+        int d = lg->succ_start[v + 1] - lg->succ_start[v];
+        if (d > max_degree) max_degree = d;
+    }
+
+    SortItem* items = malloc((size_t)max_width * sizeof(SortItem));
+    int* tree = malloc((size_t)(max_width + 1) * sizeof(int));
+    int* targets = malloc((size_t)max_degree * sizeof(int));
+    int* best_order = malloc((size_t)(lg->count ? lg->count : 1) * sizeof(int));
+    bool ok = items && tree && targets && best_order;
+
+    if (ok) {
+        long long best = count_crossings(lg, tree, targets);
+        memcpy(best_order, lg->order, (size_t)lg->count * sizeof(int));
+
+        int stalls = 0;
+        for (int sweep = 0; sweep < LAYOUT_MAX_SWEEPS && best > 0 && stalls < LAYOUT_MAX_STALLS; sweep++) {
+            for (int l = 1; l < lg->layer_count; l++) order_by_barycenter(lg, l, true, items);
+            for (int l = lg->layer_count - 2; l >= 0; l--) order_by_barycenter(lg, l, false, items);
+
+            long long crossings = count_crossings(lg, tree, targets);
+            if (crossings < best) {
+                best = crossings;
+                memcpy(best_order, lg->order, (size_t)lg->count * sizeof(int));
+                stalls = 0;
+            } else {
+                stalls++;
+            }
+        }
+
+        memcpy(lg->order, best_order, (size_t)lg->count * sizeof(int));
+        for (int l = 0; l < lg->layer_count; l++) {
+            for (int k = lg->layer_start[l]; k < lg->layer_start[l + 1]; k++) {
+                lg->pos[lg->order[k]] = k - lg->layer_start[l];
+            }
+        }
+    }
+
+    free(items);
+    free(tree);
+    free(targets);
+    free(best_order);
+    return ok;
+}
+
+// --- Phase 3: Coordinates ---
+
+/*
+ * Function: place_layer
+ * ---------------------
+ * Moves the nodes of layer 'l' toward the mean y of their neighbours,
+ * keeping their order and LAYOUT_NODE_SPACING between them. Packing
+ * greedily from the top and from the bottom and averaging the two
+ * placements keeps the spacing while not biasing either direction.
+ */
+static void place_layer(const LayeredGraph* lg, int l, bool down, double* y, double* fwd, double* bwd) {
+    const int* start = down ? lg->pred_start : lg->succ_start;
+    const int* adj = down ? lg->preds : lg->succs;
+    int first = lg->layer_start[l];
+    int width = lg->layer_start[l + 1] - first;
+    if (width == 0) return;
+
+    for (int i = 0; i < width; i++) {
+        int v = lg->order[first + i];
+        int deg = start[v + 1] - start[v];
+        double desired = y[v];
+        if (deg) {
+            double sum = 0.0;
+            for (int k = start[v]; k < start[v + 1]; k++) sum += y[adj[k]];
+            desired = sum / deg;
+        }
+        fwd[i] = desired;
+        bwd[i] = desired;
+    }
+    for (int i = 1; i < width; i++) {
+        if (fwd[i] < fwd[i - 1] + LAYOUT_NODE_SPACING) fwd[i] = fwd[i - 1] + LAYOUT_NODE_SPACING;
+    }
+    for (int i = width - 2; i >= 0; i--) {
+        if (bwd[i] > bwd[i + 1] - LAYOUT_NODE_SPACING) bwd[i] = bwd[i + 1] - LAYOUT_NODE_SPACING;
+    }
+    for (int i = 0; i < width; i++) y[lg->order[first + i]] = (fwd[i] + bwd[i]) / 2.0;
+}
+
+static bool assign_coordinates(const LayeredGraph* lg, GraphLayout* out) {
+    int max_width = 1;
+    for (int l = 0; l < lg->layer_count; l++) {
+        int w = lg->layer_start[l + 1] - lg->layer_start[l];
+        if (w > max_width) max_width = w;
+    }
+
+    double* y = malloc((size_t)(lg->count ? lg->count : 1) * sizeof(double));
+    double* fwd = malloc((size_t)max_width * sizeof(double));
+    double* bwd = malloc((size_t)max_width * sizeof(double));
+    out->x = malloc((size_t)(lg->real_count ? lg->real_count : 1) * sizeof(int));
+    out->y = malloc((size_t)(lg->real_count ? lg->real_count : 1) * sizeof(int));
+    bool ok = y && fwd && bwd && out->x && out->y;
+
+    if (ok) {
+        for (int v = 0; v < lg->count; v++) y[v] = (double)lg->pos[v] * LAYOUT_NODE_SPACING;
+
+        for (int pass = 0; pass < LAYOUT_PLACE_PASSES; pass++) {
+            for (int l = 1; l < lg->layer_count; l++) place_layer(lg, l, true, y, fwd, bwd);
+            for (int l = lg->layer_count - 2; l >= 0; l--) place_layer(lg, l, false, y, fwd, bwd);
+        }
+
+        double min_y = 0.0;
+        for (int v = 0; v < lg->count; v++) {
+            if (v == 0 || y[v] < min_y) min_y = y[v];
+        }
+        for (int v = 0; v < lg->real_count; v++) {
+            out->x[v] = lg->level[v] * LAYOUT_LAYER_SPACING;
+            out->y[v] = (int)(y[v] - min_y + 0.5);
+        }
+        out->count = lg->real_count;
+    } else {
+        Layout_Free(out);
+    }
+
+    free(y);
+    free(fwd);
+    free(bwd);
+    return ok;
+}
+
+// --- Public API ---
+
+void Layout_Init(GraphLayout* layout) {
+    layout->x = NULL;
+    layout->y = NULL;
+    layout->count = 0;
+}
+
+void Layout_Free(GraphLayout* layout) {
+    free(layout->x);
+    free(layout->y);
+    Layout_Init(layout);
+}
+
+bool Layout_Compute(const NetGraph* g, GraphLayout* out) {
+    Layout_Init(out);
+
+    LayeredGraph lg;
+    if (!build_layered(g, &lg)) return false;
+
+    bool ok = reduce_crossings(&lg) && assign_coordinates(&lg, out);
+    layered_free(&lg);
+    return ok;
+}
+
+// --- Cache ---
+
+/*
+ * Struct: CachedLayout
+ * --------------------
+ * Coordinates stored by stable node ID (sorted), because two graphs
+ * with the same hash may list their nodes in a different order.
+ */
+typedef struct {
+    uint64_t hash;
+    int count;
+    uint32_t* ids;
+    int* x;
+    int* y;
+} CachedLayout;
+
+static CachedLayout layout_cache[LAYOUT_CACHE_SIZE];
+static int layout_cache_next = 0;
+static pthread_mutex_t layout_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int find_id(const uint32_t* ids, int count, uint32_t id) {
+    int lo = 0, hi = count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (ids[mid] == id) return mid;
+        if (ids[mid] < id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+/*
+ * Function: cache_lookup
+ * ----------------------
+ * Copies a cached layout into 'out'. Caller holds layout_cache_mutex.
+ *
+ * returns: true on a hit.
+ */
+static bool cache_lookup(const NetGraph* g, GraphLayout* out) {
+    for (int c = 0; c < LAYOUT_CACHE_SIZE; c++) {
+        const CachedLayout* entry = &layout_cache[c];
+        if (!entry->ids || entry->hash != g->hash || entry->count != g->node_count) continue;
+
+        out->x = malloc((size_t)(g->node_count ? g->node_count : 1) * sizeof(int));
+        out->y = malloc((size_t)(g->node_count ? g->node_count : 1) * sizeof(int));
+        if (!out->x || !out->y) { Layout_Free(out); return false; }
+
+        for (int i = 0; i < g->node_count; i++) {
+            int k = find_id(entry->ids, entry->count, g->nodes[i].id);
+            if (k < 0) { Layout_Free(out); return false; }
+            out->x[i] = entry->x[k];
+            out->y[i] = entry->y[k];
+        }
+        out->count = g->node_count;
+        return true;
+    }
+    return false;
+}
+
+typedef struct {
+    uint32_t id;
+    int x;
+    int y;
+} IdPoint;
+
+static int cmp_id_point(const void* a, const void* b) {
+    uint32_t x = ((const IdPoint*)a)->id, y = ((const IdPoint*)b)->id;
+    return (x > y) - (x < y);
+}
+
+static void cache_store(const NetGraph* g, const GraphLayout* layout) {
+    int n = g->node_count;
+    IdPoint* points = malloc((size_t)(n ? n : 1) * sizeof(IdPoint));
+    CachedLayout entry = { g->hash, n, NULL, NULL, NULL };
+    entry.ids = malloc((size_t)(n ? n : 1) * sizeof(uint32_t));
+    entry.x = malloc((size_t)(n ? n : 1) * sizeof(int));
+    entry.y = malloc((size_t)(n ? n : 1) * sizeof(int));
+
+    if (points && entry.ids && entry.x && entry.y) {
+        for (int i = 0; i < n; i++) {
+            points[i].id = g->nodes[i].id;
+            points[i].x = layout->x[i];
+            points[i].y = layout->y[i];
+        }
+        qsort(points, (size_t)n, sizeof(IdPoint), cmp_id_point);
+        for (int i = 0; i < n; i++) {
+            entry.ids[i] = points[i].id;
+            entry.x[i] = points[i].x;
+            entry.y[i] = points[i].y;
+        }
+
+        pthread_mutex_lock(&layout_cache_mutex);
+        CachedLayout* slot = &layout_cache[layout_cache_next];
+        free(slot->ids);
+        free(slot->x);
+        free(slot->y);
+        *slot = entry;
+        layout_cache_next = (layout_cache_next + 1) % LAYOUT_CACHE_SIZE;
+        pthread_mutex_unlock(&layout_cache_mutex);
+    } else {
+        free(entry.ids);
+        free(entry.x);
+        free(entry.y);
+    }
+    free(points);
+}
+
+bool Layout_Get(const NetGraph* g, GraphLayout* out) {
+    Layout_Init(out);
+
+    pthread_mutex_lock(&layout_cache_mutex);
+    bool hit = cache_lookup(g, out);
+    pthread_mutex_unlock(&layout_cache_mutex);
+    if (hit) return true;
+
+    // Compute outside the lock: large layouts take a while
+    if (!Layout_Compute(g, out)) return false;
+    cache_store(g, out);
+    return true;
+}
@@ -1,37 +1,64 @@
 /*
  * File: logic_minimizer.c
- * Version: 1.0.0
+ * Version: 1.1.0
  * Description:
  * The Quine-McCluskey Optimization Engine.
  * This module is the mathematical core of the application. It reduces
  * complex logic trees into their simplest possible Sum-of-Products (SOP)
  * or Product-of-Sums (POS) representations.
+ *
+ * Version 1.1.0 builds truth tables with the compiled simulator
+ * (logic_sim.h): all 64 rows come out of one bit-sliced sweep instead
+ * of 64 recursive AST walks.
  */
 
 #include "logic_minimizer.h"
+#include "logic_sim.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 /*
- * Function: Minimizer_GenerateTruthTable
- * --------------------------------------
- * Brute-force generation of the truth table by evaluating the AST
- * for all 64 possible input combinations (assuming 6 vars max).
+ * Function: evaluate_rows
+ * -----------------------
+ * Returns the function's value for all 64 input combinations
+ * (assuming 6 vars max) as a bitmask: bit i is the row for mask i.
+ * Falls back to walking the AST if the program cannot be compiled.
  */
-TruthTable Minimizer_GenerateTruthTable(LogicNode* root) {
+static uint64_t evaluate_rows(LogicNode* root) {
+    uint64_t rows = 0;
+    SimProgram prog;
+    if (Sim_CompileTree(root, &prog)) {
+        rows = Sim_TruthTable(&prog, 0);
+        Sim_Free(&prog);
+    } else {
+        for (int i = 0; i < 64; i++) {
+            if (AST_Evaluate(root, i)) rows |= 1ULL << i;
+        }
+    }
+    return rows;
+}
+
+static TruthTable rows_to_table(uint64_t rows) {
     TruthTable table;
     table.count = 0;
-    if (!root) return table;
-
     for (int i = 0; i < 64; i++) {
-        if (AST_Evaluate(root, i)) {
-            table.minterms[table.count++] = i;
-        }
+        if ((rows >> i) & 1) table.minterms[table.count++] = i;
     }
     return table;
 }
 
+/*
+ * Function: Minimizer_GenerateTruthTable
+ * --------------------------------------
+ * Brute-force generation of the truth table: the function is evaluated
+ * for all 64 possible input combinations (assuming 6 vars max).
+ */
+TruthTable Minimizer_GenerateTruthTable(LogicNode* root) {
+    if (!root) return rows_to_table(0);
+    return rows_to_table(evaluate_rows(root));
+}
+
 // --- Quine-McCluskey Helper Functions ---
 
 /*
@@ -220,13 +247,6 @@ void Minimizer_PrintPOS(ImplicantList* list, char* buffer) {
  * Inverts the truth table generation logic to find inputs that result in 0.
  */
 TruthTable Minimizer_GetMaxterms(LogicNode* root) {
-    TruthTable table;
-    table.count = 0;
-    if (!root) return table;
-    for (int i = 0; i < 64; i++) {
-        if (!AST_Evaluate(root, i)) { // Check for 0s
-            table.minterms[table.count++] = i;
-        }
-    }
-    return table;
+    if (!root) return rows_to_table(0);
+    return rows_to_table(~evaluate_rows(root)); // Rows that are 0
 }
\ No newline at end of file
@@ -1,188 +1,330 @@
 /*
  * File: logic_netlist.c
- * Version: 1.0.0
+ * Version: 1.4.1
  * Description:
  * Implements the Logic-to-Netlist conversion.
- * This module traverses the Abstract Syntax Tree (AST) and serializes it
- * into a JSON format compatible with graph visualization libraries (e.g., Cytoscape.js).
+ * This module serializes circuit graphs into a JSON format compatible
+ * with graph visualization libraries (e.g., Cytoscape.js), or into the
+ * compact binary format.
  *
- * It performs "flattening" of associative operators (A & B & C) to simplify
- * the visual representation.
+ * Flattening of associative operators (A & B & C) is done while the
+ * graph is built (see logic_graph.c).
+ *
+ * Version 1.1.0 writes into a growable DynBuf, so large circuits can no
+ * longer be cut off mid-element.
+ *
+ * Version 1.2.0 separates traversal from encoding and adds the binary form.
+ *
+ * Version 1.3.0 serializes hash-consed NetGraphs instead of walking the
+ * AST directly. Node IDs are stable across edits, edges carry an ID, and
+ * a GraphDelta between two versions can be written out on its own.
+ *
+ * Version 1.4.0 can attach layout coordinates (logic_layout.h) to nodes,
+ * and reports nodes a delta moved. Version 1.4.1 grows the binary string
+ * table instead of folding labels past the 64th into one entry.
  */
 
 #include "logic_netlist.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 
-/*
- * Function: append
- * ----------------
- * Helper to safely append a string to the main buffer.
- * Checks bounds to prevent buffer overflow.
- */
-static void append(char* buffer, int* offset, int max_len, const char* str) {
-    int len = strlen(str);
-    if (*offset + len < max_len - 1) {
-        strcpy(buffer + *offset, str);
-        *offset += len;
+static const char* kind_name(NetlistNodeKind kind) {
+    switch (kind) {
+        case NETLIST_NODE_VAR:    return "var";
+        case NETLIST_NODE_OUTPUT: return "output";
+        default:                  return "gate";
     }
 }
 
+// --- JSON ---
+
+static void append_position(DynBuf* out, const GraphLayout* layout, int index) {
+    DynBuf_AppendStr(out, "{ \"x\": ");
+    DynBuf_AppendInt(out, layout->x[index]);
+    DynBuf_AppendStr(out, ", \"y\": ");
+    DynBuf_AppendInt(out, layout->y[index]);
+    DynBuf_AppendStr(out, " }");
+}
+
 /*
- * Function: is_associative
- * ------------------------
- * Returns true if the operator supports flattening.
- * e.g., (A AND B) AND C  ==  A AND B AND C.
+ * Function: json_node / json_edge
+ * -------------------------------
+ * Write a single Cytoscape element followed by a separating comma.
  */
-static bool is_associative(NodeType type) {
-    return (type == NODE_AND || type == NODE_OR || type == NODE_XOR);
+static void json_node(DynBuf* out, const NetGraph* g, const GraphLayout* layout, int index) {
+    const GraphNode* node = &g->nodes[index];
+    DynBuf_AppendStr(out, "{ \"data\": { \"id\": \"n");
+    DynBuf_AppendUInt(out, node->id);
+    DynBuf_AppendStr(out, "\", \"label\": ");
+    DynBuf_AppendJsonString(out, node->label);
+    DynBuf_AppendStr(out, ", \"type\": \"");
+    DynBuf_AppendStr(out, kind_name(node->kind));
+    DynBuf_AppendStr(out, "\" }");
+    if (layout) {
+        DynBuf_AppendStr(out, ", \"position\": ");
+        append_position(out, layout, index);
+    }
+    DynBuf_AppendStr(out, " },");
 }
 
-// Forward declaration for recursive traversal
-static int traverse(LogicNode* node, char* buffer, int* offset, int max_len, int* id_counter);
+static void append_edge_id(DynBuf* out, const NetGraph* g, int src, int dst, int pin) {
+    DynBuf_AppendStr(out, "\"e");
+    DynBuf_AppendUInt(out, g->nodes[src].id);
+    DynBuf_AppendChar(out, '_');
+    DynBuf_AppendUInt(out, g->nodes[dst].id);
+    DynBuf_AppendChar(out, '_');
+    DynBuf_AppendInt(out, pin);
+    DynBuf_AppendChar(out, '"');
+}
 
-/*
- * Function: collect_inputs
- * ------------------------
- * Recursively gathers inputs for an associative operator.
- * If a child node has the same type as the parent (e.g., AND inside AND),
- * it merges the child's inputs directly into the parent, skipping the child node.
- */
-static void collect_inputs(LogicNode* node, int parent_id, NodeType parent_type, 
-                           char* buffer, int* offset, int max_len, int* id_counter) {
-    if (!node) return;
+static void json_edge(DynBuf* out, const NetGraph* g, int src, int dst, int pin) {
+    DynBuf_AppendStr(out, "{ \"data\": { \"id\": ");
+    append_edge_id(out, g, src, dst, pin);
+    DynBuf_AppendStr(out, ", \"source\": \"n");
+    DynBuf_AppendUInt(out, g->nodes[src].id);
+    DynBuf_AppendStr(out, "\", \"target\": \"n");
+    DynBuf_AppendUInt(out, g->nodes[dst].id);
+    DynBuf_AppendStr(out, "\" } },");
+}
 
-    // Case 1: Flatten - Child is same operator as parent
-    if (node->type == parent_type && is_associative(parent_type)) {
-        collect_inputs(node->left, parent_id, parent_type, buffer, offset, max_len, id_counter);
-        collect_inputs(node->right, parent_id, parent_type, buffer, offset, max_len, id_counter);
-    } 
-    // Case 2: Standard - Child is different, create a new edge
-    else {
-        int child_id = traverse(node, buffer, offset, max_len, id_counter);
-        
-        char edge_json[128];
-        sprintf(edge_json, "{ \"data\": { \"source\": \"n%d\", \"target\": \"n%d\" } },", child_id, parent_id);
-        append(buffer, offset, max_len, edge_json);
+void Netlist_WriteJSON(const NetGraph* g, const GraphLayout* layout, DynBuf* out) {
+    DynBuf_AppendChar(out, '[');
+    for (int i = 0; i < g->node_count; i++) {
+        json_node(out, g, layout, i);
     }
+    for (int i = 0; i < g->node_count; i++) {
+        for (int pin = 0; pin < g->nodes[i].input_count; pin++) {
+            json_edge(out, g, Graph_NodeInput(g, i, pin), i, pin);
+        }
+    }
+    DynBuf_TrimChar(out, ',');
+    DynBuf_AppendChar(out, ']');
 }
 
-/*
- * Function: traverse
- * ------------------
- * Recursive function to visit nodes and generate JSON elements.
- *
- * returns: The unique integer ID of the processed node.
- */
-static int traverse(LogicNode* node, char* buffer, int* offset, int max_len, int* id_counter) {
-    if (!node) return -1;
-
-    int my_id = (*id_counter)++;
-    char temp[256];
-
-    // 1. Determine visual label
-    char label[16];
-    switch (node->type) {
-        case NODE_VAR: sprintf(label, "%c", node->var_name); break;
-        case NODE_AND: sprintf(label, "AND"); break;
-        case NODE_OR:  sprintf(label, "OR"); break;
-        case NODE_XOR: sprintf(label, "XOR"); break;
-        case NODE_NOT: sprintf(label, "NOT"); break;
-        default: sprintf(label, "?"); break;
-    }
-
-    // 2. Generate Node JSON
-    sprintf(temp, "{ \"data\": { \"id\": \"n%d\", \"label\": \"%s\", \"type\": \"%s\" } },", 
-            my_id, label, (node->type == NODE_VAR) ? "var" : "gate");
-    append(buffer, offset, max_len, temp);
-
-    // 3. Process Children (with flattening logic)
-    if (node->type == NODE_NOT) {
-        if (node->left) {
-            int child_id = traverse(node->left, buffer, offset, max_len, id_counter);
-            sprintf(temp, "{ \"data\": { \"source\": \"n%d\", \"target\": \"n%d\" } },", child_id, my_id);
-            append(buffer, offset, max_len, temp);
+void Netlist_WriteDeltaJSON(const NetGraph* from, const GraphLayout* from_layout,
+                            const NetGraph* to, const GraphLayout* to_layout,
+                            const GraphDelta* d, DynBuf* out) {
+    DynBuf_AppendStr(out, "{ \"add_nodes\": [");
+    for (int i = 0; i < d->added_node_count; i++) {
+        json_node(out, to, to_layout, d->added_nodes[i]);
+    }
+    DynBuf_TrimChar(out, ',');
+
+    if (to_layout) {
+        // Kept nodes whose coordinates changed (all of them if 'from' had none)
+        DynBuf_AppendStr(out, "], \"move_nodes\": [");
+        for (int i = 0; i < d->kept_node_count; i++) {
+            int a = d->kept_from[i], b = d->kept_to[i];
+            if (from_layout && from_layout->x[a] == to_layout->x[b] && from_layout->y[a] == to_layout->y[b]) continue;
+            DynBuf_AppendStr(out, "{ \"id\": \"n");
+            DynBuf_AppendUInt(out, to->nodes[b].id);
+            DynBuf_AppendStr(out, "\", \"position\": ");
+            append_position(out, to_layout, b);
+            DynBuf_AppendStr(out, " },");
         }
-    } else if (node->type != NODE_VAR) {
-        collect_inputs(node->left, my_id, node->type, buffer, offset, max_len, id_counter);
-        collect_inputs(node->right, my_id, node->type, buffer, offset, max_len, id_counter);
+        DynBuf_TrimChar(out, ',');
+    }
+
+    DynBuf_AppendStr(out, "], \"remove_nodes\": [");
+    for (int i = 0; i < d->removed_node_count; i++) {
+        if (i > 0) DynBuf_AppendChar(out, ',');
+        DynBuf_AppendStr(out, "\"n");
+        DynBuf_AppendUInt(out, from->nodes[d->removed_nodes[i]].id);
+        DynBuf_AppendChar(out, '"');
     }
 
-    return my_id;
+    DynBuf_AppendStr(out, "], \"add_edges\": [");
+    for (int i = 0; i < d->added_edge_count; i++) {
+        const GraphEdge* e = &d->added_edges[i];
+        json_edge(out, to, e->src, e->dst, e->pin);
+    }
+    DynBuf_TrimChar(out, ',');
+
+    DynBuf_AppendStr(out, "], \"remove_edges\": [");
+    for (int i = 0; i < d->removed_edge_count; i++) {
+        const GraphEdge* e = &d->removed_edges[i];
+        if (i > 0) DynBuf_AppendChar(out, ',');
+        append_edge_id(out, from, e->src, e->dst, e->pin);
+    }
+    DynBuf_AppendStr(out, "] }");
 }
 
+// --- Binary ---
+
 /*
- * Function: Netlist_GenerateJSON
- * ------------------------------
- * Entry point for generating a netlist for a single output.
+ * Struct: LabelTable
+ * ------------------
+ * Growable string table for the binary form. Pointers refer into the
+ * graph's nodes, which outlive the serialization call. 'failed' is set
+ * once a label could not be added (the encoding is then unusable).
  */
-void Netlist_GenerateJSON(const char* target_name, LogicNode* root, char* buffer, int max_len) {
-    int offset = 0;
-    int id_counter = 0;
+typedef struct {
+    const char** labels;
+    int count;
+    int cap;
+    bool failed;
+} LabelTable;
+
+static int intern_label(LabelTable* t, const char* label) {
+    for (int i = 0; i < t->count; i++) {
+        if (strcmp(t->labels[i], label) == 0) return i;
+    }
+    if (t->count == t->cap) {
+        int new_cap = t->cap ? t->cap * 2 : 32;
+        const char** grown = realloc(t->labels, (size_t)new_cap * sizeof(*grown));
+        if (!grown) {
+            t->failed = true;
+            return 0;
+        }
+        t->labels = grown;
+        t->cap = new_cap;
+    }
+    t->labels[t->count] = label;
+    return t->count++;
+}
+
+void Netlist_WriteBinary(const NetGraph* g, const GraphLayout* layout, DynBuf* out) {
+    LabelTable table = { NULL, 0, 0, false };
 
-    append(buffer, &offset, max_len, "[");
+    // Node section goes to a scratch buffer: the string table precedes it
+    // but is only complete once every node has been seen.
+    DynBuf nodes;
+    DynBuf_Init(&nodes);
+    for (int i = 0; i < g->node_count; i++) {
+        const GraphNode* n = &g->nodes[i];
+        DynBuf_AppendVarint(&nodes, n->id);
+        DynBuf_AppendChar(&nodes, (char)n->kind);
+        DynBuf_AppendVarint(&nodes, (unsigned)intern_label(&table, n->label));
+    }
+
+    // Header
+    DynBuf_AppendChar(out, NETLIST_BIN_MAGIC0);
+    DynBuf_AppendChar(out, NETLIST_BIN_MAGIC1);
+    DynBuf_AppendChar(out, NETLIST_BIN_VERSION);
 
-    if (root) {
-        int root_id = traverse(root, buffer, &offset, max_len, &id_counter);
+    // String table
+    DynBuf_AppendVarint(out, (unsigned)table.count);
+    for (int i = 0; i < table.count; i++) {
+        size_t len = strlen(table.labels[i]);
+        DynBuf_AppendVarint(out, len);
+        DynBuf_Append(out, table.labels[i], len);
+    }
 
-        // Create the final Output Node (e.g., "X")
-        char temp[256];
-        int out_id = id_counter++;
-        sprintf(temp, "{ \"data\": { \"id\": \"n%d\", \"label\": \"%s\", \"type\": \"output\" } },", 
-                out_id, target_name);
-        append(buffer, &offset, max_len, temp);
+    // Node and edge sections
+    DynBuf_AppendVarint(out, (unsigned)g->node_count);
+    if (g->node_count) DynBuf_Append(out, nodes.data, nodes.len);
+    DynBuf_AppendVarint(out, (unsigned)g->input_count);
+    for (int i = 0; i < g->node_count; i++) {
+        for (int pin = 0; pin < g->nodes[i].input_count; pin++) {
+            DynBuf_AppendVarint(out, g->nodes[Graph_NodeInput(g, i, pin)].id);
+            DynBuf_AppendVarint(out, g->nodes[i].id);
+            DynBuf_AppendVarint(out, (unsigned)pin);
+        }
+    }
 
-        // Link logic root to output node
-        sprintf(temp, "{ \"data\": { \"source\": \"n%d\", \"target\": \"n%d\" } },", root_id, out_id);
-        append(buffer, &offset, max_len, temp);
+    // Optional layout section
+    DynBuf_AppendChar(out, layout ? 1 : 0);
+    if (layout) {
+        for (int i = 0; i < g->node_count; i++) {
+            DynBuf_AppendVarint(out, (unsigned)layout->x[i]);
+            DynBuf_AppendVarint(out, (unsigned)layout->y[i]);
+        }
     }
 
-    // Handle trailing comma validity
-    if (offset > 1 && buffer[offset-1] == ',') {
-        offset--; 
+    if (nodes.failed || table.failed) out->failed = true;
+    DynBuf_Free(&nodes);
+    free(table.labels);
+}
+
+// --- AST Entry Points ---
+
+static bool build_graph(NetGraph* g, const char* const names[], LogicNode* const roots[], int count) {
+    Graph_Init(g);
+    for (int i = 0; i < count; i++) {
+        if (!Graph_AddOutput(g, names[i], roots[i])) {
+            Graph_Free(g);
+            return false;
+        }
     }
+    Graph_Finalize(g);
+    return true;
+}
+
+static void write_trees(const char* const names[], LogicNode* const roots[], int count, bool binary, DynBuf* out) {
+    NetGraph g;
+    if (!build_graph(&g, names, roots, count)) {
+        out->failed = true;
+        return;
+    }
+    if (binary) Netlist_WriteBinary(&g, NULL, out);
+    else        Netlist_WriteJSON(&g, NULL, out);
+    Graph_Free(&g);
+}
+
+bool Netlist_BuildCombinedGraph(
+    NetGraph* g,
+    const char* n1, LogicNode* r1,
+    const char* n2, LogicNode* r2,
+    const char* n3, LogicNode* r3,
+    const char* n4, LogicNode* r4)
+{
+    const char* names[4] = { n1, n2, n3, n4 };
+    LogicNode* roots[4] = { r1, r2, r3, r4 };
+    return build_graph(g, names, roots, 4);
+}
 
-    append(buffer, &offset, max_len, "]");
-    buffer[offset] = '\0'; 
+/*
+ * Function: Netlist_GenerateJSON
+ * ------------------------------
+ * Entry point for generating a netlist for a single output.
+ */
+void Netlist_GenerateJSON(const char* target_name, LogicNode* root, DynBuf* out) {
+    write_trees(&target_name, &root, 1, false, out);
 }
 
 /*
  * Function: Netlist_GenerateCombinedJSON
  * --------------------------------------
  * Entry point for generating the unified 4-channel netlist.
- * Iterates through all 4 roots and appends them to the same JSON array.
+ * Gates shared between channels appear once, with fan-out.
  */
 void Netlist_GenerateCombinedJSON(
     const char* n1, LogicNode* r1,
     const char* n2, LogicNode* r2,
     const char* n3, LogicNode* r3,
     const char* n4, LogicNode* r4,
-    char* buffer, int max_len) 
+    DynBuf* out)
 {
-    int offset = 0;
-    int id_counter = 0;
-    char temp[256];
-
-    append(buffer, &offset, max_len, "[");
-
-    // Macro to process a single tree within the combined list
-    #define ADD_TREE(name, root) \
-        if (root) { \
-            int root_id = traverse(root, buffer, &offset, max_len, &id_counter); \
-            int out_id = id_counter++; \
-            sprintf(temp, "{ \"data\": { \"id\": \"n%d\", \"label\": \"%s\", \"type\": \"output\" } },", out_id, name); \
-            append(buffer, &offset, max_len, temp); \
-            sprintf(temp, "{ \"data\": { \"source\": \"n%d\", \"target\": \"n%d\" } },", root_id, out_id); \
-            append(buffer, &offset, max_len, temp); \
-        }
+    const char* names[4] = { n1, n2, n3, n4 };
+    LogicNode* roots[4] = { r1, r2, r3, r4 };
+    write_trees(names, roots, 4, false, out);
+}
 
-    ADD_TREE(n1, r1);
-    ADD_TREE(n2, r2);
-    ADD_TREE(n3, r3);
-    ADD_TREE(n4, r4);
+/*
+ * Function: Netlist_GenerateBinary
+ * --------------------------------
+ * Binary counterpart of Netlist_GenerateJSON.
+ */
+void Netlist_GenerateBinary(const char* target_name, LogicNode* root, DynBuf* out) {
+    write_trees(&target_name, &root, 1, true, out);
+}
 
-    if (offset > 1 && buffer[offset-1] == ',') offset--; 
-    append(buffer, &offset, max_len, "]");
-    buffer[offset] = '\0'; 
-}
\ No newline at end of file
+/*
+ * Function: Netlist_GenerateCombinedBinary
+ * ----------------------------------------
+ * Binary counterpart of Netlist_GenerateCombinedJSON. Node IDs match the
+ * JSON form exactly (node ID N in the binary stream is "nN" in JSON).
+ */
+void Netlist_GenerateCombinedBinary(
+    const char* n1, LogicNode* r1,
+    const char* n2, LogicNode* r2,
+    const char* n3, LogicNode* r3,
+    const char* n4, LogicNode* r4,
+    DynBuf* out)
+{
+    const char* names[4] = { n1, n2, n3, n4 };
+    LogicNode* roots[4] = { r1, r2, r3, r4 };
+    write_trees(names, roots, 4, true, out);
+}
@@ -0,0 +1,481 @@
+/*
+ * File: logic_par.c
+ * Version: 1.2.0
+ * Description:
+ * Implements the thread pool, the chunk partition and both parallel
+ * evaluation modes (see logic_par.h).
+ *
+ * The pool runs "jobs": a function every thread (the caller as worker 0)
+ * calls once with its worker index. Workers sleep on a condition
+ * variable between jobs, so an idle pool costs nothing.
+ *
+ * Deques are small mutex-protected arrays rather than lock-free
+ * Chase-Lev deques: a chunk is thousands of gates, so one uncontended
+ * lock per chunk is noise, and every chunk is pushed exactly once per
+ * sweep, so a deque never needs more than chunk_count entries and
+ * never wraps.
+ *
+ * Note: Version 1.2.0 hands out the pool in arrival order (a ticket
+ * lock) instead of through a plain mutex, so a caller that runs many
+ * short jobs back to back (Stim_Run) cannot keep others waiting.
+ */
+
+#include "logic_par.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+/*
+ * Struct: ParDeque
+ * ----------------
+ * The owner pushes and pops at 'bottom'; thieves take from 'top'.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    int* items;
+    int capacity;
+    int top;
+    int bottom;
+} ParDeque;
+
+typedef struct {
+    struct ParPool* pool;
+    int index;
+} WorkerArg;
+
+struct ParPool {
+    int thread_count;
+    pthread_t threads[PAR_MAX_THREADS];
+    WorkerArg args[PAR_MAX_THREADS];
+    ParDeque deques[PAR_MAX_THREADS];
+
+    pthread_mutex_t run_lock;   // Guards the run tickets
+    pthread_cond_t run_cond;
+    unsigned long run_next;     // Next ticket to hand out
+    unsigned long run_serving;  // Ticket whose job may run; one job at a time
+    pthread_mutex_t lock;       // Guards the fields below
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    ParJobFn job;
+    void* job_ctx;
+    unsigned long generation;   // Bumped per job; workers wait for a change
+    int busy;                   // Workers still inside the current job
+    bool stopping;
+};
+
+// --- Deques ---
+
+static bool deque_reserve(ParDeque* d, int capacity) {
+    if (d->capacity >= capacity) return true;
+    int* grown = realloc(d->items, (size_t)capacity * sizeof(int));
+    if (!grown) return false;
+    d->items = grown;
+    d->capacity = capacity;
+    return true;
+}
+
+static void deque_push(ParDeque* d, int item) {
+    pthread_mutex_lock(&d->lock);
+    d->items[d->bottom++] = item;
+    pthread_mutex_unlock(&d->lock);
+}
+
+static int deque_pop(ParDeque* d) {
+    int item = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) item = d->items[--d->bottom];
+    pthread_mutex_unlock(&d->lock);
+    return item;
+}
+
+static int deque_steal(ParDeque* d) {
+    int item = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) item = d->items[d->top++];
+    pthread_mutex_unlock(&d->lock);
+    return item;
+}
+
+// --- Pool ---
+
+static void* worker_main(void* arg) {
+    ParPool* pool = ((WorkerArg*)arg)->pool;
+    int index = ((WorkerArg*)arg)->index;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->stopping) pthread_cond_wait(&pool->work_cond, &pool->lock);
+        if (pool->stopping) break;
+        seen = pool->generation;
+        ParJobFn job = pool->job;
+        void* ctx = pool->job_ctx;
+        pthread_mutex_unlock(&pool->lock);
+
+        job(ctx, index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) pthread_cond_signal(&pool->done_cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/*
+ * Function: run_begin
+ * -------------------
+ * Waits until every caller that arrived earlier has finished, then
+ * owns the pool until run_end. Callers are served first come, first
+ * served, unlike a mutex, which may hand itself straight back to the
+ * thread that released it.
+ */
+static void run_begin(ParPool* pool) {
+    pthread_mutex_lock(&pool->run_lock);
+    unsigned long ticket = pool->run_next++;
+    while (pool->run_serving != ticket) pthread_cond_wait(&pool->run_cond, &pool->run_lock);
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+static void run_end(ParPool* pool) {
+    pthread_mutex_lock(&pool->run_lock);
+    pool->run_serving++;
+    pthread_cond_broadcast(&pool->run_cond);
+    pthread_mutex_unlock(&pool->run_lock);
+}
+
+/*
+ * Function: pool_run
+ * ------------------
+ * Runs 'job' on every thread of the pool and returns when all are done.
+ * The caller owns the pool (run_begin).
+ */
+static void pool_run(ParPool* pool, ParJobFn job, void* ctx) {
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->job_ctx = ctx;
+    pool->busy = pool->thread_count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    job(ctx, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) pthread_cond_wait(&pool->done_cond, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void ParPool_Run(ParPool* pool, ParJobFn job, void* ctx) {
+    if (!pool) {
+        job(ctx, 0);
+        return;
+    }
+    run_begin(pool);
+    pool_run(pool, job, ctx);
+    run_end(pool);
+}
+
+ParPool* ParPool_Create(int threads) {
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+    if (threads > PAR_MAX_THREADS) threads = PAR_MAX_THREADS;
+
+    ParPool* pool = calloc(1, sizeof(ParPool));
+    if (!pool) return NULL;
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_cond_init(&pool->run_cond, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    for (int i = 0; i < PAR_MAX_THREADS; i++) pthread_mutex_init(&pool->deques[i].lock, NULL);
+
+    // A thread that fails to start just leaves a smaller pool
+    pool->thread_count = 1;
+    for (int i = 1; i < threads; i++) {
+        WorkerArg* arg = &pool->args[i];
+        arg->pool = pool;
+        arg->index = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_main, arg) != 0) break;
+        pool->thread_count++;
+    }
+    return pool;
+}
+
+void ParPool_Destroy(ParPool* pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 1; i < pool->thread_count; i++) pthread_join(pool->threads[i], NULL);
+
+    for (int i = 0; i < PAR_MAX_THREADS; i++) {
+        free(pool->deques[i].items);
+        pthread_mutex_destroy(&pool->deques[i].lock);
+    }
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->run_cond);
+    pthread_mutex_destroy(&pool->run_lock);
+    free(pool);
+}
+
+int ParPool_Threads(const ParPool* pool) {
+    return pool ? pool->thread_count : 1;
+}
+
+static ParPool* shared_pool = NULL;
+static pthread_once_t shared_once = PTHREAD_ONCE_INIT;
+
+static void create_shared_pool(void) {
+    shared_pool = ParPool_Create(0);
+}
+
+ParPool* Par_SharedPool(void) {
+    pthread_once(&shared_once, create_shared_pool);
+    return shared_pool;
+}
+
+// --- Partitioning ---
+
+/*
+ * Function: close_chunk
+ * ---------------------
+ * Ends the open chunk at gate 'end' if it is non-empty.
+ */
+static void close_chunk(ParPlan* plan, int end) {
+    if (end > plan->chunk_start[plan->chunk_count]) plan->chunk_start[++plan->chunk_count] = end;
+}
+
+bool ParPlan_Build(const SimProgram* p, int chunk_gates, ParPlan* plan) {
+    memset(plan, 0, sizeof(*plan));
+    if (chunk_gates <= 0) chunk_gates = PAR_CHUNK_GATES;
+
+    // Worst case: every level on its own, plus one extra chunk per split
+    int max_chunks = p->level_count + p->gate_count / chunk_gates + 1;
+    plan->chunk_start = malloc(((size_t)max_chunks + 1) * sizeof(int));
+    int* gate_chunk = malloc((size_t)p->gate_count * sizeof(int) + 1);
+    if (!plan->chunk_start || !gate_chunk) {
+        free(gate_chunk);
+        ParPlan_Free(plan);
+        return false;
+    }
+
+    plan->chunk_start[0] = 0;
+    for (int l = 0; l < p->level_count; l++) {
+        int first = p->level_start[l], last = p->level_start[l + 1];
+        int width = last - first;
+        if (width >= chunk_gates) {
+            // Wide level: own chunks of near-equal size
+            close_chunk(plan, first);
+            int pieces = width / chunk_gates;
+            for (int k = 1; k <= pieces; k++) close_chunk(plan, first + (int)((long long)width * k / pieces));
+        } else if (last - plan->chunk_start[plan->chunk_count] >= chunk_gates) {
+            // Narrow levels accumulate until the chunk is big enough
+            close_chunk(plan, last);
+        }
+    }
+    close_chunk(plan, p->gate_count);
+
+    for (int c = 0; c < plan->chunk_count; c++) {
+        for (int i = plan->chunk_start[c]; i < plan->chunk_start[c + 1]; i++) gate_chunk[i] = c;
+    }
+
+    // Edges pred -> succ, deduplicated per consumer with a last-seen mark.
+    // Chunks are in gate order and gates only read earlier gates, so
+    // every edge points forward and the chunk order is topological.
+    int edge_cap = 256, edge_count = 0;
+    int* edge_pred = malloc((size_t)edge_cap * sizeof(int));
+    int* edge_succ = malloc((size_t)edge_cap * sizeof(int));
+    int* seen = malloc((size_t)plan->chunk_count * sizeof(int) + 1);
+    plan->dep_count = calloc((size_t)plan->chunk_count + 1, sizeof(int));
+    plan->succ_start = calloc((size_t)plan->chunk_count + 1, sizeof(int));
+    plan->pending = malloc((size_t)plan->chunk_count * sizeof(int) + 1);
+    plan->roots = malloc((size_t)plan->chunk_count * sizeof(int) + 1);
+    bool ok = edge_pred && edge_succ && seen && plan->dep_count && plan->succ_start && plan->pending && plan->roots;
+
+    if (ok) for (int c = 0; c < plan->chunk_count; c++) seen[c] = -1;
+    for (int c = 0; ok && c < plan->chunk_count; c++) {
+        for (int i = plan->chunk_start[c]; ok && i < plan->chunk_start[c + 1]; i++) {
+            uint32_t in[2] = { p->in0[i], p->in1[i] };
+            for (int k = 0; k < 2; k++) {
+                if (in[k] < SIM_FIRST_GATE_SLOT) continue;
+                int from = gate_chunk[in[k] - SIM_FIRST_GATE_SLOT];
+                if (from == c || seen[from] == c) continue;
+                seen[from] = c;
+
+                if (edge_count == edge_cap) {
+                    edge_cap *= 2;
+                    int* grown_pred = realloc(edge_pred, (size_t)edge_cap * sizeof(int));
+                    if (grown_pred) edge_pred = grown_pred;
+                    int* grown_succ = realloc(edge_succ, (size_t)edge_cap * sizeof(int));
+                    if (grown_succ) edge_succ = grown_succ;
+                    if (!grown_pred || !grown_succ) {
+                        ok = false;
+                        break;
+                    }
+                }
+                edge_pred[edge_count] = from;
+                edge_succ[edge_count] = c;
+                edge_count++;
+                plan->dep_count[c]++;
+            }
+        }
+    }
+
+    if (ok) {
+        plan->succ = malloc((size_t)edge_count * sizeof(int) + 1);
+        ok = (plan->succ != NULL);
+    }
+    if (ok) {
+        // CSR by predecessor: count, prefix-sum, place
+        for (int e = 0; e < edge_count; e++) plan->succ_start[edge_pred[e] + 1]++;
+        for (int c = 0; c < plan->chunk_count; c++) plan->succ_start[c + 1] += plan->succ_start[c];
+        for (int c = 0; c < plan->chunk_count; c++) seen[c] = plan->succ_start[c];
+        for (int e = 0; e < edge_count; e++) plan->succ[seen[edge_pred[e]]++] = edge_succ[e];
+
+        for (int c = 0; c < plan->chunk_count; c++) {
+            if (plan->dep_count[c] == 0) plan->roots[plan->root_count++] = c;
+        }
+    }
+
+    free(edge_pred);
+    free(edge_succ);
+    free(seen);
+    free(gate_chunk);
+    if (!ok) ParPlan_Free(plan);
+    return ok;
+}
+
+void ParPlan_Free(ParPlan* plan) {
+    free(plan->chunk_start);
+    free(plan->succ_start);
+    free(plan->succ);
+    free(plan->dep_count);
+    free(plan->roots);
+    free(plan->pending);
+    memset(plan, 0, sizeof(*plan));
+}
+
+// --- Gate-Parallel Sweep ---
+
+typedef struct {
+    ParPool* pool;
+    const ParPlan* plan;
+    const SimProgram* prog;
+    uint64_t* values;
+    int remaining;  // Chunks not yet finished (atomic)
+} SweepJob;
+
+static int take_chunk(ParPool* pool, int worker) {
+    int chunk = deque_pop(&pool->deques[worker]);
+    // Steal round-robin starting after ourselves, so thieves spread out
+    for (int k = 1; chunk < 0 && k < pool->thread_count; k++) {
+        chunk = deque_steal(&pool->deques[(worker + k) % pool->thread_count]);
+    }
+    return chunk;
+}
+
+static void sweep_job(void* ctx, int worker) {
+    SweepJob* job = ctx;
+    const ParPlan* plan = job->plan;
+
+    while (__atomic_load_n(&job->remaining, __ATOMIC_ACQUIRE) > 0) {
+        int c = take_chunk(job->pool, worker);
+        if (c < 0) {
+            sched_yield();
+            continue;
+        }
+
+        Sim_SweepRange(job->prog, job->values, plan->chunk_start[c], plan->chunk_start[c + 1]);
+
+        // The release half publishes this chunk's values to whoever
+        // takes the successor it completes
+        for (int s = plan->succ_start[c]; s < plan->succ_start[c + 1]; s++) {
+            int next = plan->succ[s];
+            if (__atomic_sub_fetch(&plan->pending[next], 1, __ATOMIC_ACQ_REL) == 0) {
+                deque_push(&job->pool->deques[worker], next);
+            }
+        }
+        __atomic_sub_fetch(&job->remaining, 1, __ATOMIC_ACQ_REL);
+    }
+}
+
+void Par_EvaluateSlice(ParPool* pool, const ParPlan* plan, SimProgram* p, const uint64_t* inputs,
+                       uint64_t* outputs) {
+    for (uint32_t vars = p->var_mask; vars; vars &= vars - 1) {
+        int v = __builtin_ctz(vars);
+        p->values[v] = inputs[v];
+    }
+
+    if (!pool || pool->thread_count < 2 || plan->chunk_count < 2) {
+        Sim_SweepRange(p, p->values, 0, p->gate_count);
+    } else {
+        run_begin(pool);
+        bool ready = true;
+        for (int i = 0; i < pool->thread_count; i++) {
+            ParDeque* d = &pool->deques[i];
+            if (!deque_reserve(d, plan->chunk_count)) ready = false;
+            d->top = d->bottom = 0;
+        }
+
+        if (ready) {
+            memcpy(plan->pending, plan->dep_count, (size_t)plan->chunk_count * sizeof(int));
+            // Deal the roots out so every worker starts with something
+            for (int r = 0; r < plan->root_count; r++) {
+                ParDeque* d = &pool->deques[r % pool->thread_count];
+                d->items[d->bottom++] = plan->roots[r];
+            }
+            SweepJob job = { pool, plan, p, p->values, plan->chunk_count };
+            pool_run(pool, sweep_job, &job);
+        } else {
+            Sim_SweepRange(p, p->values, 0, p->gate_count);
+        }
+        run_end(pool);
+    }
+
+    for (int i = 0; i < p->output_count; i++) outputs[i] = p->values[p->outputs[i].slot];
+}
+
+// --- Stimulus-Parallel Batch ---
+
+typedef struct {
+    SimProgram* prog;
+    const uint32_t* masks;
+    uint32_t* results;
+    int count;
+    int next;  // First vector not yet claimed (atomic)
+} BatchJob;
+
+static void batch_job(void* ctx, int worker) {
+    BatchJob* job = ctx;
+    const int block = PAR_BATCH_SLICES * SIM_LANES;
+
+    // The caller owns the program, so it can use the built-in scratch
+    uint64_t* values = worker == 0 ? job->prog->values : Sim_AllocValues(job->prog);
+    if (!values) return;  // The remaining threads pick up the slack
+
+    for (;;) {
+        int base = __atomic_fetch_add(&job->next, block, __ATOMIC_RELAXED);
+        if (base >= job->count) break;
+        int n = job->count - base < block ? job->count - base : block;
+        Sim_EvaluateBatchWith(job->prog, values, job->masks + base, n, job->results + base);
+    }
+    if (worker != 0) free(values);
+}
+
+void Par_EvaluateBatch(ParPool* pool, SimProgram* p, const uint32_t* masks, int count, uint32_t* results) {
+    if (!pool || pool->thread_count < 2 || count <= SIM_LANES) {
+        Sim_EvaluateBatch(p, masks, count, results);
+        return;
+    }
+    run_begin(pool);
+    BatchJob job = { p, masks, results, count, 0 };
+    pool_run(pool, batch_job, &job);
+    run_end(pool);
+}
@@ -1,8 +1,10 @@
 /*
  * File: logic_parser.c
- * Version: 1.1.0
+ * Version: 1.2.0
  * Description:
  * Updated to parse '%' as NAND and '$' as NOR.
+ * Version 1.2.0 parses '@' as a D flip-flop: "@(expr)" is a register
+ * loaded with 'expr' on every clock.
  */
 
 #include "logic_parser.h"
@@ -34,6 +36,7 @@ int get_precedence(char op) {
     switch(op) {
         case '!': return 4; 
         case '\'': return 4; 
+        case '@': return 4; // DFF (unary, like NOT)
         case '*': return 3; // AND
         case '%': return 3; // NAND (Same as AND)
         case '+': return 2; // OR
@@ -52,6 +55,7 @@ NodeType char_to_type(char op) {
         case '!': return NODE_NOT;
         case '%': return NODE_NAND; // New Token
         case '$': return NODE_NOR;  // New Token
+        case '@': return NODE_DFF;
         default:  return NODE_AND;
     }
 }
@@ -60,7 +64,7 @@ void build_subtree(NodeStack* nodes, OpStack* ops) {
     char op = op_pop(ops);
     LogicNode* node = AST_CreateNode(char_to_type(op));
     
-    if (op == '!') {
+    if (op == '!' || op == '@') {
         node->left = node_pop(nodes);
     } else {
         node->right = node_pop(nodes);
@@ -117,9 +121,9 @@ LogicNode* Parser_ParseString(const char* expression) {
             last_token = CLOSE_PAREN;
         } 
         else {
-            // Handles *, +, ^, %, $
+            // Handles *, +, ^, %, $, and the prefix operators ! and @
             while (ops.top > 0 && get_precedence(op_peek(&ops)) >= get_precedence(c)) {
-                if (op_peek(&ops) == '!' && c == '!') break; 
+                if ((op_peek(&ops) == '!' || op_peek(&ops) == '@') && (c == '!' || c == '@')) break; 
                 build_subtree(&nodes, &ops);
             }
             op_push(&ops, c);
@@ -1,6 +1,6 @@
 /*
  * File: logic_program.c
- * Version: 1.0.0
+ * Version: 1.1.0
  * Description:
  * Utilities for direct minterm programming.
  * This module allows configuring the logic engine using raw CSV lists
@@ -8,6 +8,8 @@
  *
  * It essentially performs the reverse of the analysis pipeline:
  * Minterms -> Minimization -> SOP Equation -> State Update.
+ *
+ * Note: Version 1.1.0 also accepts minterm bit masks (binary frames).
  */
 
 #include "logic_program.h"
@@ -17,6 +19,26 @@
 #include <stdlib.h>
 #include <string.h>
 
+/*
+ * Function: program_table
+ * -----------------------
+ * Minimizes a truth table and stores the SOP equation for 'target'.
+ */
+static void program_table(const char* target, TruthTable tt) {
+    // Run Minimization (Recover the equation)
+    ImplicantList primes = Minimizer_FindPrimeImplicants(tt);
+    char sop_buffer[512];
+    Minimizer_PrintSOP(&primes, sop_buffer);
+
+    printf("  [K-Map Input] %s: %d minterms -> SOP: %s\n", target, tt.count, sop_buffer);
+
+    // Update Global State with the new equation string
+    if (strcmp(target, "x") == 0) AppState_SetInputX(sop_buffer);
+    else if (strcmp(target, "y") == 0) AppState_SetInputY(sop_buffer);
+    else if (strcmp(target, "z") == 0) AppState_SetInputZ(sop_buffer);
+    else if (strcmp(target, "w") == 0) AppState_SetInputW(sop_buffer);
+}
+
 /*
  * Function: Program_From_Minterms
  * -------------------------------
@@ -30,24 +52,26 @@ void Program_From_Minterms(const char* target, char* minterm_csv) {
     TruthTable tt;
     tt.count = 0;
 
-    // 1. Parse CSV into Truth Table structure
-    char* token = strtok(minterm_csv, ",");
+    // Parse CSV into Truth Table structure
+    char* save = NULL;
+    char* token = strtok_r(minterm_csv, ",", &save);
     while (token != NULL && tt.count < MAX_MINTERMS) {
         tt.minterms[tt.count++] = atoi(token);
-        token = strtok(NULL, ",");
+        token = strtok_r(NULL, ",", &save);
     }
+    program_table(target, tt);
+}
 
-    // 2. Run Minimization (Recover the equation)
-    ImplicantList primes = Minimizer_FindPrimeImplicants(tt);
-    char sop_buffer[512];
-    Minimizer_PrintSOP(&primes, sop_buffer);
-
-    printf("  [K-Map Input] %s Minterms: [%s] -> SOP: %s\n", 
-           target, minterm_csv, sop_buffer);
-
-    // 3. Update Global State with the new equation string
-    if (strcmp(target, "x") == 0) AppState_SetInputX(sop_buffer);
-    else if (strcmp(target, "y") == 0) AppState_SetInputY(sop_buffer);
-    else if (strcmp(target, "z") == 0) AppState_SetInputZ(sop_buffer);
-    else if (strcmp(target, "w") == 0) AppState_SetInputW(sop_buffer);
-}
\ No newline at end of file
+/*
+ * Function: Program_From_Mask
+ * ---------------------------
+ * Same as Program_From_Minterms for a minterm bit mask.
+ */
+void Program_From_Mask(const char* target, uint64_t mask) {
+    TruthTable tt;
+    tt.count = 0;
+    for (int m = 0; m < 64 && tt.count < MAX_MINTERMS; m++) {
+        if (mask >> m & 1u) tt.minterms[tt.count++] = m;
+    }
+    program_table(target, tt);
+}
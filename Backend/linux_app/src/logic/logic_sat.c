@@ -0,0 +1,614 @@
+/*
+ * File: logic_sat.c
+ * Version: 1.0.0
+ * Description:
+ * Implements the CDCL SAT solver (see logic_sat.h).
+ *
+ * Watch invariant: the first two literals of every clause are its
+ * watches, and watches[l] lists the clauses with l in one of those two
+ * positions. When l becomes false each such clause either finds another
+ * non-false literal to watch, becomes unit (lits[0] is implied, with the
+ * clause as reason), or is a conflict. An implied literal is always
+ * lits[0] of its reason, which conflict analysis relies on.
+ *
+ * Database reduction only happens at decision level 0, right after a
+ * restart. Level-0 assignments are permanent, so at that point every
+ * clause can be simplified against them (satisfied ones dropped, false
+ * literals removed), no reason pointer is needed any more, and the
+ * arena and all watch lists can simply be rebuilt.
+ */
+
+#include "logic_sat.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define L_TRUE   1
+#define L_FALSE  0
+#define L_UNDEF  (-1)
+
+#define CLAUSE_LEARNT  1
+#define CLAUSE_DELETED 2
+#define CLAUSE_LBD_SHIFT 2
+
+#define VAR_DECAY      0.95
+#define RESTART_BASE   100    // Conflicts per Luby unit
+#define KEEP_LBD       2      // Learnt clauses this good are never deleted
+
+// --- Containers ---
+
+static bool vec_push(SatSolver* s, SatVec* v, int x) {
+    if (v->count == v->cap) {
+        int new_cap = v->cap ? v->cap * 2 : 4;
+        int* grown = realloc(v->data, (size_t)new_cap * sizeof(int));
+        if (!grown) {
+            s->failed = true;
+            return false;
+        }
+        v->data = grown;
+        v->cap = new_cap;
+    }
+    v->data[v->count++] = x;
+    return true;
+}
+
+static inline int lit_value(const SatSolver* s, int lit) {
+    int v = s->value[SAT_VAR(lit)];
+    return v < 0 ? L_UNDEF : (v ^ (lit & 1));
+}
+
+static inline int* clause_lits(SatSolver* s, int cr) {
+    return &s->arena[cr + 2];
+}
+
+// --- Activity Heap (max-heap on activity) ---
+
+static bool heap_less(const SatSolver* s, int a, int b) {
+    return s->activity[a] > s->activity[b];
+}
+
+static void heap_up(SatSolver* s, int i) {
+    int var = s->heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!heap_less(s, var, s->heap[parent])) break;
+        s->heap[i] = s->heap[parent];
+        s->heap_index[s->heap[i]] = i;
+        i = parent;
+    }
+    s->heap[i] = var;
+    s->heap_index[var] = i;
+}
+
+static void heap_down(SatSolver* s, int i) {
+    int var = s->heap[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= s->heap_count) break;
+        if (child + 1 < s->heap_count && heap_less(s, s->heap[child + 1], s->heap[child])) child++;
+        if (!heap_less(s, s->heap[child], var)) break;
+        s->heap[i] = s->heap[child];
+        s->heap_index[s->heap[i]] = i;
+        i = child;
+    }
+    s->heap[i] = var;
+    s->heap_index[var] = i;
+}
+
+static void heap_insert(SatSolver* s, int var) {
+    if (s->heap_index[var] >= 0) return;
+    s->heap[s->heap_count] = var;
+    s->heap_index[var] = s->heap_count++;
+    heap_up(s, s->heap_index[var]);
+}
+
+static int heap_pop(SatSolver* s) {
+    int top = s->heap[0];
+    s->heap_index[top] = -1;
+    if (--s->heap_count > 0) {
+        s->heap[0] = s->heap[s->heap_count];
+        s->heap_index[s->heap[0]] = 0;
+        heap_down(s, 0);
+    }
+    return top;
+}
+
+static void bump_var(SatSolver* s, int var) {
+    if ((s->activity[var] += s->var_inc) > 1e100) {
+        for (int v = 0; v < s->var_count; v++) s->activity[v] *= 1e-100;
+        s->var_inc *= 1e-100;
+    }
+    if (s->heap_index[var] >= 0) heap_up(s, s->heap_index[var]);
+}
+
+// --- Setup ---
+
+void Sat_Init(SatSolver* s) {
+    memset(s, 0, sizeof(*s));
+    s->var_inc = 1.0;
+    s->ok = true;
+}
+
+void Sat_Free(SatSolver* s) {
+    for (int l = 0; l < 2 * s->var_cap && s->watches; l++) free(s->watches[l].data);
+    free(s->watches);
+    free(s->arena);
+    free(s->problem.data);
+    free(s->learnts.data);
+    free(s->value);
+    free(s->phase);
+    free(s->model);
+    free(s->seen);
+    free(s->level);
+    free(s->reason);
+    free(s->activity);
+    free(s->heap);
+    free(s->heap_index);
+    free(s->trail);
+    free(s->trail_lim);
+    free(s->scratch.data);
+    free(s->to_clear.data);
+    memset(s, 0, sizeof(*s));
+}
+
+#define GROW(field, count) \
+    do { \
+        void* grown_ = realloc(s->field, (size_t)(count) * sizeof(*s->field)); \
+        if (!grown_) { s->failed = true; return -1; } \
+        s->field = grown_; \
+    } while (0)
+
+int Sat_NewVar(SatSolver* s) {
+    if (s->failed) return -1;
+    if (s->var_count == s->var_cap) {
+        int cap = s->var_cap ? s->var_cap * 2 : 64;
+        GROW(value, cap);
+        GROW(phase, cap);
+        GROW(model, cap);
+        GROW(seen, cap);
+        GROW(level, cap);
+        GROW(reason, cap);
+        GROW(activity, cap);
+        GROW(heap, cap);
+        GROW(heap_index, cap);
+        GROW(trail, cap);
+        GROW(trail_lim, cap);
+        GROW(watches, 2 * cap);
+        memset(s->watches + 2 * s->var_cap, 0, (size_t)(2 * (cap - s->var_cap)) * sizeof(SatVec));
+        s->var_cap = cap;
+    }
+    int v = s->var_count++;
+    s->value[v] = L_UNDEF;
+    s->phase[v] = 0;
+    s->model[v] = 0;
+    s->seen[v] = 0;
+    s->level[v] = 0;
+    s->reason[v] = -1;
+    s->activity[v] = 0.0;
+    s->heap_index[v] = -1;
+    heap_insert(s, v);
+    return v;
+}
+
+/*
+ * Function: alloc_clause
+ * ----------------------
+ * Copies a clause into the arena.
+ *
+ * returns: Its offset, or -1 if memory ran out.
+ */
+static int alloc_clause(SatSolver* s, const int* lits, int count, int flags) {
+    if (s->arena_len + count + 2 > s->arena_cap) {
+        int cap = s->arena_cap ? s->arena_cap : 1024;
+        while (cap < s->arena_len + count + 2) cap *= 2;
+        int* grown = realloc(s->arena, (size_t)cap * sizeof(int));
+        if (!grown) {
+            s->failed = true;
+            return -1;
+        }
+        s->arena = grown;
+        s->arena_cap = cap;
+    }
+    int cr = s->arena_len;
+    s->arena[cr] = count;
+    s->arena[cr + 1] = flags;
+    memcpy(&s->arena[cr + 2], lits, (size_t)count * sizeof(int));
+    s->arena_len += count + 2;
+    return cr;
+}
+
+static void attach(SatSolver* s, int cr) {
+    int* lits = clause_lits(s, cr);
+    vec_push(s, &s->watches[lits[0]], cr);
+    vec_push(s, &s->watches[lits[1]], cr);
+}
+
+static void enqueue(SatSolver* s, int lit, int reason) {
+    int v = SAT_VAR(lit);
+    s->value[v] = (int8_t)((lit & 1) ^ 1);
+    s->level[v] = s->level_count;
+    s->reason[v] = reason;
+    s->trail[s->trail_count++] = lit;
+}
+
+static void cancel_until(SatSolver* s, int level) {
+    if (s->level_count <= level) return;
+    for (int i = s->trail_count - 1; i >= s->trail_lim[level]; i--) {
+        int v = SAT_VAR(s->trail[i]);
+        s->phase[v] = s->value[v];
+        s->value[v] = L_UNDEF;
+        s->reason[v] = -1;
+        heap_insert(s, v);
+    }
+    s->trail_count = s->trail_lim[level];
+    s->qhead = s->trail_count;
+    s->level_count = level;
+}
+
+/*
+ * Function: propagate
+ * -------------------
+ * Unit propagation over the trail from qhead.
+ *
+ * returns: The conflicting clause, or -1.
+ */
+static int propagate(SatSolver* s) {
+    while (s->qhead < s->trail_count) {
+        int false_lit = SAT_NOT(s->trail[s->qhead++]);
+        SatVec* ws = &s->watches[false_lit];
+        int i = 0, j = 0, n = ws->count;
+        s->propagations++;
+
+        while (i < n) {
+            int cr = ws->data[i++];
+            if (s->arena[cr + 1] & CLAUSE_DELETED) continue;  // Dropped lazily
+            int size = s->arena[cr];
+            int* lits = clause_lits(s, cr);
+
+            if (lits[0] == false_lit) {
+                lits[0] = lits[1];
+                lits[1] = false_lit;
+            }
+            if (lit_value(s, lits[0]) == L_TRUE) {
+                ws->data[j++] = cr;
+                continue;
+            }
+
+            bool moved = false;
+            for (int k = 2; k < size; k++) {
+                if (lit_value(s, lits[k]) != L_FALSE) {
+                    lits[1] = lits[k];
+                    lits[k] = false_lit;
+                    vec_push(s, &s->watches[lits[1]], cr);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            ws->data[j++] = cr;
+            if (lit_value(s, lits[0]) == L_FALSE) {
+                while (i < n) ws->data[j++] = ws->data[i++];
+                ws->count = j;
+                s->qhead = s->trail_count;
+                return cr;
+            }
+            enqueue(s, lits[0], cr);
+        }
+        ws->count = j;
+    }
+    return -1;
+}
+
+bool Sat_AddClause(SatSolver* s, const int* lits, int count) {
+    if (!s->ok || s->failed) return s->ok;
+    cancel_until(s, 0);
+
+    // Simplify against level 0: drop false literals and duplicates,
+    // skip the clause if it is satisfied or a tautology
+    s->scratch.count = 0;
+    for (int i = 0; i < count; i++) {
+        int lit = lits[i];
+        int value = lit_value(s, lit);
+        if (value == L_TRUE) return true;
+        if (value == L_FALSE) continue;
+
+        bool keep = true;
+        for (int k = 0; k < s->scratch.count; k++) {
+            if (s->scratch.data[k] == lit) keep = false;
+            if (s->scratch.data[k] == SAT_NOT(lit)) return true;
+        }
+        if (keep && !vec_push(s, &s->scratch, lit)) return true;
+    }
+
+    if (s->scratch.count == 0) {
+        s->ok = false;
+    } else if (s->scratch.count == 1) {
+        enqueue(s, s->scratch.data[0], -1);
+        if (propagate(s) >= 0) s->ok = false;
+    } else {
+        int cr = alloc_clause(s, s->scratch.data, s->scratch.count, 0);
+        if (cr >= 0 && vec_push(s, &s->problem, cr)) attach(s, cr);
+    }
+    return s->ok;
+}
+
+// --- Conflict Analysis ---
+
+/*
+ * Function: redundant
+ * -------------------
+ * Local minimization: a literal of the learnt clause can go if every
+ * other literal of its reason is already in the clause (or at level 0).
+ */
+static bool redundant(SatSolver* s, int lit) {
+    int cr = s->reason[SAT_VAR(lit)];
+    if (cr < 0) return false;
+    int size = s->arena[cr];
+    int* lits = clause_lits(s, cr);
+    for (int k = 1; k < size; k++) {
+        int v = SAT_VAR(lits[k]);
+        if (!s->seen[v] && s->level[v] > 0) return false;
+    }
+    return true;
+}
+
+/*
+ * Function: analyze
+ * -----------------
+ * Derives the first-UIP clause from a conflict into s->scratch, with the
+ * asserting literal first and a literal of the backjump level second.
+ *
+ * returns: The backjump level.
+ */
+static int analyze(SatSolver* s, int confl) {
+    SatVec* learnt = &s->scratch;
+    learnt->count = 0;
+    vec_push(s, learnt, 0);  // Placeholder for the asserting literal
+    s->to_clear.count = 0;
+
+    int path = 0;
+    int p = -1;
+    int index = s->trail_count - 1;
+    do {
+        int size = s->arena[confl];
+        int* lits = clause_lits(s, confl);
+        for (int k = (p < 0 ? 0 : 1); k < size; k++) {
+            int q = lits[k];
+            int v = SAT_VAR(q);
+            if (s->seen[v] || s->level[v] == 0) continue;
+            s->seen[v] = 1;
+            vec_push(s, &s->to_clear, v);
+            bump_var(s, v);
+            if (s->level[v] >= s->level_count) {
+                path++;
+            } else {
+                vec_push(s, learnt, q);
+            }
+        }
+        while (!s->seen[SAT_VAR(s->trail[index])]) index--;
+        p = s->trail[index--];
+        confl = s->reason[SAT_VAR(p)];
+        s->seen[SAT_VAR(p)] = 0;
+        path--;
+    } while (path > 0);
+    learnt->data[0] = SAT_NOT(p);
+
+    int kept = 1;
+    for (int i = 1; i < learnt->count; i++) {
+        if (!redundant(s, learnt->data[i])) learnt->data[kept++] = learnt->data[i];
+    }
+    learnt->count = kept;
+    for (int i = 0; i < s->to_clear.count; i++) s->seen[s->to_clear.data[i]] = 0;
+
+    int backjump = 0;
+    if (learnt->count > 1) {
+        int max_i = 1;
+        for (int i = 2; i < learnt->count; i++) {
+            if (s->level[SAT_VAR(learnt->data[i])] > s->level[SAT_VAR(learnt->data[max_i])]) max_i = i;
+        }
+        int tmp = learnt->data[1];
+        learnt->data[1] = learnt->data[max_i];
+        learnt->data[max_i] = tmp;
+        backjump = s->level[SAT_VAR(learnt->data[1])];
+    }
+    return backjump;
+}
+
+// Distinct decision levels in the learnt clause
+static int compute_lbd(SatSolver* s, const SatVec* learnt) {
+    int lbd = 0;
+    for (int i = 0; i < learnt->count; i++) {
+        int l = s->level[SAT_VAR(learnt->data[i])];
+        // 'seen' is clear here; borrow it, indexed by level (levels < var_count)
+        if (!s->seen[l]) {
+            s->seen[l] = 1;
+            lbd++;
+        }
+    }
+    for (int i = 0; i < learnt->count; i++) s->seen[s->level[SAT_VAR(learnt->data[i])]] = 0;
+    return lbd;
+}
+
+// --- Database Reduction ---
+
+typedef struct {
+    int lbd;
+    int size;
+    int cr;
+} LearntRank;
+
+static int rank_compare(const void* a, const void* b) {
+    const LearntRank* x = a;
+    const LearntRank* y = b;
+    if (x->lbd != y->lbd) return x->lbd - y->lbd;
+    return x->size - y->size;
+}
+
+/*
+ * Function: rebuild
+ * -----------------
+ * At level 0: simplifies every live clause against the permanent
+ * assignments, copies the survivors into a fresh arena and rebuilds the
+ * watch lists.
+ */
+static void rebuild(SatSolver* s) {
+    int* old = s->arena;
+    s->arena = NULL;
+    s->arena_len = 0;
+    s->arena_cap = 0;
+    for (int l = 0; l < 2 * s->var_count; l++) s->watches[l].count = 0;
+    for (int i = 0; i < s->trail_count; i++) s->reason[SAT_VAR(s->trail[i])] = -1;
+
+    SatVec* lists[2] = { &s->problem, &s->learnts };
+    for (int li = 0; li < 2; li++) {
+        SatVec* list = lists[li];
+        int kept = 0;
+        for (int i = 0; i < list->count; i++) {
+            int cr = list->data[i];
+            int size = old[cr];
+            int flags = old[cr + 1];
+            int* lits = &old[cr + 2];
+            if (flags & CLAUSE_DELETED) continue;
+
+            bool satisfied = false;
+            int n = 0;
+            for (int k = 0; k < size; k++) {
+                int value = lit_value(s, lits[k]);
+                if (value == L_TRUE) satisfied = true;
+                if (value == L_UNDEF) lits[n++] = lits[k];
+            }
+            // Propagation is complete at level 0, so a survivor should have
+            // two or more; a unit or empty one is still handled soundly
+            if (satisfied) continue;
+            if (n == 0) s->ok = false;
+            if (n == 1) enqueue(s, lits[0], -1);
+            if (n < 2) continue;
+
+            int fresh = alloc_clause(s, lits, n, flags);
+            if (fresh < 0) break;
+            attach(s, fresh);
+            list->data[kept++] = fresh;
+        }
+        list->count = kept;
+    }
+    free(old);
+}
+
+static void reduce_db(SatSolver* s) {
+    int n = s->learnts.count;
+    LearntRank* ranks = malloc((size_t)n * sizeof(LearntRank) + 1);
+    if (!ranks) return;
+    for (int i = 0; i < n; i++) {
+        int cr = s->learnts.data[i];
+        ranks[i].lbd = s->arena[cr + 1] >> CLAUSE_LBD_SHIFT;
+        ranks[i].size = s->arena[cr];
+        ranks[i].cr = cr;
+    }
+    qsort(ranks, (size_t)n, sizeof(LearntRank), rank_compare);
+    for (int i = n / 2; i < n; i++) {
+        if (ranks[i].lbd > KEEP_LBD) s->arena[ranks[i].cr + 1] |= CLAUSE_DELETED;
+    }
+    free(ranks);
+}
+
+// --- Search ---
+
+static double luby(double y, int x) {
+    int size = 1, seq = 0;
+    while (size < x + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        seq--;
+        x = x % size;
+    }
+    double r = 1.0;
+    for (int i = 0; i < seq; i++) r *= y;
+    return r;
+}
+
+static int pick_branch(SatSolver* s) {
+    while (s->heap_count > 0) {
+        int v = heap_pop(s);
+        if (s->value[v] == L_UNDEF) return SAT_LIT(v, !s->phase[v]);
+    }
+    return -1;
+}
+
+SatResult Sat_Solve(SatSolver* s, long long conflict_limit) {
+    if (!s->ok) return SAT_UNSAT;
+    if (s->failed) return SAT_UNKNOWN;
+    cancel_until(s, 0);
+    if (s->max_learnts == 0) s->max_learnts = s->problem.count / 3 + 1000;
+
+    long long start_conflicts = s->conflicts;
+    int restart = 0;
+    long long budget = (long long)(luby(2.0, restart) * RESTART_BASE);
+
+    for (;;) {
+        if (s->failed) {
+            cancel_until(s, 0);
+            return SAT_UNKNOWN;
+        }
+
+        int confl = propagate(s);
+        if (confl >= 0) {
+            s->conflicts++;
+            budget--;
+            if (s->level_count == 0) {
+                s->ok = false;
+                return SAT_UNSAT;
+            }
+
+            int backjump = analyze(s, confl);
+            int lbd = compute_lbd(s, &s->scratch);
+            cancel_until(s, backjump);
+            if (s->scratch.count == 1) {
+                enqueue(s, s->scratch.data[0], -1);
+            } else {
+                int cr = alloc_clause(s, s->scratch.data, s->scratch.count,
+                                      CLAUSE_LEARNT | (lbd << CLAUSE_LBD_SHIFT));
+                if (cr < 0) continue;  // 'failed' is set
+                vec_push(s, &s->learnts, cr);
+                attach(s, cr);
+                enqueue(s, s->scratch.data[0], cr);
+            }
+            s->var_inc /= VAR_DECAY;
+
+            if (conflict_limit > 0 && s->conflicts - start_conflicts >= conflict_limit) {
+                cancel_until(s, 0);
+                return SAT_UNKNOWN;
+            }
+            continue;
+        }
+
+        if (budget <= 0) {
+            cancel_until(s, 0);
+            s->restarts++;
+            budget = (long long)(luby(2.0, ++restart) * RESTART_BASE);
+            if (s->learnts.count - s->trail_count >= s->max_learnts) {
+                reduce_db(s);
+                rebuild(s);
+                s->max_learnts += s->max_learnts / 10;
+                if (!s->ok) return SAT_UNSAT;
+            }
+            continue;
+        }
+
+        int lit = pick_branch(s);
+        if (lit < 0) {
+            memcpy(s->model, s->value, (size_t)s->var_count);
+            cancel_until(s, 0);
+            return SAT_SAT;
+        }
+        s->decisions++;
+        s->trail_lim[s->level_count++] = s->trail_count;
+        enqueue(s, lit, -1);
+    }
+}
+
+bool Sat_ModelValue(const SatSolver* s, int var) {
+    return var >= 0 && var < s->var_count && s->model[var] == 1;
+}
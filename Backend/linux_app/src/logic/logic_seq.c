@@ -0,0 +1,323 @@
+/*
+ * File: logic_seq.c
+ * Version: 1.0.1
+ * Description:
+ * Implements the cycle-based sequential simulator (see logic_seq.h).
+ *
+ * Compilation walks the channel trees depth-first, so every gate is
+ * emitted after its operands and the emission order is already a valid
+ * evaluation order. Registers cut the walk: a DFF becomes a state slot
+ * at once, and its next-state tree is compiled afterwards from a
+ * worklist. That is what makes feedback through a register legal while
+ * a direct channel-to-itself reference is caught as a loop.
+ *
+ * While compiling, slot references to registers and gates are tagged
+ * with their kind and index; they are renumbered once the register
+ * count (and hence the first gate slot) is known.
+ */
+
+#include "logic_seq.h"
+#include "logic_sim.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG_REG  0x40000000u
+#define TAG_GATE 0x80000000u
+#define TAG_MASK (TAG_REG | TAG_GATE)
+
+// Channel order of the output mask; also the letters reserved for references
+static const char CHANNEL_NAMES[SEQ_CHANNELS] = { 'X', 'Y', 'Z', 'W' };
+
+static int channel_of(char name) {
+    for (int i = 0; i < SEQ_CHANNELS; i++) {
+        if (CHANNEL_NAMES[i] == name) return i;
+    }
+    return -1;
+}
+
+// --- Compilation ---
+
+/*
+ * Struct: SeqCompiler
+ * -------------------
+ * Growable gate and register lists plus the per-channel walk state
+ * (0 = not compiled, 1 = in progress, 2 = done).
+ */
+typedef struct {
+    uint8_t* op;
+    uint32_t* in0;
+    uint32_t* in1;
+    int gate_count;
+    int gate_cap;
+
+    const LogicNode** reg_d;
+    uint32_t* reg_ref;  // Slot of each register's next state, once compiled
+    int reg_count;
+    int reg_cap;
+
+    LogicNode* const* roots;
+    int chan_state[SEQ_CHANNELS];
+    uint32_t chan_ref[SEQ_CHANNELS];
+    uint32_t var_mask;
+    SeqStatus status;
+} SeqCompiler;
+
+static uint32_t emit(SeqCompiler* c, SimOp op, uint32_t a, uint32_t b) {
+    if (c->gate_count == c->gate_cap) {
+        int new_cap = c->gate_cap ? c->gate_cap * 2 : 64;
+        uint8_t* ops = realloc(c->op, (size_t)new_cap);
+        if (ops) c->op = ops;
+        uint32_t* in0 = realloc(c->in0, (size_t)new_cap * sizeof(uint32_t));
+        if (in0) c->in0 = in0;
+        uint32_t* in1 = realloc(c->in1, (size_t)new_cap * sizeof(uint32_t));
+        if (in1) c->in1 = in1;
+        if (!ops || !in0 || !in1) {
+            c->status = SEQ_ERR_MEMORY;
+            return SEQ_SLOT_ZERO;
+        }
+        c->gate_cap = new_cap;
+    }
+    int i = c->gate_count++;
+    c->op[i] = (uint8_t)op;
+    c->in0[i] = a;
+    c->in1[i] = b;
+    return TAG_GATE | (uint32_t)i;
+}
+
+static uint32_t add_register(SeqCompiler* c, const LogicNode* next_state) {
+    if (c->reg_count == c->reg_cap) {
+        int new_cap = c->reg_cap ? c->reg_cap * 2 : 16;
+        const LogicNode** grown = realloc(c->reg_d, (size_t)new_cap * sizeof(*grown));
+        if (grown) c->reg_d = grown;
+        uint32_t* refs = realloc(c->reg_ref, (size_t)new_cap * sizeof(uint32_t));
+        if (refs) c->reg_ref = refs;
+        if (!grown || !refs) {
+            c->status = SEQ_ERR_MEMORY;
+            return SEQ_SLOT_ZERO;
+        }
+        c->reg_cap = new_cap;
+    }
+    c->reg_d[c->reg_count] = next_state;
+    return TAG_REG | (uint32_t)c->reg_count++;
+}
+
+static uint32_t compile_channel(SeqCompiler* c, int ch);
+
+/*
+ * Function: compile_node
+ * ----------------------
+ * Emits the gates for a subtree.
+ *
+ * returns: The (tagged) slot holding its value.
+ */
+static uint32_t compile_node(SeqCompiler* c, const LogicNode* node) {
+    if (!node || c->status != SEQ_OK) return SEQ_SLOT_ZERO;
+
+    switch (node->type) {
+        case NODE_VAR: {
+            int ch = channel_of(node->var_name);
+            if (ch >= 0) return compile_channel(c, ch);
+            int v = node->var_name - 'A';
+            if (v < 0 || v >= SEQ_MAX_VARS) return SEQ_SLOT_ZERO;
+            c->var_mask |= 1u << v;
+            return (uint32_t)v;
+        }
+        case NODE_DFF:
+            return add_register(c, node->left);
+        case NODE_NOT: {
+            uint32_t a = compile_node(c, node->left);
+            return emit(c, SIM_OP_NOT, a, a);
+        }
+        case NODE_AND:
+        case NODE_OR:
+        case NODE_XOR:
+        case NODE_NAND:
+        case NODE_NOR: {
+            static const SimOp OPS[] = {
+                [NODE_AND] = SIM_OP_AND, [NODE_OR] = SIM_OP_OR, [NODE_XOR] = SIM_OP_XOR,
+                [NODE_NAND] = SIM_OP_NAND, [NODE_NOR] = SIM_OP_NOR,
+            };
+            uint32_t a = compile_node(c, node->left);
+            uint32_t b = compile_node(c, node->right);
+            return emit(c, OPS[node->type], a, b);
+        }
+        default:
+            return SEQ_SLOT_ZERO;
+    }
+}
+
+static uint32_t compile_channel(SeqCompiler* c, int ch) {
+    if (!c->roots[ch]) return SEQ_SLOT_ZERO;
+    if (c->chan_state[ch] == 2) return c->chan_ref[ch];
+    if (c->chan_state[ch] == 1) {
+        c->status = SEQ_ERR_LOOP;
+        return SEQ_SLOT_ZERO;
+    }
+    c->chan_state[ch] = 1;
+    c->chan_ref[ch] = compile_node(c, c->roots[ch]);
+    c->chan_state[ch] = 2;
+    return c->chan_ref[ch];
+}
+
+static uint32_t resolve(const SeqProgram* p, uint32_t ref) {
+    if (ref & TAG_GATE) return p->first_gate_slot + (ref & ~TAG_MASK);
+    if (ref & TAG_REG) return SEQ_FIRST_REG_SLOT + (ref & ~TAG_MASK);
+    return ref;
+}
+
+SeqStatus Seq_Compile(LogicNode* const roots[SEQ_CHANNELS], SeqProgram* p) {
+    memset(p, 0, sizeof(*p));
+
+    SeqCompiler c;
+    memset(&c, 0, sizeof(c));
+    c.roots = roots;
+
+    uint32_t out_ref[SEQ_CHANNELS] = { 0 };
+    for (int ch = 0; ch < SEQ_CHANNELS; ch++) {
+        if (!roots[ch]) continue;
+        p->out_mask |= 1u << ch;
+        out_ref[ch] = compile_channel(&c, ch);
+    }
+
+    // Next-state logic; may discover more registers as it goes
+    for (int r = 0; r < c.reg_count && c.status == SEQ_OK; r++) {
+        uint32_t ref = compile_node(&c, c.reg_d[r]);
+        c.reg_ref[r] = ref;  // Stored after the call: it may grow reg_ref
+    }
+
+    SeqStatus status = c.status;
+    if (status == SEQ_OK) {
+        p->reg_count = c.reg_count;
+        p->gate_count = c.gate_count;
+        p->first_gate_slot = SEQ_FIRST_REG_SLOT + (uint32_t)c.reg_count;
+        p->var_mask = c.var_mask;
+
+        p->op = malloc((size_t)c.gate_count + 1);
+        p->in0 = malloc((size_t)c.gate_count * sizeof(uint32_t) + 1);
+        p->in1 = malloc((size_t)c.gate_count * sizeof(uint32_t) + 1);
+        p->reg_next = malloc((size_t)c.reg_count * sizeof(uint32_t) + 1);
+        p->values = calloc((size_t)p->first_gate_slot + (size_t)c.gate_count, 1);
+        p->next_state = malloc((size_t)c.reg_count + 1);
+        if (!p->op || !p->in0 || !p->in1 || !p->reg_next || !p->values || !p->next_state) {
+            status = SEQ_ERR_MEMORY;
+        }
+    }
+    if (status == SEQ_OK) {
+        for (int i = 0; i < c.gate_count; i++) {
+            p->op[i] = c.op[i];
+            p->in0[i] = resolve(p, c.in0[i]);
+            p->in1[i] = resolve(p, c.in1[i]);
+        }
+        for (int r = 0; r < c.reg_count; r++) p->reg_next[r] = resolve(p, c.reg_ref[r]);
+        for (int ch = 0; ch < SEQ_CHANNELS; ch++) p->out_slot[ch] = resolve(p, out_ref[ch]);
+        p->values[SEQ_SLOT_ONE] = 1;
+    }
+
+    free(c.op);
+    free(c.in0);
+    free(c.in1);
+    free(c.reg_d);
+    free(c.reg_ref);
+    if (status != SEQ_OK) Seq_Free(p);
+    return status;
+}
+
+void Seq_Free(SeqProgram* p) {
+    free(p->op);
+    free(p->in0);
+    free(p->in1);
+    free(p->reg_next);
+    free(p->values);
+    free(p->next_state);
+    memset(p, 0, sizeof(*p));
+}
+
+SeqStatus Seq_Copy(const SeqProgram* src, SeqProgram* dst) {
+    *dst = *src;
+    size_t value_count = (size_t)src->first_gate_slot + (size_t)src->gate_count;
+    dst->op = malloc((size_t)src->gate_count + 1);
+    dst->in0 = malloc((size_t)src->gate_count * sizeof(uint32_t) + 1);
+    dst->in1 = malloc((size_t)src->gate_count * sizeof(uint32_t) + 1);
+    dst->reg_next = malloc((size_t)src->reg_count * sizeof(uint32_t) + 1);
+    dst->values = malloc(value_count);
+    dst->next_state = malloc((size_t)src->reg_count + 1);
+    if (!dst->op || !dst->in0 || !dst->in1 || !dst->reg_next || !dst->values || !dst->next_state) {
+        Seq_Free(dst);
+        return SEQ_ERR_MEMORY;
+    }
+
+    memcpy(dst->op, src->op, (size_t)src->gate_count);
+    memcpy(dst->in0, src->in0, (size_t)src->gate_count * sizeof(uint32_t));
+    memcpy(dst->in1, src->in1, (size_t)src->gate_count * sizeof(uint32_t));
+    memcpy(dst->reg_next, src->reg_next, (size_t)src->reg_count * sizeof(uint32_t));
+    memcpy(dst->values, src->values, value_count);
+    return SEQ_OK;
+}
+
+bool Seq_IsSequential(const LogicNode* root) {
+    if (!root) return false;
+    if (root->type == NODE_DFF) return true;
+    if (root->type == NODE_VAR) return channel_of(root->var_name) >= 0;
+    return Seq_IsSequential(root->left) || Seq_IsSequential(root->right);
+}
+
+void Seq_Reset(SeqProgram* p) {
+    memset(p->values + SEQ_FIRST_REG_SLOT, 0, (size_t)p->reg_count);
+    p->cycle = 0;
+}
+
+// --- Evaluation ---
+
+/*
+ * Function: sweep
+ * ---------------
+ * Loads the inputs and evaluates every gate once, in emission order.
+ *
+ * returns: The output mask.
+ */
+static uint32_t sweep(SeqProgram* p, uint32_t input_mask) {
+    uint8_t* v = p->values;
+    for (uint32_t vars = p->var_mask; vars; vars &= vars - 1) {
+        int i = __builtin_ctz(vars);
+        v[i] = (input_mask >> i) & 1u;
+    }
+
+    uint8_t* gate = v + p->first_gate_slot;
+    const uint8_t* op = p->op;
+    const uint32_t* in0 = p->in0;
+    const uint32_t* in1 = p->in1;
+    for (int i = 0; i < p->gate_count; i++) {
+        uint8_t a = v[in0[i]], b = v[in1[i]];
+        uint8_t r;
+        switch (op[i]) {
+            case SIM_OP_AND:  r = a & b; break;
+            case SIM_OP_OR:   r = a | b; break;
+            case SIM_OP_XOR:  r = a ^ b; break;
+            case SIM_OP_NAND: r = (a & b) ^ 1; break;
+            case SIM_OP_NOR:  r = (a | b) ^ 1; break;
+            default:          r = a ^ 1; break;
+        }
+        gate[i] = r;
+    }
+
+    uint32_t outputs = 0;
+    for (uint32_t chans = p->out_mask; chans; chans &= chans - 1) {
+        int ch = __builtin_ctz(chans);
+        outputs |= (uint32_t)v[p->out_slot[ch]] << ch;
+    }
+    return outputs;
+}
+
+uint32_t Seq_Outputs(SeqProgram* p, uint32_t input_mask) {
+    return sweep(p, input_mask);
+}
+
+uint32_t Seq_Step(SeqProgram* p, uint32_t input_mask) {
+    uint32_t outputs = sweep(p, input_mask);
+
+    // All registers load together: read every D before writing any Q
+    for (int r = 0; r < p->reg_count; r++) p->next_state[r] = p->values[p->reg_next[r]];
+    memcpy(p->values + SEQ_FIRST_REG_SLOT, p->next_state, (size_t)p->reg_count);
+    p->cycle++;
+    return outputs;
+}
@@ -0,0 +1,322 @@
+/*
+ * File: logic_sim.c
+ * Version: 1.1.0
+ * Description:
+ * Implements the levelized compiled simulator (see logic_sim.h).
+ *
+ * Compilation emits gates in graph order into temporary arrays, where a
+ * gate's slot is SIM_FIRST_GATE_SLOT + its emission index, then
+ * counting-sorts them by level and renumbers every slot reference.
+ */
+
+#include "logic_sim.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Lane k of VAR_PATTERNS[v] is bit v of k: all 64 combinations of A-F.
+static const uint64_t VAR_PATTERNS[6] = {
+    0xAAAAAAAAAAAAAAAAULL,
+    0xCCCCCCCCCCCCCCCCULL,
+    0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL,
+    0xFFFF0000FFFF0000ULL,
+    0xFFFFFFFF00000000ULL
+};
+
+// --- Compilation ---
+
+/*
+ * Struct: Emitter
+ * ---------------
+ * Gates in emission order, before levelization.
+ */
+typedef struct {
+    uint8_t* op;
+    uint32_t* in0;
+    uint32_t* in1;
+    int* level;
+    int count;
+} Emitter;
+
+static int slot_level(const Emitter* e, uint32_t slot) {
+    return slot < SIM_FIRST_GATE_SLOT ? 0 : e->level[slot - SIM_FIRST_GATE_SLOT];
+}
+
+static uint32_t emit(Emitter* e, SimOp op, uint32_t a, uint32_t b) {
+    int la = slot_level(e, a), lb = slot_level(e, b);
+    int i = e->count++;
+    e->op[i] = (uint8_t)op;
+    e->in0[i] = a;
+    e->in1[i] = b;
+    e->level[i] = 1 + (la > lb ? la : lb);
+    return SIM_FIRST_GATE_SLOT + (uint32_t)i;
+}
+
+/*
+ * Function: lower_gate
+ * --------------------
+ * Emits the two-input gates for one graph gate with 'count' operand
+ * slots in 'ops' (overwritten as scratch).
+ *
+ * returns: The slot holding the gate's value.
+ */
+static uint32_t lower_gate(Emitter* e, NodeType type, uint32_t* ops, int count) {
+    if (type == NODE_NOT) {
+        return count ? emit(e, SIM_OP_NOT, ops[0], ops[0]) : SIM_SLOT_ONE;
+    }
+
+    SimOp base, last;
+    switch (type) {
+        case NODE_AND:  base = SIM_OP_AND; last = SIM_OP_AND;  break;
+        case NODE_OR:   base = SIM_OP_OR;  last = SIM_OP_OR;   break;
+        case NODE_XOR:  base = SIM_OP_XOR; last = SIM_OP_XOR;  break;
+        case NODE_NAND: base = SIM_OP_AND; last = SIM_OP_NAND; break;
+        case NODE_NOR:  base = SIM_OP_OR;  last = SIM_OP_NOR;  break;
+        default:        return SIM_SLOT_ZERO; // NODE_DFF: reset value (see logic_seq.h)
+    }
+    bool inverted = (last != base);
+
+    if (count == 0) return inverted ? SIM_SLOT_ONE : SIM_SLOT_ZERO;
+    if (count == 1) return inverted ? emit(e, SIM_OP_NOT, ops[0], ops[0]) : ops[0];
+
+    // Pairwise reduction keeps wide gates log-depth rather than a chain
+    while (count > 2) {
+        int next = 0;
+        for (int i = 0; i + 1 < count; i += 2) ops[next++] = emit(e, base, ops[i], ops[i + 1]);
+        if (count & 1) ops[next++] = ops[count - 1];
+        count = next;
+    }
+    return emit(e, last, ops[0], ops[1]);
+}
+
+static uint32_t remap(const int* position, uint32_t slot) {
+    return slot < SIM_FIRST_GATE_SLOT ? slot : SIM_FIRST_GATE_SLOT + (uint32_t)position[slot - SIM_FIRST_GATE_SLOT];
+}
+
+bool Sim_Compile(const NetGraph* g, SimProgram* p) {
+    memset(p, 0, sizeof(*p));
+
+    // A k-input gate lowers to at most k - 1 gates (or one NOT)
+    int max_gates = g->input_count + g->node_count;
+    int max_pins = 1;
+    for (int i = 0; i < g->node_count; i++) {
+        if (g->nodes[i].input_count > max_pins) max_pins = g->nodes[i].input_count;
+    }
+
+    Emitter e;
+    e.count = 0;
+    e.op = malloc((size_t)max_gates * sizeof(uint8_t) + 1);
+    e.in0 = malloc((size_t)max_gates * sizeof(uint32_t) + 1);
+    e.in1 = malloc((size_t)max_gates * sizeof(uint32_t) + 1);
+    e.level = malloc((size_t)max_gates * sizeof(int) + 1);
+    uint32_t* node_slot = malloc((size_t)g->node_count * sizeof(uint32_t) + 1);
+    uint32_t* ops = malloc((size_t)max_pins * sizeof(uint32_t));
+    int* position = NULL;
+    int* cursor = NULL;
+
+    bool ok = e.op && e.in0 && e.in1 && e.level && node_slot && ops;
+    for (int i = 0; ok && i < g->node_count; i++) {
+        const GraphNode* n = &g->nodes[i];
+        if (n->kind == NETLIST_NODE_VAR) {
+            // Same range AST_Evaluate accepts; anything else reads as 0
+            int v = n->label[0] - 'A';
+            if (v >= 0 && v < SIM_MAX_VARS) {
+                node_slot[i] = (uint32_t)v;
+                p->var_mask |= 1u << v;
+            } else {
+                node_slot[i] = SIM_SLOT_ZERO;
+            }
+        } else if (n->kind == NETLIST_NODE_OUTPUT) {
+            node_slot[i] = node_slot[Graph_NodeInput(g, i, 0)];
+            if (p->output_count < SIM_MAX_OUTPUTS) {
+                SimOutput* out = &p->outputs[p->output_count++];
+                memcpy(out->name, n->label, sizeof(out->name));
+                out->slot = node_slot[i];
+            }
+        } else {
+            for (int pin = 0; pin < n->input_count; pin++) ops[pin] = node_slot[Graph_NodeInput(g, i, pin)];
+            node_slot[i] = lower_gate(&e, n->op, ops, n->input_count);
+        }
+    }
+
+    // Level-major order: counting sort on level (levels start at 1)
+    int max_level = 0;
+    for (int i = 0; ok && i < e.count; i++) {
+        if (e.level[i] > max_level) max_level = e.level[i];
+    }
+    if (ok) {
+        p->level_count = max_level;
+        p->level_start = calloc((size_t)max_level + 1, sizeof(int));
+        position = malloc((size_t)e.count * sizeof(int) + 1);
+        cursor = malloc((size_t)max_level * sizeof(int) + 1);
+        p->op = malloc((size_t)e.count * sizeof(uint8_t) + 1);
+        p->in0 = malloc((size_t)e.count * sizeof(uint32_t) + 1);
+        p->in1 = malloc((size_t)e.count * sizeof(uint32_t) + 1);
+        p->values = calloc(SIM_FIRST_GATE_SLOT + (size_t)e.count, sizeof(uint64_t));
+        ok = p->level_start && position && cursor && p->op && p->in0 && p->in1 && p->values;
+    }
+    if (ok) {
+        // Count gates per level at index 'level', then prefix-sum: entry L
+        // becomes the start of 0-based level L (levels are 1-based above)
+        for (int i = 0; i < e.count; i++) p->level_start[e.level[i]]++;
+        for (int l = 1; l <= max_level; l++) p->level_start[l] += p->level_start[l - 1];
+
+        // Stable placement within each level
+        memcpy(cursor, p->level_start, (size_t)max_level * sizeof(int));
+        for (int i = 0; i < e.count; i++) position[i] = cursor[e.level[i] - 1]++;
+
+        for (int i = 0; i < e.count; i++) {
+            int at = position[i];
+            p->op[at] = e.op[i];
+            p->in0[at] = remap(position, e.in0[i]);
+            p->in1[at] = remap(position, e.in1[i]);
+        }
+        for (int i = 0; i < p->output_count; i++) p->outputs[i].slot = remap(position, p->outputs[i].slot);
+        p->gate_count = e.count;
+        p->values[SIM_SLOT_ONE] = ~0ULL;
+    }
+
+    free(e.op);
+    free(e.in0);
+    free(e.in1);
+    free(e.level);
+    free(node_slot);
+    free(ops);
+    free(position);
+    free(cursor);
+    if (!ok) Sim_Free(p);
+    return ok;
+}
+
+bool Sim_CompileTree(LogicNode* root, SimProgram* p) {
+    NetGraph g;
+    Graph_Init(&g);
+    if (!Graph_AddOutput(&g, "F", root)) {
+        Graph_Free(&g);
+        memset(p, 0, sizeof(*p));
+        return false;
+    }
+    bool ok = Sim_Compile(&g, p);
+    Graph_Free(&g);
+    return ok;
+}
+
+void Sim_Free(SimProgram* p) {
+    free(p->op);
+    free(p->in0);
+    free(p->in1);
+    free(p->level_start);
+    free(p->values);
+    memset(p, 0, sizeof(*p));
+}
+
+int Sim_FindOutput(const SimProgram* p, const char* name) {
+    for (int i = 0; i < p->output_count; i++) {
+        if (strcmp(p->outputs[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// --- Evaluation ---
+
+/*
+ * Function: sweep_range
+ * ---------------------
+ * The whole simulator: one pass over gates [first, last) in level order,
+ * reading and writing 'values'. Inputs must already be in the variable
+ * slots.
+ */
+static void sweep_range(const SimProgram* p, uint64_t* values, int first, int last) {
+    uint64_t* v = values;
+    uint64_t* gate = v + SIM_FIRST_GATE_SLOT;
+    const uint8_t* op = p->op;
+    const uint32_t* in0 = p->in0;
+    const uint32_t* in1 = p->in1;
+
+    for (int i = first; i < last; i++) {
+        uint64_t a = v[in0[i]], b = v[in1[i]];
+        uint64_t r;
+        switch (op[i]) {
+            case SIM_OP_AND:  r = a & b; break;
+            case SIM_OP_OR:   r = a | b; break;
+            case SIM_OP_XOR:  r = a ^ b; break;
+            case SIM_OP_NAND: r = ~(a & b); break;
+            case SIM_OP_NOR:  r = ~(a | b); break;
+            default:          r = ~a; break;
+        }
+        gate[i] = r;
+    }
+}
+
+static void sweep(const SimProgram* p) {
+    sweep_range(p, p->values, 0, p->gate_count);
+}
+
+uint64_t* Sim_AllocValues(const SimProgram* p) {
+    uint64_t* values = calloc(SIM_FIRST_GATE_SLOT + (size_t)p->gate_count, sizeof(uint64_t));
+    if (values) values[SIM_SLOT_ONE] = ~0ULL;
+    return values;
+}
+
+void Sim_SweepRange(const SimProgram* p, uint64_t* values, int first, int last) {
+    sweep_range(p, values, first, last);
+}
+
+uint32_t Sim_Evaluate(SimProgram* p, uint32_t input_mask) {
+    for (uint32_t vars = p->var_mask; vars; vars &= vars - 1) {
+        int v = __builtin_ctz(vars);
+        p->values[v] = 0ULL - ((input_mask >> v) & 1u);
+    }
+    sweep(p);
+
+    uint32_t result = 0;
+    for (int i = 0; i < p->output_count; i++) {
+        result |= (uint32_t)(p->values[p->outputs[i].slot] & 1u) << i;
+    }
+    return result;
+}
+
+void Sim_EvaluateSlice(SimProgram* p, const uint64_t* inputs, uint64_t* outputs) {
+    for (uint32_t vars = p->var_mask; vars; vars &= vars - 1) {
+        int v = __builtin_ctz(vars);
+        p->values[v] = inputs[v];
+    }
+    sweep(p);
+    for (int i = 0; i < p->output_count; i++) outputs[i] = p->values[p->outputs[i].slot];
+}
+
+void Sim_EvaluateBatchWith(const SimProgram* p, uint64_t* values, const uint32_t* masks, int count,
+                           uint32_t* results) {
+    for (int base = 0; base < count; base += SIM_LANES) {
+        int lanes = count - base < SIM_LANES ? count - base : SIM_LANES;
+
+        // Transpose masks into bit slices (only variables the circuit reads)
+        for (uint32_t vars = p->var_mask; vars; vars &= vars - 1) {
+            int v = __builtin_ctz(vars);
+            uint64_t word = 0;
+            for (int k = 0; k < lanes; k++) word |= (uint64_t)((masks[base + k] >> v) & 1u) << k;
+            values[v] = word;
+        }
+        sweep_range(p, values, 0, p->gate_count);
+
+        for (int k = 0; k < lanes; k++) results[base + k] = 0;
+        for (int i = 0; i < p->output_count; i++) {
+            uint64_t word = values[p->outputs[i].slot];
+            for (int k = 0; k < lanes; k++) results[base + k] |= (uint32_t)((word >> k) & 1u) << i;
+        }
+    }
+}
+
+void Sim_EvaluateBatch(SimProgram* p, const uint32_t* masks, int count, uint32_t* results) {
+    Sim_EvaluateBatchWith(p, p->values, masks, count, results);
+}
+
+uint64_t Sim_TruthTable(SimProgram* p, int output) {
+    if (output < 0 || output >= p->output_count) return 0;
+    for (uint32_t vars = p->var_mask; vars; vars &= vars - 1) {
+        int v = __builtin_ctz(vars);
+        p->values[v] = v < 6 ? VAR_PATTERNS[v] : 0;
+    }
+    sweep(p);
+    return p->values[p->outputs[output].slot];
+}
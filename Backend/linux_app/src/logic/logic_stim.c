@@ -0,0 +1,235 @@
+/*
+ * File: logic_stim.c
+ * Version: 1.1.0
+ * Description:
+ * Stimulus generation and streaming evaluation (see logic_stim.h).
+ *
+ * A run is a series of rounds, one pool job each. In a round every
+ * thread takes one contiguous range of the round's slices (all slices
+ * cost the same, so a static split balances) and sweeps them through its
+ * own value array, generating the inputs in place. Toggles across the
+ * boundary between two ranges, within a round or between rounds, are
+ * added when the partial results are merged, from the first and last
+ * vector each range saw.
+ */
+
+#include "logic_stim.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Lane k of pattern j is bit j of k: the low six bits of a vector index
+static const uint64_t COUNT_PATTERNS[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+static const char* MODE_NAMES[] = { "exhaustive", "gray", "lfsr", "weighted", "walking" };
+
+bool Stim_ModeFromName(const char* name, StimMode* mode) {
+    for (int i = 0; i < (int)(sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0])); i++) {
+        if (strcmp(name, MODE_NAMES[i]) == 0) {
+            *mode = (StimMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Stim_ModeName(StimMode mode) {
+    return MODE_NAMES[mode];
+}
+
+// --- Generation ---
+
+/*
+ * Function: count_bit
+ * -------------------
+ * returns: Bit j of the vector index 64 * slice + k, across lanes k.
+ */
+static uint64_t count_bit(long long slice, int j) {
+    if (j < 6) return COUNT_PATTERNS[j];
+    return (((uint64_t)slice >> (j - 6)) & 1) ? ~0ULL : 0;
+}
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t xorshift64(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/*
+ * Function: weighted_word
+ * -----------------------
+ * 64 lanes that are each 1 with probability weight / 256. Working from
+ * the lowest bit of the weight up, OR-ing in a fresh random word for a
+ * 1 bit and AND-ing for a 0 bit maps P to (P + bit) / 2, which builds
+ * the binary fraction 0.b7...b0 exactly.
+ */
+static uint64_t weighted_word(uint64_t* state, unsigned weight) {
+    if (weight >= 256) return ~0ULL;
+    uint64_t x = 0;
+    for (int k = 0; k < 8; k++) {
+        uint64_t r = xorshift64(state);
+        x = ((weight >> k) & 1) ? (x | r) : (x & r);
+    }
+    return x;
+}
+
+void Stim_Slice(const StimConfig* cfg, long long slice, uint64_t* inputs) {
+    memset(inputs, 0, SIM_MAX_VARS * sizeof(uint64_t));
+    int n = __builtin_popcount(cfg->var_mask);
+    if (n == 0) return;
+
+    // Never 0, which would stick xorshift at 0
+    uint64_t state = splitmix64(cfg->seed ^ splitmix64((uint64_t)slice)) | 1;
+    long long base = slice * SIM_LANES;
+    int walking = (int)(base % n);
+
+    int j = 0;
+    for (uint32_t vars = cfg->var_mask; vars; vars &= vars - 1, j++) {
+        uint64_t* word = &inputs[__builtin_ctz(vars)];
+        switch (cfg->mode) {
+            case STIM_EXHAUSTIVE:
+                *word = count_bit(slice, j);
+                break;
+            case STIM_GRAY:
+                *word = count_bit(slice, j) ^ count_bit(slice, j + 1);
+                break;
+            case STIM_LFSR:
+                *word = xorshift64(&state);
+                break;
+            case STIM_WEIGHTED:
+                *word = weighted_word(&state, cfg->weight[j]);
+                break;
+            case STIM_WALKING:
+                // Lanes where (base + k) mod n == j
+                for (int k = (j - walking + n) % n; k < SIM_LANES; k += n) *word |= 1ULL << k;
+                break;
+        }
+    }
+}
+
+// --- Streaming Evaluation ---
+
+typedef struct {
+    long long ones[SIM_MAX_OUTPUTS];
+    long long toggles[SIM_MAX_OUTPUTS];
+    uint32_t first;  // Outputs of the range's first vector
+    uint32_t last;   // ... and of its last one
+    bool ran;
+} StimPartial;
+
+typedef struct {
+    const SimProgram* prog;
+    const StimConfig* cfg;
+    long long count;
+    long long first;        // This round's slices: first ..
+    long long slices;       // .. first + slices - 1
+    int threads;
+    StimPartial* partial;
+    uint64_t** values;      // Per worker, kept across rounds
+    bool failed;
+} StimJob;
+
+static void stim_job(void* ctx, int worker) {
+    StimJob* job = ctx;
+    const SimProgram* p = job->prog;
+    StimPartial* part = &job->partial[worker];
+    long long from = job->first + job->slices * worker / job->threads;
+    long long to = job->first + job->slices * (worker + 1) / job->threads;
+    if (from >= to) return;
+
+    uint64_t* values = job->values[worker];
+    if (!values) values = job->values[worker] = Sim_AllocValues(p);
+    if (!values) {
+        job->failed = true;
+        return;
+    }
+
+    uint64_t carry[SIM_MAX_OUTPUTS];
+    for (long long s = from; s < to; s++) {
+        // Slots 0 .. SIM_MAX_VARS-1 are the inputs: generate straight into them
+        Stim_Slice(job->cfg, s, values);
+        Sim_SweepRange(p, values, 0, p->gate_count);
+
+        long long left = job->count - s * SIM_LANES;
+        int lanes = left < SIM_LANES ? (int)left : SIM_LANES;
+        uint64_t live = lanes == SIM_LANES ? ~0ULL : (1ULL << lanes) - 1;
+        for (int i = 0; i < p->output_count; i++) {
+            uint64_t w = values[p->outputs[i].slot] & live;
+            if (s == from) {
+                carry[i] = w & 1;  // No predecessor inside this range
+                part->first |= (uint32_t)(w & 1) << i;
+            }
+            part->ones[i] += __builtin_popcountll(w);
+            part->toggles[i] += __builtin_popcountll((w ^ ((w << 1) | carry[i])) & live);
+            carry[i] = (w >> (lanes - 1)) & 1;
+        }
+    }
+    for (int i = 0; i < p->output_count; i++) part->last |= (uint32_t)carry[i] << i;
+    part->ran = true;
+}
+
+bool Stim_Run(ParPool* pool, const SimProgram* p, const StimConfig* cfg, StimStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    long long count = cfg->count < 0 ? 0 : cfg->count;
+    if (count > STIM_MAX_VECTORS) count = STIM_MAX_VECTORS;
+    long long total = (count + SIM_LANES - 1) / SIM_LANES;
+
+    StimJob job;
+    job.prog = p;
+    job.cfg = cfg;
+    job.count = count;
+    job.threads = ParPool_Threads(pool);
+    job.failed = false;
+    job.partial = calloc((size_t)job.threads, sizeof(StimPartial));
+    job.values = calloc((size_t)job.threads, sizeof(uint64_t*));
+    if (!job.partial || !job.values) {
+        free(job.partial);
+        free(job.values);
+        return false;
+    }
+
+    // Size a round by work, so it takes about as long whatever the circuit
+    long long per_thread = STIM_ROUND_WORK / (p->gate_count > 0 ? p->gate_count : 1);
+    long long round = (per_thread > 0 ? per_thread : 1) * job.threads;
+
+    // Stitch the ranges together in order
+    bool have_prev = false;
+    uint32_t prev = 0;
+    for (job.first = 0; job.first < total && !job.failed; job.first += job.slices) {
+        job.slices = total - job.first < round ? total - job.first : round;
+        memset(job.partial, 0, (size_t)job.threads * sizeof(StimPartial));
+        ParPool_Run(pool, stim_job, &job);
+
+        for (int w = 0; w < job.threads; w++) {
+            const StimPartial* part = &job.partial[w];
+            if (!part->ran) continue;
+            for (int i = 0; i < p->output_count; i++) {
+                stats->ones[i] += part->ones[i];
+                stats->toggles[i] += part->toggles[i];
+                if (have_prev) stats->toggles[i] += ((prev ^ part->first) >> i) & 1;
+            }
+            prev = part->last;
+            have_prev = true;
+        }
+    }
+    stats->vectors = count;
+    stats->output_count = p->output_count;
+
+    bool ok = !job.failed;
+    for (int w = 0; w < job.threads; w++) free(job.values[w]);
+    free(job.values);
+    free(job.partial);
+    return ok;
+}
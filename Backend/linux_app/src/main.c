@@ -1,9 +1,21 @@
 /*
  * File: main.c
- * Version: 1.5.0
+ * Version: 1.12.0
  * Description:
  * Main loop with Explicit State Machine for Mode Switching.
  * Fixes "Unknown" modes by jumping over enum gaps.
+ * GPIO outputs are driven by the compiled simulator (logic_sim.h).
+ * Input changes also feed the gate-delay timing view (app_timing.h).
+ * Sequential equations drive the pins from the clocked state (app_cycle.h).
+ * Pin updates feed the GPIO waveform capture (app_capture.h).
+ * Main-loop updates go to every client (the broadcast session) through
+ * the publish scheduler (app_publish.h), which rate-limits and coalesces
+ * them; pins, timing and cycle state still follow every change at once.
+ * The driven pins are published too, for "outputs" subscribers.
+ * The pins' compiled circuit is cached and rebuilt only when an equation
+ * changes, not on every input change.
+ * Between iterations the loop sleeps until the next publish slot or a
+ * state change, at most MAIN_LOOP_MS, instead of a fixed 20 ms.
  */
 
 #include <stdio.h>
@@ -23,6 +35,14 @@
 #include "utils_timer.h"
 #include "logic_parser.h"
 #include "logic_ast.h" 
+#include "logic_netlist.h"
+#include "logic_sim.h"
+#include "app_timing.h"
+#include "app_cycle.h"
+#include "app_capture.h"
+#include "app_publish.h"
+
+#define MAIN_LOOP_MS 20  // Longest sleep between iterations: the input polling tick
 
 const char* get_mode_name(SystemMode m) {
     switch(m) {
@@ -42,6 +62,51 @@ static const char* RUN_MENU_ITEMS[] = { "A", "B", "C", "D", "E", "F" };
 
 static char last_print_buf[64] = "";
 
+// Compiled circuit driving the pins, for 'pin_equations'
+static char pin_equations[4][256];
+static SimProgram pin_prog;
+static bool pin_compiled = false;
+static bool pin_cached = false;
+static int pin_output[4];  // Program output of X, Y, Z, W (-1 = unprogrammed)
+
+/*
+ * Function: update_pin_program
+ * ----------------------------
+ * Recompiles the pins' circuit when the equations in 'st' differ from
+ * the cached ones (graph building and compiling are far too costly to
+ * repeat on every input change).
+ *
+ * returns: true if 'pin_prog' holds a compiled circuit.
+ */
+static bool update_pin_program(const SharedState* st) {
+    const char* next[4] = { st->input_x, st->input_y, st->input_z, st->input_w };
+    bool changed = !pin_cached;
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(pin_equations[i], next[i]) != 0) {
+            snprintf(pin_equations[i], sizeof(pin_equations[i]), "%s", next[i]);
+            changed = true;
+        }
+    }
+    if (!changed) return pin_compiled;
+
+    if (pin_compiled) Sim_Free(&pin_prog);
+    pin_compiled = false;
+    pin_cached = true;
+
+    LogicNode* roots[4];
+    for (int i = 0; i < 4; i++) roots[i] = Parser_ParseString(pin_equations[i]);
+    NetGraph graph;
+    if (Netlist_BuildCombinedGraph(&graph, "X", roots[0], "Y", roots[1], "Z", roots[2], "W", roots[3])) {
+        pin_compiled = Sim_Compile(&graph, &pin_prog);
+        Graph_Free(&graph);
+    }
+    for (int i = 0; i < 4; i++) AST_Free(roots[i]);
+
+    const char* names[4] = { "X", "Y", "Z", "W" };
+    for (int i = 0; i < 4; i++) pin_output[i] = pin_compiled ? Sim_FindOutput(&pin_prog, names[i]) : -1;
+    return pin_compiled;
+}
+
 int main() {
     AppState_Init();
     Editor_Init();
@@ -140,7 +205,7 @@ int main() {
                 flash_active = true;
                 led_flash_start = Timer_GetMillis();
                 printf("Queued: %s\n", Editor_GetLine());
-                Process_Stateless("preview", Editor_GetLine());
+                Process_Stateless(Session_Broadcast(), "preview", Editor_GetLine());
             }
             else if (res == EDITOR_RESULT_SAVE) {
                 const char* final_eq = Editor_GetLine();
@@ -170,6 +235,7 @@ int main() {
                 uint8_t mask = AppState_GetInputMask();
                 mask ^= (1 << bit);
                 AppState_SetInputMask(mask);
+                Timing_SetInputs(mask);
                 printf("  [Run Input] Toggled %s -> %s\n", RUN_MENU_ITEMS[run_menu_index], (mask >> bit) & 1 ? "ON" : "OFF");
             }
         }
@@ -177,32 +243,33 @@ int main() {
         // 4. Updates
         if (AppState_IsDirty()) {
             SharedState st = AppState_GetSnapshot();
-            
-            bool vx = Process_Equation("X", st.input_x, "run");
-            bool vy = Process_Equation("Y", st.input_y, "run");
-            bool vz = Process_Equation("Z", st.input_z, "run");
-            bool vw = Process_Equation("W", st.input_w, "run");
-            
-            if (st.valid_x != vx || st.valid_y != vy) 
-                AppState_SetValidation(vx, vy, vz, vw);
-
-            Send_Combined_Update(st.input_x, st.input_y, st.input_z, st.input_w);
-            NetUDP_BroadcastState();
+            Publish_Request(&st);  // Sent by Publish_Poll, rate-limited
+            Timing_Update(st.input_x, st.input_y, st.input_z, st.input_w, st.input_signal_state);
+            Cycle_Update(st.input_x, st.input_y, st.input_z, st.input_w);
 
-            LogicNode* rx = Parser_ParseString(st.input_x);
-            LogicNode* ry = Parser_ParseString(st.input_y);
-            LogicNode* rz = Parser_ParseString(st.input_z);
-            LogicNode* rw = Parser_ParseString(st.input_w);
-            
-            bool val_x = AST_Evaluate(rx, st.input_signal_state);
-            bool val_y = AST_Evaluate(ry, st.input_signal_state);
-            bool val_z = AST_Evaluate(rz, st.input_signal_state);
-            bool val_w = AST_Evaluate(rw, st.input_signal_state);
+            // Drive the pins from the compiled circuit: shared logic is
+            // evaluated once for all four outputs. Circuits with registers
+            // show their current clock cycle instead.
+            uint32_t outputs = 0;
+            if (Cycle_GetOutputs(st.input_signal_state, &outputs)) {
+                // Outputs come from the clocked state
+            } else if (update_pin_program(&st)) {
+                uint32_t values = Sim_Evaluate(&pin_prog, st.input_signal_state);
+                for (int i = 0; i < 4; i++) {
+                    if (pin_output[i] >= 0 && ((values >> pin_output[i]) & 1)) outputs |= 1u << i;
+                }
+            }
+            bool val_x = outputs & 1;
+            bool val_y = (outputs >> 1) & 1;
+            bool val_z = (outputs >> 2) & 1;
+            bool val_w = (outputs >> 3) & 1;
             
             HAL_GPIO_Write(GPIO_OUT_X, val_x);
             HAL_GPIO_Write(GPIO_OUT_Y, val_y);
             HAL_GPIO_Write(GPIO_OUT_Z, val_z);
             HAL_GPIO_Write(GPIO_OUT_W, val_w);
+            Capture_Live(CAPTURE_GPIO, 0, st.input_signal_state, outputs);
+            Publish_Outputs(st.input_signal_state, outputs);
             
             if (flash_active) {
                 if (Timer_HasElapsed(led_flash_start, 150)) flash_active = false;
@@ -213,15 +280,15 @@ int main() {
                 HAL_LED_SetRGB(val_y ? 255 : 0, val_x ? 255 : 0, 0);
             }
 
-            AST_Free(rx); AST_Free(ry); AST_Free(rz); AST_Free(rw);
-
             AppState_ClearDirty();
         }
+        Publish_Poll();
 
-        usleep(20000); 
+        AppState_WaitDirty(Publish_NextDue(MAIN_LOOP_MS));
     }
 
     NetUDP_Cleanup();
+    if (pin_compiled) Sim_Free(&pin_prog);
     HAL_General_Cleanup();
     AppState_Cleanup();
     return 0;
@@ -1,6 +1,6 @@
 /*
  * File: net_json.c
- * Version: 1.1.0
+ * Version: 1.2.0
  * Description:
  * Lightweight JSON serialization helper.
  * Provides simple string formatting functions to construct valid JSON objects
@@ -8,6 +8,7 @@
  *
  * This avoids the overhead of a full JSON library (like cJSON) since the
  * output format is strictly controlled and known at compile time.
+ * User-supplied strings (equations, messages) are escaped by DynBuf.
  */
 
 #include "net_json.h"
@@ -19,31 +20,28 @@
  * Serializes the SharedState struct into a JSON object.
  * Boolean values are converted to "true"/"false" literals.
  */
-void JSON_SerializeState(const SharedState* state, char* buffer, int len) {
-    snprintf(buffer, len,
-        "{"
-        "\"mode\": %d,"
-        "\"inputs\": %d," 
-        "\"input_x\": \"%s\","
-        "\"input_y\": \"%s\","
-        "\"input_z\": \"%s\","
-        "\"input_w\": \"%s\","
-        "\"valid_x\": %s,"
-        "\"valid_y\": %s,"
-        "\"valid_z\": %s,"
-        "\"valid_w\": %s"
-        "}",
-        state->mode,
-        state->input_signal_state,
-        state->input_x,
-        state->input_y,
-        state->input_z,
-        state->input_w,
-        state->valid_x ? "true" : "false",
-        state->valid_y ? "true" : "false",
-        state->valid_z ? "true" : "false",
-        state->valid_w ? "true" : "false"
-    );
+void JSON_SerializeState(const SharedState* state, DynBuf* out) {
+    DynBuf_AppendStr(out, "{\"mode\": ");
+    DynBuf_AppendInt(out, state->mode);
+    DynBuf_AppendStr(out, ",\"inputs\": ");
+    DynBuf_AppendInt(out, state->input_signal_state);
+    DynBuf_AppendStr(out, ",\"input_x\": ");
+    DynBuf_AppendJsonString(out, state->input_x);
+    DynBuf_AppendStr(out, ",\"input_y\": ");
+    DynBuf_AppendJsonString(out, state->input_y);
+    DynBuf_AppendStr(out, ",\"input_z\": ");
+    DynBuf_AppendJsonString(out, state->input_z);
+    DynBuf_AppendStr(out, ",\"input_w\": ");
+    DynBuf_AppendJsonString(out, state->input_w);
+    DynBuf_AppendStr(out, ",\"valid_x\": ");
+    DynBuf_AppendJsonBool(out, state->valid_x);
+    DynBuf_AppendStr(out, ",\"valid_y\": ");
+    DynBuf_AppendJsonBool(out, state->valid_y);
+    DynBuf_AppendStr(out, ",\"valid_z\": ");
+    DynBuf_AppendJsonBool(out, state->valid_z);
+    DynBuf_AppendStr(out, ",\"valid_w\": ");
+    DynBuf_AppendJsonBool(out, state->valid_w);
+    DynBuf_AppendChar(out, '}');
 }
 
 /*
@@ -51,6 +49,8 @@ void JSON_SerializeState(const SharedState* state, char* buffer, int len) {
  * -------------------------------
  * Wraps a simple text string in a JSON object.
  */
-void JSON_SerializeMessage(const char* msg, char* buffer, int len) {
-    snprintf(buffer, len, "{ \"message\": \"%s\" }", msg);
-}
\ No newline at end of file
+void JSON_SerializeMessage(const char* msg, DynBuf* out) {
+    DynBuf_AppendStr(out, "{ \"message\": ");
+    DynBuf_AppendJsonString(out, msg);
+    DynBuf_AppendStr(out, " }");
+}
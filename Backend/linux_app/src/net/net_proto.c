@@ -0,0 +1,136 @@
+/*
+ * File: net_proto.c
+ * Version: 1.0.1
+ * Description:
+ * Encoding and decoding of binary command/response frames
+ * (see net_proto.h).
+ */
+
+#include "net_proto.h"
+#include <string.h>
+
+/*
+ * Function: read_varint
+ * ---------------------
+ * Reads a LEB128 varint from [*p, end).
+ *
+ * returns: false if it runs past 'end' or over 64 bits.
+ */
+static bool read_varint(const uint8_t** p, const uint8_t* end, uint64_t* value) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*p >= end) return false;
+        uint8_t byte = *(*p)++;
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NetProto_IsFrame(const void* data, size_t len) {
+    return len >= NET_PROTO_HEADER && ((const uint8_t*)data)[0] == NET_PROTO_MAGIC;
+}
+
+bool NetProto_Parse(const void* data, size_t len, NetFrame* frame) {
+    const uint8_t* bytes = data;
+    if (!NetProto_IsFrame(data, len) || NET_PROTO_HEADER + (size_t)bytes[3] > len) return false;
+
+    frame->version = bytes[1];
+    frame->opcode = bytes[2];
+    frame->uid = (const char*)bytes + NET_PROTO_HEADER;
+    frame->uid_len = bytes[3];
+    frame->tlv = bytes + NET_PROTO_HEADER + frame->uid_len;
+    frame->tlv_len = len - NET_PROTO_HEADER - frame->uid_len;
+
+    // Walk the TLVs once so lookups can trust the lengths
+    const uint8_t* p = frame->tlv;
+    const uint8_t* end = p + frame->tlv_len;
+    while (p < end) {
+        uint64_t field_len;
+        p++;
+        if (!read_varint(&p, end, &field_len) || field_len > (uint64_t)(end - p)) return false;
+        p += field_len;
+    }
+    return true;
+}
+
+bool NetProto_Find(const NetFrame* frame, uint8_t tag, const uint8_t** value, size_t* len) {
+    const uint8_t* p = frame->tlv;
+    const uint8_t* end = p + frame->tlv_len;
+    while (p < end) {
+        uint8_t field = *p++;
+        uint64_t field_len;
+        // Re-checked: NetProto_Parse vets the lengths, but not every caller parsed
+        if (!read_varint(&p, end, &field_len) || field_len > (uint64_t)(end - p)) return false;
+        if (field == tag) {
+            *value = p;
+            *len = (size_t)field_len;
+            return true;
+        }
+        p += field_len;
+    }
+    return false;
+}
+
+bool NetProto_FindVarint(const NetFrame* frame, uint8_t tag, uint64_t* value) {
+    const uint8_t* p;
+    size_t len;
+    return NetProto_Find(frame, tag, &p, &len) && read_varint(&p, p + len, value);
+}
+
+bool NetProto_FindString(const NetFrame* frame, uint8_t tag, char* out, size_t size) {
+    const uint8_t* p;
+    size_t len;
+    if (!NetProto_Find(frame, tag, &p, &len) || len >= size) return false;
+    memcpy(out, p, len);
+    out[len] = '\0';
+    return true;
+}
+
+bool NetProto_FindMinterms(const NetFrame* frame, uint8_t tag, uint64_t* mask) {
+    const uint8_t* p;
+    size_t len;
+    if (!NetProto_Find(frame, tag, &p, &len) || len != 8) return false;
+    uint64_t m = 0;
+    for (int i = 7; i >= 0; i--) m = (m << 8) | p[i];
+    *mask = m;
+    return true;
+}
+
+void NetProto_Begin(DynBuf* b, uint8_t opcode, const char* uid) {
+    size_t uid_len = strlen(uid);
+    if (uid_len > 255) uid_len = 255;
+    uint8_t header[NET_PROTO_HEADER] = { NET_PROTO_MAGIC, NET_PROTO_VERSION, opcode, (uint8_t)uid_len };
+    DynBuf_Append(b, header, sizeof(header));
+    DynBuf_Append(b, uid, uid_len);
+}
+
+void NetProto_AppendTlv(DynBuf* b, uint8_t tag, const void* value, size_t len) {
+    DynBuf_AppendChar(b, (char)tag);
+    DynBuf_AppendVarint(b, len);
+    DynBuf_Append(b, value, len);
+}
+
+void NetProto_AppendString(DynBuf* b, uint8_t tag, const char* str) {
+    NetProto_AppendTlv(b, tag, str, strlen(str));
+}
+
+void NetProto_AppendVarint(DynBuf* b, uint8_t tag, uint64_t value) {
+    uint8_t bytes[10];
+    size_t n = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        bytes[n++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    NetProto_AppendTlv(b, tag, bytes, n);
+}
+
+void NetProto_AppendMinterms(DynBuf* b, uint8_t tag, uint64_t mask) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) bytes[i] = (uint8_t)(mask >> (8 * i));
+    NetProto_AppendTlv(b, tag, bytes, sizeof(bytes));
+}
@@ -0,0 +1,648 @@
+/*
+ * File: net_reactor.c
+ * Version: 1.5.1
+ * Description:
+ * Implements the epoll reactor, the command workers and the send queues
+ * (see net_reactor.h).
+ *
+ * Version 1.1.0 batches the syscalls: datagrams are read up to
+ * REACTOR_RECV_BATCH per recvmmsg, and packets are sent up to
+ * REACTOR_SEND_BATCH per sendmmsg, from a thread's batch or a queue.
+ * Version 1.3.0 lets other transports queue commands (NetReactor_Submit),
+ * and 1.4.0 lets the owner define session keys (ReactorKeyFn). Version
+ * 1.5.0 dispatches other descriptors on the same loop (NetReactor_Watch).
+ *
+ * The socket is registered level-triggered for EPOLLIN only; EPOLLOUT is
+ * added while any packet is queued and removed once the queues drain.
+ * Workers pick the oldest command whose session is not being served by
+ * another worker, which keeps each session in order without tying a
+ * session to one thread.
+ */
+
+#define _GNU_SOURCE  // recvmmsg, sendmmsg
+#include "net_reactor.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+typedef struct Job {
+    struct Job* next;
+    struct sockaddr_in from;
+    char key[REACTOR_KEY_MAX];
+    size_t len;
+    char msg[];
+} Job;
+
+/*
+ * Struct: BatchPacket
+ * -------------------
+ * A packet held in a thread's batch until NetReactor_EndBatch.
+ */
+typedef struct {
+    int destination;
+    size_t len;
+    char* data;
+} BatchPacket;
+
+/*
+ * Struct: Watch
+ * -------------
+ * A descriptor added with NetReactor_Watch.
+ */
+typedef struct {
+    int fd;
+    ReactorWatchFn fn;
+    void* ctx;
+} Watch;
+
+typedef struct OutPacket {
+    struct OutPacket* next;
+    size_t len;
+    char data[];
+} OutPacket;
+
+/*
+ * Struct: Destination
+ * -------------------
+ * head/tail: Packets waiting for the socket, oldest first.
+ * bytes:     Their total size (at most REACTOR_QUEUE_BYTES).
+ */
+typedef struct {
+    struct sockaddr_in addr;
+    pthread_mutex_t lock;
+    OutPacket* head;
+    OutPacket* tail;
+    size_t bytes;
+} Destination;
+
+static int sock_fd = -1;
+static int epoll_fd = -1;
+static int wake_fd = -1;
+static pthread_t reactor_thread;
+static pthread_t workers[REACTOR_WORKERS];
+static int worker_count = 0;
+static ReactorCommandFn command_handler = NULL;
+static ReactorKeyFn key_function = NULL;
+
+// --- Command Queue (job_lock) ---
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_cond = PTHREAD_COND_INITIALIZER;
+static Job* job_head = NULL;
+static Job* job_tail = NULL;
+static int job_count = 0;
+static char serving[REACTOR_WORKERS][REACTOR_KEY_MAX];  // Session each worker runs
+static bool busy[REACTOR_WORKERS];
+static bool stopping = false;
+
+// --- Send Queues (out_lock guards the fields below the table) ---
+static Destination destinations[REACTOR_MAX_DESTINATIONS];
+static int destination_count = 0;
+static pthread_mutex_t out_lock = PTHREAD_MUTEX_INITIALIZER;
+static int queued_packets = 0;
+static bool write_armed = false;
+static ReactorStats stats;
+static Watch watches[REACTOR_MAX_WATCHES];
+static int watch_count = 0;
+static pthread_mutex_t watch_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// --- Per-Thread Send Batch ---
+static __thread BatchPacket batch[REACTOR_SEND_BATCH];
+static __thread int batch_count = 0;
+static __thread size_t batch_bytes = 0;
+static __thread int batch_depth = 0;  // Nested Begin/End pairs
+
+// --- Commands ---
+
+/*
+ * Function: take_job
+ * ------------------
+ * Unlinks the oldest command whose session no other worker is serving.
+ * The caller holds job_lock.
+ */
+static Job* take_job(void) {
+    Job* prev = NULL;
+    for (Job* j = job_head; j; prev = j, j = j->next) {
+        bool taken = false;
+        for (int w = 0; w < worker_count && !taken; w++) {
+            taken = busy[w] && strcmp(serving[w], j->key) == 0;
+        }
+        if (taken) continue;
+
+        if (prev) prev->next = j->next; else job_head = j->next;
+        if (job_tail == j) job_tail = prev;
+        job_count--;
+        return j;
+    }
+    return NULL;
+}
+
+static void* worker_main(void* arg) {
+    int index = (int)(intptr_t)arg;
+    pthread_mutex_lock(&job_lock);
+    for (;;) {
+        Job* job = NULL;
+        while (!stopping && !(job = take_job())) pthread_cond_wait(&job_cond, &job_lock);
+        if (stopping) {
+            free(job);
+            break;
+        }
+        busy[index] = true;
+        strcpy(serving[index], job->key);
+        pthread_mutex_unlock(&job_lock);
+
+        NetReactor_BeginBatch();  // A command's replies leave together
+        command_handler(job->msg, job->len, &job->from);
+        NetReactor_EndBatch();
+        free(job);
+
+        pthread_mutex_lock(&job_lock);
+        busy[index] = false;
+    }
+    pthread_mutex_unlock(&job_lock);
+    return NULL;
+}
+
+/*
+ * Function: queue_command
+ * -----------------------
+ * Copies a command and its sender into the command queue, keyed by
+ * key_function or by the text before the first '|' (empty without one).
+ *
+ * returns: false if the queue is full (the command is dropped).
+ */
+static bool queue_command(const char* data, size_t len, const struct sockaddr_in* from) {
+    Job* job = malloc(sizeof(Job) + len + 1);
+    if (!job) return false;
+    job->next = NULL;
+    if (from) {
+        job->from = *from;
+    } else {
+        memset(&job->from, 0, sizeof(job->from));
+        job->from.sin_family = AF_UNSPEC;
+    }
+    job->len = len;
+    memcpy(job->msg, data, len);
+    job->msg[len] = '\0';
+
+    if (key_function) {
+        job->key[0] = '\0';
+        key_function(job->msg, len, job->key);
+        job->key[REACTOR_KEY_MAX - 1] = '\0';
+    } else {
+        size_t key_len = strcspn(job->msg, "|");
+        if (key_len == len) key_len = 0;
+        if (key_len >= REACTOR_KEY_MAX) key_len = REACTOR_KEY_MAX - 1;
+        memcpy(job->key, job->msg, key_len);
+        job->key[key_len] = '\0';
+    }
+
+    pthread_mutex_lock(&job_lock);
+    bool full = job_count >= REACTOR_MAX_PENDING;
+    if (!full) {
+        if (job_tail) job_tail->next = job; else job_head = job;
+        job_tail = job;
+        job_count++;
+        pthread_cond_signal(&job_cond);
+    }
+    pthread_mutex_unlock(&job_lock);
+
+    if (full) {
+        free(job);
+        pthread_mutex_lock(&out_lock);
+        stats.dropped_commands++;
+        pthread_mutex_unlock(&out_lock);
+    }
+    return !full;
+}
+
+void NetReactor_Submit(const char* data, size_t len, const struct sockaddr_in* from) {
+    queue_command(data, len, from);
+}
+
+/*
+ * Function: drain_socket
+ * ----------------------
+ * Reads every datagram waiting on the socket, a batch per recvmmsg.
+ */
+static void drain_socket(void) {
+    // Only the reactor thread receives
+    static char buffers[REACTOR_RECV_BATCH][REACTOR_MAX_DATAGRAM];
+    struct mmsghdr msgs[REACTOR_RECV_BATCH];
+    struct iovec iov[REACTOR_RECV_BATCH];
+    struct sockaddr_in from[REACTOR_RECV_BATCH];
+
+    for (;;) {
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < REACTOR_RECV_BATCH; i++) {
+            iov[i].iov_base = buffers[i];
+            iov[i].iov_len = REACTOR_MAX_DATAGRAM - 1;  // Room for the NUL
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+        }
+        int n = recvmmsg(sock_fd, msgs, REACTOR_RECV_BATCH, MSG_DONTWAIT, NULL);
+
+        pthread_mutex_lock(&out_lock);
+        stats.recv_calls++;
+        if (n > 0) stats.received += n;
+        pthread_mutex_unlock(&out_lock);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;  // EAGAIN: drained
+        }
+        for (int i = 0; i < n; i++) queue_command(buffers[i], msgs[i].msg_len, &from[i]);
+        if (n < REACTOR_RECV_BATCH) return;  // Level-triggered: more wakes us again
+    }
+}
+
+// --- Sending ---
+
+static void set_write_interest(bool on) {
+    struct epoll_event ev = { .events = EPOLLIN | (on ? EPOLLOUT : 0), .data.fd = sock_fd };
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sock_fd, &ev);
+    write_armed = on;
+}
+
+/*
+ * Function: send_batch
+ * --------------------
+ * Sends packets to one destination with as few sendmmsg calls as the
+ * socket allows. Packets the kernel rejects outright are dropped.
+ *
+ * returns: How many of the packets are done (sent or dropped); the rest
+ *          hit a full socket buffer.
+ */
+static int send_batch(const Destination* d, const char* const* data, const size_t* len, int count) {
+    struct mmsghdr msgs[REACTOR_SEND_BATCH];
+    struct iovec iov[REACTOR_SEND_BATCH];
+    int done = 0, sent = 0, dropped = 0, calls = 0;
+
+    while (done < count) {
+        int n = count - done;
+        if (n > REACTOR_SEND_BATCH) n = REACTOR_SEND_BATCH;
+        memset(msgs, 0, (size_t)n * sizeof(msgs[0]));
+        for (int i = 0; i < n; i++) {
+            iov[i].iov_base = (void*)data[done + i];
+            iov[i].iov_len = len[done + i];
+            msgs[i].msg_hdr.msg_name = (void*)&d->addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(d->addr);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int r = sendmmsg(sock_fd, msgs, (unsigned int)n, MSG_DONTWAIT);
+        calls++;
+        if (r > 0) {
+            done += r;
+            sent += r;
+        } else if (r < 0 && errno == EINTR) {
+            continue;
+        } else if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)) {
+            break;
+        } else {
+            done++;  // This packet cannot be sent at all
+            dropped++;
+        }
+    }
+
+    pthread_mutex_lock(&out_lock);
+    stats.send_calls += calls;
+    stats.sent += sent;
+    stats.dropped_packets += dropped;
+    pthread_mutex_unlock(&out_lock);
+    return done;
+}
+
+/*
+ * Function: flush_queues
+ * ----------------------
+ * Sends queued packets until the socket is full again, and stops
+ * watching for EPOLLOUT once nothing is left.
+ */
+static void flush_queues(void) {
+    const char* data[REACTOR_SEND_BATCH];
+    size_t len[REACTOR_SEND_BATCH];
+
+    for (int i = 0; i < destination_count; i++) {
+        Destination* d = &destinations[i];
+        pthread_mutex_lock(&d->lock);
+        while (d->head) {
+            int n = 0;
+            for (OutPacket* p = d->head; p && n < REACTOR_SEND_BATCH; p = p->next, n++) {
+                data[n] = p->data;
+                len[n] = p->len;
+            }
+            int done = send_batch(d, data, len, n);
+            for (int k = 0; k < done; k++) {
+                OutPacket* p = d->head;
+                d->head = p->next;
+                d->bytes -= p->len;
+                free(p);
+            }
+            if (!d->head) d->tail = NULL;
+
+            pthread_mutex_lock(&out_lock);
+            queued_packets -= done;
+            pthread_mutex_unlock(&out_lock);
+            if (done < n) break;  // Socket full
+        }
+        pthread_mutex_unlock(&d->lock);
+    }
+
+    pthread_mutex_lock(&out_lock);
+    if (queued_packets == 0 && write_armed) set_write_interest(false);
+    pthread_mutex_unlock(&out_lock);
+}
+
+/*
+ * Function: send_or_queue
+ * -----------------------
+ * Sends packets to one destination right away unless packets are queued
+ * ahead of them (never overtake), and queues whatever is left.
+ */
+static void send_or_queue(int destination, const char* const* data, const size_t* len, int count) {
+    Destination* d = &destinations[destination];
+    pthread_mutex_lock(&d->lock);
+    int done = d->head ? 0 : send_batch(d, data, len, count);
+
+    int queued = 0, dropped = 0;
+    for (int i = done; i < count; i++) {
+        OutPacket* p = NULL;
+        if (d->bytes + len[i] <= REACTOR_QUEUE_BYTES) p = malloc(sizeof(OutPacket) + len[i]);
+        if (!p) {
+            dropped++;
+            continue;
+        }
+        p->next = NULL;
+        p->len = len[i];
+        memcpy(p->data, data[i], len[i]);
+        if (d->tail) d->tail->next = p; else d->head = p;
+        d->tail = p;
+        d->bytes += len[i];
+        queued++;
+    }
+
+    pthread_mutex_lock(&out_lock);
+    stats.queued += queued;
+    stats.dropped_packets += dropped;
+    queued_packets += queued;
+    if (queued > 0 && !write_armed) set_write_interest(true);
+    pthread_mutex_unlock(&out_lock);
+    pthread_mutex_unlock(&d->lock);
+}
+
+/*
+ * Function: flush_batch
+ * ---------------------
+ * Sends the thread's batch, one send_or_queue per run of packets for
+ * the same destination, and empties it.
+ */
+static void flush_batch(void) {
+    const char* data[REACTOR_SEND_BATCH];
+    size_t len[REACTOR_SEND_BATCH];
+    int start = 0;
+    while (start < batch_count) {
+        int end = start;
+        while (end < batch_count && batch[end].destination == batch[start].destination) {
+            data[end - start] = batch[end].data;
+            len[end - start] = batch[end].len;
+            end++;
+        }
+        if (sock_fd >= 0) send_or_queue(batch[start].destination, data, len, end - start);
+        start = end;
+    }
+    for (int i = 0; i < batch_count; i++) free(batch[i].data);
+    batch_count = 0;
+    batch_bytes = 0;
+}
+
+void NetReactor_Send(int destination, const void* data, size_t len) {
+    if (sock_fd < 0 || destination < 0 || destination >= destination_count) return;
+
+    if (batch_depth > 0) {
+        char* copy = malloc(len);
+        if (copy) {
+            memcpy(copy, data, len);
+            batch[batch_count++] = (BatchPacket){ destination, len, copy };
+            batch_bytes += len;
+            if (batch_count == REACTOR_SEND_BATCH || batch_bytes >= REACTOR_BATCH_BYTES) flush_batch();
+            return;
+        }
+        flush_batch();  // Out of memory: keep the order and send it alone
+    }
+    const char* one = data;
+    send_or_queue(destination, &one, &len, 1);
+}
+
+void NetReactor_BeginBatch(void) {
+    batch_depth++;
+}
+
+void NetReactor_EndBatch(void) {
+    if (batch_depth > 0 && --batch_depth == 0) flush_batch();
+}
+
+int NetReactor_AddDestination(const char* ip, int port) {
+    pthread_mutex_lock(&out_lock);
+    int index = -1;
+    if (destination_count < REACTOR_MAX_DESTINATIONS) {
+        Destination* d = &destinations[destination_count];
+        memset(d, 0, sizeof(*d));
+        d->addr.sin_family = AF_INET;
+        d->addr.sin_port = htons((uint16_t)port);
+        if (inet_pton(AF_INET, ip, &d->addr.sin_addr) == 1) {
+            pthread_mutex_init(&d->lock, NULL);
+            index = destination_count++;
+        }
+    }
+    pthread_mutex_unlock(&out_lock);
+    return index;
+}
+
+bool NetReactor_IsLoopback(int destination) {
+    if (destination < 0 || destination >= destination_count) return false;
+    Destination* d = &destinations[destination];
+    pthread_mutex_lock(&d->lock);
+    bool loopback = (ntohl(d->addr.sin_addr.s_addr) >> 24) == 127;
+    pthread_mutex_unlock(&d->lock);
+    return loopback;
+}
+
+// --- Watched Descriptors ---
+
+bool NetReactor_Watch(int fd, uint32_t events, ReactorWatchFn fn, void* ctx) {
+    if (epoll_fd < 0) return false;
+    struct epoll_event ev = { .events = events, .data.fd = fd };
+    pthread_mutex_lock(&watch_lock);
+    int index = -1;
+    for (int i = 0; i < watch_count && index < 0; i++) {
+        if (watches[i].fd == fd) index = i;
+    }
+    bool ok;
+    if (index >= 0) {
+        if (fn) {
+            watches[index].fn = fn;
+            watches[index].ctx = ctx;
+        }
+        ok = epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) == 0;
+    } else if (fn && watch_count < REACTOR_MAX_WATCHES) {
+        ok = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+        if (ok) watches[watch_count++] = (Watch){ fd, fn, ctx };
+    } else {
+        ok = false;
+    }
+    pthread_mutex_unlock(&watch_lock);
+    return ok;
+}
+
+void NetReactor_Unwatch(int fd) {
+    pthread_mutex_lock(&watch_lock);
+    for (int i = 0; i < watch_count; i++) {
+        if (watches[i].fd != fd) continue;
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+        watches[i] = watches[--watch_count];
+        break;
+    }
+    pthread_mutex_unlock(&watch_lock);
+}
+
+/*
+ * Function: dispatch_watch
+ * ------------------------
+ * Runs the callback of a watched descriptor. An event for a descriptor
+ * removed earlier in the same epoll_wait batch finds no entry and is
+ * dropped.
+ */
+static void dispatch_watch(int fd, uint32_t events) {
+    pthread_mutex_lock(&watch_lock);
+    Watch w = { -1, NULL, NULL };
+    for (int i = 0; i < watch_count; i++) {
+        if (watches[i].fd == fd) w = watches[i];
+    }
+    pthread_mutex_unlock(&watch_lock);
+    if (w.fn) w.fn(fd, events, w.ctx);
+}
+
+// --- Reactor ---
+
+static void* reactor_main(void* arg) {
+    (void)arg;
+    struct epoll_event events[8];
+    for (;;) {
+        int n = epoll_wait(epoll_fd, events, 8, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            return NULL;
+        }
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.fd == wake_fd) return NULL;
+            if (events[i].data.fd != sock_fd) {
+                dispatch_watch(events[i].data.fd, events[i].events);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) drain_socket();
+            if (events[i].events & EPOLLOUT) flush_queues();
+        }
+    }
+}
+
+bool NetReactor_Start(int port, ReactorCommandFn handler, ReactorKeyFn key) {
+    command_handler = handler;
+    key_function = key;
+    sock_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock_fd < 0) { perror("Socket failed"); return false; }
+
+    // Allow port reuse for faster restarts
+    int opt = 1;
+    setsockopt(sock_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in servaddr;
+    memset(&servaddr, 0, sizeof(servaddr));
+    servaddr.sin_family = AF_INET;
+    servaddr.sin_addr.s_addr = INADDR_ANY;
+    servaddr.sin_port = htons((uint16_t)port);
+    if (bind(sock_fd, (const struct sockaddr*)&servaddr, sizeof(servaddr)) < 0) { perror("Bind failed"); return false; }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) { perror("epoll/eventfd failed"); return false; }
+    struct epoll_event ev = { .events = EPOLLIN, .data.fd = sock_fd };
+    struct epoll_event wake = { .events = EPOLLIN, .data.fd = wake_fd };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock_fd, &ev) < 0 ||
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &wake) < 0) {
+        perror("epoll_ctl failed");
+        return false;
+    }
+
+    for (int i = 0; i < REACTOR_WORKERS; i++) {
+        if (pthread_create(&workers[i], NULL, worker_main, (void*)(intptr_t)i) != 0) break;
+        worker_count++;
+    }
+    if (worker_count == 0 || pthread_create(&reactor_thread, NULL, reactor_main, NULL) != 0) {
+        fprintf(stderr, "Reactor threads failed\n");
+        return false;
+    }
+    return true;
+}
+
+void NetReactor_Stop(void) {
+    if (wake_fd < 0) return;
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) != sizeof(one)) perror("eventfd write");
+    pthread_join(reactor_thread, NULL);
+
+    pthread_mutex_lock(&job_lock);
+    stopping = true;
+    pthread_cond_broadcast(&job_cond);
+    pthread_mutex_unlock(&job_lock);
+    for (int i = 0; i < worker_count; i++) pthread_join(workers[i], NULL);
+    worker_count = 0;
+
+    while (job_head) {
+        Job* next = job_head->next;
+        free(job_head);
+        job_head = next;
+    }
+    job_tail = NULL;
+    job_count = 0;
+
+    // Last chance for queued replies (e.g. the "exit" acknowledgement)
+    flush_queues();
+    for (int i = 0; i < destination_count; i++) {
+        Destination* d = &destinations[i];
+        while (d->head) {
+            OutPacket* next = d->head->next;
+            free(d->head);
+            d->head = next;
+        }
+        d->tail = NULL;
+        d->bytes = 0;
+        pthread_mutex_destroy(&d->lock);
+    }
+    destination_count = 0;
+
+    pthread_mutex_lock(&watch_lock);
+    watch_count = 0;  // Their owners close them
+    pthread_mutex_unlock(&watch_lock);
+
+    close(wake_fd);
+    close(epoll_fd);
+    close(sock_fd);
+    wake_fd = epoll_fd = sock_fd = -1;
+}
+
+void NetReactor_GetStats(ReactorStats* out) {
+    pthread_mutex_lock(&out_lock);
+    *out = stats;
+    pthread_mutex_unlock(&out_lock);
+}
@@ -0,0 +1,206 @@
+/*
+ * File: net_session.c
+ * Version: 1.5.0
+ * Description:
+ * Implements the session table (see net_session.h). The table is small
+ * and looked up once per command, so a linear scan under one mutex is
+ * all it needs.
+ */
+
+#include "net_session.h"
+#include "app_publish.h"
+#include "utils_timer.h"
+#include <ctype.h>
+#include <string.h>
+
+static Session sessions[SESSION_MAX];
+static int session_count = 0;
+static Session broadcast_session = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .subscriptions = SESSION_TOPICS_DEFAULT,
+    .state_hz = PUBLISH_STATE_HZ,
+    .heavy_hz = PUBLISH_HEAVY_HZ,
+};
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Function: reset_session
+ * -----------------------
+ * Gives a slot to a new client with the default settings.
+ */
+static void reset_session(Session* s, const char* uid) {
+    pthread_mutex_lock(&s->lock);
+    strncpy(s->uid, uid, SESSION_UID_MAX - 1);
+    s->uid[SESSION_UID_MAX - 1] = '\0';
+    s->authenticated = false;
+    s->format = NETFMT_JSON;
+    s->has_format = false;
+    s->acked_version = 0;
+    s->has_ack = false;
+    s->binary_replies = false;
+    s->subscriptions = SESSION_TOPICS_DEFAULT;
+    s->compress_min = 0;
+    s->state_hz = 0;
+    s->heavy_hz = 0;
+    memset(s->preview, 0, sizeof(s->preview));
+    pthread_mutex_unlock(&s->lock);
+}
+
+Session* Session_Acquire(const char* uid) {
+    if (!uid || uid[0] == '\0') return &broadcast_session;
+
+    pthread_mutex_lock(&table_lock);
+    Session* found = NULL;
+    for (int i = 0; i < session_count && !found; i++) {
+        if (strncmp(sessions[i].uid, uid, SESSION_UID_MAX - 1) == 0) found = &sessions[i];
+    }
+    if (!found && session_count < SESSION_MAX) {
+        found = &sessions[session_count++];
+        pthread_mutex_init(&found->lock, NULL);
+        reset_session(found, uid);
+    }
+    if (!found) {
+        // Full: recycle the session idle for longest
+        for (int i = 0; i < session_count; i++) {
+            Session* s = &sessions[i];
+            if (s->refs == 0 && (!found || s->last_used_ms < found->last_used_ms)) found = s;
+        }
+        if (found) reset_session(found, uid);
+    }
+    if (found) {
+        found->refs++;
+        found->last_used_ms = Timer_GetMillis();
+    }
+    pthread_mutex_unlock(&table_lock);
+    return found;  // NULL: never fall back to the broadcast session, its packets reach everyone
+}
+
+void Session_Release(Session* s) {
+    if (!s || s == &broadcast_session) return;
+    pthread_mutex_lock(&table_lock);
+    s->refs--;
+    pthread_mutex_unlock(&table_lock);
+}
+
+Session* Session_Broadcast(void) {
+    return &broadcast_session;
+}
+
+bool Session_IsBroadcast(const Session* s) {
+    return s == &broadcast_session;
+}
+
+void Session_SetPreview(Session* s, int channel, const char* expression) {
+    if (channel < 0 || channel >= SESSION_CHANNELS) return;
+    pthread_mutex_lock(&s->lock);
+    strncpy(s->preview[channel], expression, SESSION_EQ_MAX - 1);
+    s->preview[channel][SESSION_EQ_MAX - 1] = '\0';
+    pthread_mutex_unlock(&s->lock);
+}
+
+void Session_ClearPreviews(Session* s) {
+    pthread_mutex_lock(&s->lock);
+    memset(s->preview, 0, sizeof(s->preview));
+    pthread_mutex_unlock(&s->lock);
+}
+
+uint32_t Session_Subscribe(Session* s, uint32_t topics, bool on) {
+    pthread_mutex_lock(&s->lock);
+    if (on) s->subscriptions |= topics;
+    else s->subscriptions &= ~topics;
+    uint32_t result = s->subscriptions;
+    pthread_mutex_unlock(&s->lock);
+    return result;
+}
+
+void Session_SetRates(Session* s, int state_hz, int heavy_hz) {
+    pthread_mutex_lock(&s->lock);
+    // The broadcast session's rates are the defaults and never "follow" anything
+    if (s != &broadcast_session || (state_hz > 0 && heavy_hz > 0)) {
+        s->state_hz = state_hz;
+        s->heavy_hz = heavy_hz;
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+bool Session_GetRates(Session* s, int* state_hz, int* heavy_hz) {
+    pthread_mutex_lock(&s->lock);
+    bool own = s->state_hz > 0;
+    *state_hz = s->state_hz;
+    *heavy_hz = s->heavy_hz;
+    pthread_mutex_unlock(&s->lock);
+    if (own) return s != &broadcast_session;
+
+    pthread_mutex_lock(&broadcast_session.lock);
+    *state_hz = broadcast_session.state_hz;
+    *heavy_hz = broadcast_session.heavy_hz;
+    pthread_mutex_unlock(&broadcast_session.lock);
+    return false;
+}
+
+void Session_FastestRates(int* state_hz, int* heavy_hz) {
+    pthread_mutex_lock(&broadcast_session.lock);
+    int default_state = broadcast_session.state_hz;
+    int default_heavy = broadcast_session.heavy_hz;
+    pthread_mutex_unlock(&broadcast_session.lock);
+
+    // Only clients that receive broadcasts at all count
+    pthread_mutex_lock(&table_lock);
+    int listeners = 0;
+    *state_hz = 0;
+    *heavy_hz = 0;
+    for (int i = 0; i < session_count; i++) {
+        pthread_mutex_lock(&sessions[i].lock);
+        bool listening = sessions[i].subscriptions != 0;
+        int s = sessions[i].state_hz > 0 ? sessions[i].state_hz : default_state;
+        int h = sessions[i].heavy_hz > 0 ? sessions[i].heavy_hz : default_heavy;
+        pthread_mutex_unlock(&sessions[i].lock);
+        if (!listening) continue;
+        listeners++;
+        if (s > *state_hz) *state_hz = s;
+        if (h > *heavy_hz) *heavy_hz = h;
+    }
+    pthread_mutex_unlock(&table_lock);
+
+    if (listeners == 0) {
+        *state_hz = default_state;
+        *heavy_hz = default_heavy;
+    }
+}
+
+uint32_t Session_ResultTopic(const char* label) {
+    if (label[0] == '\0' || label[1] != '\0') return TOPIC_RESULTS;
+    switch (toupper((unsigned char)label[0])) {
+        case 'X': return TOPIC_RESULT_X;
+        case 'Y': return TOPIC_RESULT_Y;
+        case 'Z': return TOPIC_RESULT_Z;
+        case 'W': return TOPIC_RESULT_W;
+        default: return TOPIC_RESULTS;
+    }
+}
+
+uint32_t Session_Demand(void) {
+    pthread_mutex_lock(&table_lock);
+    int count = session_count;
+    uint32_t demand = 0;
+    for (int i = 0; i < count; i++) {
+        pthread_mutex_lock(&sessions[i].lock);
+        demand |= sessions[i].subscriptions;
+        pthread_mutex_unlock(&sessions[i].lock);
+    }
+    pthread_mutex_unlock(&table_lock);
+
+    if (count == 0) {
+        pthread_mutex_lock(&broadcast_session.lock);
+        demand = broadcast_session.subscriptions;
+        pthread_mutex_unlock(&broadcast_session.lock);
+    }
+    return demand;
+}
+
+int Session_Count(void) {
+    pthread_mutex_lock(&table_lock);
+    int count = session_count;
+    pthread_mutex_unlock(&table_lock);
+    return count;
+}
@@ -0,0 +1,153 @@
+/*
+ * File: net_shm.c
+ * Version: 1.1.0
+ * Description:
+ * Shared-memory ring buffers (see net_shm.h). Positions only grow; the
+ * offset in the data area is the position modulo the capacity. The
+ * producer publishes 'tail' with a release store after copying the
+ * message, the consumer publishes 'head' after using it.
+ *
+ * Note: Version 1.1.0 bounds-checks what the drain reads from the other
+ * process (ShmRing_Drain).
+ */
+
+#include "net_shm.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define OFFSET_HEAD    64
+#define OFFSET_TAIL    128
+#define OFFSET_WAITING 192
+
+static uint64_t* head_of(const ShmRing* r) { return (uint64_t*)(r->base + OFFSET_HEAD); }
+static uint64_t* tail_of(const ShmRing* r) { return (uint64_t*)(r->base + OFFSET_TAIL); }
+static uint32_t* waiting_of(const ShmRing* r) { return (uint32_t*)(r->base + OFFSET_WAITING); }
+
+static size_t padded(size_t len) {
+    return (len + 3) & ~(size_t)3;
+}
+
+bool ShmRing_Create(ShmRing* ring, const char* name, size_t capacity, const char** error) {
+    memset(ring, 0, sizeof(*ring));
+    if (capacity < 64 || (capacity & (capacity - 1)) != 0 || strlen(name) >= sizeof(ring->name)) {
+        *error = "Bad ring size or name";
+        return false;
+    }
+
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        *error = "Cannot create shared memory";
+        return false;
+    }
+    size_t size = SHM_RING_DATA + capacity;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        *error = "Cannot size shared memory";
+        return false;
+    }
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping keeps the object open
+    if (map == MAP_FAILED) {
+        shm_unlink(name);
+        *error = "Cannot map shared memory";
+        return false;
+    }
+
+    // ftruncate zero-filled it: head = tail = 0. The consumer starts
+    // asleep, so the first message rings the doorbell.
+    ring->base = map;
+    ring->capacity = capacity;
+    snprintf(ring->name, sizeof(ring->name), "%s", name);
+    pthread_mutex_init(&ring->lock, NULL);
+    uint32_t cap32 = (uint32_t)capacity;
+    memcpy(ring->base + 4, &cap32, 4);
+    memcpy(ring->base, SHM_RING_MAGIC, 4);
+    __atomic_store_n(waiting_of(ring), 1, __ATOMIC_SEQ_CST);
+    return true;
+}
+
+void ShmRing_Destroy(ShmRing* ring) {
+    if (!ring->base) return;
+    munmap(ring->base, SHM_RING_DATA + ring->capacity);
+    shm_unlink(ring->name);
+    pthread_mutex_destroy(&ring->lock);
+    memset(ring, 0, sizeof(*ring));
+}
+
+bool ShmRing_Write(ShmRing* ring, const void* data, size_t len, bool* doorbell) {
+    *doorbell = false;
+    if (!ring->base || len > ring->capacity / 2) return false;
+
+    pthread_mutex_lock(&ring->lock);
+    uint64_t head = __atomic_load_n(head_of(ring), __ATOMIC_ACQUIRE);
+    uint64_t tail = *tail_of(ring);  // Only producers move it, under the lock
+    size_t offset = (size_t)(tail & (ring->capacity - 1));
+    size_t need = 4 + padded(len);
+    size_t skip = ring->capacity - offset < need ? ring->capacity - offset : 0;
+    if (tail + skip + need - head > ring->capacity) {
+        pthread_mutex_unlock(&ring->lock);
+        return false;
+    }
+
+    char* area = ring->base + SHM_RING_DATA;
+    if (skip) {
+        uint32_t pad = SHM_RING_PAD;
+        memcpy(area + offset, &pad, 4);
+        offset = 0;
+    }
+    uint32_t len32 = (uint32_t)len;
+    memcpy(area + offset, &len32, 4);
+    memcpy(area + offset + 4, data, len);
+    __atomic_store_n(tail_of(ring), tail + skip + need, __ATOMIC_SEQ_CST);
+
+    // Pairs with the consumer setting 'waiting' and then re-reading 'tail'
+    *doorbell = __atomic_exchange_n(waiting_of(ring), 0, __ATOMIC_SEQ_CST) != 0;
+    pthread_mutex_unlock(&ring->lock);
+    return true;
+}
+
+int ShmRing_Drain(ShmRing* ring, ShmMessageFn fn, void* ctx) {
+    if (!ring->base) return 0;
+    if (ring->broken) return -1;
+    const char* area = ring->base + SHM_RING_DATA;
+    int handled = 0;
+
+    for (;;) {
+        uint64_t head = *head_of(ring);  // Only the consumer moves it
+        uint64_t tail = __atomic_load_n(tail_of(ring), __ATOMIC_ACQUIRE);
+        if (tail < head || tail - head > ring->capacity) ring->broken = true;
+        while (!ring->broken && head < tail) {
+            size_t offset = (size_t)(head & (ring->capacity - 1));
+            size_t room = ring->capacity - offset;
+            uint32_t len;
+            memcpy(&len, area + offset, 4);
+            if (len == SHM_RING_PAD) {
+                if (room > tail - head) ring->broken = true;
+                else head += room;
+                continue;
+            }
+            // The length word comes from the other process: the message
+            // must lie between head and tail and inside the data area
+            size_t need = 4 + padded(len);
+            if (room < 4 || need > tail - head || need > room) {
+                ring->broken = true;
+                continue;
+            }
+            fn(area + offset + 4, len, ctx);
+            head += need;
+            handled++;
+            __atomic_store_n(head_of(ring), head, __ATOMIC_RELEASE);
+        }
+        if (ring->broken) return -1;  // Leaves head before the bad message
+        __atomic_store_n(head_of(ring), head, __ATOMIC_RELEASE);  // Also past a trailing pad
+
+        __atomic_store_n(waiting_of(ring), 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(tail_of(ring), __ATOMIC_SEQ_CST) == head) return handled;
+        __atomic_store_n(waiting_of(ring), 0, __ATOMIC_SEQ_CST);
+    }
+}
@@ -1,10 +1,36 @@
 /*
  * File: net_udp.c
- * Version: 1.1.0
+ * Version: 1.26.0
  * Description:
- * Implements the UDP server thread for external communication.
+ * Implements the UDP command server for external communication.
  * Listens on Port 12345 for ASCII commands and handles the specific
  * logic for "Input Protection" when in GPIO mode.
+ *
+ * Note: Version 1.12.0 hands the socket to the epoll reactor
+ * (net_reactor.h); commands now run on its worker threads. Version
+ * 1.13.0 replaces the global current UID with sessions (net_session.h)
+ * passed to every send, so concurrent commands and the main thread's
+ * broadcasts can no longer redirect each other's replies. Version
+ * 1.14.0 adds send batching and the "netstats" counters. Version 1.15.0
+ * splits packets larger than one datagram into sequenced chunks
+ * (NET_CHUNK_MAGIC) and answers "nack" from a retransmit cache.
+ * Version 1.16.0 adds the shared-memory transport ("transport shm").
+ * Version 1.17.0 accepts binary command frames (net_proto.h), dispatched
+ * through a table indexed by opcode, and sends binary replies to
+ * sessions that ask for them with "proto binary". Version 1.18.0 adds
+ * "rate" for the broadcast publish scheduler (app_publish.h). Version
+ * 1.19.0 adds "subscribe"/"unsubscribe" for broadcast topics. Version
+ * 1.20.0 adds the engine's own WebSocket endpoint (net_ws.h): packets
+ * for its clients' sessions bypass the bridge ("websocket"). Version
+ * 1.21.0 compresses large packets for sessions that ask ("compress").
+ * Version 1.22.0 drops "bench"; the benchmarks are a separate
+ * executable (logic_bench) and no longer run on reactor workers.
+ * Version 1.23.0 makes "rate" set the calling session's own rates.
+ * Version 1.24.0 falls back to UDP when the bridge's ring is malformed.
+ * Version 1.25.0 cuts long frame UIDs instead of answering them through
+ * the broadcast session. Version 1.26.0 limits "websocket" clients to
+ * pages from allowed sites (WS_ORIGINS, else the bridge's host) and
+ * takes an optional address to listen on.
  */
 
 #include "net_udp.h"
@@ -15,27 +41,73 @@
 #include "app_utils.h"       
 #include "utils_colors.h"    
 #include "app_verification.h"
+#include "utils_buffer.h"
+#include "app_timing.h"
+#include "app_cycle.h"
+#include "app_formal.h"
+#include "app_vectors.h"
+#include "app_capture.h"
+#include "net_reactor.h"
+#include "net_session.h"
+#include "net_shm.h"
+#include "net_proto.h"
+#include "app_publish.h"
+#include "net_ws.h"
+#include "utils_lz4.h"
+#include "utils_timer.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <pthread.h>
-#include <unistd.h>
-#include <arpa/inet.h>
-#include <sys/socket.h>
 
 // --- Configuration Constants ---
 #define PORT_LISTEN  12345
 #define PORT_NODEJS  12346
-#define IP_NODEJS    "127.0.0.1" 
+#define IP_NODEJS    "127.0.0.1"  // Bridge host unless BRIDGE_IP names another
+#define SHM_OUT_NAME "/logic_sim_out"  // Engine -> bridge ring
+#define SHM_IN_NAME  "/logic_sim_in"   // Bridge -> engine ring
 
 // --- Global Variables (Module Level) ---
-static pthread_t udp_thread;
-static int sockfd;
-static struct sockaddr_in node_addr;
-static volatile int running = 1;
+static int node_dest = -1;  // Reactor destination of the Node.js bridge
+static char ws_origins[WS_MAX_ORIGINS] = "";  // Sites whose pages may use "websocket"
 static volatile int exit_requested = 0;
-static char current_uid[64] = ""; 
+
+// --- Chunked Transport ---
+/*
+ * Struct: SentMessage
+ * -------------------
+ * A chunked packet kept for retransmission (remote bridges only).
+ */
+typedef struct {
+    uint32_t id;
+    size_t chunk_size;
+    size_t len;
+    char* data;  // NULL = free slot
+} SentMessage;
+
+static uint32_t next_message_id = 0;  // Atomic
+static SentMessage sent_cache[NET_CHUNK_CACHE];
+static int sent_cache_next = 0;
+static size_t sent_cache_bytes = 0;
+static pthread_mutex_t sent_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// --- Shared-Memory Transport ---
+static ShmRing ring_out, ring_in;
+static bool shm_available = false;    // Both rings exist
+static int shm_active = 0;            // Atomic; replies go through ring_out
+static long long shm_fallbacks = 0;   // Atomic; ring full, sent over UDP
+static int shm_broken = 0;            // Atomic; the bridge's ring held a malformed message
+
+// --- Payload Compression ---
+static __thread Lz4Context lz4_ctx;   // Reused by every packet a thread compresses
+static __thread DynBuf lz4_out;       // Keeps the capacity of the largest packet so far
+static long long compressed = 0;      // Atomic counters since start
+static long long compress_skipped = 0;
+static long long compress_bytes_in = 0;
+static long long compress_bytes_out = 0;
+static long long compress_ns = 0;
 
 // --- Security Globals ---
 static unsigned long ADMIN_HASH = 0; 
@@ -77,68 +149,661 @@ static void load_admin_secret() {
     }
 }
 
+/*
+ * Function: send_chunk
+ * --------------------
+ * Sends chunk 'index' of message 'id' (see NET_CHUNK_MAGIC).
+ */
+static void send_chunk(uint32_t id, const char* data, size_t len, size_t chunk_size, size_t index) {
+    size_t count = (len + chunk_size - 1) / chunk_size;
+    size_t offset = index * chunk_size;
+    size_t part = len - offset < chunk_size ? len - offset : chunk_size;
+
+    DynBuf chunk;
+    DynBuf_Init(&chunk);
+    DynBuf_AppendChar(&chunk, (char)NET_CHUNK_MAGIC);
+    DynBuf_AppendVarint(&chunk, id);
+    DynBuf_AppendVarint(&chunk, index);
+    DynBuf_AppendVarint(&chunk, count);
+    DynBuf_Append(&chunk, data + offset, part);
+    if (DynBuf_Ok(&chunk)) NetReactor_Send(node_dest, chunk.data, chunk.len);
+    DynBuf_Free(&chunk);
+}
+
+/*
+ * Function: remember_message
+ * --------------------------
+ * Keeps a copy of a chunked message for "nack", evicting the oldest
+ * ones past NET_CHUNK_CACHE entries or NET_CHUNK_CACHE_BYTES.
+ */
+static void remember_message(uint32_t id, const char* data, size_t len, size_t chunk_size) {
+    if (len > NET_CHUNK_CACHE_BYTES) return;
+    char* copy = malloc(len);
+    if (!copy) return;
+    memcpy(copy, data, len);
+
+    pthread_mutex_lock(&sent_cache_lock);
+    for (int i = 0; i < NET_CHUNK_CACHE && sent_cache_bytes + len > NET_CHUNK_CACHE_BYTES; i++) {
+        SentMessage* old = &sent_cache[(sent_cache_next + i) % NET_CHUNK_CACHE];
+        if (!old->data) continue;
+        sent_cache_bytes -= old->len;
+        free(old->data);
+        old->data = NULL;
+    }
+    SentMessage* m = &sent_cache[sent_cache_next];
+    if (m->data) {
+        sent_cache_bytes -= m->len;
+        free(m->data);
+    }
+    m->id = id;
+    m->chunk_size = chunk_size;
+    m->len = len;
+    m->data = copy;
+    sent_cache_bytes += len;
+    sent_cache_next = (sent_cache_next + 1) % NET_CHUNK_CACHE;
+    pthread_mutex_unlock(&sent_cache_lock);
+}
+
+/*
+ * Function: resend_chunks
+ * -----------------------
+ * Answers "nack <id> <i,j,...>": sends the listed chunks of a cached
+ * message again. Unknown ids (evicted, or sent to a local bridge) and
+ * out-of-range indices are ignored.
+ */
+static void resend_chunks(uint32_t id, char* list) {
+    pthread_mutex_lock(&sent_cache_lock);
+    for (int i = 0; i < NET_CHUNK_CACHE; i++) {
+        SentMessage* m = &sent_cache[i];
+        if (!m->data || m->id != id) continue;
+
+        size_t count = (m->len + m->chunk_size - 1) / m->chunk_size;
+        char* save = NULL;
+        for (char* tok = strtok_r(list, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+            char* end;
+            unsigned long index = strtoul(tok, &end, 10);
+            if (end != tok && index < count) send_chunk(id, m->data, m->len, m->chunk_size, index);
+        }
+        break;
+    }
+    pthread_mutex_unlock(&sent_cache_lock);
+}
+
+/*
+ * Function: send_datagram
+ * -----------------------
+ * Sends a finished packet to the bridge: through the shared-memory ring
+ * when that transport is on and the packet fits, otherwise as a
+ * datagram, split into chunks when it does not fit in one for the
+ * bridge's link.
+ */
+static void send_datagram(const char* data, size_t len) {
+    if (__atomic_load_n(&shm_active, __ATOMIC_ACQUIRE)) {
+        bool doorbell;
+        if (ShmRing_Write(&ring_out, data, len, &doorbell)) {
+            if (doorbell) {
+                const char bell = (char)SHM_DOORBELL;
+                NetReactor_Send(node_dest, &bell, 1);
+            }
+            return;
+        }
+        __atomic_add_fetch(&shm_fallbacks, 1, __ATOMIC_RELAXED);
+    }
+
+    bool loopback = NetReactor_IsLoopback(node_dest);
+    size_t chunk_size = loopback ? NET_CHUNK_LOCAL : NET_CHUNK_REMOTE;
+    if (len <= chunk_size) {
+        NetReactor_Send(node_dest, data, len);
+        return;
+    }
+
+    uint32_t id = __atomic_add_fetch(&next_message_id, 1, __ATOMIC_RELAXED);
+    if (!loopback) remember_message(id, data, len, chunk_size);
+
+    // Chunks of one message leave together
+    NetReactor_BeginBatch();
+    size_t count = (len + chunk_size - 1) / chunk_size;
+    for (size_t i = 0; i < count; i++) send_chunk(id, data, len, chunk_size, i);
+    NetReactor_EndBatch();
+}
+
+/*
+ * Function: read_varint
+ * ---------------------
+ * Reads an unsigned LEB128 varint at '*pos', advancing it.
+ *
+ * returns: false if it runs past 'len'.
+ */
+static bool read_varint(const uint8_t* data, size_t len, size_t* pos, size_t* value) {
+    *value = 0;
+    for (int shift = 0; *pos < len && shift < 64; shift += 7) {
+        uint8_t byte = data[(*pos)++];
+        *value |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+/*
+ * Function: json_topic
+ * --------------------
+ * Topic of a broadcast JSON object from its leading keys, as the
+ * bridge's topicOf does.
+ */
+static uint32_t json_topic(const char* json, size_t len) {
+    if (len > 128) len = 128;  // Type and target are among the first keys
+    if (len >= 7 && strncmp(json, "{\"mode\"", 7) == 0) return TOPIC_STATE;
+
+    char head[129];
+    memcpy(head, json, len);
+    head[len] = '\0';
+    const char* type = strstr(head, "\"type\": \"");
+    if (!type) return 0;
+    type += 9;
+    if (strncmp(type, "outputs\"", 8) == 0) return TOPIC_OUTPUTS;
+    if (strncmp(type, "netlist\"", 8) == 0) return TOPIC_NETLIST;
+    if (strncmp(type, "combined\"", 9) == 0) return TOPIC_COMBINED;
+    if (strncmp(type, "verify\"", 7) == 0) return TOPIC_VERIFY;
+    if (strncmp(type, "metrics\"", 8) == 0) return TOPIC_METRICS;
+    if (strncmp(type, "result\"", 7) == 0) {
+        const char* target = strstr(type, "\"target\": \"");
+        char label[2] = { target ? target[11] : '\0', '\0' };
+        if (target && target[12] == '"') return Session_ResultTopic(label);
+    }
+    return 0;
+}
+
+/*
+ * Function: packet_topic
+ * ----------------------
+ * Topic of a broadcast packet (JSON or binary envelope), or 0 for
+ * packets every client gets.
+ */
+static uint32_t packet_topic(const char* data, size_t len) {
+    if (len > 0 && data[0] == '{') return json_topic(data, len);
+    if (len == 0 || (uint8_t)data[0] != NET_BINARY_ENVELOPE) return 0;
+
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t pos = 1, uid_len, header_len;
+    if (!read_varint(bytes, len, &pos, &uid_len) || uid_len > len - pos) return 0;
+    pos += uid_len;
+    if (!read_varint(bytes, len, &pos, &header_len) || header_len > len - pos) return 0;
+    return json_topic(data + pos, header_len);
+}
+
+/*
+ * Function: compress_for
+ * ----------------------
+ * Compresses a packet for session 's' if it asked for compression and
+ * the packet reaches its threshold. The result lives in this thread's
+ * buffer until its next call.
+ *
+ * returns: true if '*data' and '*len' now name the compressed packet.
+ */
+static bool compress_for(Session* s, const char** data, size_t* len) {
+    pthread_mutex_lock(&s->lock);
+    uint32_t min = s->compress_min;
+    pthread_mutex_unlock(&s->lock);
+    if (min == 0 || *len < min) return false;
+
+    long long start = Timer_GetNanos();
+    DynBuf_Reset(&lz4_out);
+    DynBuf_AppendChar(&lz4_out, (char)NET_COMPRESSED_MAGIC);
+    DynBuf_AppendVarint(&lz4_out, *len);
+    Lz4_Compress(&lz4_ctx, *data, *len, &lz4_out);
+    __atomic_add_fetch(&compress_ns, Timer_GetNanos() - start, __ATOMIC_RELAXED);
+
+    if (!DynBuf_Ok(&lz4_out) || lz4_out.len >= *len) {
+        __atomic_add_fetch(&compress_skipped, 1, __ATOMIC_RELAXED);  // Sent as it is
+        return false;
+    }
+    __atomic_add_fetch(&compressed, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&compress_bytes_in, (long long)*len, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&compress_bytes_out, (long long)lz4_out.len, __ATOMIC_RELAXED);
+    *data = lz4_out.data;
+    *len = lz4_out.len;
+    return true;
+}
+
+/*
+ * Function: send_broadcast
+ * ------------------------
+ * Sends a broadcast packet to the bridge and to the WebSocket clients
+ * subscribed to its topic, except the client with session 'except_uid'
+ * (NULL for none). Only the bridge's copy is compressed (WebSocket
+ * clients negotiate compression for their own session only).
+ */
+static void send_broadcast(const char* data, size_t len, const char* except_uid) {
+    NetWs_Broadcast(data, len, packet_topic(data, len), except_uid);
+    compress_for(Session_Broadcast(), &data, &len);
+    send_datagram(data, len);
+}
+
+/*
+ * Function: send_to
+ * -----------------
+ * Sends a finished packet for a session: straight to its WebSocket when
+ * it is a WebSocket client's, to the bridge and every WebSocket client
+ * when it is a broadcast, otherwise to the bridge. Compressed first if
+ * the session asked for it.
+ */
+static void send_to(Session* s, const char* data, size_t len) {
+    if (Session_IsBroadcast(s)) {
+        send_broadcast(data, len, NULL);
+        return;
+    }
+    compress_for(s, &data, &len);
+    if (NetWs_IsClient(s->uid)) NetWs_Send(s->uid, data, len);
+    else send_datagram(data, len);
+}
+
 /*
  * Function: send_packet
  * ---------------------
  * Transmits a JSON string to the configured Node.js backend.
- * If a User ID (UID) is active, it wraps the JSON to target that specific user session.
+ * Packets for a client session get its UID spliced in so the bridge
+ * routes them to that user; broadcast packets go out untouched.
  */
-static void send_packet(const char* json_body) {
-    char buffer[65536];
-    
-    // Wrapper logic for multi-user support
-    if (strlen(current_uid) > 0) {
-        sprintf(buffer, "{ \"uid\": \"%s\", %s", current_uid, json_body + 1);
+static void send_packet(Session* s, const char* json_body) {
+    // A WebSocket carries one session's packets only: no UID needed
+    if (Session_IsBroadcast(s) || json_body[0] != '{' || NetWs_IsClient(s->uid)) {
+        send_to(s, json_body, strlen(json_body));
+        return;
+    }
+
+    // Wrapper logic for multi-user support: splice the uid in as the first key
+    DynBuf packet;
+    DynBuf_Init(&packet);
+    DynBuf_AppendStr(&packet, "{ \"uid\": ");
+    DynBuf_AppendJsonString(&packet, s->uid);
+    DynBuf_AppendStr(&packet, ", ");
+    DynBuf_AppendStr(&packet, json_body + 1);
+
+    if (DynBuf_Ok(&packet)) send_to(s, packet.data, packet.len);
+    DynBuf_Free(&packet);
+}
+
+/*
+ * Function: send_frame
+ * --------------------
+ * Sends a binary reply frame built with NetProto_Begin for session 's'.
+ */
+static void send_frame(Session* s, DynBuf* frame) {
+    if (DynBuf_Ok(frame)) send_to(s, frame->data, frame->len);
+}
+
+/*
+ * Function: wants_binary
+ * ----------------------
+ * true if the session asked for binary reply frames.
+ */
+static bool wants_binary(Session* s) {
+    pthread_mutex_lock(&s->lock);
+    bool binary = s->binary_replies;
+    pthread_mutex_unlock(&s->lock);
+    return binary;
+}
+
+/*
+ * Function: send_status
+ * ---------------------
+ * Sends { "status": "<text>" }, or a NET_OP_STATUS frame to a session in
+ * binary mode.
+ */
+static void send_status(Session* s, const char* text) {
+    DynBuf msg;
+    DynBuf_Init(&msg);
+    if (wants_binary(s)) {
+        NetProto_Begin(&msg, NET_OP_STATUS, s->uid);
+        NetProto_AppendString(&msg, NET_TAG_TEXT, text);
+        send_frame(s, &msg);
     } else {
-        strcpy(buffer, json_body);
+        DynBuf_AppendStr(&msg, "{ \"status\": ");
+        DynBuf_AppendJsonString(&msg, text);
+        DynBuf_AppendStr(&msg, " }");
+        if (DynBuf_Ok(&msg)) send_packet(s, msg.data);
     }
+    DynBuf_Free(&msg);
+}
+
+/*
+ * Function: send_report_packet
+ * ----------------------------
+ * VerificationSink that sends each packet of a streamed report to the
+ * Session passed as 'ctx'. The final packet (the summary) is also
+ * broadcast to TOPIC_VERIFY subscribers, tagged with the requester as
+ * "from" so the bridge does not deliver it to that client twice.
+ */
+static void send_report_packet(const char* packet, void* ctx) {
+    Session* s = ctx;
+    send_packet(s, packet);
+    if (Session_IsBroadcast(s) || packet[0] != '{' || strstr(packet, "\"status\": \"partial\"")) return;
+    if (!(Session_Demand() & TOPIC_VERIFY)) return;
+
+    DynBuf copy;
+    DynBuf_Init(&copy);
+    DynBuf_AppendStr(&copy, "{ \"from\": ");
+    DynBuf_AppendJsonString(&copy, s->uid);
+    DynBuf_AppendChar(&copy, ',');
+    DynBuf_AppendStr(&copy, packet + 1);
+    if (DynBuf_Ok(&copy)) send_broadcast(copy.data, copy.len, s->uid);
+    DynBuf_Free(&copy);
+}
+
+/*
+ * Constant: TOPIC_NAMES
+ * ---------------------
+ * Names of the broadcast topics for "subscribe"/"unsubscribe".
+ */
+static const struct {
+    const char* name;
+    uint32_t topics;
+} TOPIC_NAMES[] = {
+    { "state", TOPIC_STATE },
+    { "outputs", TOPIC_OUTPUTS },
+    { "result_x", TOPIC_RESULT_X },
+    { "result_y", TOPIC_RESULT_Y },
+    { "result_z", TOPIC_RESULT_Z },
+    { "result_w", TOPIC_RESULT_W },
+    { "results", TOPIC_RESULTS },
+    { "netlist", TOPIC_NETLIST },
+    { "combined", TOPIC_COMBINED },
+    { "verify", TOPIC_VERIFY },
+    { "metrics", TOPIC_METRICS },
+    { "all", TOPIC_ALL },
+};
+
+/*
+ * Function: parse_topics
+ * ----------------------
+ * Parses a comma-separated list of topic names into a mask.
+ *
+ * returns: 0 if the list is empty or names an unknown topic.
+ */
+static uint32_t parse_topics(const char* list) {
+    uint32_t topics = 0;
+    while (*list) {
+        size_t len = strcspn(list, ", ");
+        bool known = false;
+        for (size_t i = 0; i < sizeof(TOPIC_NAMES) / sizeof(TOPIC_NAMES[0]); i++) {
+            if (strlen(TOPIC_NAMES[i].name) == len && strncmp(TOPIC_NAMES[i].name, list, len) == 0) {
+                topics |= TOPIC_NAMES[i].topics;
+                known = true;
+            }
+        }
+        if (!known && len > 0) return 0;
+        list += len;
+        list += strspn(list, ", ");
+    }
+    return topics;
+}
+
+/*
+ * Function: send_subscriptions
+ * ----------------------------
+ * Replies { "type": "subscriptions", "topics": [ single topic names ] }.
+ */
+static void send_subscriptions(Session* s, uint32_t topics) {
+    DynBuf reply;
+    DynBuf_Init(&reply);
+    DynBuf_AppendStr(&reply, "{ \"type\": \"subscriptions\", \"topics\": [");
+    bool first = true;
+    for (size_t i = 0; i < sizeof(TOPIC_NAMES) / sizeof(TOPIC_NAMES[0]); i++) {
+        uint32_t t = TOPIC_NAMES[i].topics;
+        if ((t & (t - 1)) != 0 || !(topics & t)) continue;  // Groups are listed by member
+        if (!first) DynBuf_AppendChar(&reply, ',');
+        DynBuf_AppendJsonString(&reply, TOPIC_NAMES[i].name);
+        first = false;
+    }
+    DynBuf_AppendStr(&reply, "] }");
+    if (DynBuf_Ok(&reply)) send_packet(s, reply.data);
+    DynBuf_Free(&reply);
+}
 
-    sendto(sockfd, buffer, strlen(buffer), 0, 
-           (const struct sockaddr *)&node_addr, sizeof(node_addr));
+/*
+ * Function: write_netstats
+ * ------------------------
+ * Appends the network counters as a { "type": <type> } object.
+ */
+static void write_netstats(DynBuf* out, const char* type) {
+    ReactorStats rs;
+    NetReactor_GetStats(&rs);
+    char per_recv[32], per_send[32];
+    snprintf(per_recv, sizeof(per_recv), "%.2f", rs.recv_calls ? (double)rs.received / (double)rs.recv_calls : 0.0);
+    snprintf(per_send, sizeof(per_send), "%.2f", rs.send_calls ? (double)rs.sent / (double)rs.send_calls : 0.0);
+    DynBuf_AppendStr(out, "{ \"type\": ");
+    DynBuf_AppendJsonString(out, type);
+    DynBuf_AppendStr(out, ", \"received\": ");
+    DynBuf_AppendInt(out, rs.received);
+    DynBuf_AppendStr(out, ", \"recv_calls\": ");
+    DynBuf_AppendInt(out, rs.recv_calls);
+    DynBuf_AppendStr(out, ", \"packets_per_recv\": ");
+    DynBuf_AppendStr(out, per_recv);
+    DynBuf_AppendStr(out, ", \"sent\": ");
+    DynBuf_AppendInt(out, rs.sent);
+    DynBuf_AppendStr(out, ", \"send_calls\": ");
+    DynBuf_AppendInt(out, rs.send_calls);
+    DynBuf_AppendStr(out, ", \"packets_per_send\": ");
+    DynBuf_AppendStr(out, per_send);
+    DynBuf_AppendStr(out, ", \"queued\": ");
+    DynBuf_AppendInt(out, rs.queued);
+    DynBuf_AppendStr(out, ", \"dropped_commands\": ");
+    DynBuf_AppendInt(out, rs.dropped_commands);
+    DynBuf_AppendStr(out, ", \"dropped_packets\": ");
+    DynBuf_AppendInt(out, rs.dropped_packets);
+    DynBuf_AppendStr(out, ", \"sessions\": ");
+    DynBuf_AppendInt(out, Session_Count());
+    DynBuf_AppendStr(out, __atomic_load_n(&shm_active, __ATOMIC_RELAXED) ? ", \"transport\": \"shm\"" : ", \"transport\": \"udp\"");
+    DynBuf_AppendStr(out, ", \"shm_fallbacks\": ");
+    DynBuf_AppendInt(out, __atomic_load_n(&shm_fallbacks, __ATOMIC_RELAXED));
+
+    long long bytes_in = __atomic_load_n(&compress_bytes_in, __ATOMIC_RELAXED);
+    long long bytes_out = __atomic_load_n(&compress_bytes_out, __ATOMIC_RELAXED);
+    long long ns = __atomic_load_n(&compress_ns, __ATOMIC_RELAXED);
+    char ratio[32], mb_per_s[32];
+    snprintf(ratio, sizeof(ratio), "%.2f", bytes_out ? (double)bytes_in / (double)bytes_out : 0.0);
+    snprintf(mb_per_s, sizeof(mb_per_s), "%.2f", ns ? (double)bytes_in * 1000.0 / (double)ns : 0.0);
+    DynBuf_AppendStr(out, ", \"compressed\": ");
+    DynBuf_AppendInt(out, __atomic_load_n(&compressed, __ATOMIC_RELAXED));
+    DynBuf_AppendStr(out, ", \"compress_skipped\": ");
+    DynBuf_AppendInt(out, __atomic_load_n(&compress_skipped, __ATOMIC_RELAXED));
+    DynBuf_AppendStr(out, ", \"compress_bytes_in\": ");
+    DynBuf_AppendInt(out, bytes_in);
+    DynBuf_AppendStr(out, ", \"compress_bytes_out\": ");
+    DynBuf_AppendInt(out, bytes_out);
+    DynBuf_AppendStr(out, ", \"compress_ratio\": ");
+    DynBuf_AppendStr(out, ratio);
+    DynBuf_AppendStr(out, ", \"compress_us\": ");
+    DynBuf_AppendInt(out, ns / 1000);
+    DynBuf_AppendStr(out, ", \"compress_mb_per_s\": ");
+    DynBuf_AppendStr(out, mb_per_s);
+    DynBuf_AppendStr(out, " }");
+}
+
+/*
+ * Function: send_log
+ * ------------------
+ * Sends a { "log": "<prefix><text>" } packet with the text escaped.
+ */
+static void send_log(Session* s, const char* prefix, const char* text) {
+    DynBuf line;
+    DynBuf_Init(&line);
+    DynBuf_AppendStr(&line, prefix);
+    DynBuf_AppendStr(&line, text);
+
+    DynBuf msg;
+    DynBuf_Init(&msg);
+    DynBuf_AppendStr(&msg, "{ \"log\": ");
+    DynBuf_AppendJsonString(&msg, line.data);
+    DynBuf_AppendStr(&msg, " }");
+    if (DynBuf_Ok(&msg)) send_packet(s, msg.data);
+
+    DynBuf_Free(&msg);
+    DynBuf_Free(&line);
+}
+
+/*
+ * Function: send_error
+ * --------------------
+ * Reports a refused command: { "log": "Error: <text>" }, or a
+ * NET_OP_ERROR frame when binary. 'binary' forces a frame (replies to
+ * malformed frames).
+ */
+static void send_error(Session* s, const char* text, bool binary) {
+    if (!binary && !wants_binary(s)) {
+        send_log(s, "Error: ", text);
+        return;
+    }
+    DynBuf frame;
+    DynBuf_Init(&frame);
+    NetProto_Begin(&frame, NET_OP_ERROR, s->uid);
+    NetProto_AppendString(&frame, NET_TAG_TEXT, text);
+    send_frame(s, &frame);
+    DynBuf_Free(&frame);
+}
+
+/*
+ * Function: set_format_pref
+ * -------------------------
+ * Records the netlist encoding for a session; for the broadcast session
+ * it becomes the default.
+ */
+static void set_format_pref(Session* s, NetlistFormat format) {
+    pthread_mutex_lock(&s->lock);
+    s->format = format;
+    s->has_format = true;
+    pthread_mutex_unlock(&s->lock);
+}
+
+/*
+ * Function: set_acked_version
+ * ---------------------------
+ * Records the netlist version a session holds. Version 0 means the
+ * client has nothing and needs a full snapshot.
+ */
+static void set_acked_version(Session* s, uint32_t version) {
+    if (Session_IsBroadcast(s)) return;
+    pthread_mutex_lock(&s->lock);
+    s->acked_version = version;
+    s->has_ack = (version != 0);
+    pthread_mutex_unlock(&s->lock);
+}
+
+/*
+ * Function: channel_index
+ * -----------------------
+ * Maps "x".."w" (either case) to 0 (X) .. 3 (W); -1 for anything else.
+ */
+static int channel_index(char c) {
+    switch (c) {
+        case 'x': case 'X': return 0;
+        case 'y': case 'Y': return 1;
+        case 'z': case 'Z': return 2;
+        case 'w': case 'W': return 3;
+        default: return -1;
+    }
+}
+
+/*
+ * Function: set_inputs
+ * --------------------
+ * Drives inputs A-F from a client, unless the hardware pins own them.
+ */
+static void set_inputs(Session* s, int mask) {
+    SharedState st = AppState_GetSnapshot();
+
+    // PROTECTION: If in GPIO Mode, hardware pins rule. Web cannot override.
+    if (st.mode == MODE_GPIO_EXEC) {
+        send_error(s, "System is in GPIO Mode. Inputs are locked to hardware pins.", false);
+        printf("      " C_B_RED "✘ DENIED:" C_RESET " GPIO Mode Active\n");
+    } else {
+        AppState_SetInputMask((uint8_t)mask);
+        Timing_SetInputs((uint8_t)mask);
+        send_status(s, "Inputs Updated");
+    }
+}
+
+/*
+ * Function: program_channel
+ * -------------------------
+ * Saves the equation of channel 0 (X) .. 3 (W); the saved equation
+ * replaces the session's scratch copy.
+ */
+static void program_channel(Session* s, int channel, const char* expression) {
+    static const char* const STATUS[SESSION_CHANNELS] = { "Updated X", "Updated Y", "Updated Z", "Updated W" };
+    switch (channel) {
+        case 0: AppState_SetInputX(expression); break;
+        case 1: AppState_SetInputY(expression); break;
+        case 2: AppState_SetInputZ(expression); break;
+        default: AppState_SetInputW(expression); break;
+    }
+    Session_SetPreview(s, channel, "");
+    send_status(s, STATUS[channel]);
+}
+
+/*
+ * Function: set_reply_mode
+ * ------------------------
+ * Switches a session between JSON replies and binary frames. The
+ * broadcast session stays JSON: every client reads broadcasts.
+ */
+static void set_reply_mode(Session* s, bool binary) {
+    if (Session_IsBroadcast(s)) {
+        send_error(s, "proto needs a session ID", false);
+        return;
+    }
+    pthread_mutex_lock(&s->lock);
+    s->binary_replies = binary;
+    pthread_mutex_unlock(&s->lock);
+    send_status(s, binary ? "Protocol: binary" : "Protocol: json");
 }
 
 /*
  * Function: process_command
  * -------------------------
- * Parses raw ASCII commands received over UDP.
- * Format: "UID|Command Arguments"
+ * Runs one ASCII command received over UDP for session 's' (the UID
+ * before the '|' of "UID|Command Arguments"); replies go to 's'.
  *
  * Supported Commands:
  * - login <pass>: Authenticate admin access.
  * - program <target> <eq>: Set persistent equation.
  * - preview <target> <eq>: Test equation without saving.
  * - kmap <target> <csv>: Program via minterms.
+ * - ack/netsync <version>: Netlist version tracking.
+ * - timing / delay <gate> <ns>: Gate-delay timelines.
+ * - run <cycles> [masks] / reset: Clocked (sequential) execution.
+ * - verify <steps>: Test suite with expected outputs (streamed report).
+ * - verify_file / vectors_convert: Memory-mapped vector files.
+ * - trace <source> <target|off>: Waveform capture (VCD / binary).
+ * - netstats: Network counters (packets per syscall).
+ * - rate [state_hz heavy_hz|default]: This client's broadcast rates
+ *   (the defaults without a session ID) and the publish counters.
+ * - subscribe/unsubscribe <topics>: Broadcast topics this client receives.
+ * - nack <id> <i,j,...>: Resend chunks of a large packet.
+ * - transport <udp|shm>: Reply path to a bridge on this host.
+ * - proto <json|binary>: Reply encoding (binary frames, net_proto.h).
  * - print/clear/refresh: Utility commands.
  */
-static void process_command(char* raw_msg) {
-    // Split UID and Command
-    char* pipe_ptr = strchr(raw_msg, '|');
-    char* cmd;
-    
-    if (pipe_ptr) {
-        *pipe_ptr = '\0'; 
-        strncpy(current_uid, raw_msg, 63);
-        cmd = pipe_ptr + 1;
-    } else {
-        current_uid[0] = '\0';
-        cmd = raw_msg;
-    }
-
+static void process_command(Session* s, char* cmd) {
     // Strip newline characters
     cmd[strcspn(cmd, "\r\n")] = 0;
     printf(C_B_MAGENTA "[UDP]" C_RESET " User " C_CYAN "[%s]" C_RESET " sent: " C_YELLOW "'%s'" C_RESET "\n", 
-           current_uid, cmd);
+           s->uid, cmd);
 
     // --- Authentication ---
     if (strncmp(cmd, "login ", 6) == 0) {
         char* attempt = cmd + 6;
         unsigned long attempt_hash = hash_string(attempt);
-        
-        if (attempt_hash == ADMIN_HASH) {
-            send_packet("{ \"type\": \"auth\", \"status\": \"success\" }");
+        bool success = attempt_hash == ADMIN_HASH;
+
+        pthread_mutex_lock(&s->lock);
+        s->authenticated = success;
+        pthread_mutex_unlock(&s->lock);
+        if (success) {
+            send_packet(s, "{ \"type\": \"auth\", \"status\": \"success\" }");
             printf("      " C_B_GREEN "✔ AUTH SUCCESS" C_RESET "\n");
         } else {
-            send_packet("{ \"type\": \"auth\", \"status\": \"fail\" }");
+            send_packet(s, "{ \"type\": \"auth\", \"status\": \"fail\" }");
             printf("      " C_B_RED "✘ AUTH FAILED" C_RESET "\n");
         }
         return;
@@ -146,24 +811,14 @@ static void process_command(char* raw_msg) {
 
     // --- INPUT CONTROL (New for Requirement #10) ---
     else if (strncmp(cmd, "set_input ", 10) == 0) {
-        SharedState st = AppState_GetSnapshot();
-        
-        // PROTECTION: If in GPIO Mode, hardware pins rule. Web cannot override.
-        if (st.mode == MODE_GPIO_EXEC) {
-             send_packet("{ \"log\": \"Error: System is in GPIO Mode. Inputs are locked to hardware pins.\" }");
-             printf("      " C_B_RED "✘ DENIED:" C_RESET " GPIO Mode Active\n");
-        } else {
-             int mask = atoi(cmd + 10);
-             AppState_SetInputMask((uint8_t)mask);
-             send_packet("{ \"status\": \"Inputs Updated\" }");
-        }
+        set_inputs(s, atoi(cmd + 10));
     }
 
     // --- Stateless Preview ---
     else if (strncmp(cmd, "preview ", 8) == 0) {
         char* ptr = cmd + 8;
         char target[2] = { ptr[0], '\0' }; 
-        Process_Stateless(target, ptr + 2);
+        Process_Stateless(s, target, ptr + 2);
     }
     // --- K-Map Preview ---
     else if (strncmp(cmd, "preview_kmap ", 13) == 0) {
@@ -173,10 +828,11 @@ static void process_command(char* raw_msg) {
         if (ptr[1] == ' ') {
             char* csv = ptr + 2;
             TruthTable tt; tt.count = 0;
-            char* token = strtok(csv, ",");
+            char* save = NULL;
+            char* token = strtok_r(csv, ",", &save);
             while (token != NULL && tt.count < 64) {
                 tt.minterms[tt.count++] = atoi(token);
-                token = strtok(NULL, ",");
+                token = strtok_r(NULL, ",", &save);
             }
             
             ImplicantList primes = Minimizer_FindPrimeImplicants(tt);
@@ -184,40 +840,365 @@ static void process_command(char* raw_msg) {
             Minimizer_PrintSOP(&primes, sop_buffer);
 
             printf("      " C_BLUE "↳ K-Map Reversal:" C_RESET " %s\n", sop_buffer);
-            Process_Stateless(target, sop_buffer);
+            Process_Stateless(s, target, sop_buffer);
         }
     }
     // --- Persistent Programming ---
-    else if (strncmp(cmd, "program x ", 10) == 0) { AppState_SetInputX(cmd + 10); send_packet("{ \"status\": \"Updated X\" }"); }
-    else if (strncmp(cmd, "program y ", 10) == 0) { AppState_SetInputY(cmd + 10); send_packet("{ \"status\": \"Updated Y\" }"); }
-    else if (strncmp(cmd, "program z ", 10) == 0) { AppState_SetInputZ(cmd + 10); send_packet("{ \"status\": \"Updated Z\" }"); }
-    else if (strncmp(cmd, "program w ", 10) == 0) { AppState_SetInputW(cmd + 10); send_packet("{ \"status\": \"Updated W\" }"); }
+    // (the saved equation replaces the session's scratch copy)
+    else if (strncmp(cmd, "program ", 8) == 0 && islower((unsigned char)cmd[8]) &&
+             channel_index(cmd[8]) >= 0 && cmd[9] == ' ') {
+        program_channel(s, channel_index(cmd[8]), cmd + 10);
+    }
     
     else if (strncmp(cmd, "kmap ", 5) == 0) {
         char* ptr = cmd + 5;
         char target[2] = { ptr[0], '\0' };
+        Session_SetPreview(s, channel_index(ptr[0]), "");
         Program_From_Minterms(target, ptr + 2);
-        send_packet("{ \"status\": \"Processing K-Map Input\" }");
+        send_status(s, "Processing K-Map Input");
     }
     // --- Utilities ---
     else if (strcmp(cmd, "print x") == 0) {
         SharedState st = AppState_GetSnapshot();
-        char buf[256]; snprintf(buf, sizeof(buf), "{ \"log\": \"X = %s\" }", st.input_x); send_packet(buf);
+        send_log(s, "X = ", st.input_x);
     }
     else if (strcmp(cmd, "clear") == 0) {
         AppState_SetInputX(""); AppState_SetInputY(""); 
         AppState_SetInputZ(""); AppState_SetInputW("");
-        send_packet("{ \"status\": \"Cleared All\" }");
+        Session_ClearPreviews(s);
+        send_status(s, "Cleared All");
     }
     else if (strcmp(cmd, "refresh") == 0) {
         AppState_Touch();
+        Publish_RequestFull();  // Netlists too, although no equation changed
         printf("[UDP] Force Refresh Requested\n");
     }
     else if (strcmp(cmd, "exit") == 0) {
         exit_requested = 1; 
-        running = 0;        
         AppState_Touch(); 
-        send_packet("{ \"status\": \"Shutting down.\" }");
+        send_packet(s, "{ \"status\": \"Shutting down.\" }");
+    }
+
+    // --- Netlist Encoding ---
+    else if (strncmp(cmd, "netfmt ", 7) == 0) {
+        const char* fmt = cmd + 7;
+        if (strcmp(fmt, "binary") == 0 || strcmp(fmt, "json") == 0) {
+            set_format_pref(s, fmt[0] == 'b' ? NETFMT_BINARY : NETFMT_JSON);
+            send_log(s, "Netlist format: ", fmt);
+        } else {
+            send_log(s, "Error: netfmt expects 'json' or 'binary', got ", fmt);
+        }
+    }
+
+    // --- Payload Compression ---
+    else if (strncmp(cmd, "compress ", 9) == 0) {
+        char mode[8] = "";
+        int min = NET_COMPRESS_MIN;
+        sscanf(cmd + 9, "%7s %d", mode, &min);
+        bool lz4 = strcmp(mode, "lz4") == 0;
+        if ((!lz4 && strcmp(mode, "off") != 0) || min < NET_COMPRESS_MIN_FLOOR) {
+            send_error(s, "Usage: compress <off|lz4> [min_bytes] (at least 64)", false);
+        } else {
+            pthread_mutex_lock(&s->lock);
+            s->compress_min = lz4 ? (uint32_t)min : 0;
+            pthread_mutex_unlock(&s->lock);
+
+            DynBuf reply;
+            DynBuf_Init(&reply);
+            DynBuf_AppendStr(&reply, "{ \"type\": \"compress\", \"mode\": ");
+            DynBuf_AppendJsonString(&reply, lz4 ? "lz4" : "off");
+            DynBuf_AppendStr(&reply, ", \"min_bytes\": ");
+            DynBuf_AppendInt(&reply, lz4 ? min : 0);
+            DynBuf_AppendStr(&reply, " }");
+            if (DynBuf_Ok(&reply)) send_packet(s, reply.data);
+            DynBuf_Free(&reply);
+        }
+    }
+
+    // --- Reply Protocol ---
+    else if (strcmp(cmd, "proto binary") == 0 || strcmp(cmd, "proto json") == 0) {
+        set_reply_mode(s, cmd[6] == 'b');
+    }
+
+    // --- Netlist Versioning ---
+    else if (strncmp(cmd, "ack ", 4) == 0) {
+        set_acked_version(s, (uint32_t)strtoul(cmd + 4, NULL, 10));
+    }
+    else if (strncmp(cmd, "netsync ", 8) == 0) {
+        // Client reports what it holds (0 = nothing) and wants the
+        // current netlist: a delta if that version is still known.
+        set_acked_version(s, (uint32_t)strtoul(cmd + 8, NULL, 10));
+        SharedState st = AppState_GetSnapshot();
+        Send_Combined_Update(s, st.input_x, st.input_y, st.input_z, st.input_w);
+    }
+
+    // --- Timing Simulation ---
+    else if (strcmp(cmd, "timing") == 0) {
+        DynBuf report;
+        DynBuf_Init(&report);
+        Timing_WriteReport(&report);
+        if (DynBuf_Ok(&report)) send_packet(s, report.data);
+        DynBuf_Free(&report);
+    }
+    else if (strncmp(cmd, "delay ", 6) == 0) {
+        char gate[8] = "";
+        int ticks = 0;
+        if (sscanf(cmd + 6, "%7s %d", gate, &ticks) == 2 && Timing_SetDelay(gate, ticks)) {
+            send_log(s, "Gate delay updated: ", cmd + 6);
+        } else {
+            send_log(s, "Error: delay expects <and|or|xor|not|nand|nor> <ns>, got ", cmd + 6);
+        }
+    }
+
+    // --- Clocked Execution ---
+    else if (strncmp(cmd, "run ", 4) == 0) {
+        char* rest = NULL;
+        long long cycles = strtoll(cmd + 4, &rest, 10);
+
+        // Optional per-cycle input masks: "run 100 1,0,3"
+        uint8_t stimulus[CYCLE_MAX_STIMULUS];
+        int stimulus_count = 0;
+        char* save = NULL;
+        char* token = strtok_r(rest, ", ", &save);
+        while (token != NULL && stimulus_count < CYCLE_MAX_STIMULUS) {
+            stimulus[stimulus_count++] = (uint8_t)atoi(token);
+            token = strtok_r(NULL, ", ", &save);
+        }
+
+        // The main loop recompiles only on its next pass; a "program" sent
+        // just before must already be in effect for this run
+        SharedState st = AppState_GetSnapshot();
+        Cycle_Update(st.input_x, st.input_y, st.input_z, st.input_w);
+
+        DynBuf report;
+        DynBuf_Init(&report);
+        Cycle_Run(cycles, stimulus, stimulus_count, AppState_GetInputMask(), &report);
+        if (DynBuf_Ok(&report)) send_packet(s, report.data);
+        DynBuf_Free(&report);
+        AppState_Touch(); // Pins and state broadcast follow the new cycle
+    }
+    else if (strcmp(cmd, "reset") == 0) {
+        Cycle_Reset();
+        AppState_Touch();
+        send_packet(s, "{ \"status\": \"Registers Reset\" }");
+    }
+
+    // --- Fault Coverage ---
+    else if (strcmp(cmd, "faults") == 0 || strncmp(cmd, "faults ", 7) == 0) {
+        DynBuf report;
+        DynBuf_Init(&report);
+        Verification_FaultCoverage(cmd[6] == ' ' ? cmd + 7 : NULL, &report);
+        if (DynBuf_Ok(&report)) send_packet(s, report.data);
+        DynBuf_Free(&report);
+    }
+
+    // --- Test Suites ---
+    else if (strcmp(cmd, "verify") == 0 || strncmp(cmd, "verify ", 7) == 0) {
+        Verification_RunSuite(cmd[6] == ' ' ? cmd + 7 : "", send_report_packet, s);
+    }
+
+    else if (strncmp(cmd, "verify_file ", 12) == 0) {
+        Verification_RunFile(cmd + 12, send_report_packet, s);
+    }
+    else if (strncmp(cmd, "vectors_convert ", 16) == 0) {
+        // "vectors_convert suite.txt suite.lstv", both inside VECTORS_DIR
+        char text_name[128] = "", vector_name[128] = "";
+        char text_path[VECTORS_PATH_MAX], vector_path[VECTORS_PATH_MAX];
+        const char* error = "Usage: vectors_convert <text file> <vector file>";
+        long long count = 0;
+        if (sscanf(cmd + 16, "%127s %127s", text_name, vector_name) == 2) {
+            error = NULL;
+            if (!Vectors_ResolvePath(text_name, text_path, sizeof(text_path)) ||
+                !Vectors_ResolvePath(vector_name, vector_path, sizeof(vector_path))) {
+                error = "Invalid file name";
+            } else {
+                Vectors_ConvertText(text_path, vector_path, &count, &error);
+            }
+        }
+        DynBuf reply;
+        DynBuf_Init(&reply);
+        DynBuf_AppendStr(&reply, "{ \"type\": \"vectors\", \"status\": ");
+        if (error) {
+            DynBuf_AppendStr(&reply, "\"error\", \"message\": ");
+            DynBuf_AppendJsonString(&reply, error);
+        } else {
+            DynBuf_AppendStr(&reply, "\"ok\", \"file\": ");
+            DynBuf_AppendJsonString(&reply, vector_name);
+            DynBuf_AppendStr(&reply, ", \"steps\": ");
+            DynBuf_AppendInt(&reply, count);
+        }
+        DynBuf_AppendStr(&reply, " }");
+        if (DynBuf_Ok(&reply)) send_packet(s, reply.data);
+        DynBuf_Free(&reply);
+    }
+
+    // --- Waveform Capture ---
+    else if (strncmp(cmd, "trace ", 6) == 0) {
+        // "trace <verify|timing|gpio> <file|udp|off> [vcd|bin]"
+        char source_name[16] = "", target[64] = "", format_name[8] = "vcd";
+        CaptureSource source;
+        int fields = sscanf(cmd + 6, "%15s %63s %7s", source_name, target, format_name);
+        DynBuf reply;
+        DynBuf_Init(&reply);
+        if (fields < 2 || !Capture_SourceFromName(source_name, &source) ||
+            (strcmp(format_name, "vcd") != 0 && strcmp(format_name, "bin") != 0)) {
+            DynBuf_AppendStr(&reply, "{ \"type\": \"trace\", \"status\": \"error\", \"message\": \"Usage: trace <verify|timing|gpio> <file|udp|off> [vcd|bin]\" }");
+        } else if (strcmp(target, "off") == 0) {
+            if (source == CAPTURE_TIMING) Timing_Sync();  // Flush edges still pending
+            Capture_Stop(source, &reply);
+        } else {
+            const char* error = NULL;
+            TraceFormat format = strcmp(format_name, "bin") == 0 ? TRACE_BINARY : TRACE_VCD;
+            DynBuf_AppendStr(&reply, "{ \"type\": \"trace\", \"source\": ");
+            DynBuf_AppendJsonString(&reply, source_name);
+            if (Capture_Start(source, target, format, s->uid, &error)) {
+                DynBuf_AppendStr(&reply, ", \"status\": \"started\", \"target\": ");
+                DynBuf_AppendJsonString(&reply, target);
+                DynBuf_AppendStr(&reply, ", \"format\": ");
+                DynBuf_AppendJsonString(&reply, format_name);
+                // Start the live traces from the present state
+                if (source == CAPTURE_TIMING) Timing_Sync();
+                if (source == CAPTURE_GPIO) AppState_Touch();
+            } else {
+                DynBuf_AppendStr(&reply, ", \"status\": \"error\", \"message\": ");
+                DynBuf_AppendJsonString(&reply, error);
+            }
+            DynBuf_AppendStr(&reply, " }");
+        }
+        if (DynBuf_Ok(&reply)) send_packet(s, reply.data);
+        DynBuf_Free(&reply);
+    }
+
+    // --- Network Counters ---
+    else if (strcmp(cmd, "netstats") == 0) {
+        DynBuf reply;
+        DynBuf_Init(&reply);
+        write_netstats(&reply, "netstats");
+        if (DynBuf_Ok(&reply)) send_packet(s, reply.data);
+        DynBuf_Free(&reply);
+    }
+
+    // --- Broadcast Topics ---
+    else if (strncmp(cmd, "subscribe ", 10) == 0 || strncmp(cmd, "unsubscribe ", 12) == 0) {
+        bool on = cmd[0] == 's';
+        uint32_t topics = parse_topics(cmd + (on ? 10 : 12));
+        if (topics == 0) {
+            send_error(s, "Unknown topic (state, outputs, result_x..result_w, results, netlist, combined, verify, metrics, all)", false);
+        } else {
+            uint32_t now = Session_Subscribe(s, topics, on);
+            if (on) Publish_RequestFull();  // New subscribers start from a full update
+            send_subscriptions(s, now);
+        }
+    }
+    else if (strcmp(cmd, "subscriptions") == 0) {
+        pthread_mutex_lock(&s->lock);
+        uint32_t topics = s->subscriptions;
+        pthread_mutex_unlock(&s->lock);
+        send_subscriptions(s, topics);
+    }
+
+    // --- Broadcast Publish Rates ---
+    else if (strcmp(cmd, "rate") == 0 || strncmp(cmd, "rate ", 5) == 0) {
+        // A client sets its own rates; without a session ID, the defaults
+        int state_hz, heavy_hz;
+        bool ok = true;
+        if (strcmp(cmd, "rate default") == 0 && !Session_IsBroadcast(s)) {
+            Session_SetRates(s, 0, 0);
+        } else if (cmd[4]) {
+            ok = sscanf(cmd + 5, "%d %d", &state_hz, &heavy_hz) == 2 && Publish_SetRates(s, state_hz, heavy_hz);
+        }
+        if (!ok) {
+            send_error(s, "Usage: rate <state_hz> <heavy_hz> (1-1000) | rate default", false);
+        } else {
+            DynBuf reply;
+            DynBuf_Init(&reply);
+            Publish_WriteReport(s, &reply);
+            if (DynBuf_Ok(&reply)) send_packet(s, reply.data);
+            DynBuf_Free(&reply);
+        }
+    }
+
+    // --- Chunk Retransmission (sent by the bridge, no reply) ---
+    else if (strncmp(cmd, "nack ", 5) == 0) {
+        char* end;
+        unsigned long id = strtoul(cmd + 5, &end, 10);
+        if (end != cmd + 5 && *end == ' ') resend_chunks((uint32_t)id, end + 1);
+    }
+
+    // --- Transport Selection (sent by the bridge) ---
+    else if (strcmp(cmd, "transport udp") == 0) {
+        __atomic_store_n(&shm_active, 0, __ATOMIC_RELEASE);
+        send_packet(s, "{ \"type\": \"transport\", \"mode\": \"udp\" }");
+    }
+    else if (strcmp(cmd, "transport shm") == 0) {
+        if (!shm_available || __atomic_load_n(&shm_broken, __ATOMIC_ACQUIRE)) {
+            send_packet(s, "{ \"log\": \"Error: Shared memory is not available on the engine host.\" }");
+        } else if (!NetReactor_IsLoopback(node_dest)) {
+            send_packet(s, "{ \"log\": \"Error: Shared memory needs the bridge on the engine host.\" }");
+        } else {
+            __atomic_store_n(&shm_active, 1, __ATOMIC_RELEASE);
+            send_packet(s, "{ \"type\": \"transport\", \"mode\": \"shm\" }");
+        }
+    }
+
+    // --- Direct Browser Connections ---
+    else if (strcmp(cmd, "websocket") == 0 || strncmp(cmd, "websocket ", 10) == 0) {
+        char action[8] = "";
+        char address[INET_ADDRSTRLEN] = "";
+        int port = WS_DEFAULT_PORT;
+        sscanf(cmd + 9, "%7s %d %15s", action, &port, address);
+        if (strcmp(action, "on") == 0 && (port < 1 || port > 65535 || !NetWs_Start(address, port, ws_origins))) {
+            char where[32];
+            snprintf(where, sizeof(where), "%s:%d", address[0] ? address : "*", port);
+            send_log(s, "Error: Cannot listen for WebSocket clients on ", where);
+        } else if (strcmp(action, "off") == 0 || action[0] == '\0' || strcmp(action, "on") == 0) {
+            if (strcmp(action, "off") == 0) NetWs_Stop();
+            DynBuf report;
+            DynBuf_Init(&report);
+            NetWs_WriteReport(&report);
+            if (DynBuf_Ok(&report)) send_packet(s, report.data);
+            DynBuf_Free(&report);
+        } else {
+            send_error(s, "Usage: websocket [on [port [address]]|off]", false);
+        }
+    }
+
+    // --- Generated Stimulus ---
+    else if (strncmp(cmd, "stim ", 5) == 0) {
+        DynBuf report;
+        DynBuf_Init(&report);
+        Verification_RunStimulus(cmd + 5, &report);
+        if (DynBuf_Ok(&report)) send_packet(s, report.data);
+        DynBuf_Free(&report);
+    }
+
+    // --- Formal Checks ---
+    else if (strncmp(cmd, "equiv ", 6) == 0) {
+        // "equiv x y" or "equiv x A*B + C": the rest of the line is the other side
+        char a[8] = "";
+        int consumed = 0;
+        DynBuf report;
+        DynBuf_Init(&report);
+        if (sscanf(cmd + 6, "%7s %n", a, &consumed) == 1 && consumed > 0 && cmd[6 + consumed] != '\0') {
+            Formal_Equiv(a, cmd + 6 + consumed, &report);
+            if (DynBuf_Ok(&report)) send_packet(s, report.data);
+        } else {
+            send_log(s, "Error: equiv expects <channel> <channel|expression>, got ", cmd + 6);
+        }
+        DynBuf_Free(&report);
+    }
+    else if (strncmp(cmd, "sat ", 4) == 0) {
+        char channel[8] = "";
+        int value = 1;
+        DynBuf report;
+        DynBuf_Init(&report);
+        if (sscanf(cmd + 4, "%7s %d", channel, &value) >= 1) {
+            Formal_Sat(channel, value, &report);
+            if (DynBuf_Ok(&report)) send_packet(s, report.data);
+        } else {
+            send_log(s, "Error: sat expects <channel> [0|1], got ", cmd + 4);
+        }
+        DynBuf_Free(&report);
     }
 
     // --- Help Command ---
@@ -227,109 +1208,483 @@ static void process_command(char* raw_msg) {
             "\"set_input <mask> - Set inputs A-F (0-63). Locked in GPIO Mode.\","
             "\"program <target> <eq> - Set equation for x/y/z/w.\","
             "\"preview <target> <eq> - Test equation.\","
-            "\"kmap <target> <csv> - Program via minterms.\""
+            "\"kmap <target> <csv> - Program via minterms.\","
+            "\"netfmt <json|binary> - Choose the netlist encoding for this session.\","
+            "\"ack <version> - Confirm the netlist version this session holds.\","
+            "\"netsync <version> - Request the current netlist as a delta from <version> (0 = full).\","
+            "\"timing - Report per-output transition timelines with gate delays.\","
+            "\"delay <gate> <ns> - Set the propagation delay of a gate type.\","
+            "\"run <cycles> [m1,m2,...] - Clock the circuit; replies with a compressed output trace.\","
+            "\"reset - Clear all registers.\","
+            "\"verify <mask:ms[:expected],...> - Check every output against expected masks; streams mismatches and a summary.\","
+            "\"verify_file <name> - Run a binary vector file from the vectors/ directory like verify.\","
+            "\"vectors_convert <text> <name> - Convert a mask:ms[:expected] text suite in vectors/ to a binary vector file.\","
+            "\"trace <verify|timing|gpio> <file|udp|off> [vcd|bin] - Capture waveforms to traces/<file> or stream VCD over UDP.\","
+            "\"netstats - Network counters: datagrams and packets per recvmmsg/sendmmsg call, queued and dropped packets, compression ratio and CPU time.\","
+            "\"subscribe <topic,...> - Receive broadcast topics: state, outputs, result_x..result_w (results), netlist, combined, verify, metrics, all.\","
+            "\"unsubscribe <topic,...> - Stop receiving broadcast topics; topics nobody receives are not computed.\","
+            "\"subscriptions - List the broadcast topics this session receives.\","
+            "\"rate [state_hz heavy_hz|default] - Set or show the maximum rates at which this session receives state packets and netlist/result updates (default: follow the engine defaults), with sent and coalesced counters.\","
+            "\"nack <id> <i,j,...> - Resend missing chunks of a large packet (used by the bridge over remote links).\","
+            "\"transport <udp|shm> - Exchange packets with a bridge on this host through shared-memory rings.\","
+            "\"websocket [on [port [address]]|off] - Serve WebSocket clients directly (default port 8090 on every interface; text messages are commands, binary ones command frames; browser pages only from the WS_ORIGINS sites, by default the bridge's host), or show its counters.\","
+            "\"compress <off|lz4> [min_bytes] - LZ4-compress packets of at least min_bytes (default 1024) for this session; netstats reports the ratio and CPU time.\","
+            "\"proto <json|binary> - Reply to this session with JSON or binary frames (commands may be sent as binary frames either way).\","
+            "\"faults [mask:ms,...] - Stuck-at fault coverage of a test sequence (default: all input combinations).\","
+            "\"stim <mode> [vectors] [seed] [p1,p2,...] - Stream generated vectors (exhaustive, gray, lfsr, weighted, walking); reports per-output ones and toggles.\","
+            "\"equiv <ch> <ch|expr> - Prove a channel equivalent to another channel or an expression, or return the first counterexample.\","
+            "\"sat <ch> [0|1] - Find an input making a channel output the value (default 1), or prove there is none.\""
             "] }";
-        send_packet(help_json);
+        send_packet(s, help_json);
     }
     else {
         printf("      " C_B_RED "✘ ERROR:" C_RESET " Unknown command\n");
-        char err_buf[256];
-        snprintf(err_buf, sizeof(err_buf), "{ \"log\": \"Error: Unknown command '%s'\" }", cmd);
-        send_packet(err_buf);
+        send_log(s, "Error: Unknown command ", cmd);
     }
 }
 
+// --- Binary Frames ---
+
+typedef void (*FrameHandler)(Session* s, const NetFrame* frame);
+
 /*
- * Function: udp_loop
- * ------------------
- * The main execution loop for the UDP thread.
- * Blocks on recvfrom() until data arrives.
- */
-static void* udp_loop(void* arg) {
-    char buffer[1024];
-    struct sockaddr_in cliaddr;
-    socklen_t len = sizeof(cliaddr);
-
-    while (running) {
-        int n = recvfrom(sockfd, buffer, 1024, 0, (struct sockaddr *)&cliaddr, &len);
-        if (n > 0) {
-            buffer[n] = '\0';
-            process_command(buffer);
+ * Function: frame_channel
+ * -----------------------
+ * Reads a frame's TARGET as a channel index, replying with an error
+ * if it is missing or unknown.
+ *
+ * returns: 0 (X) .. 3 (W), or -1.
+ */
+static int frame_channel(Session* s, const NetFrame* frame) {
+    char target[4];
+    int channel = NetProto_FindString(frame, NET_TAG_TARGET, target, sizeof(target)) && target[1] == '\0'
+                  ? channel_index(target[0]) : -1;
+    if (channel < 0) send_error(s, "Frame needs a TARGET of x, y, z or w", true);
+    return channel;
+}
+
+static void op_text(Session* s, const NetFrame* frame) {
+    const uint8_t* text;
+    size_t len;
+    if (!NetProto_Find(frame, NET_TAG_TEXT, &text, &len)) {
+        send_error(s, "TEXT frame without a command", true);
+        return;
+    }
+    char* cmd = malloc(len + 1);
+    if (!cmd) return;
+    memcpy(cmd, text, len);
+    cmd[len] = '\0';
+    process_command(s, cmd);
+    free(cmd);
+}
+
+static void op_set_input(Session* s, const NetFrame* frame) {
+    uint64_t mask;
+    if (NetProto_FindVarint(frame, NET_TAG_MASK, &mask)) set_inputs(s, (int)(mask & 0xFF));
+    else send_error(s, "SET_INPUT frame without a MASK", true);
+}
+
+static void op_program(Session* s, const NetFrame* frame) {
+    char expression[SESSION_EQ_MAX];
+    int channel = frame_channel(s, frame);
+    if (channel < 0) return;
+    if (NetProto_FindString(frame, NET_TAG_TEXT, expression, sizeof(expression))) program_channel(s, channel, expression);
+    else send_error(s, "PROGRAM frame needs a TEXT equation that fits 255 bytes", true);
+}
+
+static void op_preview(Session* s, const NetFrame* frame) {
+    char expression[SESSION_EQ_MAX];
+    int channel = frame_channel(s, frame);
+    if (channel < 0) return;
+    char target[2] = { "xyzw"[channel], '\0' };
+    if (NetProto_FindString(frame, NET_TAG_TEXT, expression, sizeof(expression))) Process_Stateless(s, target, expression);
+    else send_error(s, "PREVIEW frame needs a TEXT equation that fits 255 bytes", true);
+}
+
+static void op_kmap(Session* s, const NetFrame* frame) {
+    uint64_t mask;
+    int channel = frame_channel(s, frame);
+    if (channel < 0) return;
+    if (!NetProto_FindMinterms(frame, NET_TAG_MINTERMS, &mask)) {
+        send_error(s, "KMAP frame without an 8-byte MINTERMS mask", true);
+        return;
+    }
+    char target[2] = { "xyzw"[channel], '\0' };
+    Session_SetPreview(s, channel, "");
+    Program_From_Mask(target, mask);
+    send_status(s, "Processing K-Map Input");
+}
+
+static void op_ack(Session* s, const NetFrame* frame) {
+    uint64_t version;
+    if (NetProto_FindVarint(frame, NET_TAG_VERSION, &version)) set_acked_version(s, (uint32_t)version);
+    else send_error(s, "ACK frame without a VERSION", true);
+}
+
+static void op_netsync(Session* s, const NetFrame* frame) {
+    uint64_t version = 0;
+    NetProto_FindVarint(frame, NET_TAG_VERSION, &version);  // Missing = full snapshot
+    set_acked_version(s, (uint32_t)version);
+    SharedState st = AppState_GetSnapshot();
+    Send_Combined_Update(s, st.input_x, st.input_y, st.input_z, st.input_w);
+}
+
+static void op_proto(Session* s, const NetFrame* frame) {
+    uint64_t mode;
+    if (NetProto_FindVarint(frame, NET_TAG_MODE, &mode) && mode <= 1) set_reply_mode(s, mode == 1);
+    else send_error(s, "PROTO frame needs MODE 0 (json) or 1 (binary)", true);
+}
+
+static void op_ping(Session* s, const NetFrame* frame) {
+    const uint8_t* nonce = NULL;
+    size_t len = 0;
+    NetProto_Find(frame, NET_TAG_NONCE, &nonce, &len);
+    DynBuf pong;
+    DynBuf_Init(&pong);
+    NetProto_Begin(&pong, NET_OP_PONG, s->uid);
+    NetProto_AppendTlv(&pong, NET_TAG_NONCE, nonce, len);
+    send_frame(s, &pong);
+    DynBuf_Free(&pong);
+}
+
+// Indexed by request opcode
+static const FrameHandler FRAME_HANDLERS[NET_OP_REQUEST_COUNT] = {
+    [NET_OP_TEXT] = op_text,
+    [NET_OP_SET_INPUT] = op_set_input,
+    [NET_OP_PROGRAM] = op_program,
+    [NET_OP_PREVIEW] = op_preview,
+    [NET_OP_KMAP] = op_kmap,
+    [NET_OP_ACK] = op_ack,
+    [NET_OP_NETSYNC] = op_netsync,
+    [NET_OP_PROTO] = op_proto,
+    [NET_OP_PING] = op_ping,
+};
+
+/*
+ * Function: refuse_session
+ * ------------------------
+ * Answers a client that got no session (the table is full and every
+ * slot is held) through a stand-in with its UID and default settings,
+ * so the refusal reaches that client alone.
+ */
+static void refuse_session(const char* uid, bool binary) {
+    Session stand_in = { .lock = PTHREAD_MUTEX_INITIALIZER };
+    snprintf(stand_in.uid, sizeof(stand_in.uid), "%s", uid);
+    send_error(&stand_in, "Too many sessions; try again later", binary);
+    printf("      " C_B_RED "✘ DENIED:" C_RESET " No free session for %s\n", uid);
+}
+
+/*
+ * Function: handle_frame
+ * ----------------------
+ * Runs one binary command frame for the session named in its header.
+ * The UID is taken from the header even when the rest of the frame is
+ * malformed, so the error reaches the requester. A UID that does not
+ * fit in the datagram or holds a NUL leaves no one to answer, and the
+ * frame is dropped rather than answered through the broadcast session.
+ * Long UIDs are cut to SESSION_UID_MAX - 1 bytes, like text commands.
+ */
+static void handle_frame(const char* msg, size_t len) {
+    NetFrame frame;
+    char uid[SESSION_UID_MAX] = "";
+    size_t uid_len = (uint8_t)msg[3];
+    if (NET_PROTO_HEADER + uid_len > len || memchr(msg + NET_PROTO_HEADER, '\0', uid_len)) {
+        printf("      " C_B_RED "✘ DROPPED:" C_RESET " Frame without a readable UID\n");
+        return;
+    }
+    if (uid_len >= sizeof(uid)) uid_len = sizeof(uid) - 1;
+    memcpy(uid, msg + NET_PROTO_HEADER, uid_len);
+    uid[uid_len] = '\0';
+    bool ok = NetProto_Parse(msg, len, &frame);
+
+    Session* s = Session_Acquire(uid);
+    if (!s) {
+        refuse_session(uid, true);
+    } else if (!ok) {
+        send_error(s, "Malformed frame", true);
+    } else if (frame.version != NET_PROTO_VERSION) {
+        send_error(s, "Unsupported frame version", true);
+    } else if (frame.opcode >= NET_OP_REQUEST_COUNT) {
+        send_error(s, "Unknown opcode", true);
+    } else {
+        FRAME_HANDLERS[frame.opcode](s, &frame);
+    }
+    Session_Release(s);
+}
+
+/*
+ * Function: session_key
+ * ---------------------
+ * ReactorKeyFn: a command's UID, from a frame header or before the '|'
+ * of a text command, so both forms of one session stay in order.
+ */
+static void session_key(const char* msg, size_t len, char* key) {
+    size_t key_len = 0;
+    const char* start = msg;
+    if (NetProto_IsFrame(msg, len)) {
+        key_len = (uint8_t)msg[3];
+        start = msg + NET_PROTO_HEADER;
+        if (NET_PROTO_HEADER + key_len > len) key_len = 0;
+    } else {
+        const char* pipe_ptr = memchr(msg, '|', len);
+        if (pipe_ptr) key_len = (size_t)(pipe_ptr - msg);
+    }
+    if (key_len >= REACTOR_KEY_MAX) key_len = REACTOR_KEY_MAX - 1;
+    memcpy(key, start, key_len);
+    key[key_len] = '\0';
+}
+
+/*
+ * Function: submit_ring_command
+ * -----------------------------
+ * ShmMessageFn: queues a command from the bridge's ring like a datagram
+ * from 'ctx' (the doorbell's sender).
+ */
+static void submit_ring_command(const char* data, size_t len, void* ctx) {
+    NetReactor_Submit(data, len, ctx);
+}
+
+/*
+ * Function: handle_datagram
+ * -------------------------
+ * ReactorCommandFn: splits "UID|command", holds the UID's session for
+ * the command and runs it on a reactor worker. A doorbell queues the
+ * commands waiting in the bridge's ring instead. Replies always go to
+ * the configured bridge (bridge_address), whoever sent the command.
+ */
+static void handle_datagram(char* msg, size_t len, const struct sockaddr_in* from) {
+    if (len == 1 && (unsigned char)msg[0] == SHM_DOORBELL) {
+        // Doorbells carry no session, so they drain the ring one at a time
+        if (ShmRing_Drain(&ring_in, submit_ring_command, (void*)from) < 0 &&
+            !__atomic_exchange_n(&shm_broken, 1, __ATOMIC_ACQ_REL)) {
+            // Tell the bridge to send over UDP again; the ring stays unused
+            printf(C_B_RED "[Network] Malformed message in the shared-memory ring, using UDP" C_RESET "\n");
+            __atomic_store_n(&shm_active, 0, __ATOMIC_RELEASE);
+            send_packet(Session_Broadcast(), "{ \"type\": \"transport\", \"mode\": \"udp\" }");
         }
+        return;
+    }
+    if (NetProto_IsFrame(msg, len)) {
+        handle_frame(msg, len);
+        return;
+    }
+
+    char* pipe_ptr = strchr(msg, '|');
+    char* cmd = msg;
+    const char* uid = "";
+    if (pipe_ptr) {
+        *pipe_ptr = '\0';
+        uid = msg;
+        cmd = pipe_ptr + 1;
     }
-    return NULL;
+
+    Session* s = Session_Acquire(uid);
+    if (!s) {
+        refuse_session(uid, false);
+        return;
+    }
+    process_command(s, cmd);
+    Session_Release(s);
+}
+
+/*
+ * Function: bridge_address
+ * ------------------------
+ * returns: The bridge's host: the BRIDGE_IP environment variable when it
+ *          is set, else IP_NODEJS. Taken once at start, so a stray
+ *          datagram from another host can never redirect the broadcasts.
+ */
+static const char* bridge_address(void) {
+    const char* ip = getenv("BRIDGE_IP");
+    return (ip && ip[0]) ? ip : IP_NODEJS;
 }
 
 // --- Public API Implementation ---
 
 void NetUDP_Init(void) {
-    if ((sockfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) { perror("Socket failed"); exit(EXIT_FAILURE); }
-    
-    struct sockaddr_in servaddr;
-    memset(&servaddr, 0, sizeof(servaddr));
-    servaddr.sin_family = AF_INET;
-    servaddr.sin_addr.s_addr = INADDR_ANY;
-    servaddr.sin_port = htons(PORT_LISTEN);
+    load_admin_secret();
 
-    // Allow port reuse for faster restarts
-    int opt = 1;
-    setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    const char* error = NULL;
+    shm_available = ShmRing_Create(&ring_out, SHM_OUT_NAME, SHM_RING_BYTES, &error) &&
+                    ShmRing_Create(&ring_in, SHM_IN_NAME, SHM_RING_BYTES, &error);
+    if (!shm_available) {
+        printf("[UDP] Shared-memory transport unavailable: %s\n", error);
+        ShmRing_Destroy(&ring_out);
+    }
 
-    if (bind(sockfd, (const struct sockaddr *)&servaddr, sizeof(servaddr)) < 0) { perror("Bind failed"); exit(EXIT_FAILURE); }
+    const char* bridge_ip = bridge_address();
+    node_dest = NetReactor_AddDestination(bridge_ip, PORT_NODEJS);
+    if (node_dest < 0) {
+        printf(C_B_RED "[UDP] Invalid BRIDGE_IP '%s'; using %s" C_RESET "\n", bridge_ip, IP_NODEJS);
+        node_dest = NetReactor_AddDestination(IP_NODEJS, PORT_NODEJS);
+    }
 
-    memset(&node_addr, 0, sizeof(node_addr));
-    node_addr.sin_family = AF_INET;
-    node_addr.sin_port = htons(PORT_NODEJS);
-    inet_pton(AF_INET, IP_NODEJS, &node_addr.sin_addr);
+    // Browsers load the page from the bridge, so by default only its host may connect
+    const char* origins = getenv("WS_ORIGINS");
+    if (origins && origins[0] && strlen(origins) < sizeof(ws_origins)) {
+        snprintf(ws_origins, sizeof(ws_origins), "%s", origins);
+    } else {
+        snprintf(ws_origins, sizeof(ws_origins), "%s%s", bridge_ip,
+                 NetReactor_IsLoopback(node_dest) ? ",localhost" : "");
+    }
 
-    load_admin_secret();
-    
-    pthread_create(&udp_thread, NULL, udp_loop, NULL);
-    printf("[UDP] Server listening on port %d\n", PORT_LISTEN);
+    if (!NetReactor_Start(PORT_LISTEN, handle_datagram, session_key)) exit(EXIT_FAILURE);
+    printf("[UDP] Server listening on port %d (%d workers)\n", PORT_LISTEN, REACTOR_WORKERS);
 }
 
 void NetUDP_Cleanup(void) {
-    running = 0;
-    pthread_cancel(udp_thread);
-    pthread_join(udp_thread, NULL);
-    close(sockfd);
+    NetWs_Stop();  // Its sockets are on the reactor's loop
+    NetReactor_Stop();
+    ShmRing_Destroy(&ring_out);
+    ShmRing_Destroy(&ring_in);
+
+    pthread_mutex_lock(&sent_cache_lock);
+    for (int i = 0; i < NET_CHUNK_CACHE; i++) {
+        free(sent_cache[i].data);
+        sent_cache[i].data = NULL;
+    }
+    sent_cache_bytes = 0;
+    pthread_mutex_unlock(&sent_cache_lock);
 }
 
 void NetUDP_BroadcastState(void) {
-    char json_buf[1024];
     SharedState st = AppState_GetSnapshot();
-    JSON_SerializeState(&st, json_buf, sizeof(json_buf));
-    current_uid[0] = '\0'; 
-    send_packet(json_buf);
+    DynBuf json;
+    DynBuf_Init(&json);
+    JSON_SerializeState(&st, &json);
+    if (DynBuf_Ok(&json)) send_packet(Session_Broadcast(), json.data);
+    DynBuf_Free(&json);
 }
 
-void NetUDP_SendLogicResult(const char* target, const char* sop, const char* pos, const int* minterms, int count, const char* mode) {
-    char buffer[4096]; 
-    int offset = 0;
-    
-    offset += sprintf(buffer + offset, 
-        "{ \"type\": \"result\", \"mode\": \"%s\", \"target\": \"%s\", \"sop\": \"%s\", \"pos\": \"%s\", \"minterms\": [", 
-        mode, target, sop, pos);
+void NetUDP_BroadcastOutputs(uint32_t inputs, uint32_t outputs) {
+    DynBuf json;
+    DynBuf_Init(&json);
+    DynBuf_AppendStr(&json, "{ \"type\": \"outputs\", \"inputs\": ");
+    DynBuf_AppendUInt(&json, inputs);
+    DynBuf_AppendStr(&json, ", \"outputs\": ");
+    DynBuf_AppendUInt(&json, outputs);
+    DynBuf_AppendStr(&json, " }");
+    if (DynBuf_Ok(&json)) send_packet(Session_Broadcast(), json.data);
+    DynBuf_Free(&json);
+}
+
+void NetUDP_BroadcastMetrics(void) {
+    DynBuf json;
+    DynBuf_Init(&json);
+    write_netstats(&json, "metrics");
+    if (DynBuf_Ok(&json)) send_packet(Session_Broadcast(), json.data);
+    DynBuf_Free(&json);
+}
 
-    for (int i = 0; i < count; i++) {
-        offset += sprintf(buffer + offset, "%d", minterms[i]);
-        if (i < count - 1) offset += sprintf(buffer + offset, ", ");
+void NetUDP_SendLogicResult(Session* session, const char* target, const char* sop, const char* pos, const int* minterms, int count, const char* mode) {
+    DynBuf packet;
+    DynBuf_Init(&packet);
+
+    if (wants_binary(session)) {
+        uint64_t mask = 0;
+        for (int i = 0; i < count; i++) {
+            if (minterms[i] >= 0 && minterms[i] < 64) mask |= 1ULL << minterms[i];
+        }
+        NetProto_Begin(&packet, NET_OP_RESULT, session->uid);
+        NetProto_AppendString(&packet, NET_TAG_TARGET, target);
+        NetProto_AppendString(&packet, NET_TAG_MODE_NAME, mode);
+        NetProto_AppendString(&packet, NET_TAG_SOP, sop);
+        NetProto_AppendString(&packet, NET_TAG_POS, pos);
+        NetProto_AppendMinterms(&packet, NET_TAG_MINTERMS, mask);
+        send_frame(session, &packet);
+        DynBuf_Free(&packet);
+        return;
     }
-    offset += sprintf(buffer + offset, "] }");
-    
-    send_packet(buffer);
+
+    DynBuf_AppendStr(&packet, "{ \"type\": \"result\", \"mode\": ");
+    DynBuf_AppendJsonString(&packet, mode);
+    DynBuf_AppendStr(&packet, ", \"target\": ");
+    DynBuf_AppendJsonString(&packet, target);
+    DynBuf_AppendStr(&packet, ", \"sop\": ");
+    DynBuf_AppendJsonString(&packet, sop);
+    DynBuf_AppendStr(&packet, ", \"pos\": ");
+    DynBuf_AppendJsonString(&packet, pos);
+    DynBuf_AppendStr(&packet, ", \"minterms\": ");
+    DynBuf_AppendJsonIntArray(&packet, minterms, count);
+    DynBuf_AppendStr(&packet, " }");
+
+    if (DynBuf_Ok(&packet)) send_packet(session, packet.data);
+    DynBuf_Free(&packet);
+}
+
+void NetUDP_SendNetlist(Session* session, const char* target, const char* json_data) {
+    DynBuf packet;
+    DynBuf_Init(&packet);
+
+    DynBuf_AppendStr(&packet, "{ \"type\": \"netlist\", \"target\": ");
+    DynBuf_AppendJsonString(&packet, target);
+    DynBuf_AppendStr(&packet, ", \"elements\": ");
+    DynBuf_AppendStr(&packet, json_data);
+    DynBuf_AppendStr(&packet, " }");
+
+    if (DynBuf_Ok(&packet)) send_packet(session, packet.data);
+    DynBuf_Free(&packet);
+}
+
+NetlistFormat NetUDP_GetNetlistFormat(Session* session) {
+    Session* b = Session_Broadcast();
+    pthread_mutex_lock(&session->lock);
+    bool has_format = session->has_format;
+    NetlistFormat format = session->format;
+    pthread_mutex_unlock(&session->lock);
+    if (has_format) return format;
+
+    pthread_mutex_lock(&b->lock);
+    format = b->has_format ? b->format : NETFMT_JSON;
+    pthread_mutex_unlock(&b->lock);
+    return format;
 }
 
-void NetUDP_SendNetlist(const char* target, const char* json_data) {
-    static char buffer[8192]; 
-    snprintf(buffer, sizeof(buffer), "{ \"type\": \"netlist\", \"target\": \"%s\", \"elements\": %s }", target, json_data);
-    send_packet(buffer);
+bool NetUDP_GetBaseVersion(Session* session, uint32_t* version) {
+    pthread_mutex_lock(&session->lock);
+    bool known = session->has_ack;
+    if (known) *version = session->acked_version;
+    pthread_mutex_unlock(&session->lock);
+    return known;
 }
 
-void NetUDP_SendRaw(const char* json_data) {
-    send_packet(json_data);
+void NetUDP_NoteSentVersion(Session* session, uint32_t version) {
+    if (!Session_IsBroadcast(session)) return; // Sessions report their own version via "ack"
+    pthread_mutex_lock(&session->lock);
+    session->acked_version = version;
+    session->has_ack = true;
+    pthread_mutex_unlock(&session->lock);
+}
+
+void NetUDP_SendBinaryNetlist(Session* session, const char* header_json, const DynBuf* netlist) {
+    size_t uid_len = strlen(session->uid);
+    size_t header_len = strlen(header_json);
+
+    DynBuf packet;
+    DynBuf_Init(&packet);
+    DynBuf_AppendChar(&packet, (char)NET_BINARY_ENVELOPE);
+    DynBuf_AppendVarint(&packet, uid_len);
+    DynBuf_Append(&packet, session->uid, uid_len);
+    DynBuf_AppendVarint(&packet, header_len);
+    DynBuf_Append(&packet, header_json, header_len);
+    DynBuf_Append(&packet, netlist->data, netlist->len);
+
+    if (DynBuf_Ok(&packet) && DynBuf_Ok(netlist)) send_to(session, packet.data, packet.len);
+    DynBuf_Free(&packet);
+}
+
+void NetUDP_SendRaw(Session* session, const char* json_data) {
+    send_packet(session, json_data);
+}
+
+void NetUDP_BeginBatch(void) {
+    NetReactor_BeginBatch();
+}
+
+void NetUDP_EndBatch(void) {
+    NetReactor_EndBatch();
 }
 
 int NetUDP_ExitRequested(void) {
     return exit_requested;
-}
\ No newline at end of file
+}
@@ -0,0 +1,852 @@
+/*
+ * File: net_ws.c
+ * Version: 1.2.0
+ * Description:
+ * Implements the WebSocket endpoint (see net_ws.h): the HTTP upgrade
+ * handshake, frame parsing and framing, and the per-client backlogs.
+ *
+ * One lock guards the client table and every client's socket and
+ * buffers. The reactor thread holds it while it accepts, reads and
+ * flushes; workers hold it while they send. Every socket call is
+ * non-blocking, so no one waits on it for long.
+ *
+ * Note: Version 1.1.0 holds each client to its session's broadcast
+ * rates. A rate-limited broadcast that is not due yet is kept as a
+ * ready frame: state and outputs packets latest-wins, heavy packets in
+ * order (a netlist delta needs the ones before it). NetWs_Poll sends
+ * them when their slot comes. Version 1.2.0 refuses handshakes from
+ * browser pages whose Origin is not allowed (403) and can bind the
+ * listener to one address.
+ */
+
+#define _GNU_SOURCE  // accept4, memmem
+#include "net_ws.h"
+#include "net_reactor.h"
+#include "net_session.h"
+#include "net_proto.h"
+#include "utils_timer.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"  // RFC 6455, section 1.3
+
+enum {
+    WS_OP_CONTINUATION = 0x0,
+    WS_OP_TEXT = 0x1,
+    WS_OP_BINARY = 0x2,
+    WS_OP_CLOSE = 0x8,
+    WS_OP_PING = 0x9,
+    WS_OP_PONG = 0xA
+};
+
+enum {
+    WS_CLOSE_NORMAL = 1000,
+    WS_CLOSE_PROTOCOL = 1002,
+    WS_CLOSE_TOO_BIG = 1009
+};
+
+enum {
+    WS_HELD_STATE,    // Latest state packet
+    WS_HELD_OUTPUTS,  // Latest outputs packet
+    WS_HELD_HEAVY,    // Results, netlists and combined updates, in order
+    WS_HELD_SLOTS
+};
+
+enum {
+    WS_CLASS_STATE,   // TOPIC_CLASS_STATE, limited by state_hz
+    WS_CLASS_HEAVY    // TOPIC_CLASS_HEAVY, limited by heavy_hz
+};
+
+typedef enum {
+    WS_FREE,
+    WS_HANDSHAKE,
+    WS_OPEN
+} WsState;
+
+/*
+ * Struct: WsClient
+ * ----------------
+ * in:      Received bytes not yet parsed.
+ * message: Payload of a fragmented message so far ('message_opcode'
+ *          is its first frame's opcode, 0 when none is in progress).
+ * out:     Backlog; the bytes before 'out_pos' are already sent.
+ * session: Held while the client is connected.
+ * held:    Broadcasts waiting for the client's next slot, as frames
+ *          (WS_HELD_*); 'held_count' messages each.
+ * last_ms: When each rate class (WS_CLASS_*) was last sent.
+ */
+typedef struct {
+    WsState state;
+    int fd;
+    char uid[SESSION_UID_MAX];
+    Session* session;
+    DynBuf in;
+    DynBuf message;
+    uint8_t message_opcode;
+    DynBuf out;
+    size_t out_pos;
+    DynBuf held[WS_HELD_SLOTS];
+    int held_count[WS_HELD_SLOTS];
+    long long last_ms[2];
+} WsClient;
+
+static WsClient clients[WS_MAX_CLIENTS];
+static pthread_mutex_t ws_lock = PTHREAD_MUTEX_INITIALIZER;
+static int listen_fd = -1;
+static int ws_port = 0;
+static char ws_address[INET_ADDRSTRLEN] = "";  // "" = every interface
+static char ws_origins[WS_MAX_ORIGINS] = "";
+static unsigned int next_client = 0;
+static long long accepted = 0, received = 0, sent = 0, dropped = 0, coalesced = 0;
+
+// --- Handshake Helpers ---
+
+/*
+ * Function: sha1
+ * --------------
+ * SHA-1 of 'len' bytes (only used for Sec-WebSocket-Accept).
+ */
+static void sha1(const uint8_t* data, size_t len, uint8_t digest[20]) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    uint64_t bits = (uint64_t)len * 8;
+    size_t total = ((len + 8) / 64 + 1) * 64;
+
+    for (size_t block = 0; block < total; block += 64) {
+        uint8_t chunk[64];
+        for (size_t i = 0; i < 64; i++) {
+            size_t pos = block + i;
+            if (pos < len) chunk[i] = data[pos];
+            else if (pos == len) chunk[i] = 0x80;
+            else if (pos >= total - 8) chunk[i] = (uint8_t)(bits >> (8 * (total - 1 - pos)));
+            else chunk[i] = 0;
+        }
+
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t)chunk[4 * i] << 24 | (uint32_t)chunk[4 * i + 1] << 16 |
+                   (uint32_t)chunk[4 * i + 2] << 8 | chunk[4 * i + 3];
+        }
+        for (int i = 16; i < 80; i++) {
+            uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = x << 1 | x >> 31;
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+            uint32_t t = (a << 5 | a >> 27) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = b << 30 | b >> 2;
+            b = a;
+            a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 20; i++) digest[i] = (uint8_t)(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+/*
+ * Function: base64
+ * ----------------
+ * Encodes 'len' bytes into 'out' (4 * ceil(len / 3) + 1 bytes).
+ */
+static void base64(const uint8_t* data, size_t len, char* out) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) v |= data[i + 2];
+        out[o++] = ALPHABET[v >> 18 & 63];
+        out[o++] = ALPHABET[v >> 12 & 63];
+        out[o++] = i + 1 < len ? ALPHABET[v >> 6 & 63] : '=';
+        out[o++] = i + 2 < len ? ALPHABET[v & 63] : '=';
+    }
+    out[o] = '\0';
+}
+
+/*
+ * Function: find_header
+ * ---------------------
+ * Copies the value of header 'name' from an HTTP request (lines end in
+ * "\r\n") into 'out', trimmed.
+ *
+ * returns: false if the header is missing or its value does not fit.
+ */
+static bool find_header(const char* request, const char* name, char* out, size_t size) {
+    size_t name_len = strlen(name);
+    for (const char* line = strstr(request, "\r\n"); line; line = strstr(line, "\r\n")) {
+        line += 2;
+        if (strncasecmp(line, name, name_len) != 0 || line[name_len] != ':') continue;
+        const char* value = line + name_len + 1;
+        value += strspn(value, " \t");
+        size_t len = strcspn(value, "\r\n");
+        while (len > 0 && (value[len - 1] == ' ' || value[len - 1] == '\t')) len--;
+        if (len >= size) return false;
+        memcpy(out, value, len);
+        out[len] = '\0';
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Function: origin_allowed
+ * ------------------------
+ * Checks an Origin header ("http://host:8088") against ws_origins. An
+ * entry with "://" must match the whole origin, any other entry only
+ * its host; "*" matches everything. Case never matters.
+ */
+static bool origin_allowed(const char* origin) {
+    const char* host = strstr(origin, "://");
+    if (!host) return false;  // "null" (file: pages, sandboxed frames) or garbage
+    host += 3;
+    size_t host_len = host[0] == '[' ? strcspn(host, "]") + 1 : strcspn(host, ":/");
+
+    for (const char* entry = ws_origins; *entry; ) {
+        size_t len = strcspn(entry, ",");
+        if ((len == 1 && entry[0] == '*') ||
+            (len == strlen(origin) && strncasecmp(entry, origin, len) == 0) ||
+            (len == host_len && !memmem(entry, len, "://", 3) && strncasecmp(entry, host, len) == 0)) {
+            return true;
+        }
+        entry += len;
+        if (*entry == ',') entry++;
+    }
+    return false;
+}
+
+// --- Sending (ws_lock held) ---
+
+/*
+ * Function: queue_bytes
+ * ---------------------
+ * Sends 'head' then 'body' to a client, straight to the socket when its
+ * backlog is empty, and keeps whatever the socket does not take.
+ *
+ * returns: false if the backlog is full (nothing was sent).
+ */
+static bool queue_bytes(WsClient* c, const void* head, size_t head_len, const void* body, size_t body_len) {
+    size_t total = head_len + body_len;
+    if (c->out.len - c->out_pos + total > WS_MAX_BACKLOG) return false;
+
+    size_t done = 0;
+    if (c->out_pos == c->out.len) {
+        struct iovec iov[2] = { { (void*)head, head_len }, { (void*)body, body_len } };
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = 2 };
+        ssize_t n = sendmsg(c->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) done = (size_t)n;
+        // On a hard error the reactor sees EPOLLERR/EPOLLHUP and closes the client
+    }
+    if (done == total) return true;
+
+    // Keep the rest behind what is already waiting
+    if (c->out_pos > 0) {
+        memmove(c->out.data, c->out.data + c->out_pos, c->out.len - c->out_pos);
+        c->out.len -= c->out_pos;
+        c->out_pos = 0;
+    }
+    if (done < head_len) DynBuf_Append(&c->out, (const char*)head + done, head_len - done);
+    size_t body_done = done > head_len ? done - head_len : 0;
+    DynBuf_Append(&c->out, (const char*)body + body_done, body_len - body_done);
+    if (!DynBuf_Ok(&c->out)) {
+        shutdown(c->fd, SHUT_RDWR);  // Part of a frame is lost: the stream is unusable
+        return false;
+    }
+    NetReactor_Watch(c->fd, EPOLLIN | EPOLLOUT, NULL, NULL);
+    return true;
+}
+
+/*
+ * Function: frame_head
+ * --------------------
+ * Writes the header of an unmasked, unfragmented frame.
+ *
+ * returns: Its length (at most 10 bytes).
+ */
+static size_t frame_head(uint8_t opcode, size_t len, uint8_t head[10]) {
+    size_t h = 0;
+    head[h++] = 0x80 | opcode;
+    if (len < 126) {
+        head[h++] = (uint8_t)len;
+    } else if (len <= 0xFFFF) {
+        head[h++] = 126;
+        head[h++] = (uint8_t)(len >> 8);
+        head[h++] = (uint8_t)len;
+    } else {
+        head[h++] = 127;
+        for (int i = 7; i >= 0; i--) head[h++] = (uint8_t)((uint64_t)len >> (8 * i));
+    }
+    return h;
+}
+
+/*
+ * Function: send_message
+ * ----------------------
+ * Sends one unmasked, unfragmented frame.
+ */
+static void send_message(WsClient* c, uint8_t opcode, const void* data, size_t len) {
+    uint8_t head[10];
+    size_t h = frame_head(opcode, len, head);
+    if (queue_bytes(c, head, h, data, len)) sent++;
+    else dropped++;
+}
+
+/*
+ * Function: class_due
+ * -------------------
+ * true if the client's rate lets it have a broadcast of class 'cls'
+ * (WS_CLASS_*) at 'now'.
+ */
+static bool class_due(WsClient* c, int cls, long long now) {
+    int state_hz, heavy_hz;
+    Session_GetRates(c->session, &state_hz, &heavy_hz);
+    return now - c->last_ms[cls] >= 1000 / (cls == WS_CLASS_STATE ? state_hz : heavy_hz);
+}
+
+/*
+ * Function: flush_held
+ * --------------------
+ * Sends the frames held in one slot.
+ */
+static void flush_held(WsClient* c, int slot) {
+    DynBuf* held = &c->held[slot];
+    if (held->len == 0) return;
+    if (queue_bytes(c, held->data, held->len, "", 0)) sent += c->held_count[slot];
+    else dropped += c->held_count[slot];
+    DynBuf_Reset(held);
+    c->held_count[slot] = 0;
+}
+
+/*
+ * Function: send_limited
+ * ----------------------
+ * Sends a broadcast of topic 'topic' (one of TOPIC_CLASS_STATE or
+ * TOPIC_CLASS_HEAVY) now if the client's rate allows and nothing of its
+ * class is waiting; otherwise holds it for NetWs_Poll.
+ */
+static void send_limited(WsClient* c, uint8_t opcode, const void* data, size_t len, uint32_t topic, long long now) {
+    int cls = (topic & TOPIC_CLASS_STATE) ? WS_CLASS_STATE : WS_CLASS_HEAVY;
+    int slot = cls == WS_CLASS_HEAVY ? WS_HELD_HEAVY : (topic & TOPIC_STATE) ? WS_HELD_STATE : WS_HELD_OUTPUTS;
+    bool waiting = cls == WS_CLASS_HEAVY ? c->held[WS_HELD_HEAVY].len > 0
+                                         : c->held[WS_HELD_STATE].len > 0 || c->held[WS_HELD_OUTPUTS].len > 0;
+    if (!waiting && class_due(c, cls, now)) {
+        c->last_ms[cls] = now;
+        send_message(c, opcode, data, len);
+        return;
+    }
+
+    DynBuf* held = &c->held[slot];
+    if (slot != WS_HELD_HEAVY && c->held_count[slot] > 0) {
+        // A state or outputs packet is a snapshot: only the latest matters
+        coalesced += c->held_count[slot];
+        DynBuf_Reset(held);
+        c->held_count[slot] = 0;
+    }
+    if (held->len + len + 10 > WS_MAX_BACKLOG) {
+        dropped++;
+        return;
+    }
+    uint8_t head[10];
+    size_t h = frame_head(opcode, len, head);
+    DynBuf_Append(held, head, h);
+    DynBuf_Append(held, data, len);
+    if (DynBuf_Ok(held)) {
+        c->held_count[slot]++;
+    } else {
+        dropped += c->held_count[slot] + 1;
+        DynBuf_Reset(held);
+        c->held_count[slot] = 0;
+    }
+}
+
+/*
+ * Function: send_close
+ * --------------------
+ * Sends a close frame with a status code.
+ */
+static void send_close(WsClient* c, int code) {
+    uint8_t payload[2] = { (uint8_t)(code >> 8), (uint8_t)code };
+    send_message(c, WS_OP_CLOSE, payload, sizeof(payload));
+}
+
+/*
+ * Function: flush_backlog
+ * -----------------------
+ * Sends what the socket takes of the backlog and stops watching for
+ * EPOLLOUT once it is empty.
+ */
+static void flush_backlog(WsClient* c) {
+    while (c->out_pos < c->out.len) {
+        ssize_t n = send(c->fd, c->out.data + c->out_pos, c->out.len - c->out_pos, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) c->out_pos += (size_t)n;
+        else if (n < 0 && errno == EINTR) continue;
+        else return;
+    }
+    DynBuf_Reset(&c->out);
+    c->out_pos = 0;
+    NetReactor_Watch(c->fd, EPOLLIN, NULL, NULL);
+}
+
+// --- Clients (ws_lock held) ---
+
+static void on_client(int fd, uint32_t events, void* ctx);
+
+static void close_client(WsClient* c) {
+    if (c->state == WS_FREE) return;
+    NetReactor_Unwatch(c->fd);
+    close(c->fd);
+    if (c->session) {
+        // Topics nobody receives any more are not computed, nor at its rate
+        Session_Subscribe(c->session, TOPIC_ALL, false);
+        Session_SetRates(c->session, 0, 0);
+        Session_Release(c->session);
+    }
+    DynBuf_Free(&c->in);
+    DynBuf_Free(&c->message);
+    DynBuf_Free(&c->out);
+    for (int i = 0; i < WS_HELD_SLOTS; i++) DynBuf_Free(&c->held[i]);
+    c->state = WS_FREE;
+    c->fd = -1;
+    c->session = NULL;
+}
+
+/*
+ * Function: consume
+ * -----------------
+ * Drops the first 'n' bytes of a buffer.
+ */
+static void consume(DynBuf* b, size_t n) {
+    memmove(b->data, b->data + n, b->len - n);
+    b->len -= n;
+    b->data[b->len] = '\0';
+}
+
+/*
+ * Function: handshake
+ * -------------------
+ * Answers the HTTP upgrade request once it is complete.
+ *
+ * Browsers always send Origin, so a page from a site not in
+ * ws_origins cannot drive the engine through its visitors (a 403).
+ * Clients that are not browsers send none and are let in.
+ *
+ * returns: false if the request is not a WebSocket upgrade (the client
+ *          got a 400), comes from another site (a 403) or no session
+ *          is free for it (a 503); the client must then be closed.
+ */
+static bool handshake(WsClient* c) {
+    char* end = memmem(c->in.data, c->in.len, "\r\n\r\n", 4);
+    if (!end) return c->in.len <= WS_MAX_HANDSHAKE;
+    end[2] = '\0';  // Headers end with the last "\r\n"
+
+    char key[64], upgrade[64], version[16];
+    bool ok = strncmp(c->in.data, "GET ", 4) == 0 &&
+              find_header(c->in.data, "Upgrade", upgrade, sizeof(upgrade)) && strcasecmp(upgrade, "websocket") == 0 &&
+              find_header(c->in.data, "Sec-WebSocket-Version", version, sizeof(version)) && strcmp(version, "13") == 0 &&
+              find_header(c->in.data, "Sec-WebSocket-Key", key, sizeof(key));
+    if (!ok) {
+        static const char BAD[] = "HTTP/1.1 400 Bad Request\r\nSec-WebSocket-Version: 13\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        queue_bytes(c, BAD, sizeof(BAD) - 1, "", 0);
+        return false;
+    }
+
+    char origin[256];
+    bool has_origin = find_header(c->in.data, "Origin", origin, sizeof(origin));
+    if ((has_origin && !origin_allowed(origin)) || (!has_origin && strcasestr(c->in.data, "\r\nOrigin:"))) {
+        static const char FORBIDDEN[] = "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        queue_bytes(c, FORBIDDEN, sizeof(FORBIDDEN) - 1, "", 0);
+        printf("[WS] Client %s refused: origin %s not allowed\n", c->uid, has_origin ? origin : "(too long)");
+        return false;
+    }
+
+    c->session = Session_Acquire(c->uid);
+    if (!c->session) {
+        static const char BUSY[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        queue_bytes(c, BUSY, sizeof(BUSY) - 1, "", 0);
+        printf("[WS] Client %s refused: too many sessions\n", c->uid);
+        return false;
+    }
+
+    char material[64 + sizeof(WS_GUID)];
+    snprintf(material, sizeof(material), "%s%s", key, WS_GUID);
+    uint8_t digest[20];
+    sha1((const uint8_t*)material, strlen(material), digest);
+    char accept_key[32];
+    base64(digest, sizeof(digest), accept_key);
+
+    char reply[256];
+    int n = snprintf(reply, sizeof(reply),
+                     "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: %s\r\n\r\n", accept_key);
+    queue_bytes(c, reply, (size_t)n, "", 0);
+
+    consume(&c->in, (size_t)(end + 4 - c->in.data));
+    c->state = WS_OPEN;
+    printf("[WS] Client %s connected\n", c->uid);
+    return true;
+}
+
+/*
+ * Function: deliver
+ * -----------------
+ * Queues a complete client message as a command of the client's session.
+ */
+static void deliver(WsClient* c, uint8_t opcode, const char* data, size_t len) {
+    DynBuf cmd;
+    DynBuf_Init(&cmd);
+    size_t uid_len = strlen(c->uid);
+    if (opcode == WS_OP_TEXT) {
+        DynBuf_Append(&cmd, c->uid, uid_len);
+        DynBuf_AppendChar(&cmd, '|');
+        DynBuf_Append(&cmd, data, len);
+    } else if (NetProto_IsFrame(data, len) && NET_PROTO_HEADER + (size_t)(uint8_t)data[3] <= len) {
+        // Same frame, addressed to this client's session
+        size_t skip = NET_PROTO_HEADER + (uint8_t)data[3];
+        DynBuf_Append(&cmd, data, 3);
+        DynBuf_AppendChar(&cmd, (char)uid_len);
+        DynBuf_Append(&cmd, c->uid, uid_len);
+        DynBuf_Append(&cmd, data + skip, len - skip);
+    } else {
+        dropped++;  // Binary messages must be command frames
+    }
+    if (DynBuf_Ok(&cmd)) {
+        received++;
+        NetReactor_Submit(cmd.data, cmd.len, NULL);
+    }
+    DynBuf_Free(&cmd);
+}
+
+/*
+ * Function: process_frames
+ * ------------------------
+ * Parses every complete frame in the input buffer.
+ *
+ * returns: false if the client must be closed.
+ */
+static bool process_frames(WsClient* c) {
+    for (;;) {
+        const uint8_t* p = (const uint8_t*)c->in.data;
+        size_t avail = c->in.len;
+        if (avail < 2) return true;
+
+        bool fin = p[0] & 0x80;
+        uint8_t opcode = p[0] & 0x0F;
+        uint64_t len = p[1] & 0x7F;
+        size_t h = 2;
+        if (len == 126) {
+            if (avail < 4) return true;
+            len = (uint64_t)p[2] << 8 | p[3];
+            h = 4;
+        } else if (len == 127) {
+            if (avail < 10) return true;
+            len = 0;
+            for (int i = 0; i < 8; i++) len = len << 8 | p[2 + i];
+            h = 10;
+        }
+        bool control = opcode & 0x8;
+        if (!(p[1] & 0x80) || (p[0] & 0x70) || (control && (!fin || len > 125))) {
+            send_close(c, WS_CLOSE_PROTOCOL);  // Unmasked, extension bits, or a bad control frame
+            return false;
+        }
+        if (len > WS_MAX_MESSAGE) {
+            send_close(c, WS_CLOSE_TOO_BIG);
+            return false;
+        }
+        if (avail < h + 4 + len) return true;
+
+        char* payload = c->in.data + h + 4;
+        const uint8_t* mask = p + h;
+        for (uint64_t i = 0; i < len; i++) payload[i] ^= (char)mask[i & 3];
+
+        switch (opcode) {
+            case WS_OP_CLOSE:
+                send_message(c, WS_OP_CLOSE, payload, len >= 2 ? 2 : 0);  // Echo the status
+                return false;
+            case WS_OP_PING:
+                send_message(c, WS_OP_PONG, payload, (size_t)len);
+                break;
+            case WS_OP_PONG:
+                break;
+            case WS_OP_TEXT:
+            case WS_OP_BINARY:
+            case WS_OP_CONTINUATION:
+                if ((opcode == WS_OP_CONTINUATION) != (c->message_opcode != 0)) {
+                    send_close(c, WS_CLOSE_PROTOCOL);  // Continuation without a start, or a start mid-message
+                    return false;
+                }
+                if (opcode != WS_OP_CONTINUATION) c->message_opcode = opcode;
+                if (c->message.len + len > WS_MAX_MESSAGE) {
+                    send_close(c, WS_CLOSE_TOO_BIG);
+                    return false;
+                }
+                if (fin && c->message.len == 0) {
+                    deliver(c, c->message_opcode, payload, (size_t)len);  // Unfragmented: no copy
+                } else {
+                    DynBuf_Append(&c->message, payload, (size_t)len);
+                    if (fin) deliver(c, c->message_opcode, c->message.data, c->message.len);
+                }
+                if (fin) {
+                    DynBuf_Reset(&c->message);
+                    c->message_opcode = 0;
+                }
+                break;
+            default:
+                send_close(c, WS_CLOSE_PROTOCOL);
+                return false;
+        }
+        consume(&c->in, h + 4 + (size_t)len);
+    }
+}
+
+/*
+ * Function: read_client
+ * ---------------------
+ * Reads what the socket holds and handles it.
+ *
+ * returns: false if the client must be closed.
+ */
+static bool read_client(WsClient* c) {
+    char buffer[16384];
+    for (;;) {
+        ssize_t n = recv(c->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        DynBuf_Append(&c->in, buffer, (size_t)n);
+        if (!DynBuf_Ok(&c->in)) return false;
+        if (c->state == WS_HANDSHAKE && !handshake(c)) return false;
+        if (c->state == WS_OPEN && !process_frames(c)) return false;
+    }
+}
+
+static void on_client(int fd, uint32_t events, void* ctx) {
+    WsClient* c = ctx;
+    pthread_mutex_lock(&ws_lock);
+    if (c->state != WS_FREE && c->fd == fd) {
+        bool keep = true;
+        if (events & EPOLLOUT) flush_backlog(c);
+        if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) keep = read_client(c);
+        if (!keep) {
+            flush_backlog(c);  // Best effort for a final close frame or 400
+            printf("[WS] Client %s disconnected\n", c->uid);
+            close_client(c);
+        }
+    }
+    pthread_mutex_unlock(&ws_lock);
+}
+
+static void on_listen(int fd, uint32_t events, void* ctx) {
+    (void)events;
+    (void)ctx;
+    pthread_mutex_lock(&ws_lock);
+    for (;;) {
+        int conn = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (conn < 0) break;
+
+        WsClient* c = NULL;
+        for (int i = 0; i < WS_MAX_CLIENTS && !c; i++) {
+            if (clients[i].state == WS_FREE) c = &clients[i];
+        }
+        if (!c) {
+            close(conn);  // Full
+            continue;
+        }
+        int one = 1;
+        setsockopt(conn, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // Live values must not wait for Nagle
+
+        memset(c, 0, sizeof(*c));
+        c->fd = conn;
+        c->state = WS_HANDSHAKE;
+        snprintf(c->uid, sizeof(c->uid), WS_UID_PREFIX "%u", next_client++);
+        DynBuf_Init(&c->in);
+        DynBuf_Init(&c->message);
+        DynBuf_Init(&c->out);
+        for (int i = 0; i < WS_HELD_SLOTS; i++) DynBuf_Init(&c->held[i]);
+        if (!NetReactor_Watch(conn, EPOLLIN, on_client, c)) {
+            close(conn);
+            c->state = WS_FREE;
+            continue;
+        }
+        accepted++;
+    }
+    pthread_mutex_unlock(&ws_lock);
+}
+
+// --- Public API ---
+
+bool NetWs_Start(const char* address, int port, const char* origins) {
+    NetWs_Stop();
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons((uint16_t)port);
+    if (address && address[0] && inet_pton(AF_INET, address, &addr.sin_addr) != 1) return false;
+    if (strlen(origins) >= sizeof(ws_origins)) return false;
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (bind(fd, (const struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, WS_MAX_CLIENTS) < 0) {
+        perror("[WS] Listen failed");
+        close(fd);
+        return false;
+    }
+
+    pthread_mutex_lock(&ws_lock);
+    listen_fd = fd;
+    ws_port = port;
+    snprintf(ws_address, sizeof(ws_address), "%s", address ? address : "");
+    snprintf(ws_origins, sizeof(ws_origins), "%s", origins);
+    bool ok = NetReactor_Watch(fd, EPOLLIN, on_listen, NULL);
+    pthread_mutex_unlock(&ws_lock);
+    if (!ok) {
+        NetWs_Stop();
+        return false;
+    }
+    printf("[WS] Listening on %s:%d (origins %s)\n", ws_address[0] ? ws_address : "*", port, origins);
+    return true;
+}
+
+void NetWs_Stop(void) {
+    pthread_mutex_lock(&ws_lock);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].state == WS_OPEN) send_close(&clients[i], WS_CLOSE_NORMAL);
+        close_client(&clients[i]);
+    }
+    if (listen_fd >= 0) {
+        NetReactor_Unwatch(listen_fd);
+        close(listen_fd);
+    }
+    listen_fd = -1;
+    ws_port = 0;
+    ws_address[0] = '\0';
+    ws_origins[0] = '\0';
+    pthread_mutex_unlock(&ws_lock);
+}
+
+bool NetWs_IsClient(const char* uid) {
+    return strncmp(uid, WS_UID_PREFIX, sizeof(WS_UID_PREFIX) - 1) == 0;
+}
+
+void NetWs_Send(const char* uid, const void* data, size_t len) {
+    uint8_t opcode = len > 0 && ((const char*)data)[0] == '{' ? WS_OP_TEXT : WS_OP_BINARY;
+    pthread_mutex_lock(&ws_lock);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClient* c = &clients[i];
+        if (c->state == WS_OPEN && strcmp(c->uid, uid) == 0) {
+            send_message(c, opcode, data, len);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ws_lock);
+}
+
+void NetWs_Broadcast(const void* data, size_t len, uint32_t topics, const char* except_uid) {
+    uint8_t opcode = len > 0 && ((const char*)data)[0] == '{' ? WS_OP_TEXT : WS_OP_BINARY;
+    bool limited = (topics & (TOPIC_CLASS_STATE | TOPIC_CLASS_HEAVY)) != 0;
+    long long now = Timer_GetMillis();
+    pthread_mutex_lock(&ws_lock);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClient* c = &clients[i];
+        if (c->state != WS_OPEN || (except_uid && strcmp(c->uid, except_uid) == 0)) continue;
+        if (topics) {
+            pthread_mutex_lock(&c->session->lock);
+            bool wanted = (c->session->subscriptions & topics) != 0;
+            pthread_mutex_unlock(&c->session->lock);
+            if (!wanted) continue;
+        }
+        if (limited) send_limited(c, opcode, data, len, topics, now);
+        else send_message(c, opcode, data, len);
+    }
+    pthread_mutex_unlock(&ws_lock);
+}
+
+void NetWs_Poll(void) {
+    long long now = Timer_GetMillis();
+    pthread_mutex_lock(&ws_lock);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClient* c = &clients[i];
+        if (c->state != WS_OPEN) continue;
+        if ((c->held[WS_HELD_STATE].len > 0 || c->held[WS_HELD_OUTPUTS].len > 0) && class_due(c, WS_CLASS_STATE, now)) {
+            c->last_ms[WS_CLASS_STATE] = now;
+            flush_held(c, WS_HELD_STATE);
+            flush_held(c, WS_HELD_OUTPUTS);
+        }
+        if (c->held[WS_HELD_HEAVY].len > 0 && class_due(c, WS_CLASS_HEAVY, now)) {
+            c->last_ms[WS_CLASS_HEAVY] = now;
+            flush_held(c, WS_HELD_HEAVY);
+        }
+    }
+    pthread_mutex_unlock(&ws_lock);
+}
+
+long long NetWs_NextDue(void) {
+    long long due = -1;
+    pthread_mutex_lock(&ws_lock);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClient* c = &clients[i];
+        if (c->state != WS_OPEN) continue;
+        int state_hz, heavy_hz;
+        Session_GetRates(c->session, &state_hz, &heavy_hz);
+        if (c->held[WS_HELD_STATE].len > 0 || c->held[WS_HELD_OUTPUTS].len > 0) {
+            long long t = c->last_ms[WS_CLASS_STATE] + 1000 / state_hz;
+            if (due < 0 || t < due) due = t;
+        }
+        if (c->held[WS_HELD_HEAVY].len > 0) {
+            long long t = c->last_ms[WS_CLASS_HEAVY] + 1000 / heavy_hz;
+            if (due < 0 || t < due) due = t;
+        }
+    }
+    pthread_mutex_unlock(&ws_lock);
+    return due;
+}
+
+void NetWs_WriteReport(DynBuf* out) {
+    pthread_mutex_lock(&ws_lock);
+    int open = 0;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].state == WS_OPEN) open++;
+    }
+    DynBuf_AppendStr(out, "{ \"type\": \"websocket\", \"port\": ");
+    DynBuf_AppendInt(out, ws_port);
+    DynBuf_AppendStr(out, ", \"address\": ");
+    DynBuf_AppendJsonString(out, ws_address);
+    DynBuf_AppendStr(out, ", \"origins\": ");
+    DynBuf_AppendJsonString(out, ws_origins);
+    DynBuf_AppendStr(out, ", \"clients\": ");
+    DynBuf_AppendInt(out, open);
+    DynBuf_AppendStr(out, ", \"accepted\": ");
+    DynBuf_AppendInt(out, accepted);
+    DynBuf_AppendStr(out, ", \"received\": ");
+    DynBuf_AppendInt(out, received);
+    DynBuf_AppendStr(out, ", \"sent\": ");
+    DynBuf_AppendInt(out, sent);
+    DynBuf_AppendStr(out, ", \"dropped\": ");
+    DynBuf_AppendInt(out, dropped);
+    DynBuf_AppendStr(out, ", \"coalesced\": ");
+    DynBuf_AppendInt(out, coalesced);
+    DynBuf_AppendStr(out, " }");
+    pthread_mutex_unlock(&ws_lock);
+}
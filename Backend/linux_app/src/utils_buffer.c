@@ -0,0 +1,158 @@
+/*
+ * File: utils_buffer.c
+ * Version: 1.0.0
+ * Description:
+ * Implements the growable DynBuf and its JSON helpers.
+ * The buffer doubles its capacity on demand, so building a packet costs
+ * amortized O(1) per byte and never needs a worst-case size up front.
+ */
+
+#include "utils_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define DYNBUF_MIN_CAP 256
+
+void DynBuf_Init(DynBuf* b) {
+    b->data = NULL;
+    b->len = 0;
+    b->cap = 0;
+    b->failed = false;
+}
+
+void DynBuf_Free(DynBuf* b) {
+    free(b->data);
+    DynBuf_Init(b);
+}
+
+void DynBuf_Reset(DynBuf* b) {
+    b->len = 0;
+    b->failed = false;
+    if (b->data) b->data[0] = '\0';
+}
+
+bool DynBuf_Reserve(DynBuf* b, size_t extra) {
+    if (b->failed) return false;
+
+    size_t need = b->len + extra + 1; // +1 keeps room for the terminator
+    if (need <= b->cap) return true;
+
+    size_t new_cap = b->cap ? b->cap : DYNBUF_MIN_CAP;
+    while (new_cap < need) new_cap *= 2;
+
+    char* grown = realloc(b->data, new_cap);
+    if (!grown) {
+        b->failed = true;
+        return false;
+    }
+    b->data = grown;
+    b->cap = new_cap;
+    return true;
+}
+
+bool DynBuf_Ok(const DynBuf* b) {
+    return !b->failed && b->data != NULL;
+}
+
+void DynBuf_Append(DynBuf* b, const void* data, size_t n) {
+    if (!DynBuf_Reserve(b, n)) return;
+    memcpy(b->data + b->len, data, n);
+    b->len += n;
+    b->data[b->len] = '\0';
+}
+
+void DynBuf_AppendStr(DynBuf* b, const char* str) {
+    if (str) DynBuf_Append(b, str, strlen(str));
+}
+
+void DynBuf_AppendChar(DynBuf* b, char c) {
+    if (!DynBuf_Reserve(b, 1)) return;
+    b->data[b->len++] = c;
+    b->data[b->len] = '\0';
+}
+
+void DynBuf_AppendUInt(DynBuf* b, unsigned long long value) {
+    // Digits are produced in reverse into a scratch array, then copied.
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value);
+
+    if (!DynBuf_Reserve(b, n)) return;
+    while (n > 0) b->data[b->len++] = digits[--n];
+    b->data[b->len] = '\0';
+}
+
+void DynBuf_AppendInt(DynBuf* b, long long value) {
+    if (value < 0) {
+        DynBuf_AppendChar(b, '-');
+        // Negate in unsigned space so LLONG_MIN is handled correctly
+        DynBuf_AppendUInt(b, 0ULL - (unsigned long long)value);
+    } else {
+        DynBuf_AppendUInt(b, (unsigned long long)value);
+    }
+}
+
+void DynBuf_AppendVarint(DynBuf* b, unsigned long long value) {
+    unsigned char bytes[10];
+    int n = 0;
+    do {
+        unsigned char byte = value & 0x7F;
+        value >>= 7;
+        if (value) byte |= 0x80;
+        bytes[n++] = byte;
+    } while (value);
+    DynBuf_Append(b, bytes, (size_t)n);
+}
+
+void DynBuf_TrimChar(DynBuf* b, char c) {
+    if (b->len > 0 && b->data[b->len - 1] == c) {
+        b->data[--b->len] = '\0';
+    }
+}
+
+void DynBuf_AppendJsonString(DynBuf* b, const char* str) {
+    static const char HEX[] = "0123456789abcdef";
+
+    DynBuf_AppendChar(b, '"');
+    if (str) {
+        const char* run = str; // Start of the current unescaped run
+        for (const char* p = str; *p; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c != '"' && c != '\\' && c >= 0x20) continue;
+
+            DynBuf_Append(b, run, (size_t)(p - run));
+            switch (c) {
+                case '"':  DynBuf_Append(b, "\\\"", 2); break;
+                case '\\': DynBuf_Append(b, "\\\\", 2); break;
+                case '\n': DynBuf_Append(b, "\\n", 2); break;
+                case '\r': DynBuf_Append(b, "\\r", 2); break;
+                case '\t': DynBuf_Append(b, "\\t", 2); break;
+                default: {
+                    char esc[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF] };
+                    DynBuf_Append(b, esc, sizeof(esc));
+                    break;
+                }
+            }
+            run = p + 1;
+        }
+        DynBuf_AppendStr(b, run);
+    }
+    DynBuf_AppendChar(b, '"');
+}
+
+void DynBuf_AppendJsonBool(DynBuf* b, bool value) {
+    if (value) DynBuf_Append(b, "true", 4);
+    else       DynBuf_Append(b, "false", 5);
+}
+
+void DynBuf_AppendJsonIntArray(DynBuf* b, const int* values, int count) {
+    DynBuf_AppendChar(b, '[');
+    for (int i = 0; i < count; i++) {
+        if (i > 0) DynBuf_AppendChar(b, ',');
+        DynBuf_AppendInt(b, values[i]);
+    }
+    DynBuf_AppendChar(b, ']');
+}
@@ -0,0 +1,165 @@
+/*
+ * File: utils_lz4.c
+ * Version: 1.0.0
+ * Description:
+ * Implements the LZ4 block compressor and decompressor (see utils_lz4.h).
+ * The end-of-block rules of the format are kept: the last 5 bytes are
+ * always literals and no match starts in the last 12 bytes, so the
+ * output is valid for every LZ4 decoder, not just this one.
+ */
+
+#include "utils_lz4.h"
+#include <string.h>
+
+#define LZ4_MIN_MATCH     4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MF_LIMIT      12
+#define LZ4_MAX_OFFSET    65535
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t hash_sequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ4_HASH_LOG);
+}
+
+/*
+ * Function: write_length
+ * ----------------------
+ * Writes the part of a length beyond the token's 15 as 255-bytes and a
+ * remainder.
+ */
+static uint8_t* write_length(uint8_t* op, size_t extra) {
+    while (extra >= 255) {
+        *op++ = 255;
+        extra -= 255;
+    }
+    *op++ = (uint8_t)extra;
+    return op;
+}
+
+/*
+ * Function: write_sequence
+ * ------------------------
+ * Writes one sequence: 'literals' bytes from 'anchor', then a match of
+ * 'match_len' bytes 'offset' back (match_len 0: the final, literal-only
+ * sequence).
+ */
+static uint8_t* write_sequence(uint8_t* op, const uint8_t* anchor, size_t literals, size_t offset, size_t match_len) {
+    uint8_t* token = op++;
+    *token = (uint8_t)((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) op = write_length(op, literals - 15);
+    memcpy(op, anchor, literals);
+    op += literals;
+    if (match_len == 0) return op;
+
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+    size_t code = match_len - LZ4_MIN_MATCH;
+    *token |= (uint8_t)(code < 15 ? code : 15);
+    if (code >= 15) op = write_length(op, code - 15);
+    return op;
+}
+
+size_t Lz4_Bound(size_t len) {
+    return len + len / 255 + 16;
+}
+
+bool Lz4_Compress(Lz4Context* ctx, const void* src, size_t len, DynBuf* out) {
+    if (!DynBuf_Reserve(out, Lz4_Bound(len))) return false;
+    const uint8_t* in = src;
+    uint8_t* op = (uint8_t*)out->data + out->len;
+    uint8_t* start = op;
+    size_t anchor = 0;
+
+    if (len > LZ4_MF_LIMIT) {
+        memset(ctx->table, 0, sizeof(ctx->table));
+        size_t match_limit = len - LZ4_MF_LIMIT;   // Last position a match may start at
+        size_t extend_limit = len - LZ4_LAST_LITERALS;
+        size_t pos = 0;
+        while (pos < match_limit) {
+            uint32_t sequence = read32(in + pos);
+            uint32_t h = hash_sequence(sequence);
+            size_t candidate = ctx->table[h];
+            ctx->table[h] = (uint32_t)pos;
+            if (candidate >= pos || pos - candidate > LZ4_MAX_OFFSET || read32(in + candidate) != sequence) {
+                pos += 1 + ((pos - anchor) >> 6);  // Skip faster through data that does not compress
+                continue;
+            }
+
+            // Grow the match backwards into the pending literals, then forwards
+            while (pos > anchor && candidate > 0 && in[pos - 1] == in[candidate - 1]) {
+                pos--;
+                candidate--;
+            }
+            size_t match_len = LZ4_MIN_MATCH;
+            while (pos + match_len < extend_limit && in[pos + match_len] == in[candidate + match_len]) match_len++;
+
+            op = write_sequence(op, in + anchor, pos - anchor, pos - candidate, match_len);
+            pos += match_len;
+            anchor = pos;
+            if (pos - 2 < match_limit) ctx->table[hash_sequence(read32(in + pos - 2))] = (uint32_t)(pos - 2);
+        }
+    }
+    op = write_sequence(op, in + anchor, len - anchor, 0, 0);
+
+    out->len += (size_t)(op - start);
+    out->data[out->len] = '\0';
+    return true;
+}
+
+bool Lz4_Decompress(const void* src, size_t len, void* dst, size_t dst_len) {
+    const uint8_t* ip = src;
+    const uint8_t* ip_end = ip + len;
+    uint8_t* op = dst;
+    uint8_t* op_end = op + dst_len;
+
+    while (ip < ip_end) {
+        uint8_t token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            uint8_t b;
+            do {
+                if (ip >= ip_end) return false;
+                b = *ip++;
+                literals += b;
+            } while (b == 255);
+        }
+        if (literals > (size_t)(ip_end - ip) || literals > (size_t)(op_end - op)) return false;
+        memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == ip_end) break;  // The last sequence has no match
+
+        if (ip_end - ip < 2) return false;
+        size_t offset = (size_t)ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - (uint8_t*)dst)) return false;
+
+        size_t match_len = token & 15;
+        if (match_len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= ip_end) return false;
+                b = *ip++;
+                match_len += b;
+            } while (b == 255);
+        }
+        match_len += LZ4_MIN_MATCH;
+        if (match_len > (size_t)(op_end - op)) return false;
+
+        // Matches may overlap their own output (runs), so copy forwards
+        const uint8_t* match = op - offset;
+        if (offset >= match_len) {
+            memcpy(op, match, match_len);
+            op += match_len;
+        } else {
+            for (size_t i = 0; i < match_len; i++) *op++ = match[i];
+        }
+    }
+    return op == op_end;
+}
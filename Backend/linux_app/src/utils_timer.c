@@ -1,6 +1,6 @@
 /*
  * File: utils_timer.c
- * Version: 1.1.0
+ * Version: 1.2.0
  * Description:
  * Implements high-resolution timekeeping functions for Linux.
  * Uses the POSIX `CLOCK_REALTIME` to provide millisecond-precision
@@ -59,6 +59,18 @@ bool Timer_HasElapsed(long long start_ts, int duration_ms) {
     return (Timer_GetMillis() - start_ts) >= duration_ms;
 }
 
+/*
+ * Function: Timer_GetNanos
+ * ------------------------
+ * Monotonic timestamp for benchmarking. Unlike the millisecond clock this
+ * is unaffected by wall-clock adjustments.
+ */
+long long Timer_GetNanos(void) {
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return (long long)spec.tv_sec * 1000000000LL + spec.tv_nsec;
+}
+
 void Timer_SleepMs(int ms) {
     struct timespec req;
     req.tv_sec = ms / 1000;
@@ -0,0 +1,166 @@
+/*
+ * File: utils_trace.c
+ * Version: 1.0.0
+ * Description:
+ * Implements the streaming waveform writer (see utils_trace.h).
+ */
+
+#include "utils_trace.h"
+#include <string.h>
+
+static const char* TIMESCALE_UNITS[] = { "s", "ms", "us", "ns", "ps", "fs" };
+
+static void open_common(TraceWriter* w, TraceFormat format, int timescale) {
+    memset(w, 0, sizeof(*w));
+    w->format = format;
+    if (timescale > 0) timescale = 0;
+    if (timescale < -15) timescale = -15;
+    w->timescale = timescale;
+    DynBuf_Init(&w->buf);
+}
+
+bool TraceWriter_OpenFile(TraceWriter* w, TraceFormat format, int timescale, const char* path) {
+    open_common(w, format, timescale);
+    w->file = fopen(path, "wb");
+    w->chunk = TRACE_FILE_CHUNK;
+    return w->file != NULL;
+}
+
+void TraceWriter_OpenSink(TraceWriter* w, TraceFormat format, int timescale, size_t chunk,
+                          TraceSink sink, void* ctx) {
+    open_common(w, format, timescale);
+    w->sink = sink;
+    w->ctx = ctx;
+    w->chunk = chunk;
+}
+
+int TraceWriter_AddSignal(TraceWriter* w, const char* name) {
+    if (w->started || w->signal_count == TRACE_MAX_SIGNALS) return -1;
+    strncpy(w->names[w->signal_count], name, TRACE_NAME_MAX - 1);
+    return w->signal_count++;
+}
+
+void TraceWriter_Flush(TraceWriter* w) {
+    if (w->buf.len == 0) return;
+    if (!DynBuf_Ok(&w->buf)) {
+        w->failed = true;
+    } else if (w->file) {
+        if (fwrite(w->buf.data, 1, w->buf.len, w->file) != w->buf.len) w->failed = true;
+    } else if (w->sink) {
+        w->sink(w->buf.data, w->buf.len, w->ctx);
+    }
+    w->bytes += (long long)w->buf.len;
+    DynBuf_Reset(&w->buf);
+}
+
+/*
+ * Function: vcd_id
+ * ----------------
+ * VCD identifier code of a signal: one printable character.
+ */
+static char vcd_id(int signal) {
+    return (char)('!' + signal);
+}
+
+static void write_header(TraceWriter* w) {
+    DynBuf* b = &w->buf;
+    if (w->format == TRACE_BINARY) {
+        DynBuf_Append(b, "LSWT", 4);
+        DynBuf_AppendChar(b, 1);
+        DynBuf_AppendChar(b, (char)(int8_t)w->timescale);
+        DynBuf_AppendChar(b, (char)w->signal_count);
+        for (int i = 0; i < w->signal_count; i++) DynBuf_Append(b, w->names[i], strlen(w->names[i]) + 1);
+        return;
+    }
+
+    // Timescale: 1, 10 or 100 of the unit at or below 10^timescale
+    static const char* MAGNITUDES[] = { "1", "10", "100" };
+    int unit = (-w->timescale + 2) / 3;
+    DynBuf_AppendStr(b, "$version logic_sim $end\n$timescale ");
+    DynBuf_AppendStr(b, MAGNITUDES[w->timescale + 3 * unit]);
+    DynBuf_AppendStr(b, TIMESCALE_UNITS[unit]);
+    DynBuf_AppendStr(b, " $end\n$scope module logic_sim $end\n");
+    for (int i = 0; i < w->signal_count; i++) {
+        DynBuf_AppendStr(b, "$var wire 1 ");
+        DynBuf_AppendChar(b, vcd_id(i));
+        DynBuf_AppendChar(b, ' ');
+        DynBuf_AppendStr(b, w->names[i]);
+        DynBuf_AppendStr(b, " $end\n");
+    }
+    DynBuf_AppendStr(b, "$upscope $end\n$enddefinitions $end\n");
+}
+
+/*
+ * Function: write_changes
+ * -----------------------
+ * Writes the signals in 'changed' with their values from 'values'.
+ */
+static void write_changes(TraceWriter* w, uint64_t time, uint64_t changed, uint64_t values) {
+    DynBuf* b = &w->buf;
+    if (w->format == TRACE_BINARY) {
+        uint64_t delta = time - w->time;
+        for (; changed; changed &= changed - 1) {
+            int i = __builtin_ctzll(changed);
+            DynBuf_AppendVarint(b, (delta << 7) | ((uint64_t)i << 1) | ((values >> i) & 1));
+            delta = 0;
+            w->changes++;
+        }
+    } else {
+        if (!w->time_written || time != w->time) {
+            DynBuf_AppendChar(b, '#');
+            DynBuf_AppendUInt(b, time);
+            DynBuf_AppendChar(b, '\n');
+            w->time_written = true;
+        }
+        for (; changed; changed &= changed - 1) {
+            int i = __builtin_ctzll(changed);
+            DynBuf_AppendChar(b, ((values >> i) & 1) ? '1' : '0');
+            DynBuf_AppendChar(b, vcd_id(i));
+            DynBuf_AppendChar(b, '\n');
+            w->changes++;
+        }
+    }
+    w->time = time;
+    w->values = values;
+    if (w->buf.len >= w->chunk) TraceWriter_Flush(w);
+}
+
+void TraceWriter_Sample(TraceWriter* w, uint64_t time, uint64_t values) {
+    uint64_t all = w->signal_count == 64 ? ~0ULL : (1ULL << w->signal_count) - 1;
+    values &= all;
+    if (time < w->time) time = w->time;
+
+    if (!w->started) {
+        write_header(w);
+        w->started = true;
+        if (w->format == TRACE_VCD) {
+            DynBuf_AppendChar(&w->buf, '#');
+            DynBuf_AppendUInt(&w->buf, time);
+            DynBuf_AppendStr(&w->buf, "\n$dumpvars\n");
+            w->time_written = true;
+            w->time = time;
+            write_changes(w, time, all, values);
+            DynBuf_AppendStr(&w->buf, "$end\n");
+        } else {
+            write_changes(w, time, all, values);
+        }
+        return;
+    }
+    uint64_t changed = values ^ w->values;
+    if (changed) write_changes(w, time, changed, values);
+}
+
+void TraceWriter_Change(TraceWriter* w, uint64_t time, int signal, bool value) {
+    if (signal < 0 || signal >= w->signal_count) return;
+    uint64_t bit = 1ULL << signal;
+    TraceWriter_Sample(w, time, value ? (w->values | bit) : (w->values & ~bit));
+}
+
+bool TraceWriter_Close(TraceWriter* w) {
+    if (!w->started && w->signal_count > 0) TraceWriter_Sample(w, 0, 0);
+    TraceWriter_Flush(w);
+    if (w->file && fclose(w->file) != 0) w->failed = true;
+    w->file = NULL;
+    DynBuf_Free(&w->buf);
+    return !w->failed;
+}
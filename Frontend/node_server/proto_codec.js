@@ -0,0 +1,136 @@
+/**
+ * ============================================================================
+ * File: proto_codec.js
+ * Version: 1.0.0
+ * Description:
+ * Binary command/response frames shared with the C app (see net_proto.h
+ * for the layout, opcodes and tags). The bridge encodes the browsers'
+ * high-rate commands as frames and turns reply frames back into the
+ * JSON objects the browser already understands.
+ * ============================================================================
+ */
+
+const MAGIC = 0xB2;
+const VERSION = 1;
+
+const OP = {
+    TEXT: 0, SET_INPUT: 1, PROGRAM: 2, PREVIEW: 3, KMAP: 4, ACK: 5, NETSYNC: 6, PROTO: 7, PING: 8,
+    RESULT: 0x80, STATUS: 0x81, PONG: 0x82, ERROR: 0x83,
+};
+
+const TAG = {
+    TEXT: 1, TARGET: 2, MASK: 3, MINTERMS: 4, VERSION: 5, MODE: 6, MODE_NAME: 7, SOP: 8, POS: 9, NONCE: 10,
+};
+
+function varint(value) {
+    const bytes = [];
+    do {
+        let byte = value % 128;
+        value = Math.floor(value / 128);
+        if (value) byte |= 0x80;
+        bytes.push(byte);
+    } while (value);
+    return Buffer.from(bytes);
+}
+
+function readVarint(buf, pos) {
+    let value = 0;
+    let scale = 1;
+    while (pos < buf.length) {
+        const byte = buf[pos++];
+        value += (byte & 0x7F) * scale;
+        if (!(byte & 0x80)) return { value, pos };
+        scale *= 128;
+    }
+    throw new Error('truncated varint');
+}
+
+function tlv(tag, value) {
+    return Buffer.concat([Buffer.from([tag]), varint(value.length), value]);
+}
+
+function frame(opcode, uid, fields) {
+    const uidBytes = Buffer.from(uid);
+    return Buffer.concat([Buffer.from([MAGIC, VERSION, opcode, uidBytes.length]), uidBytes, ...fields]);
+}
+
+/** 8-byte little-endian minterm mask from a CSV list, or null if a term is out of range. */
+function mintermMask(csv) {
+    const mask = Buffer.alloc(8);
+    for (const term of csv.split(',')) {
+        const m = parseInt(term, 10);
+        if (!(m >= 0 && m < 64)) return null;
+        mask[m >> 3] |= 1 << (m & 7);
+    }
+    return mask;
+}
+
+/**
+ * Encodes a text command for session 'uid' as a frame: the commands sent
+ * at high rates get their own opcode, everything else travels as TEXT.
+ */
+function encodeCommand(uid, command) {
+    let m;
+    if ((m = /^set_input (\d+)$/.exec(command))) {
+        return frame(OP.SET_INPUT, uid, [tlv(TAG.MASK, varint(Number(m[1]) & 0xFF))]);
+    }
+    if ((m = /^(program|preview) ([xyzw]) (.*)$/.exec(command))) {
+        const op = m[1] === 'program' ? OP.PROGRAM : OP.PREVIEW;
+        return frame(op, uid, [tlv(TAG.TARGET, Buffer.from(m[2])), tlv(TAG.TEXT, Buffer.from(m[3]))]);
+    }
+    if ((m = /^kmap ([xyzw]) ([\d, ]+)$/.exec(command))) {
+        const mask = mintermMask(m[2]);
+        if (mask) return frame(OP.KMAP, uid, [tlv(TAG.TARGET, Buffer.from(m[1])), tlv(TAG.MINTERMS, mask)]);
+    }
+    if ((m = /^(ack|netsync) (\d+)$/.exec(command))) {
+        const op = m[1] === 'ack' ? OP.ACK : OP.NETSYNC;
+        return frame(op, uid, [tlv(TAG.VERSION, varint(Number(m[2])))]);
+    }
+    if ((m = /^proto (json|binary)$/.exec(command))) {
+        return frame(OP.PROTO, uid, [tlv(TAG.MODE, varint(m[1] === 'binary' ? 1 : 0))]);
+    }
+    return frame(OP.TEXT, uid, [tlv(TAG.TEXT, Buffer.from(command))]);
+}
+
+function isFrame(buf) {
+    return buf.length >= 4 && buf[0] === MAGIC;
+}
+
+/**
+ * Decodes a reply frame into the JSON object the text protocol would
+ * have sent ({ uid, type: 'result', ... }, { uid, status }, { uid, log }),
+ * or null for replies the browser does not need (PONG).
+ */
+function decodeReply(buf) {
+    const uidLength = buf[3];
+    const uid = buf.toString('utf8', 4, 4 + uidLength);
+    const fields = {};
+    let pos = 4 + uidLength;
+    while (pos < buf.length) {
+        const tag = buf[pos++];
+        const len = readVarint(buf, pos);
+        fields[tag] = buf.subarray(len.pos, len.pos + len.value);
+        pos = len.pos + len.value;
+    }
+    const text = (tag) => (fields[tag] ? fields[tag].toString('utf8') : '');
+
+    let packet;
+    switch (buf[2]) {
+        case OP.RESULT: {
+            const minterms = [];
+            const mask = fields[TAG.MINTERMS] || Buffer.alloc(8);
+            for (let m = 0; m < 64; m++) {
+                if (mask[m >> 3] & (1 << (m & 7))) minterms.push(m);
+            }
+            packet = { type: 'result', mode: text(TAG.MODE_NAME), target: text(TAG.TARGET), sop: text(TAG.SOP), pos: text(TAG.POS), minterms };
+            break;
+        }
+        case OP.STATUS: packet = { status: text(TAG.TEXT) }; break;
+        case OP.ERROR: packet = { log: `Error: ${text(TAG.TEXT)}` }; break;
+        default: return null;
+    }
+    if (uid) packet.uid = uid;
+    return packet;
+}
+
+module.exports = { encodeCommand, decodeReply, isFrame, OP, TAG };
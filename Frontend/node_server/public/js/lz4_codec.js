@@ -0,0 +1,86 @@
+/*
+ * File: lz4_codec.js
+ * Purpose: Decoder for the C engine's compressed packets.
+ * * Description:
+ * - Shared by the Node bridge (require) and the browser (window.Lz4Codec),
+ *   e.g. a page talking to the engine's WebSocket endpoint directly.
+ * - unwrap() turns a 0xC5 packet back into the original packet bytes
+ *   (JSON or a 0xB1 envelope); decompressBlock() decodes a raw LZ4 block.
+ * * Wire format: see NET_COMPRESSED_MAGIC in Backend/linux_app/include/net_udp.h
+ *   and the block format in utils_lz4.h.
+ */
+
+(function (root, factory) {
+    if (typeof module === 'object' && module.exports) module.exports = factory();
+    else root.Lz4Codec = factory();
+}(typeof self !== 'undefined' ? self : this, function () {
+
+    const COMPRESSED_MARKER = 0xC5;
+    const MIN_MATCH = 4;
+
+    // Reads the length extension after a token nibble of 15
+    function readLength(src, state, base) {
+        let len = base;
+        if (base !== 15) return len;
+        let b;
+        do {
+            if (state.pos >= src.length) throw new Error('lz4: truncated length');
+            b = src[state.pos++];
+            len += b;
+        } while (b === 255);
+        return len;
+    }
+
+    // Decodes an LZ4 block that expands to exactly 'outLen' bytes
+    function decompressBlock(src, outLen) {
+        const out = new Uint8Array(outLen);
+        const state = { pos: 0 };
+        let op = 0;
+        while (state.pos < src.length) {
+            const token = src[state.pos++];
+
+            const literals = readLength(src, state, token >> 4);
+            if (state.pos + literals > src.length || op + literals > outLen) throw new Error('lz4: literals out of range');
+            out.set(src.subarray(state.pos, state.pos + literals), op);
+            state.pos += literals;
+            op += literals;
+            if (state.pos === src.length) break; // The last sequence has no match
+
+            if (state.pos + 2 > src.length) throw new Error('lz4: truncated offset');
+            const offset = src[state.pos] | (src[state.pos + 1] << 8);
+            state.pos += 2;
+            if (offset === 0 || offset > op) throw new Error('lz4: bad offset');
+
+            const matchLen = readLength(src, state, token & 15) + MIN_MATCH;
+            if (op + matchLen > outLen) throw new Error('lz4: match out of range');
+            if (offset >= matchLen) {
+                out.copyWithin(op, op - offset, op - offset + matchLen);
+                op += matchLen;
+            } else {
+                for (let i = 0; i < matchLen; i++, op++) out[op] = out[op - offset]; // Overlapping run
+            }
+        }
+        if (op !== outLen) throw new Error('lz4: size mismatch');
+        return out;
+    }
+
+    function isCompressed(buf) {
+        return buf.length > 0 && buf[0] === COMPRESSED_MARKER;
+    }
+
+    // 0xC5, original length (LEB128 varint), LZ4 block -> original bytes
+    function unwrap(buf) {
+        const bytes = buf instanceof Uint8Array ? buf : new Uint8Array(buf);
+        if (!isCompressed(bytes)) throw new Error('lz4: bad marker');
+        let pos = 1, outLen = 0, scale = 1, b;
+        do {
+            if (pos >= bytes.length) throw new Error('lz4: truncated header');
+            b = bytes[pos++];
+            outLen += (b & 0x7F) * scale;
+            scale *= 128;
+        } while (b & 0x80);
+        return decompressBlock(bytes.subarray(pos), outLen);
+    }
+
+    return { unwrap, decompressBlock, isCompressed };
+}));
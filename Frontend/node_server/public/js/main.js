@@ -7,7 +7,10 @@
 let currentInputMask = 0;
 let currentMinterms = { x:[], y:[], z:[], w:[] };
 let cachedNetlistElements = null; 
+let netlistVersion = 0;               // Netlist version held (0 = none yet)
+let netlistMap = new Map();           // Element id -> element, for applying deltas
 let lastCsvData = null;           
+let pendingMismatchCsv = null;        // Mismatch report of the suite being received
 const logDiv = document.getElementById('server-log'); 
 
 // --- AUDIO: Offline Alert ---
@@ -24,6 +27,10 @@ socket.on('connect', () => {
         indicator.innerHTML = '<span class="w-1.5 h-1.5 rounded-full bg-emerald-500"></span> Connected';
         indicator.style.color = "var(--channel-x)";
     }
+    // Ask for the compact binary netlist; the bridge falls back to JSON otherwise
+    if (window.NetlistCodec) socket.emit('command', 'netfmt binary');
+    // Catch up on the netlist; after a reconnect this is a delta from what we hold
+    socket.emit('command', `netsync ${netlistVersion}`);
     console.log("Socket connected");
 });
 
@@ -92,17 +99,29 @@ socket.on('state_update', (json) => {
         currentMinterms.y = json.mintermsY || [];
         currentMinterms.z = json.mintermsZ || [];
         currentMinterms.w = json.mintermsW || [];
-        cachedNetlistElements = json.elements;
-        refreshDiagram(); 
+        if (applyNetlistUpdate(json)) refreshDiagram();
         updateLiveIO();
     }
-    else if (json.type === 'verification' && json.csv) {
-        addLog("TEST SUCCESS", "var(--status-ok)");
-        lastCsvData = json.csv;
-        const dlBtn = document.getElementById('dl-btn');
-        if (dlBtn) dlBtn.style.display = 'block'; 
+    else if (json.type === 'verify') {
+        // Mismatches stream in 'partial' packets; the last one carries the summary
+        if (pendingMismatchCsv === null) pendingMismatchCsv = "Step,Time,Inputs,Expected,Actual,Diff\n";
+        (json.mismatches || []).forEach(m => {
+            pendingMismatchCsv += `${m.step},${m.time},${m.inputs},${m.expected},${m.actual},${m.diff}\n`;
+        });
+        if (json.status === 'partial') return;
+        if (json.status === 'error') {
+            addLog(`TEST ERROR: ${json.message}`, "#ef4444");
+        } else {
+            const ok = json.status === 'pass';
+            addLog(`TEST ${ok ? 'PASSED' : 'FAILED'}: ${json.passed}/${json.checked} checked steps passed`,
+                   ok ? "var(--status-ok)" : "#ef4444");
+            lastCsvData = pendingMismatchCsv;
+            const dlBtn = document.getElementById('dl-btn');
+            if (dlBtn) dlBtn.style.display = 'block'; 
+        }
+        pendingMismatchCsv = null;
     }
-    if (json.inputs !== undefined) {
+    if (json.inputs !== undefined && json.mode !== undefined) {
         currentInputMask = json.inputs;
         updateLiveIO(); 
         const modes = [
@@ -264,6 +283,49 @@ function handleZoom(val) {
         });
     }
 }
+/**
+ * Applies the netlist part of a combined packet: a full snapshot
+ * ("elements" / "elements_bin") or a delta against "base".
+ * A delta against a version we do not hold triggers a resync request.
+ * @returns {boolean} true if the netlist changed
+ */
+function applyNetlistUpdate(json) {
+    if (json.version === undefined) {
+        // Engine without versioning: always a snapshot
+        cachedNetlistElements = json.elements_bin
+            ? NetlistCodec.decodeNetlist(new Uint8Array(json.elements_bin))
+            : json.elements;
+        return true;
+    }
+    if (json.version === netlistVersion) return false;
+
+    if (json.delta) {
+        if (json.base !== netlistVersion) {
+            socket.emit('command', `netsync ${netlistVersion}`);
+            return false;
+        }
+        const d = json.delta;
+        d.remove_edges.forEach(id => netlistMap.delete(id));
+        d.remove_nodes.forEach(id => netlistMap.delete(id));
+        d.add_nodes.forEach(el => netlistMap.set(el.data.id, el));
+        (d.move_nodes || []).forEach(m => {
+            const el = netlistMap.get(m.id);
+            if (el) netlistMap.set(m.id, { data: el.data, position: m.position });
+        });
+        d.add_edges.forEach(el => netlistMap.set(el.data.id, el));
+    } else {
+        const elements = json.elements_bin
+            ? NetlistCodec.decodeNetlist(new Uint8Array(json.elements_bin))
+            : (json.elements || []);
+        netlistMap = new Map(elements.map(el => [el.data.id, el]));
+    }
+
+    netlistVersion = json.version;
+    cachedNetlistElements = Array.from(netlistMap.values());
+    socket.emit('command', `ack ${netlistVersion}`);
+    return true;
+}
+
 function refreshDiagram() {
     if (!cachedNetlistElements) return;
     const active = [];
@@ -0,0 +1,110 @@
+/*
+ * File: netlist_codec.js
+ * Purpose: Decoder for the C engine's binary netlist and binary envelope.
+ * * Description:
+ * - Shared by the Node bridge (require) and the browser (window.NetlistCodec).
+ * - decodeNetlist() turns an "NB" v1-v3 netlist into the same Cytoscape element
+ *   array the engine emits in JSON mode, so the renderer needs no changes.
+ * - parseEnvelope() splits a 0xB1 datagram into uid, JSON header and netlist.
+ * * Wire format: see Backend/linux_app/include/logic_netlist.h and net_udp.h.
+ */
+
+(function (root, factory) {
+    if (typeof module === 'object' && module.exports) module.exports = factory();
+    else root.NetlistCodec = factory();
+}(typeof self !== 'undefined' ? self : this, function () {
+
+    const ENVELOPE_MARKER = 0xB1;
+    const KIND_NAMES = ['var', 'gate', 'output'];
+    const textDecoder = new TextDecoder();
+
+    // Sequential reader over a Uint8Array
+    function Reader(bytes, offset) {
+        this.bytes = bytes;
+        this.pos = offset || 0;
+    }
+    Reader.prototype.byte = function () {
+        if (this.pos >= this.bytes.length) throw new Error('netlist: truncated');
+        return this.bytes[this.pos++];
+    };
+    Reader.prototype.varint = function () {
+        let value = 0, scale = 1, b;
+        do {
+            b = this.byte();
+            value += (b & 0x7F) * scale; // multiply, not shift: stays exact past 2^31
+            scale *= 128;
+        } while (b & 0x80);
+        return value;
+    };
+    Reader.prototype.string = function (len) {
+        if (this.pos + len > this.bytes.length) throw new Error('netlist: truncated');
+        const s = textDecoder.decode(this.bytes.subarray(this.pos, this.pos + len));
+        this.pos += len;
+        return s;
+    };
+
+    function toBytes(buf) {
+        if (buf instanceof Uint8Array) return buf;
+        return new Uint8Array(buf);
+    }
+
+    /**
+     * Decodes a binary netlist into Cytoscape elements.
+     * @param {Uint8Array|ArrayBuffer} buf - Bytes starting at the 'N' 'B' magic
+     * @returns {Array} Elements identical to the JSON encoding
+     */
+    function decodeNetlist(buf) {
+        const r = new Reader(toBytes(buf));
+        if (r.byte() !== 0x4E || r.byte() !== 0x42) throw new Error('netlist: bad magic');
+        const version = r.byte();
+        if (version < 1 || version > 3) throw new Error(`netlist: unsupported version ${version}`);
+        const v2 = (version >= 2); // v2+: explicit stable node IDs, edges carry a pin
+
+        const labels = new Array(r.varint());
+        for (let i = 0; i < labels.length; i++) labels[i] = r.string(r.varint());
+
+        const elements = [];
+        const nodeCount = r.varint();
+        for (let i = 0; i < nodeCount; i++) {
+            const id = v2 ? r.varint() : i;
+            const kind = KIND_NAMES[r.byte()] || 'gate';
+            elements.push({ data: { id: `n${id}`, label: labels[r.varint()], type: kind } });
+        }
+        const edgeCount = r.varint();
+        for (let i = 0; i < edgeCount; i++) {
+            const source = r.varint();
+            const target = r.varint();
+            if (v2) {
+                const pin = r.varint();
+                elements.push({ data: { id: `e${source}_${target}_${pin}`, source: `n${source}`, target: `n${target}` } });
+            } else {
+                elements.push({ data: { source: `n${source}`, target: `n${target}` } });
+            }
+        }
+        // v3: optional layout section, one (x, y) per node in node order
+        if (version >= 3 && r.byte() === 1) {
+            for (let i = 0; i < nodeCount; i++) elements[i].position = { x: r.varint(), y: r.varint() };
+        }
+        return elements;
+    }
+
+    /**
+     * Splits a binary envelope datagram.
+     * @param {Uint8Array} buf - Raw datagram whose first byte is 0xB1
+     * @returns {{uid: string, header: object, netlist: Uint8Array}}
+     */
+    function parseEnvelope(buf) {
+        const bytes = toBytes(buf);
+        const r = new Reader(bytes);
+        if (r.byte() !== ENVELOPE_MARKER) throw new Error('envelope: bad marker');
+        const uid = r.string(r.varint());
+        const header = JSON.parse(r.string(r.varint()));
+        return { uid, header, netlist: bytes.subarray(r.pos) };
+    }
+
+    function isEnvelope(buf) {
+        return buf.length > 0 && buf[0] === ENVELOPE_MARKER;
+    }
+
+    return { decodeNetlist, parseEnvelope, isEnvelope };
+}));
@@ -5,6 +5,8 @@
  * - Uses Cytoscape.js to render the JSON Netlist received from the C App.
  * - Applies custom styles (shapes, colors) to represent logic gates.
  * - Handles "Input Merging" to clean up the diagram.
+ * - Uses the engine's precomputed layout when nodes carry a "position";
+ *   Dagre is only the fallback for netlists without one.
  */
 
 // --- 1. Logic to Merge Duplicate Inputs ---
@@ -66,8 +68,11 @@ function renderCircuit(target, rawElements, activeLabels = null) {
         return;
     }
 
+    // Engine-laid-out netlists already have one node per variable
+    const preset = rawElements.length > 0 && rawElements.every(el => el.data.source || el.position);
+
     // Pre-process elements to merge inputs
-    const elements = mergeCommonInputs(rawElements);
+    const elements = preset ? rawElements : mergeCommonInputs(rawElements);
 
     // Initialize Cytoscape
     const cy = cytoscape({
@@ -178,22 +183,27 @@ function renderCircuit(target, rawElements, activeLabels = null) {
         }
     }
 
-    // --- LAYOUT ENGINE (Dagre) ---
-    // Dagre creates hierarchical layouts (like flowcharts)
-    cy.layout({
-        name: 'dagre', 
-        rankDir: 'LR',   // Left-to-Right flow
-        align: 'UL',     // Align Upper-Left
+    // --- LAYOUT ENGINE ---
+    // Positions from the engine are used as-is; otherwise Dagre
+    // creates hierarchical layouts (like flowcharts)
+    if (preset) {
+        cy.layout({ name: 'preset', padding: 40 }).run();
+    } else {
+        cy.layout({
+            name: 'dagre', 
+            rankDir: 'LR',   // Left-to-Right flow
+            align: 'UL',     // Align Upper-Left
         
-        // Spacing Settings for Clean 90-degree wires
-        nodeSep: 60,     // Vertical space between nodes
-        rankSep: 150,    // Horizontal space (runway for wires)
+            // Spacing Settings for Clean 90-degree wires
+            nodeSep: 60,     // Vertical space between nodes
+            rankSep: 150,    // Horizontal space (runway for wires)
         
-        padding: 40,
-        animate: true,
-        animationDuration: 400,
-        ranker: 'network-simplex'
-    }).run();
+            padding: 40,
+            animate: true,
+            animationDuration: 400,
+            ranker: 'network-simplex'
+        }).run();
+    }
 
     // --- EXPOSE FOR SLIDER ---
     // Save instance globally so the Zoom Slider can access it
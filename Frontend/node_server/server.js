@@ -1,7 +1,7 @@
 /**
  * ============================================================================
  * File: server.js
- * Version: 1.0.0
+ * Version: 1.9.0
  * Description:
  * This is the main entry point for the Node.js backend. It acts as a "Bridge"
  * or middleware between the Web Frontend (Browser) and the C Logic Engine.
@@ -13,6 +13,25 @@
  * * Data Flow:
  * Browser -> Socket.IO -> Node.js -> UDP -> C App (Logic Engine)
  * C App -> UDP -> Node.js -> Socket.IO -> Browser
+ * * Packets too large for one datagram arrive as sequenced chunks (first
+ * byte 0xC4) and are reassembled here before routing.
+ * * With ENGINE_TRANSPORT=shm and the C app on this host, packets travel
+ * through shared-memory rings instead (shm_ring.js); UDP then only
+ * carries one-byte doorbells. A ring with a malformed message in it
+ * is abandoned for UDP until the C app restarts.
+ * * Browser commands go to C as binary frames (proto_codec.js) unless
+ * ENGINE_PROTO=text; reply frames are turned back into JSON here.
+ * * Broadcasts are coalesced per browser and sent at most at the
+ * browser's own rates ("rate"; the engine's defaults otherwise): state
+ * and outputs packets latest-wins, results and netlists latest snapshot
+ * per type and channel (netlist deltas are kept in order until a
+ * snapshot supersedes them). Direct replies go out at once.
+ * Counters: GET /stats.
+ * * Each browser only gets the broadcast topics it subscribed to
+ * ("subscribe"/"unsubscribe", mirrored from its commands).
+ * * Large packets can arrive LZ4-compressed (first byte 0xC5, see
+ * ENGINE_COMPRESS); they are decompressed here (lz4_codec.js) and then
+ * handled like any other packet, so browsers never see compression.
  * ============================================================================
  */
 
@@ -23,12 +42,51 @@ const server = http.createServer(app);
 const { Server } = require("socket.io");
 const io = new Server(server);
 const dgram = require('dgram');
+const NetlistCodec = require('./public/js/netlist_codec.js');
+const { ShmRing, DOORBELL } = require('./shm_ring.js');
+const ProtoCodec = require('./proto_codec.js');
+const Lz4Codec = require('./public/js/lz4_codec.js');
 
 // --- CONFIGURATION CONSTANTS ---
 const WEB_PORT = 8088;                                  // Port for the browser to access (http://localhost:8088)
 const TARGET_IP = process.env.TARGET_IP || '127.0.0.1'; // Allow environment variable to override, or default to localhost
 const TARGET_PORT = 12345;                              // UDP Port the C Application is listening on
 const LISTEN_PORT = 12346;                              // UDP Port Node.js listens on for responses from C
+const ENGINE_NETFMT = process.env.ENGINE_NETFMT || 'binary'; // Netlist encoding requested from C ('json' for debugging)
+const ENGINE_PROTO = process.env.ENGINE_PROTO || 'binary';   // Command encoding sent to C ('text' for debugging)
+const ENGINE_TRANSPORT = process.env.ENGINE_TRANSPORT || 'udp'; // 'shm': shared-memory rings when C runs on this host
+const SHM_OUT_PATH = '/dev/shm/logic_sim_out';          // C -> Node ring
+const SHM_IN_PATH = '/dev/shm/logic_sim_in';            // Node -> C ring
+const TARGET_IS_LOCAL = /^127\./.test(TARGET_IP) || TARGET_IP === 'localhost';
+// Packet compression requested from C: 'lz4 [min_bytes]' or 'off'. Loopback bandwidth is free, so only remote engines compress by default
+const ENGINE_COMPRESS = process.env.ENGINE_COMPRESS || (TARGET_IS_LOCAL ? 'off' : 'lz4');
+const compressStats = { decompressed: 0, bytes_in: 0, bytes_out: 0, errors: 0 };
+
+// --- BROADCAST RATE LIMITING ---
+// Rates of browsers that did not set their own, mirrored from the engine's defaults (PUBLISH_*_HZ until it reports)
+const defaultRates = {
+    state_hz: Number(process.env.BRIDGE_STATE_HZ) || 50,
+    heavy_hz: Number(process.env.BRIDGE_HEAVY_HZ) || 10,
+};
+const HEAVY_TYPES = new Set(['result', 'netlist', 'combined']);
+const publishStats = { immediate: 0, state_sent: 0, heavy_sent: 0, coalesced: 0 };
+
+// --- BROADCAST TOPICS (must match TOPIC_NAMES in net_udp.c) ---
+const TOPIC_GROUPS = {
+    results: ['result_x', 'result_y', 'result_z', 'result_w'],
+    all: ['state', 'outputs', 'result_x', 'result_y', 'result_z', 'result_w', 'netlist', 'combined', 'verify', 'metrics'],
+};
+const DEFAULT_TOPICS = ['state', 'result_x', 'result_y', 'result_z', 'result_w', 'netlist', 'combined'];
+
+// --- CHUNKED TRANSPORT ---
+const CHUNK_MAGIC = 0xC4;                 // Must match NET_CHUNK_MAGIC in net_udp.h
+const REASSEMBLY_TIMEOUT_MS = 2000;       // Incomplete messages are dropped after this
+const NACK_DELAY_MS = 40;                 // Quiet time before asking for missing chunks
+const NACK_RETRIES = 3;
+// Loss is not expected on loopback; over a real link, ask the C app to resend missing chunks
+const CHUNK_NACK = process.env.CHUNK_NACK
+    ? process.env.CHUNK_NACK === '1'
+    : !TARGET_IS_LOCAL;
 
 // --- UDP SOCKET SETUP (Backend-to-Backend Communication) ---
 // We use UDP for its low overhead, matching the embedded nature of the C app.
@@ -41,50 +99,431 @@ udpSocket.on('error', (err) => {
 });
 
 /**
- * UDP Message Handler
- * This function triggers whenever the C application sends a packet to Node.js.
- * It parses the JSON response and routes it to the correct WebSocket client.
+ * Emits a decoded binary-envelope packet to one socket, honouring the
+ * socket's own netlist format. Browsers that negotiated 'binary' get the
+ * raw netlist bytes; everyone else gets the usual JSON element array.
+ * 'decoded' caches the JSON form so it is built at most once per packet.
  */
-udpSocket.on('message', (msg, rinfo) => {
-    const messageStr = msg.toString().trim();
+function emitEnvelope(socket, packet, decoded) {
+    const payload = Object.assign({}, packet.header);
+    if (packet.uid) payload.uid = packet.uid;
+
+    if (socket.data.netfmt === 'binary') {
+        payload.elements_bin = Buffer.from(packet.netlist);
+    } else {
+        if (!decoded.elements) decoded.elements = NetlistCodec.decodeNetlist(packet.netlist);
+        payload.elements = decoded.elements;
+    }
+    socket.emit('state_update', payload);
+}
+
+/**
+ * Binary Envelope Handler
+ * Routes a 0xB1 datagram (JSON header + binary netlist) from the C app.
+ */
+function handleEnvelope(msg) {
+    const packet = NetlistCodec.parseEnvelope(msg);
+    const decoded = {};
+    if (packet.uid) {
+        const socket = io.sockets.sockets.get(packet.uid);
+        if (socket) emitEnvelope(socket, packet, decoded);
+    } else {
+        const key = publishKey(packet.header);
+        const topic = topicOf(packet.header);
+        io.sockets.sockets.forEach((socket) => {
+            if (!topic || socket.data.topics.has(topic)) publish(socket, key, () => emitEnvelope(socket, packet, decoded));
+        });
+    }
+}
+
+/**
+ * Topic Filtering
+ * Returns the topic of a broadcast packet, or null for packets every
+ * browser gets (logs, replies to the engine's own status).
+ */
+function topicOf(packet) {
+    switch (packet.type) {
+        case undefined: return packet.mode !== undefined && packet.inputs !== undefined ? 'state' : null;
+        case 'result': return /^[XYZW]$/i.test(packet.target || '') ? `result_${packet.target.toLowerCase()}` : null;
+        case 'outputs': case 'netlist': case 'combined': case 'verify': case 'metrics': return packet.type;
+        default: return null;
+    }
+}
+
+/**
+ * Applies a browser's "subscribe"/"unsubscribe <topic,...>" command to
+ * its own topic set (the C app keeps the same set for its session).
+ */
+function trackSubscription(socket, cmd) {
+    const m = /^(subscribe|unsubscribe) (.+)$/.exec(cmd);
+    if (!m) return;
+    const names = m[2].split(/[, ]+/).filter(Boolean);
+    const topics = [].concat(...names.map((name) => TOPIC_GROUPS[name] || [name]));
+    if (!topics.every((t) => TOPIC_GROUPS.all.includes(t))) return; // The C app rejects the whole list
+    for (const t of topics) {
+        if (m[1] === 'subscribe') socket.data.topics.add(t);
+        else socket.data.topics.delete(t);
+    }
+}
+
+/**
+ * Broadcast Coalescing
+ * Returns the coalescing key of a rate-limited broadcast ("type:target"
+ * for results and netlists, "state:" and "outputs:" for the state
+ * class), or null for packets that are sent at once (logs, reports).
+ */
+function publishKey(packet) {
+    if (HEAVY_TYPES.has(packet.type)) return `${packet.type}:${packet.target || ''}`;
+    const topic = topicOf(packet);
+    return topic === 'state' || topic === 'outputs' ? `${topic}:` : null;
+}
+
+/**
+ * Returns the rate class ('state' or 'heavy') of a coalescing key.
+ */
+function rateClass(key) {
+    return /^(state|outputs):/.test(key) ? 'state' : 'heavy';
+}
+
+/**
+ * Returns the rate in Hz at which 'socket' gets broadcasts of class
+ * 'cls': its own from "rate", else the engine's defaults.
+ */
+function socketRate(socket, cls) {
+    const rates = socket.data.rates || defaultRates;
+    return cls === 'state' ? rates.state_hz : rates.heavy_hz;
+}
+
+/**
+ * Sends a broadcast to one socket. Rate-limited packets wait in the
+ * pending map of their class until the socket's next slot for that
+ * class. A snapshot replaces everything pending under its key; a delta
+ * ('chained') only applies on top of the version before it, so it is
+ * queued behind the others and never replaced by another delta.
+ */
+function publish(socket, key, emit, chained) {
+    if (!key) {
+        publishStats.immediate++;
+        emit();
+        return;
+    }
+    const cls = rateClass(key);
+    const queue = socket.data.publish[cls];
+    if (chained) {
+        queue.pending.set(`${key}#${queue.seq++}`, emit);
+    } else {
+        for (const pendingKey of queue.pending.keys()) {
+            if (pendingKey === key || pendingKey.startsWith(`${key}#`)) {
+                queue.pending.delete(pendingKey);
+                publishStats.coalesced++;
+            }
+        }
+        queue.pending.set(key, emit); // Re-inserted: flushed after the deltas before it
+    }
+    if (queue.timer) return;
+    const wait = Math.max(0, queue.last + 1000 / socketRate(socket, cls) - Date.now());
+    queue.timer = setTimeout(() => flushPublish(socket, cls), wait);
+}
+
+function flushPublish(socket, cls) {
+    const queue = socket.data.publish[cls];
+    queue.timer = null;
+    queue.last = Date.now();
+    for (const emit of queue.pending.values()) {
+        publishStats[`${cls}_sent`]++;
+        emit();
+    }
+    queue.pending.clear();
+}
+
+/**
+ * Mirrors the rates from a "publish" report (the reply to "rate"): a
+ * browser's own, or the engine's defaults when it has no 'uid'.
+ */
+function trackRates(report) {
+    const rates = { state_hz: report.state_hz, heavy_hz: report.heavy_hz };
+    if (!(rates.state_hz > 0 && rates.heavy_hz > 0)) return;
+    if (!report.uid) {
+        Object.assign(defaultRates, rates);
+        return;
+    }
+    const socket = io.sockets.sockets.get(report.uid);
+    if (socket) socket.data.rates = report.default ? null : rates;
+}
+
+/**
+ * Chunk Reassembly
+ * Messages being reassembled, keyed by message ID:
+ * { count, chunks[], received, timeout, nackTimer, nacks }
+ */
+const pendingChunks = new Map();
+
+/**
+ * Reads the LEB128 varint at 'pos'. Returns { value, pos } or null.
+ */
+function readVarint(buf, pos) {
+    let value = 0;
+    let scale = 1;
+    while (pos < buf.length) {
+        const byte = buf[pos++];
+        value += (byte & 0x7F) * scale;
+        if (!(byte & 0x80)) return { value, pos };
+        scale *= 128;
+    }
+    return null;
+}
+
+/**
+ * Asks the C app for the chunks of message 'id' still missing, a few
+ * times, until the message completes or times out.
+ */
+function scheduleNack(id, entry) {
+    clearTimeout(entry.nackTimer);
+    if (!CHUNK_NACK || entry.nacks >= NACK_RETRIES) return;
+    entry.nackTimer = setTimeout(() => {
+        const missing = [];
+        for (let i = 0; i < entry.count; i++) {
+            if (!entry.chunks[i]) missing.push(i);
+        }
+        entry.nacks++;
+        sendToCpp('', `nack ${id} ${missing.join(',')}`);
+        scheduleNack(id, entry);
+    }, NACK_DELAY_MS);
+}
+
+/**
+ * Chunk Handler
+ * Stores one 0xC4 datagram; once every chunk of its message is in, the
+ * joined payload is handled like any other datagram.
+ */
+function handleChunk(msg) {
+    const id = readVarint(msg, 1);
+    const index = id && readVarint(msg, id.pos);
+    const count = index && readVarint(msg, index.pos);
+    if (!count || index.value >= count.value) {
+        console.error('Bad chunk from C app');
+        return;
+    }
+
+    let entry = pendingChunks.get(id.value);
+    if (!entry || entry.count !== count.value) {
+        if (entry) clearTimeout(entry.nackTimer);
+        entry = { count: count.value, chunks: new Array(count.value), received: 0, nacks: 0 };
+        entry.timeout = setTimeout(() => {
+            clearTimeout(entry.nackTimer);
+            pendingChunks.delete(id.value);
+            console.error(`Dropped incomplete message ${id.value} (${entry.received}/${entry.count} chunks)`);
+        }, REASSEMBLY_TIMEOUT_MS);
+        pendingChunks.set(id.value, entry);
+    }
 
+    if (!entry.chunks[index.value]) {
+        entry.chunks[index.value] = msg.subarray(count.pos);
+        entry.received++;
+    }
+    if (entry.received < entry.count) {
+        scheduleNack(id.value, entry);
+        return;
+    }
+
+    clearTimeout(entry.timeout);
+    clearTimeout(entry.nackTimer);
+    pendingChunks.delete(id.value);
+    handleDatagram(Buffer.concat(entry.chunks));
+}
+
+/**
+ * Datagram Handler
+ * Routes one complete packet from the C app: a binary envelope, or a
+ * JSON response for the correct WebSocket client.
+ */
+function handleDatagram(msg) {
+    if (Lz4Codec.isCompressed(msg)) {
+        let packet;
+        try {
+            packet = Lz4Codec.unwrap(msg);
+        } catch (e) {
+            compressStats.errors++;
+            console.error('Bad compressed packet from C app:', e.message);
+            return;
+        }
+        compressStats.decompressed++;
+        compressStats.bytes_in += msg.length;
+        compressStats.bytes_out += packet.length;
+        handleDatagram(Buffer.from(packet.buffer, packet.byteOffset, packet.length));
+        return;
+    }
+
+    if (NetlistCodec.isEnvelope(msg)) {
+        try {
+            handleEnvelope(msg);
+        } catch (e) {
+            console.error('Bad binary packet from C app:', e.message);
+        }
+        return;
+    }
+
+    if (ProtoCodec.isFrame(msg)) {
+        let packet = null;
+        try {
+            packet = ProtoCodec.decodeReply(msg);
+        } catch (e) {
+            console.error('Bad reply frame from C app:', e.message);
+        }
+        if (packet) routePacket(packet);
+        return;
+    }
+
+    const messageStr = msg.toString().trim();
+    let jsonData;
     try {
         // Attempt to parse the incoming string as JSON
-        const jsonData = JSON.parse(messageStr);
-
-        // --- SESSION ROUTING LOGIC ---
-        // The C app includes a 'uid' field if the response is meant for a specific user
-        // (e.g., a private 'preview' command).
-        if (jsonData.uid) {
-            // Route exclusively to the specific socket ID (Browser Tab)
-            io.to(jsonData.uid).emit('state_update', jsonData);
-        } else {
-            // If no 'uid' is present, this is a System Broadcast (e.g., Hardware State Changed).
-            // Broadcast to ALL connected clients to keep them in sync.
-            io.emit('state_update', jsonData);
-        }
+        jsonData = JSON.parse(messageStr);
     } catch (e) {
         // Fallback: If the message isn't valid JSON, log it as a raw text message.
         // This is extremely useful for debugging C `printf` outputs remotely.
         io.emit('server_log', messageStr);
+        return;
+    }
+
+    // Transport handshake, for the bridge only
+    if (jsonData.type === 'transport') {
+        if (shm) shm.ready = jsonData.mode === 'shm';
+        console.log(`Engine transport: ${jsonData.mode}`);
+        return;
+    }
+    if (jsonData.type === 'compress' && !jsonData.uid) return; // Reply to announceFormat
+    if (jsonData.type === 'publish') {
+        trackRates(jsonData);
+        if (!jsonData.uid) return; // Reply to announceFormat
+    }
+    routePacket(jsonData);
+}
+
+/**
+ * Session Routing
+ * The C app includes a 'uid' field if the response is meant for a specific user
+ * (e.g., a private 'preview' command).
+ */
+function routePacket(jsonData) {
+    if (jsonData.uid) {
+        // Route exclusively to the specific socket ID (Browser Tab)
+        io.to(jsonData.uid).emit('state_update', jsonData);
+    } else {
+        // If no 'uid' is present, this is a System Broadcast (e.g., Hardware State Changed).
+        // Broadcast to ALL connected clients to keep them in sync, each at its own rates.
+        // Verification summaries name their requester ('from'), who already has the reply.
+        const key = publishKey(jsonData);
+        const topic = topicOf(jsonData);
+        io.sockets.sockets.forEach((socket) => {
+            if (topic && !socket.data.topics.has(topic)) return;
+            if (jsonData.from === socket.id) return;
+            publish(socket, key, () => socket.emit('state_update', jsonData), jsonData.delta !== undefined);
+        });
+    }
+}
+
+/**
+ * UDP Message Handler
+ * This function triggers whenever the C application sends a packet to Node.js.
+ */
+udpSocket.on('message', (msg, rinfo) => {
+    if (msg.length === 1 && msg[0] === DOORBELL) {
+        if (shm && !shm.broken && !shm.out.drain(handleDatagram)) {
+            // Left alone until the C app restarts with new rings
+            console.error('Malformed message in the shared-memory ring, using UDP');
+            shm.broken = true;
+            shm.ready = false;
+            sendToCpp('', 'transport udp');
+        }
+    } else if (msg.length > 0 && msg[0] === CHUNK_MAGIC) {
+        handleChunk(msg);
+    } else {
+        handleDatagram(msg);
     }
 });
 
 // Bind the UDP socket to the listening port to start receiving data
 udpSocket.bind(LISTEN_PORT, () => {
     console.log(`UDP Bridge Listening on port ${LISTEN_PORT}`);
+    announceTransport();
+    announceFormat();
 });
 
+/**
+ * Shared-Memory Transport
+ * { out, in, ready }: the open rings; 'ready' once the C app confirmed
+ * it replies through them. Commands use the ring only when ready.
+ */
+let shm = null;
+
+/**
+ * Helper: Switch the C app to the shared-memory rings (ENGINE_TRANSPORT=shm,
+ * C app on this host). Reopens the rings if the C app has recreated them
+ * since (it does on every start), then asks for the switch over UDP.
+ */
+function announceTransport() {
+    if (ENGINE_TRANSPORT !== 'shm' || !TARGET_IS_LOCAL) return;
+    if (shm && (shm.ready || shm.broken) && shm.in.isCurrent()) return;
+
+    if (shm) {
+        shm.out.close();
+        shm.in.close();
+        shm = null;
+    }
+    try {
+        shm = { out: new ShmRing(SHM_OUT_PATH), in: new ShmRing(SHM_IN_PATH), ready: false, broken: false };
+    } catch (e) {
+        if (shm && shm.out) shm.out.close();
+        shm = null;
+        console.error('Shared-memory transport unavailable, using UDP:', e.message);
+        return;
+    }
+    sendToCpp('', 'transport shm');
+}
+
+/**
+ * Helper: Request the broadcast netlist encoding and compression from
+ * the C app. The bridge can decode either encoding, so it asks for the
+ * compact one. Sent without a socket ID, these set the engine default
+ * (compression only applies to broadcasts; each browser's session asks
+ * for its own on connection). Also asks for the default broadcast
+ * rates, which browsers without their own are held to. Repeated on
+ * every browser connection because the C app may have started after
+ * the bridge.
+ */
+function announceFormat() {
+    sendToCpp('', `netfmt ${ENGINE_NETFMT}`);
+    sendToCpp('', `compress ${ENGINE_COMPRESS}`);
+    sendToCpp('', 'rate');
+}
+
 /**
  * Helper: Send Command to C Backend
  * Formats the payload according to the protocol defined in the C application.
- * * Protocol Format: "SocketID|Command"
+ * * Protocol Format: "SocketID|Command", or a binary frame carrying both
  * - SocketID: The unique ID of the browser user (for routing replies).
  * - Command: The text command (e.g., "program x A+B").
  */
 function sendToCpp(socketId, command) {
-    const payload = `${socketId}|${command}`;
-    const message = Buffer.from(payload);
+    const payload = socketId ? `${socketId}|${command}` : command;
+    const message = socketId && ENGINE_PROTO === 'binary'
+        ? ProtoCodec.encodeCommand(socketId, command)
+        : Buffer.from(payload);
+
+    // Through the ring if the C app reads it (a restarted C app has new rings)
+    if (shm && shm.ready) {
+        if (!shm.in.isCurrent()) {
+            shm.ready = false;
+            announceTransport();
+        } else {
+            const doorbell = shm.in.write(message);
+            if (doorbell !== null) {
+                if (doorbell) udpSocket.send(Buffer.from([DOORBELL]), TARGET_PORT, TARGET_IP);
+                return;
+            }
+        }
+    }
 
     // Send the packet to the C App (Localhost:12345)
     udpSocket.send(message, TARGET_PORT, TARGET_IP, (err) => {
@@ -96,19 +535,53 @@ function sendToCpp(socketId, command) {
 // Serve static assets (index.html, style.css, client-side JS) from the 'public' folder
 app.use(express.static('public')); 
 
+// Bridge counters: broadcasts sent at once, rate-limited broadcasts sent and coalesced, packets decompressed
+app.get('/stats', (req, res) => {
+    let pending = 0, ownRates = 0;
+    io.sockets.sockets.forEach((socket) => {
+        pending += socket.data.publish.state.pending.size + socket.data.publish.heavy.pending.size;
+        if (socket.data.rates) ownRates++;
+    });
+    const ratio = compressStats.bytes_in ? +(compressStats.bytes_out / compressStats.bytes_in).toFixed(2) : 0;
+    res.json(Object.assign({ default_rates: defaultRates, own_rates: ownRates, clients: io.sockets.sockets.size, pending }, publishStats,
+        { compression: Object.assign({ mode: ENGINE_COMPRESS, ratio }, compressStats) }));
+});
+
 // --- SOCKET.IO SETUP (Frontend-to-Backend Communication) ---
 io.on('connection', (socket) => {
     console.log(`User Connected: ${socket.id}`);
 
     // Event: 'command'
     // Triggered when the frontend calls socket.emit('command', ...)
+    socket.data.netfmt = 'json';
+    socket.data.publish = {
+        state: { pending: new Map(), timer: null, last: 0, seq: 0 },
+        heavy: { pending: new Map(), timer: null, last: 0, seq: 0 },
+    };
+    socket.data.rates = null; // Follows defaultRates until the engine reports its own
+    socket.data.topics = new Set(DEFAULT_TOPICS);
+    announceTransport();
+    announceFormat();
+    if (ENGINE_PROTO === 'binary') sendToCpp(socket.id, 'proto binary');
+    if (ENGINE_COMPRESS !== 'off') sendToCpp(socket.id, `compress ${ENGINE_COMPRESS}`);
+
     socket.on('command', (cmd) => {
+        // Remember this tab's netlist encoding so broadcasts can be tailored
+        const fmt = /^netfmt (json|binary)$/.exec(cmd);
+        if (fmt) socket.data.netfmt = fmt[1];
+        trackSubscription(socket, cmd);
+
         // Forward the command immediately to the C backend via UDP
         sendToCpp(socket.id, cmd);
     });
 
     socket.on('disconnect', () => {
         console.log(`User Disconnected: ${socket.id}`);
+        clearTimeout(socket.data.publish.state.timer);
+        clearTimeout(socket.data.publish.heavy.timer);
+        // Topics nobody receives any more are not computed by the C app, nor at this tab's rate
+        sendToCpp(socket.id, 'unsubscribe all');
+        sendToCpp(socket.id, 'rate default');
     });
 });
 
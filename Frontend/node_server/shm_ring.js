@@ -0,0 +1,147 @@
+/**
+ * ============================================================================
+ * File: shm_ring.js
+ * Version: 1.1.0
+ * Description:
+ * Node side of the engine's shared-memory rings (see net_shm.h in the C
+ * app for the layout). Node cannot map memory without a native addon,
+ * so the ring file in /dev/shm is read and written with positioned
+ * reads/writes: one copy per message, but no socket and no datagram
+ * size limit. The doorbell is a one-byte datagram on the existing UDP
+ * sockets, sent only to a consumer that is asleep.
+ *
+ * Version 1.1.0: drain() checks every length word against the ring and
+ * stops at the first one that cannot be right.
+ * ============================================================================
+ */
+
+const fs = require('fs');
+
+const MAGIC = 'LSRB';
+const DATA = 256;
+const OFFSET_CAPACITY = 4;
+const OFFSET_HEAD = 64;
+const OFFSET_TAIL = 128;
+const OFFSET_WAITING = 192;
+const PAD = 0xFFFFFFFF;
+const DOORBELL = 0xD0;
+
+class ShmRing {
+    /**
+     * Opens an existing ring, e.g. '/dev/shm/logic_sim_out'.
+     * Throws if the file is missing or is not a ring.
+     */
+    constructor(path) {
+        this.path = path;
+        this.fd = fs.openSync(path, 'r+');
+        this.ino = fs.fstatSync(this.fd).ino;
+        this.word = Buffer.alloc(8);
+
+        const header = Buffer.alloc(8);
+        fs.readSync(this.fd, header, 0, 8, 0);
+        if (header.toString('latin1', 0, 4) !== MAGIC) {
+            this.close();
+            throw new Error(`${path} is not a ring`);
+        }
+        this.capacity = header.readUInt32LE(OFFSET_CAPACITY);
+    }
+
+    close() {
+        if (this.fd !== null) fs.closeSync(this.fd);
+        this.fd = null;
+    }
+
+    /** True while the engine still has this ring (it recreates them on restart). */
+    isCurrent() {
+        try {
+            return fs.statSync(this.path).ino === this.ino;
+        } catch (e) {
+            return false;
+        }
+    }
+
+    readU64(offset) {
+        fs.readSync(this.fd, this.word, 0, 8, offset);
+        return Number(this.word.readBigUInt64LE(0));
+    }
+
+    writeU64(offset, value) {
+        this.word.writeBigUInt64LE(BigInt(value), 0);
+        fs.writeSync(this.fd, this.word, 0, 8, offset);
+    }
+
+    readU32(offset) {
+        fs.readSync(this.fd, this.word, 0, 4, offset);
+        return this.word.readUInt32LE(0);
+    }
+
+    writeU32(offset, value) {
+        this.word.writeUInt32LE(value, 0);
+        fs.writeSync(this.fd, this.word, 0, 4, offset);
+    }
+
+    /**
+     * Consumer: passes every waiting message (a Buffer) to onMessage, then
+     * marks this side asleep so the next message rings the doorbell.
+     * Returns false, leaving the ring alone, if a length or position
+     * does not fit between head and tail or past the end of the data.
+     */
+    drain(onMessage) {
+        const mask = this.capacity - 1;
+        for (;;) {
+            let head = this.readU64(OFFSET_HEAD);
+            const tail = this.readU64(OFFSET_TAIL);
+            if (tail < head || tail - head > this.capacity) return false;
+            while (head < tail) {
+                const offset = head & mask;
+                const room = this.capacity - offset;
+                const len = this.readU32(DATA + offset);
+                if (len === PAD) {
+                    if (room > tail - head) return false;
+                    head += room;
+                    continue;
+                }
+                const need = 4 + ((len + 3) & ~3);
+                if (need > tail - head || need > room) return false;
+                const msg = Buffer.allocUnsafe(len);
+                fs.readSync(this.fd, msg, 0, len, DATA + offset + 4);
+                head += need;
+                onMessage(msg);
+            }
+            this.writeU64(OFFSET_HEAD, head);
+
+            this.writeU32(OFFSET_WAITING, 1);
+            if (this.readU64(OFFSET_TAIL) === head) return true;
+            this.writeU32(OFFSET_WAITING, 0);
+        }
+    }
+
+    /**
+     * Producer (single): appends one message.
+     * Returns null if it does not fit, otherwise whether the consumer
+     * was asleep and needs the doorbell.
+     */
+    write(msg) {
+        const need = 4 + ((msg.length + 3) & ~3);
+        if (msg.length > this.capacity / 2) return null;
+        const head = this.readU64(OFFSET_HEAD);
+        const tail = this.readU64(OFFSET_TAIL);
+        let offset = tail & (this.capacity - 1);
+        const skip = this.capacity - offset < need ? this.capacity - offset : 0;
+        if (tail + skip + need - head > this.capacity) return null;
+
+        if (skip) {
+            this.writeU32(DATA + offset, PAD);
+            offset = 0;
+        }
+        this.writeU32(DATA + offset, msg.length);
+        fs.writeSync(this.fd, msg, 0, msg.length, DATA + offset + 4);
+        this.writeU64(OFFSET_TAIL, tail + skip + need);
+
+        if (this.readU32(OFFSET_WAITING) === 0) return false;
+        this.writeU32(OFFSET_WAITING, 0);
+        return true;
+    }
+}
+
+module.exports = { ShmRing, DOORBELL };